@@ -0,0 +1,813 @@
+#include <stdexcept>
+#include <vector>
+#include <array>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <mutex>
+#include <filesystem>
+#include <string>
+
+#include "EditorBackend.hpp"
+#include "core/Hash.hpp"
+#include "core/JobSystem.hpp"
+#include "core/Log.hpp"
+#include "core/Profiler.hpp"
+#include "graphics/DeviceAllocator.hpp"
+#include "graphics/GpuProfiler.hpp"
+#include "graphics/PipelineCache.hpp"
+#include "graphics/RenderGraph.hpp"
+#include "graphics/ShaderCache.hpp"
+#include "graphics/Uploader.hpp"
+
+#include <imgui.h>
+#include <backends/imgui_impl_glfw.h>
+#include <backends/imgui_impl_vulkan.h>
+#if defined(__APPLE__)
+// MoltenVK on macOS requires Metal surface + portability extensions
+#ifndef VK_USE_PLATFORM_METAL_EXT
+#define VK_USE_PLATFORM_METAL_EXT
+#endif
+#endif
+
+using namespace dancore::ui;
+using dancore::editor::BackendConfig;
+using dancore::editor::FrameTimings;
+using dancore::editor::FrameCounters;
+
+static void VK_CHECK(VkResult r, const char* where){ if(r!=VK_SUCCESS){ std::cerr<<"Vulkan error "<<r<<" at "<<where<<"\n"; throw std::runtime_error("Vulkan error"); }}
+
+ // --- globals (bootstrap-only) ---
+GLFWwindow* gWin{};
+VkInstance gInst{};
+VkSurfaceKHR gSurf{};
+VkPhysicalDevice gGPU{};
+uint32_t gQFam{};
+uint32_t gTransferFam{};             // == gQFam when the device has no separate transfer family
+VkDevice gDev{};
+VkQueue gQ{};
+VkQueue gTransferQ{};
+std::mutex gQueueMutex;              // gQ is shared with the uploader when there is no transfer family
+VkSwapchainKHR gSwap{};
+VkPresentModeKHR gPresentMode = VK_PRESENT_MODE_FIFO_KHR;
+VkFormat gFmt = VK_FORMAT_B8G8R8A8_UNORM;
+VkColorSpaceKHR gCS = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+VkExtent2D gExt{};
+std::vector<VkImage> gImgs;
+std::vector<VkImageView> gViews;
+VkRenderPass gRP{};                  // ImGui's pipeline is built against it; the graph's UI pass is compatible
+std::vector<VkSemaphore> gSemDraw;   // per swapchain image: an image is not re-acquired before its present is done
+std::vector<VkFence> gImgFence;      // fence of the frame that last rendered into the image
+std::vector<dancore::graphics::Allocation> gOffMem; // headless: backing memory of the offscreen targets in gImgs
+std::vector<dancore::graphics::RGImageState> gOffState; // headless: their layouts between frames
+dancore::graphics::RGImageState gAcquiredState;         // windowed: the image acquired this frame
+VkDescriptorPool gImGuiPool{};
+bool gResized = false;
+BackendConfig gCfg;
+VkPhysicalDeviceProperties gGPUProps{};
+dancore::graphics::GpuProfiler gGpuProf;
+dancore::graphics::Uploader gUploader;
+dancore::graphics::DeviceAllocator gMemory;
+dancore::graphics::FrameArena gFrameArena;   // per-frame uniform/vertex scratch
+bool gMemoryBudget = false;                  // VK_EXT_memory_budget enabled
+dancore::graphics::PipelineCache gPipelineCache;   // persisted across launches, see CacheDir()
+dancore::graphics::PipelineCompiler gPipelines;
+dancore::graphics::ShaderCache gShaders;
+dancore::graphics::RenderGraph gGraph;       // passes of a frame: scene -> viewport texture, UI -> swapchain
+// Image the Viewport panel samples. A new size gets a new image: the UI built this frame
+// still draws the old one, so it retires like a swapchain
+struct ViewportTarget {
+    VkImage image{};
+    VkImageView view{};
+    dancore::graphics::Allocation mem;
+    VkDescriptorSet texture{};  // ImTextureID
+    VkExtent2D extent{};
+    dancore::graphics::RGImageState state;
+    uint64_t frame = 0;         // retired: last frame that sampled it
+};
+ViewportTarget gViewport;
+std::vector<ViewportTarget> gRetiredViewports;
+VkSampler gViewportSampler{};
+// ImGui font atlas is recorded into the first frame instead of a blocking one-off submit
+enum class FontUpload { Pending, Recorded, Done } gFontUpload = FontUpload::Pending;
+uint64_t gFontUploadFrame = 0;
+// Idle: the UI is rebuilt every DrawFrame, but recorded and submitted only when its draw data changed
+uint64_t gDrawHash = 0;        // draw data of the last submitted frame
+bool gRedraw = true;           // new swapchain images hold nothing yet: submit even if the UI is the same
+bool gUiChanged = true;        // last built UI differed from the one before: it may still be settling
+FrameCounters gCounters;
+
+// --- frame-context ring: everything one CPU frame touches until its fence signals ---
+struct FrameContext {
+    VkCommandPool pool{};
+    VkCommandBuffer cmd{};
+    VkSemaphore semImg{};   // acquire -> submit
+    VkFence fence{};        // submit -> CPU reuse of this context
+};
+std::vector<FrameContext> gFrames;
+uint64_t gFrameNumber = 0;
+
+// Old swapchain objects are kept until every frame that could reference them has retired,
+// so a resize never needs vkDeviceWaitIdle.
+struct RetiredSwapchain {
+    VkSwapchainKHR swap{};
+    std::vector<VkImageView> views;
+    std::vector<VkSemaphore> sems;
+    uint64_t frame = 0;
+};
+std::vector<RetiredSwapchain> gRetired;
+
+// --cache-dir, else the platform's per-user cache directory
+static std::filesystem::path CacheDir(){
+    if(!gCfg.cacheDir.empty()) return gCfg.cacheDir;
+#if defined(__APPLE__)
+    if(const char* home=std::getenv("HOME")) return std::filesystem::path(home)/"Library/Caches/Dancore";
+#elif defined(_WIN32)
+    if(const char* local=std::getenv("LOCALAPPDATA")) return std::filesystem::path(local)/"Dancore/Cache";
+#else
+    if(const char* xdg=std::getenv("XDG_CACHE_HOME"); xdg && *xdg) return std::filesystem::path(xdg)/"dancore";
+    if(const char* home=std::getenv("HOME")) return std::filesystem::path(home)/".cache/dancore";
+#endif
+    return ".dancore-cache";
+}
+static void CreateInstance(){
+    {
+        VkApplicationInfo app{VK_STRUCTURE_TYPE_APPLICATION_INFO};
+        app.pApplicationName = "Dancore Editor";
+        app.apiVersion = VK_API_VERSION_1_2;
+
+        std::vector<const char*> exts;
+        if(!gCfg.headless){
+            uint32_t n = 0;
+            const char** ex = glfwGetRequiredInstanceExtensions(&n);
+            exts.assign(ex, ex + n);
+        }
+
+#if defined(__APPLE__)
+        // Required for MoltenVK portability on macOS
+        exts.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
+#endif
+
+        VkInstanceCreateInfo ci{VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
+        ci.pApplicationInfo = &app;
+        ci.enabledExtensionCount = static_cast<uint32_t>(exts.size());
+        ci.ppEnabledExtensionNames = exts.data();
+
+#if defined(__APPLE__)
+        // Allow vkEnumeratePhysicalDevices to return portability devices
+        ci.flags |= VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR;
+#endif
+
+        VK_CHECK(vkCreateInstance(&ci, nullptr, &gInst), "vkCreateInstance");
+    }
+}
+static void CreateSurface(){
+    if(glfwCreateWindowSurface(gInst,gWin,nullptr,&gSurf)!=VK_SUCCESS) throw std::runtime_error("glfwCreateWindowSurface");
+}
+static void PickGPU(){
+    uint32_t c=0; vkEnumeratePhysicalDevices(gInst,&c,nullptr); if(!c) throw std::runtime_error("No GPU");
+    std::vector<VkPhysicalDevice> d(c); vkEnumeratePhysicalDevices(gInst,&c,d.data());
+    for(auto dev: d){
+        uint32_t qn=0; vkGetPhysicalDeviceQueueFamilyProperties(dev,&qn,nullptr);
+        std::vector<VkQueueFamilyProperties> qp(qn); vkGetPhysicalDeviceQueueFamilyProperties(dev,&qn,qp.data());
+        for(uint32_t i=0;i<qn;i++){
+            VkBool32 present=VK_FALSE;
+            if(gCfg.headless) present=VK_TRUE; // no surface: any graphics queue will do
+            else vkGetPhysicalDeviceSurfaceSupportKHR(dev,i,gSurf,&present);
+            if((qp[i].queueFlags&VK_QUEUE_GRAPHICS_BIT) && present){
+                gGPU=dev; gQFam=i; vkGetPhysicalDeviceProperties(gGPU,&gGPUProps);
+                // the profiler relies on timestamps; a family without them just reports no GPU time
+                if(!qp[i].timestampValidBits) DC_LOG_WARN(Render,"Queue family {} has no timestamp support",i);
+                if(gGPUProps.apiVersion<VK_API_VERSION_1_2) throw std::runtime_error("Vulkan 1.2 required (timeline semaphores)");
+                gTransferFam=dancore::graphics::FindTransferQueueFamily(gGPU,gQFam);
+                return;
+            }
+        }
+    }
+    throw std::runtime_error("No suitable GPU");
+}
+static void CreateDevice(){
+    {
+        float pr = 1.f;
+        VkDeviceQueueCreateInfo q[2]{};
+        for(auto& qi: q){
+            qi.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            qi.queueCount = 1;
+            qi.pQueuePriorities = &pr;
+        }
+        q[0].queueFamilyIndex = gQFam;
+        q[1].queueFamilyIndex = gTransferFam;
+        uint32_t queueInfos = gTransferFam!=gQFam ? 2 : 1;
+
+        // timeline semaphores are core in 1.2 but still have to be enabled
+        VkPhysicalDeviceVulkan12Features f12{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+        f12.timelineSemaphore = VK_TRUE;
+
+        std::vector<const char*> devExts;
+        if(!gCfg.headless) devExts.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        // optional: real per-heap budgets for the allocator instead of a fixed estimate
+        uint32_t extCount=0; vkEnumerateDeviceExtensionProperties(gGPU,nullptr,&extCount,nullptr);
+        std::vector<VkExtensionProperties> exts(extCount); vkEnumerateDeviceExtensionProperties(gGPU,nullptr,&extCount,exts.data());
+        gMemoryBudget=std::any_of(exts.begin(),exts.end(),[](const VkExtensionProperties& e){
+            return !std::strcmp(e.extensionName,VK_EXT_MEMORY_BUDGET_EXTENSION_NAME); });
+        if(gMemoryBudget) devExts.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+#if defined(__APPLE__)
+        // MoltenVK portability subset extension
+        devExts.push_back("VK_KHR_portability_subset");
+#endif
+
+        VkDeviceCreateInfo ci{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
+        ci.pNext = &f12;
+        ci.queueCreateInfoCount = queueInfos;
+        ci.pQueueCreateInfos = q;
+        ci.enabledExtensionCount = static_cast<uint32_t>(devExts.size());
+        ci.ppEnabledExtensionNames = devExts.data();
+
+        VK_CHECK(vkCreateDevice(gGPU, &ci, nullptr, &gDev), "vkCreateDevice");
+        vkGetDeviceQueue(gDev, gQFam, 0, &gQ);
+        vkGetDeviceQueue(gDev, gTransferFam, 0, &gTransferQ);
+    }
+    dancore::graphics::AllocatorDesc ad;
+    ad.gpu=gGPU; ad.device=gDev; ad.memoryBudget=gMemoryBudget; ad.framesInFlight=gCfg.framesInFlight;
+    gMemory.Init(ad);
+    gPipelineCache.Init(gGPU,gDev,CacheDir());
+    gPipelines.Init(gDev,gPipelineCache.Handle());
+    gShaders.Init(CacheDir()/"shaders");
+}
+static const char* PresentModeName(VkPresentModeKHR m){
+    switch(m){
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: return "immediate";
+        case VK_PRESENT_MODE_MAILBOX_KHR: return "mailbox";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "fifo_relaxed";
+        default: return "fifo";
+    }
+}
+static VkPresentModeKHR ChoosePresentMode(){
+    uint32_t n=0; vkGetPhysicalDeviceSurfacePresentModesKHR(gGPU,gSurf,&n,nullptr);
+    std::vector<VkPresentModeKHR> modes(n); vkGetPhysicalDeviceSurfacePresentModesKHR(gGPU,gSurf,&n,modes.data());
+    if(std::find(modes.begin(),modes.end(),gCfg.presentMode)!=modes.end()) return gCfg.presentMode;
+    // FIFO is the only mode the spec guarantees
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+static void CreateSwapchain(int w,int h){
+    VkSurfaceCapabilitiesKHR caps{}; VK_CHECK(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(gGPU,gSurf,&caps),"vkGetPhysicalDeviceSurfaceCapabilitiesKHR");
+    if(caps.currentExtent.width!=UINT32_MAX) gExt=caps.currentExtent;
+    else gExt={ std::clamp((uint32_t)w,caps.minImageExtent.width,caps.maxImageExtent.width),
+                std::clamp((uint32_t)h,caps.minImageExtent.height,caps.maxImageExtent.height) };
+    uint32_t minImages=std::max(caps.minImageCount+1,2u);
+    if(caps.maxImageCount) minImages=std::min(minImages,caps.maxImageCount);
+    gPresentMode=ChoosePresentMode();
+
+    VkSwapchainCreateInfoKHR ci{VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR};
+    ci.surface=gSurf; ci.minImageCount=minImages; ci.imageFormat=gFmt; ci.imageColorSpace=gCS; ci.imageExtent=gExt;
+    ci.imageArrayLayers=1; ci.imageUsage=VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; ci.imageSharingMode=VK_SHARING_MODE_EXCLUSIVE;
+    ci.preTransform=caps.currentTransform; ci.compositeAlpha=VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    ci.presentMode=gPresentMode; ci.clipped=VK_TRUE; ci.oldSwapchain=gSwap;
+    VkSwapchainKHR swap{};
+    VK_CHECK(vkCreateSwapchainKHR(gDev,&ci,nullptr,&swap),"vkCreateSwapchainKHR");
+    gSwap=swap;
+    uint32_t n=0; vkGetSwapchainImagesKHR(gDev,gSwap,&n,nullptr); gImgs.resize(n);
+    vkGetSwapchainImagesKHR(gDev,gSwap,&n,gImgs.data());
+    gViews.resize(n);
+    for(uint32_t i=0;i<n;i++){
+        VkImageViewCreateInfo vi{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+        vi.image=gImgs[i]; vi.viewType=VK_IMAGE_VIEW_TYPE_2D; vi.format=gFmt;
+        vi.subresourceRange.aspectMask=VK_IMAGE_ASPECT_COLOR_BIT; vi.subresourceRange.levelCount=1; vi.subresourceRange.layerCount=1;
+        VK_CHECK(vkCreateImageView(gDev,&vi,nullptr,&gViews[i]),"vkCreateImageView");
+    }
+    VkSemaphoreCreateInfo si{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    gSemDraw.resize(n);
+    for(auto& s: gSemDraw) VK_CHECK(vkCreateSemaphore(gDev,&si,nullptr,&s),"vkCreateSemaphore");
+    gImgFence.assign(n,VK_NULL_HANDLE);
+}
+// Headless stand-in for the swapchain: one offscreen target per frame context, so
+// consecutive frames never write the same image and can overlap like windowed ones.
+static void CreateOffscreenTargets(){
+    gExt={gCfg.width,gCfg.height};
+    uint32_t n=gCfg.framesInFlight;
+    gImgs.resize(n); gViews.resize(n); gOffMem.resize(n); gOffState.assign(n,{});
+    for(uint32_t i=0;i<n;i++){
+        VkImageCreateInfo ci{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+        ci.imageType=VK_IMAGE_TYPE_2D; ci.format=gFmt; ci.extent={gExt.width,gExt.height,1};
+        ci.mipLevels=1; ci.arrayLayers=1; ci.samples=VK_SAMPLE_COUNT_1_BIT; ci.tiling=VK_IMAGE_TILING_OPTIMAL;
+        ci.usage=VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT|VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        ci.sharingMode=VK_SHARING_MODE_EXCLUSIVE; ci.initialLayout=VK_IMAGE_LAYOUT_UNDEFINED;
+        // render targets get their own VkDeviceMemory: drivers can compress/place them better
+        gImgs[i]=gMemory.CreateImage(ci,dancore::graphics::MemoryUsage::GpuOnly,&gOffMem[i],true);
+        VkImageViewCreateInfo vi{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+        vi.image=gImgs[i]; vi.viewType=VK_IMAGE_VIEW_TYPE_2D; vi.format=gFmt;
+        vi.subresourceRange.aspectMask=VK_IMAGE_ASPECT_COLOR_BIT; vi.subresourceRange.levelCount=1; vi.subresourceRange.layerCount=1;
+        VK_CHECK(vkCreateImageView(gDev,&vi,nullptr,&gViews[i]),"vkCreateImageView");
+    }
+}
+// Only for ImGui_ImplVulkan_Init: frames render through gGraph, whose UI pass has the same
+// single gFmt attachment and so is compatible with the pipeline ImGui builds against this one.
+static void CreateRenderPass(){
+    VkAttachmentDescription col{}; col.format=gFmt; col.samples=VK_SAMPLE_COUNT_1_BIT;
+    col.loadOp=VK_ATTACHMENT_LOAD_OP_CLEAR; col.storeOp=VK_ATTACHMENT_STORE_OP_STORE;
+    col.initialLayout=VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; col.finalLayout=VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    VkAttachmentReference cref{0,VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    VkSubpassDescription sub{}; sub.pipelineBindPoint=VK_PIPELINE_BIND_POINT_GRAPHICS; sub.colorAttachmentCount=1; sub.pColorAttachments=&cref;
+    VkRenderPassCreateInfo ci{VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO}; ci.attachmentCount=1; ci.pAttachments=&col; ci.subpassCount=1; ci.pSubpasses=&sub;
+    VK_CHECK(vkCreateRenderPass(gDev,&ci,nullptr,&gRP),"vkCreateRenderPass");
+}
+static void CreateFrames(){
+    gFrames.resize(gCfg.framesInFlight);
+    for(auto& f: gFrames){
+        VkCommandPoolCreateInfo pi{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+        pi.queueFamilyIndex=gQFam; pi.flags=VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        VK_CHECK(vkCreateCommandPool(gDev,&pi,nullptr,&f.pool),"vkCreateCommandPool");
+        VkCommandBufferAllocateInfo ai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        ai.commandPool=f.pool; ai.level=VK_COMMAND_BUFFER_LEVEL_PRIMARY; ai.commandBufferCount=1;
+        VK_CHECK(vkAllocateCommandBuffers(gDev,&ai,&f.cmd),"vkAllocateCommandBuffers");
+        VkSemaphoreCreateInfo si{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+        VK_CHECK(vkCreateSemaphore(gDev,&si,nullptr,&f.semImg),"vkCreateSemaphore");
+        VkFenceCreateInfo fi{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO}; fi.flags=VK_FENCE_CREATE_SIGNALED_BIT;
+        VK_CHECK(vkCreateFence(gDev,&fi,nullptr,&f.fence),"vkCreateFence");
+    }
+    gGpuProf.Init(gGPU,gDev,gQFam,gCfg.framesInFlight);
+    dancore::graphics::UploaderDesc ud;
+    ud.gpu=gGPU; ud.device=gDev; ud.graphicsFamily=gQFam; ud.transferFamily=gTransferFam; ud.transferQueue=gTransferQ;
+    ud.queueMutex=&gQueueMutex;
+    gUploader.Init(ud);
+    gFrameArena.Init(gMemory,gCfg.framesInFlight,4ull<<20,
+                     VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT|VK_BUFFER_USAGE_VERTEX_BUFFER_BIT|VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+    dancore::graphics::RenderGraphDesc gd;
+    gd.device=gDev; gd.memory=&gMemory; gd.queueFamily=gQFam; gd.framesInFlight=gCfg.framesInFlight;
+    gGraph.Init(gd);
+    VkSamplerCreateInfo si{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+    si.magFilter=VK_FILTER_LINEAR; si.minFilter=VK_FILTER_LINEAR; si.mipmapMode=VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    si.addressModeU=si.addressModeV=si.addressModeW=VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    VK_CHECK(vkCreateSampler(gDev,&si,nullptr,&gViewportSampler),"vkCreateSampler");
+}
+static void DestroyRetired(const RetiredSwapchain& r){
+    for(auto v:r.views){ gGraph.ReleaseView(v); vkDestroyImageView(gDev,v,nullptr); }
+    for(auto s:r.sems) vkDestroySemaphore(gDev,s,nullptr);
+    vkDestroySwapchainKHR(gDev,r.swap,nullptr);
+}
+static void DestroyViewport(ViewportTarget& v){
+    if(v.texture) vkFreeDescriptorSets(gDev,gImGuiPool,1,&v.texture);
+    if(v.view) vkDestroyImageView(gDev,v.view,nullptr);
+    if(v.image) gMemory.DestroyImage(v.image,v.mem);
+    v={};
+}
+// Called after the current frame's fence was waited: anything retired framesInFlight frames ago is idle.
+static void CollectRetired(){
+    std::erase_if(gRetired,[](const RetiredSwapchain& r){
+        if(gFrameNumber < r.frame + gCfg.framesInFlight) return false;
+        DestroyRetired(r); return true;
+    });
+    std::erase_if(gRetiredViewports,[](ViewportTarget& v){
+        if(gFrameNumber < v.frame + gCfg.framesInFlight) return false;
+        DestroyViewport(v); return true;
+    });
+}
+// After the fence wait: the old image is still drawn by this frame's UI and retires with it
+static void ResizeViewport(uint32_t w,uint32_t h){
+    if(gViewport.image){ gViewport.frame=gFrameNumber; gRetiredViewports.push_back(gViewport); }
+    gViewport={};
+    VkImageCreateInfo ci{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    ci.imageType=VK_IMAGE_TYPE_2D; ci.format=VK_FORMAT_R8G8B8A8_UNORM; ci.extent={w,h,1};
+    ci.mipLevels=1; ci.arrayLayers=1; ci.samples=VK_SAMPLE_COUNT_1_BIT; ci.tiling=VK_IMAGE_TILING_OPTIMAL;
+    ci.usage=VK_IMAGE_USAGE_TRANSFER_DST_BIT|VK_IMAGE_USAGE_SAMPLED_BIT;
+    ci.sharingMode=VK_SHARING_MODE_EXCLUSIVE; ci.initialLayout=VK_IMAGE_LAYOUT_UNDEFINED;
+    gViewport.image=gMemory.CreateImage(ci,dancore::graphics::MemoryUsage::GpuOnly,&gViewport.mem,true);
+    VkImageViewCreateInfo vi{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+    vi.image=gViewport.image; vi.viewType=VK_IMAGE_VIEW_TYPE_2D; vi.format=ci.format;
+    vi.subresourceRange.aspectMask=VK_IMAGE_ASPECT_COLOR_BIT; vi.subresourceRange.levelCount=1; vi.subresourceRange.layerCount=1;
+    VK_CHECK(vkCreateImageView(gDev,&vi,nullptr,&gViewport.view),"vkCreateImageView");
+    gViewport.texture=ImGui_ImplVulkan_AddTexture(gViewportSampler,gViewport.view,VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    gViewport.extent={w,h};
+}
+static uint32_t ImGuiMinImageCount(){ return std::max((uint32_t)gImgs.size(),2u); }
+// Returns false while the window is minimized (zero-sized framebuffer).
+static bool RecreateSwapchain(){
+    int w=0,h=0; glfwGetFramebufferSize(gWin,&w,&h);
+    if(w==0||h==0){ gResized=true; return false; }
+    RetiredSwapchain r{gSwap,std::move(gViews),std::move(gSemDraw),gFrameNumber};
+    gViews.clear(); gSemDraw.clear();
+    CreateSwapchain(w,h);
+    gRetired.push_back(std::move(r));
+    // the new swapchain may have a different image count; ImGui only rebuilds its buffers if it changed
+    ImGui_ImplVulkan_SetMinImageCount(ImGuiMinImageCount());
+    gResized=false;
+    gRedraw=true;
+    return true;
+}
+static void CreateImGuiPool(){
+    std::array<VkDescriptorPoolSize,11> sizes = {
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLER,1000},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,1000},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,1000},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,1000},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,1000},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,1000},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,1000},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,1000},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,1000},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,1000},
+        VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,1000}
+    };
+    VkDescriptorPoolCreateInfo ci{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    ci.flags=VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    ci.maxSets=1000*(uint32_t)sizes.size();
+    ci.poolSizeCount=(uint32_t)sizes.size(); ci.pPoolSizes=sizes.data();
+    VK_CHECK(vkCreateDescriptorPool(gDev,&ci,nullptr,&gImGuiPool),"vkCreateDescriptorPool");
+}
+static void InitImGui(){
+    IMGUI_CHECKVERSION(); ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO(); io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+    ImGui::StyleColorsDark();
+    if(gCfg.headless){
+        // no platform backend: fixed display size and timestep keep bench runs reproducible
+        io.IniFilename=nullptr;
+        io.DisplaySize=ImVec2((float)gExt.width,(float)gExt.height);
+        io.DeltaTime=1.0f/60.0f;
+    } else {
+        ImGui_ImplGlfw_InitForVulkan(gWin,true);
+    }
+    ImGui_ImplVulkan_InitInfo ii{};
+    ii.Instance=gInst; ii.PhysicalDevice=gGPU; ii.Device=gDev; ii.QueueFamily=gQFam; ii.Queue=gQ;
+    // ImageCount sizes ImGui's per-frame vertex buffer ring, so it must cover every frame in flight
+    ii.PipelineCache=gPipelineCache.Handle();
+    ii.DescriptorPool=gImGuiPool; ii.MinImageCount=ImGuiMinImageCount();
+    ii.ImageCount=std::max(ii.MinImageCount,gCfg.framesInFlight);
+    ii.MSAASamples=VK_SAMPLE_COUNT_1_BIT; ii.CheckVkResultFn = [](VkResult r){ VK_CHECK(r,"ImGui"); };
+    ImGui_ImplVulkan_Init(&ii, gRP);
+    gFontUpload=FontUpload::Pending; // recorded into the first frame's command buffer
+}
+// ImGui frame on the CPU only: whether it has to reach the GPU is decided from its draw data
+static void BuildUI(EditorState& state){
+    {
+        DC_PROFILE_ZONE("ImGui::NewFrame");
+        ImGui_ImplVulkan_NewFrame();
+        if(!gCfg.headless) ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+    }
+
+    dancore::ui::DrawEditorUI(state);
+
+    {
+        DC_PROFILE_ZONE("ImGui::Render");
+        ImGui::Render();
+    }
+}
+// Everything that ends up in the command buffer: geometry, clip rects, textures, target size;
+// seed covers what the graph draws besides the UI (viewport markers).
+// A user callback draws outside the lists, so such a frame never counts as unchanged.
+static uint64_t HashDrawData(const ImDrawData* dd, uint64_t seed){
+    DC_PROFILE_ZONE("HashDrawData");
+    using dancore::core::Hash64; using dancore::core::HashCombine;
+    const float view[6]={dd->DisplayPos.x,dd->DisplayPos.y,dd->DisplaySize.x,dd->DisplaySize.y,
+                         dd->FramebufferScale.x,dd->FramebufferScale.y};
+    uint64_t h=Hash64(view,sizeof(view),seed);
+    for(int n=0;n<dd->CmdListsCount;n++){
+        const ImDrawList* list=dd->CmdLists[n];
+        h=HashCombine(h,Hash64(list->VtxBuffer.Data,(size_t)list->VtxBuffer.Size*sizeof(ImDrawVert)));
+        h=HashCombine(h,Hash64(list->IdxBuffer.Data,(size_t)list->IdxBuffer.Size*sizeof(ImDrawIdx)));
+        for(const ImDrawCmd& c: list->CmdBuffer){
+            if(c.UserCallback && c.UserCallback!=ImDrawCallback_ResetRenderState) return gDrawHash+1;
+            const uint64_t cmd[4]={(uint64_t)(uintptr_t)c.TextureId,c.VtxOffset,c.IdxOffset,c.ElemCount};
+            h=HashCombine(h,Hash64(cmd,sizeof(cmd)));
+            h=HashCombine(h,Hash64(&c.ClipRect,sizeof(c.ClipRect)));
+        }
+    }
+    return h;
+}
+// Viewport markers as clear rects, no shaders needed: one vkCmdClearAttachments per
+// (depth bucket, kind), buckets far to near so nearer markers land on top.
+static void DrawMarkers(VkCommandBuffer cmd, VkExtent2D ext, const std::vector<dancore::graphics::ViewportMarker>& markers){
+    using dancore::graphics::ViewportMarker; using dancore::graphics::kViewportShades;
+    static const float kColors[3][3]={{0.55f,0.62f,0.70f},{0.95f,0.55f,0.20f},{1.00f,0.85f,0.20f}};
+    std::vector<VkClearRect> rects[3];
+    size_t i=0;
+    while(i<markers.size()){
+        const uint8_t shade=markers[i].shade;
+        for(auto& r: rects) r.clear();
+        for(; i<markers.size() && markers[i].shade==shade; ++i){
+            const ViewportMarker& m=markers[i];
+            int32_t x0=std::max(m.x-m.size/2,0), y0=std::max(m.y-m.size/2,0);
+            int32_t x1=std::min(m.x+(m.size+1)/2,(int)ext.width), y1=std::min(m.y+(m.size+1)/2,(int)ext.height);
+            if(x1<=x0 || y1<=y0) continue;
+            rects[m.kind].push_back({{{x0,y0},{uint32_t(x1-x0),uint32_t(y1-y0)}},0,1});
+        }
+        const float k=0.35f+0.65f*float(shade)/float(kViewportShades-1);
+        for(uint32_t kind=0; kind<3; ++kind){
+            if(rects[kind].empty()) continue;
+            const float b=kind==ViewportMarker::Selected ? 1.0f : k;
+            VkClearAttachment att{VK_IMAGE_ASPECT_COLOR_BIT,0,{}};
+            att.clearValue.color={{kColors[kind][0]*b,kColors[kind][1]*b,kColors[kind][2]*b,1.0f}};
+            vkCmdClearAttachments(cmd,1,&att,(uint32_t)rects[kind].size(),rects[kind].data());
+        }
+    }
+}
+// The frame as render graph passes. Adding one (shadows, G-buffer, post) is another AddPass:
+// barriers, attachment memory and the secondary command buffer come from the graph.
+static void DeclarePasses(const EditorState& state, uint32_t idx, bool uiSamplesViewport){
+    using namespace dancore::graphics;
+    RGImage viewport;
+    if(state.viewport_width && state.viewport_height){
+        const VkExtent2D ext=gViewport.extent;
+        viewport=gGraph.Import("Viewport",gViewport.image,gViewport.view,{VK_FORMAT_R8G8B8A8_UNORM,ext},&gViewport.state,
+                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        RGImage scene=gGraph.Create("SceneColor",{VK_FORMAT_R16G16B16A16_SFLOAT,ext});
+        const auto* markers=&state.viewport_markers;
+        gGraph.AddPass("Scene")
+            .Color(scene,VK_ATTACHMENT_LOAD_OP_CLEAR,{{0.07f,0.08f,0.09f,1.0f}})
+            .Record([markers](const RGPassContext& ctx){ DrawMarkers(ctx.cmd,ctx.extent,*markers); });
+        gGraph.AddPass("Resolve")
+            .CopySource(scene)
+            .CopyDestination(viewport)
+            .Record([scene,viewport,ext](const RGPassContext& ctx){
+                // HDR scene -> 8-bit texture for ImGui; a tonemap pass would sample SceneColor instead
+                VkImageBlit blit{};
+                blit.srcSubresource={VK_IMAGE_ASPECT_COLOR_BIT,0,0,1};
+                blit.dstSubresource=blit.srcSubresource;
+                blit.srcOffsets[1]=blit.dstOffsets[1]={(int32_t)ext.width,(int32_t)ext.height,1};
+                vkCmdBlitImage(ctx.cmd,ctx.Image(scene),VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               ctx.Image(viewport),VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,1,&blit,VK_FILTER_NEAREST);
+            });
+    }
+    // windowed: a fresh acquire, ordered by the semaphore wait at COLOR_ATTACHMENT_OUTPUT
+    gAcquiredState={VK_IMAGE_LAYOUT_UNDEFINED,VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,0,0};
+    RGImage target=gGraph.Import("Swapchain",gImgs[idx],gViews[idx],{gFmt,gExt},gCfg.headless ? &gOffState[idx] : &gAcquiredState,
+                                 gCfg.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    auto ui=gGraph.AddPass("UI");
+    ui.Color(target,VK_ATTACHMENT_LOAD_OP_CLEAR,{{0.10f,0.11f,0.12f,1.0f}});
+    if(viewport && uiSamplesViewport) ui.Sample(viewport);
+    ui.Record([](const RGPassContext& ctx){
+        DC_PROFILE_ZONE("RenderDrawData");
+        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(),ctx.cmd);
+    });
+}
+// Returns the uploader timeline value this frame's submit has to wait for (0: none).
+static uint64_t Record(FrameContext& f, uint32_t slot, uint32_t idx, const EditorState& state, bool uiSamplesViewport){
+    DC_PROFILE_ZONE("Record");
+    VkCommandBuffer cmd=f.cmd;
+    VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    bi.flags=VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(cmd,&bi),"vkBeginCommandBuffer");
+    gGpuProf.BeginFrame(cmd,slot);
+    gGpuProf.BeginZone(cmd,"Frame");
+    uint64_t uploadWait=gUploader.RecordAcquires(cmd);
+    if(gFontUpload==FontUpload::Pending){
+        ImGui_ImplVulkan_CreateFontsTexture(cmd);
+        gFontUpload=FontUpload::Recorded; gFontUploadFrame=gFrameNumber;
+    }
+    gMemory.DefragStep(cmd,4ull<<20); // before the graph: copies are transfer commands
+    gGraph.Begin(gFrameNumber,slot);
+    DeclarePasses(state,idx,uiSamplesViewport);
+    gGraph.Execute(cmd,&gGpuProf);
+    gGpuProf.EndZone(cmd); // Frame
+    VK_CHECK(vkEndCommandBuffer(cmd),"vkEndCommandBuffer");
+    return uploadWait;
+}
+static void Cleanup(){
+    vkDeviceWaitIdle(gDev);
+    gGraph.Shutdown();
+    gPipelines.Shutdown();
+    gUploader.Shutdown();
+    gFrameArena.Shutdown();
+    ImGui_ImplVulkan_Shutdown(); if(!gCfg.headless) ImGui_ImplGlfw_Shutdown(); ImGui::DestroyContext();
+    for(auto& v: gRetiredViewports) DestroyViewport(v);
+    DestroyViewport(gViewport);
+    vkDestroySampler(gDev,gViewportSampler,nullptr);
+    vkDestroyDescriptorPool(gDev,gImGuiPool,nullptr);
+    gGpuProf.Shutdown();
+    for(auto& f: gFrames){
+        vkDestroyFence(gDev,f.fence,nullptr);
+        vkDestroySemaphore(gDev,f.semImg,nullptr);
+        vkDestroyCommandPool(gDev,f.pool,nullptr);
+    }
+    for(auto& r: gRetired) DestroyRetired(r);
+    for(auto s:gSemDraw) vkDestroySemaphore(gDev,s,nullptr);
+    vkDestroyRenderPass(gDev,gRP,nullptr);
+    for(auto v:gViews) vkDestroyImageView(gDev,v,nullptr);
+    if(gCfg.headless){
+        for(size_t i=0;i<gImgs.size();++i) gMemory.DestroyImage(gImgs[i],gOffMem[i]);
+    } else {
+        vkDestroySwapchainKHR(gDev,gSwap,nullptr);
+    }
+    gMemory.Shutdown();
+    gPipelineCache.Shutdown(); // writes the cache back for the next launch
+    vkDestroyDevice(gDev,nullptr);
+    if(!gCfg.headless) vkDestroySurfaceKHR(gInst,gSurf,nullptr);
+    vkDestroyInstance(gInst,nullptr);
+    if(!gCfg.headless){ glfwDestroyWindow(gWin); glfwTerminate(); }
+}
+static double MsSince(std::chrono::steady_clock::time_point t0){
+    return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-t0).count();
+}
+// One iteration of the frame ring. Only blocks on the fence of the context being reused,
+// so up to framesInFlight frames are queued on the GPU while the CPU records the next one.
+static bool RenderFrame(EditorState& state, FrameTimings* t){
+    if(!gCfg.headless && gResized && !RecreateSwapchain()){ glfwWaitEvents(); return false; } // minimized
+    auto t0=std::chrono::steady_clock::now();
+    state.viewport_texture=(void*)gViewport.texture;
+    BuildUI(state);
+    const uint64_t drawHash=HashDrawData(ImGui::GetDrawData(),state.viewport_hash);
+    gUiChanged=drawHash!=gDrawHash;
+    // same pixels as on screen: no fence wait, acquire, record or present
+    if(gCfg.skipUnchanged && !gUiChanged && !gRedraw && gFontUpload!=FontUpload::Pending && !gUploader.PendingAcquires()){
+        gUploader.Flush();
+        ++gCounters.skipped;
+        if(t) t->record_ms=MsSince(t0);
+        return false;
+    }
+    const double uiMs=MsSince(t0);
+    uint32_t slot=(uint32_t)(gFrameNumber%gFrames.size());
+    FrameContext& f=gFrames[slot];
+    {
+        DC_PROFILE_ZONE("WaitFence");
+        vkWaitForFences(gDev,1,&f.fence,VK_TRUE,UINT64_MAX);
+    }
+    double gpu=gGpuProf.Collect(slot);
+    if(t) t->gpu_ms=gpu;
+    CollectRetired();
+    gMemory.BeginFrame(gFrameNumber);
+    gFrameArena.Begin(slot);
+    if(gFontUpload==FontUpload::Recorded && gFrameNumber>=gFontUploadFrame+gCfg.framesInFlight){
+        ImGui_ImplVulkan_DestroyFontUploadObjects(); // the frame that copied the atlas has retired
+        gFontUpload=FontUpload::Done;
+    }
+
+    uint32_t idx=slot;
+    VkResult r=VK_SUCCESS;
+    if(!gCfg.headless){
+        DC_PROFILE_ZONE("Acquire");
+        r=vkAcquireNextImageKHR(gDev,gSwap,UINT64_MAX,f.semImg,VK_NULL_HANDLE,&idx);
+        if(r==VK_ERROR_OUT_OF_DATE_KHR){ RecreateSwapchain(); return false; }
+        if(r!=VK_SUBOPTIMAL_KHR) VK_CHECK(r,"acquire");
+        // the image may still be owned by an older frame when images outnumber frame contexts
+        if(gImgFence[idx]!=VK_NULL_HANDLE && gImgFence[idx]!=f.fence)
+            vkWaitForFences(gDev,1,&gImgFence[idx],VK_TRUE,UINT64_MAX);
+        gImgFence[idx]=f.fence;
+    }
+    // reset only once we know a submit will follow, otherwise the next wait would deadlock
+    vkResetFences(gDev,1,&f.fence);
+    // the UI just drew the current image only if it already has the requested size
+    bool uiSamplesViewport=gViewport.texture && state.viewport_texture==(void*)gViewport.texture;
+    if(state.viewport_width && (state.viewport_width!=gViewport.extent.width || state.viewport_height!=gViewport.extent.height)){
+        ResizeViewport(state.viewport_width,state.viewport_height);
+        uiSamplesViewport=false;
+    }
+
+    t0=std::chrono::steady_clock::now();
+    VK_CHECK(vkResetCommandPool(gDev,f.pool,0),"vkResetCommandPool");
+    gUploader.Flush(); // this frame's uploads go out before the frame that may consume them
+    uint64_t uploadWait=Record(f,slot,idx,state,uiSamplesViewport);
+    if(t) t->record_ms=uiMs+MsSince(t0);
+
+    DC_PROFILE_ZONE("Submit+Present");
+    t0=std::chrono::steady_clock::now();
+    // binary acquire semaphore + uploader timeline; values of binary semaphores are ignored
+    VkSemaphore waitSems[2]; VkPipelineStageFlags waitStages[2]; uint64_t waitValues[2]; uint32_t waits=0;
+    if(!gCfg.headless){
+        waitSems[waits]=f.semImg; waitStages[waits]=VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT; waitValues[waits++]=0;
+    }
+    if(uploadWait){
+        waitSems[waits]=gUploader.Timeline(); waitStages[waits]=VK_PIPELINE_STAGE_ALL_COMMANDS_BIT; waitValues[waits++]=uploadWait;
+    }
+    VkTimelineSemaphoreSubmitInfo ti{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+    ti.waitSemaphoreValueCount=waits; ti.pWaitSemaphoreValues=waitValues;
+    VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    si.pNext=&ti;
+    si.waitSemaphoreCount=waits; si.pWaitSemaphores=waitSems; si.pWaitDstStageMask=waitStages;
+    if(!gCfg.headless){
+        si.signalSemaphoreCount=1; si.pSignalSemaphores=&gSemDraw[idx];
+    }
+    si.commandBufferCount=1; si.pCommandBuffers=&f.cmd;
+    std::unique_lock<std::mutex> queueLock(gQueueMutex);
+    VK_CHECK(vkQueueSubmit(gQ,1,&si,f.fence),"submit");
+    gGpuProf.MarkSubmitted();
+    gDrawHash=drawHash; gRedraw=false;
+    ++gCounters.rendered;
+    if(gCfg.headless){
+        if(t) t->submit_ms=MsSince(t0);
+        ++gFrameNumber;
+        return true;
+    }
+    VkPresentInfoKHR pi{VK_STRUCTURE_TYPE_PRESENT_INFO_KHR};
+    pi.waitSemaphoreCount=1; pi.pWaitSemaphores=&gSemDraw[idx]; pi.swapchainCount=1; pi.pSwapchains=&gSwap; pi.pImageIndices=&idx;
+    r=vkQueuePresentKHR(gQ,&pi);
+    queueLock.unlock();
+    if(t) t->submit_ms=MsSince(t0);
+    ++gFrameNumber;
+    if(r==VK_ERROR_OUT_OF_DATE_KHR || r==VK_SUBOPTIMAL_KHR || gResized) RecreateSwapchain();
+    else VK_CHECK(r,"present");
+    return true;
+}
+
+namespace dancore::editor {
+
+bool ParseBackendArg(BackendConfig& cfg, const char* a){
+    if(!std::strncmp(a,"--frames-in-flight=",19)){
+        cfg.framesInFlight=(uint32_t)std::clamp(std::atoi(a+19),1,4);
+    } else if(!std::strncmp(a,"--present-mode=",15)){
+        const char* m=a+15;
+        if(!std::strcmp(m,"fifo")) cfg.presentMode=VK_PRESENT_MODE_FIFO_KHR;
+        else if(!std::strcmp(m,"mailbox")) cfg.presentMode=VK_PRESENT_MODE_MAILBOX_KHR;
+        else if(!std::strcmp(m,"immediate")) cfg.presentMode=VK_PRESENT_MODE_IMMEDIATE_KHR;
+        else std::cerr<<"Unknown present mode '"<<m<<"', using mailbox\n";
+    } else if(!std::strcmp(a,"--headless")){
+        cfg.headless=true;
+    } else if(!std::strncmp(a,"--size=",7)){
+        unsigned w=0,h=0;
+        if(std::sscanf(a+7,"%ux%u",&w,&h)==2 && w && h){ cfg.width=w; cfg.height=h; }
+        else std::cerr<<"Bad size '"<<a+7<<"', expected WxH\n";
+    } else if(!std::strncmp(a,"--workers=",10)){
+        cfg.jobWorkers=(uint32_t)std::max(std::atoi(a+10),1);
+    } else if(!std::strncmp(a,"--cache-dir=",12)){
+        cfg.cacheDir=a+12;
+    } else if(!std::strcmp(a,"--always-redraw")){
+        cfg.skipUnchanged=false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void InitBackend(const BackendConfig& cfg){
+    gCfg=cfg;
+    dancore::core::profiler::SetThreadName("Main");
+    dancore::core::jobs::Init(gCfg.jobWorkers);
+    if(gCfg.headless){
+        CreateInstance(); PickGPU(); CreateDevice();
+        CreateOffscreenTargets();
+    } else {
+        if(!glfwInit()) throw std::runtime_error("glfwInit");
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        gWin = glfwCreateWindow((int)gCfg.width,(int)gCfg.height,"Dancore Editor (Vulkan)",nullptr,nullptr);
+        glfwSetFramebufferSizeCallback(gWin,[](GLFWwindow*,int,int){ gResized=true; });
+        // jobs finishing work the UI shows wake WaitEvents; glfwPostEmptyEvent is thread-safe
+        dancore::core::jobs::SetMainThreadWake([]{ glfwPostEmptyEvent(); });
+        CreateInstance(); CreateSurface(); PickGPU(); CreateDevice();
+        int w,h; glfwGetFramebufferSize(gWin,&w,&h);
+        CreateSwapchain(w,h);
+    }
+    CreateRenderPass(); CreateFrames();
+    CreateImGuiPool(); InitImGui();
+    std::cout<<"Device: "<<gGPUProps.deviceName<<", "
+             <<(gCfg.headless ? "headless" : PresentModeName(gPresentMode))
+             <<", frames in flight: "<<gCfg.framesInFlight
+             <<", job workers: "<<dancore::core::jobs::WorkerCount()
+             <<", uploads: "<<(gUploader.DedicatedQueue() ? "transfer queue family " : "graphics queue family ")<<gTransferFam
+             <<", memory budget: "<<(gMemoryBudget ? "VK_EXT_memory_budget" : "estimated")
+             <<", pipeline cache: "<<(gPipelineCache.LoadedBytes() ? std::to_string(gPipelineCache.LoadedBytes()/1024)+" KB from disk" : std::string("cold"))<<"\n";
+}
+bool ShouldClose(){ return !gCfg.headless && glfwWindowShouldClose(gWin); }
+void PollEvents(){ if(!gCfg.headless) glfwPollEvents(); }
+void WaitEvents(double timeoutSeconds){
+    if(gCfg.headless) return;
+    // after input the UI takes a frame or two to settle (hover, layout), and a text cursor blinks
+    if(gUiChanged || gRedraw){ glfwPollEvents(); return; }
+    if(ImGui::GetIO().WantTextInput) timeoutSeconds=std::min(timeoutSeconds,0.1);
+    DC_PROFILE_ZONE("WaitEvents");
+    glfwWaitEventsTimeout(timeoutSeconds);
+    ++gCounters.waits;
+}
+bool DrawFrame(EditorState& state, FrameTimings* timings){
+    dancore::core::profiler::BeginFrame();
+    {
+        // Vulkan/ImGui work posted by jobs runs here, before this frame is recorded
+        DC_PROFILE_ZONE("MainThreadJobs");
+        dancore::core::jobs::PumpMainThread();
+    }
+    dancore::core::log::Drain();
+    if(state.show_memory){
+        DC_PROFILE_ZONE("MemoryStats");
+        state.memory=gMemory.Stats();
+        state.memory.arenaBytes=gFrameArena.Capacity();
+        state.memory.arenaPeak=gFrameArena.Peak();
+        state.memory.arenaOverflows=gFrameArena.Overflows();
+        const auto& graph=gGraph.Stats();
+        state.memory.transientImages=graph.transients;
+        state.memory.transientBytes=graph.transientBytes;
+        state.memory.transientHeapBytes=graph.heapBytes;
+    }
+    bool drawn=RenderFrame(state,timings);
+    state.frames_rendered=gCounters.rendered;
+    state.frames_skipped=gCounters.skipped;
+    dancore::core::profiler::EndFrame();
+    return drawn;
+}
+void ShutdownBackend(){
+    dancore::core::jobs::SetMainThreadWake(nullptr); // the window goes away in Cleanup
+    // drains pending jobs and main-thread callbacks while the device is still alive
+    dancore::core::jobs::Shutdown();
+    Cleanup();
+    dancore::core::log::Drain(); // warnings from shutdown still reach stderr
+}
+const char* DeviceName(){ return gGPUProps.deviceName; }
+FrameCounters Frames(){ return gCounters; }
+dancore::graphics::Uploader& Uploads(){ return gUploader; }
+dancore::graphics::DeviceAllocator& Memory(){ return gMemory; }
+dancore::graphics::FrameArena& FrameScratch(){ return gFrameArena; }
+dancore::graphics::ShaderCache& Shaders(){ return gShaders; }
+dancore::graphics::PipelineCompiler& Pipelines(){ return gPipelines; }
+std::filesystem::path CacheDirectory(){ return CacheDir(); }
+
+} // namespace dancore::editor
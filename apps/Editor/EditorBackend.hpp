@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "../../engine/ui/editor/EditorUI.hpp"
+
+// Vulkan + GLFW bootstrap shared by dancore_editor and dancore_bench.
+// Windowed: swapchain + present. Headless: offscreen VkImage per frame context,
+// no GLFW and no surface, so it runs on software ICDs such as lavapipe.
+
+namespace dancore::graphics { class Uploader; class DeviceAllocator; class FrameArena; class ShaderCache; class PipelineCompiler; }
+
+namespace dancore::editor {
+
+struct BackendConfig {
+    uint32_t framesInFlight = 2;
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR; // falls back to FIFO when unsupported
+    bool headless = false;
+    uint32_t width = 1280, height = 720;
+    uint32_t jobWorkers = 0; // 0: hardware threads - 1
+    std::string cacheDir;    // pipeline + SPIR-V caches; empty: per-user cache directory
+    bool skipUnchanged = true; // idle: no record/submit when the UI draw data matches the last frame
+};
+
+// record/submit belong to the frame just drawn; gpu_ms to the older frame
+// whose fence was waited this call (-1 when no result was available yet)
+struct FrameTimings {
+    double record_ms = 0.0;
+    double submit_ms = 0.0;
+    double gpu_ms = -1.0;
+};
+
+// DrawFrame calls that reached the GPU, that were skipped because the UI had not changed,
+// and how often WaitEvents actually slept
+struct FrameCounters {
+    uint64_t rendered = 0;
+    uint64_t skipped = 0;
+    uint64_t waits = 0;
+};
+
+// --frames-in-flight=N  (1..4)
+// --present-mode=fifo|mailbox|immediate
+// --headless, --size=WxH
+// --workers=N  (job system worker threads)
+// --cache-dir=PATH
+// --always-redraw  (record and submit every frame, even when nothing changed)
+// Returns false when the argument is not a backend option.
+bool ParseBackendArg(BackendConfig& cfg, const char* arg);
+
+void InitBackend(const BackendConfig& cfg);
+bool ShouldClose();
+void PollEvents();
+// Idle loop: sleeps until input, core::jobs::WakeMainThread() or the timeout. Returns at once
+// while the UI is still changing from frame to frame. Headless: returns at once.
+void WaitEvents(double timeoutSeconds);
+// Returns false when no frame was submitted (minimized window, out-of-date swapchain,
+// or the UI draw data was the same as the last submitted frame).
+bool DrawFrame(ui::EditorState& state, FrameTimings* timings = nullptr);
+void ShutdownBackend();
+
+const char* DeviceName();
+FrameCounters Frames();
+// Staging-ring uploads (textures, meshes); valid between InitBackend and ShutdownBackend
+graphics::Uploader& Uploads();
+// Buffers/images sub-allocated from pooled VkDeviceMemory blocks
+graphics::DeviceAllocator& Memory();
+// Host-visible scratch reset every frame (uniforms, transient vertices); main thread only
+graphics::FrameArena& FrameScratch();
+// Content-hashed HLSL -> SPIR-V cache and background pipeline builds on the persistent VkPipelineCache
+graphics::ShaderCache& Shaders();
+graphics::PipelineCompiler& Pipelines();
+// --cache-dir or the per-user cache directory; other persistent caches (content index) live here too
+std::filesystem::path CacheDirectory();
+
+} // namespace dancore::editor
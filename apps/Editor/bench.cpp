@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "EditorBackend.hpp"
+#include "core/SceneComponents.hpp"
+
+// dancore_bench: drives the editor UI for N frames (headless by default) with a
+// deterministic EditorState script and prints CPU record / submit / GPU percentiles as JSON.
+//
+//   dancore_bench [--frames=N] [--warmup=N] [--entities=N] [--out=file.json] [--windowed] [backend options]
+
+using namespace dancore;
+
+struct Stats { double mean=0, p50=0, p90=0, p99=0, min=0, max=0; size_t count=0; };
+
+static Stats Summarize(std::vector<double> v){
+    Stats s;
+    if(v.empty()) return s;
+    std::sort(v.begin(),v.end());
+    auto pct=[&](double p){ return v[std::min(v.size()-1,(size_t)(p*(v.size()-1)+0.5))]; };
+    double sum=0; for(double x: v) sum+=x;
+    s.count=v.size(); s.mean=sum/v.size();
+    s.p50=pct(0.50); s.p90=pct(0.90); s.p99=pct(0.99); s.min=v.front(); s.max=v.back();
+    return s;
+}
+
+static void WriteStats(std::ostream& o, const char* name, const Stats& s, bool last=false){
+    char buf[256];
+    std::snprintf(buf,sizeof(buf),
+        "  \"%s\": {\"count\": %zu, \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"min\": %.4f, \"max\": %.4f}%s\n",
+        name,s.count,s.mean,s.p50,s.p90,s.p99,s.min,s.max,last?"":",");
+    o<<buf;
+}
+
+// Scripted edits: panels open/close and modes switch on fixed periods so every run
+// exercises the same UI paths in the same order.
+static void ScriptState(ui::EditorState& st, uint32_t frame){
+    if(frame%60==59) st.show_console=!st.show_console;
+    if(frame%90==89) st.show_inspector=!st.show_inspector;
+    if(frame%150==149) st.show_file_explorer=!st.show_file_explorer;
+    if(frame%120==119) st.edit_mode=(st.edit_mode+1)%3;
+    if(frame%200==199) st.play_mode=!st.play_mode;
+    if(frame%30==29) st.tool=(ui::Tool)(((int)st.tool+1)%4);
+    if(frame%45==44 && st.world && st.world->Count()) st.selected=st.world->At((frame*7919u)%st.world->Count());
+}
+
+int main(int argc, char** argv){
+    editor::BackendConfig cfg;
+    cfg.headless=true;
+    cfg.skipUnchanged=false; // measures recording, so every frame is drawn
+    uint32_t frames=1000, warmup=60, entities=100000;
+    std::string out;
+    for(int i=1;i<argc;i++){
+        const char* a=argv[i];
+        if(!std::strncmp(a,"--frames=",9)) frames=(uint32_t)std::max(1,std::atoi(a+9));
+        else if(!std::strncmp(a,"--warmup=",9)) warmup=(uint32_t)std::max(0,std::atoi(a+9));
+        else if(!std::strncmp(a,"--entities=",11)) entities=(uint32_t)std::max(0,std::atoi(a+11));
+        else if(!std::strncmp(a,"--out=",6)) out=a+6;
+        else if(!std::strcmp(a,"--windowed")) cfg.headless=false;
+        else if(!editor::ParseBackendArg(cfg,a)) std::cerr<<"Unknown option "<<a<<"\n";
+    }
+
+    std::vector<double> record, submit, gpu, transform;
+    record.reserve(frames); submit.reserve(frames); gpu.reserve(frames); transform.reserve(frames);
+    try {
+        editor::InitBackend(cfg);
+        core::ecs::World world;
+        world.CreateBatch(core::scene::TransformMask(),entities);
+        ui::EditorState state{};
+        state.world=&world;
+        uint32_t drawn=0;
+        for(uint32_t i=0; drawn<warmup+frames && !editor::ShouldClose(); ++i){
+            editor::PollEvents();
+            ScriptState(state,i);
+            auto t0=std::chrono::steady_clock::now();
+            core::scene::UpdateLocalToWorld(world);
+            double transform_ms=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-t0).count();
+            editor::FrameTimings t;
+            if(!editor::DrawFrame(state,&t)) continue;
+            // gpu_ms belongs to a frame framesInFlight behind; it is dropped with its warmup window
+            if(drawn>=warmup){
+                record.push_back(t.record_ms);
+                submit.push_back(t.submit_ms);
+                transform.push_back(transform_ms);
+                if(t.gpu_ms>=0.0) gpu.push_back(t.gpu_ms);
+            }
+            ++drawn;
+        }
+    } catch(const std::exception& e){
+        std::cerr<<e.what()<<"\n";
+        return 1;
+    }
+
+    std::ostringstream o;
+    o<<"{\n";
+    o<<"  \"device\": \""<<editor::DeviceName()<<"\",\n";
+    o<<"  \"headless\": "<<(cfg.headless?"true":"false")<<",\n";
+    o<<"  \"width\": "<<cfg.width<<", \"height\": "<<cfg.height<<",\n";
+    o<<"  \"frames_in_flight\": "<<cfg.framesInFlight<<",\n";
+    o<<"  \"frames\": "<<record.size()<<", \"warmup\": "<<warmup<<",\n";
+    o<<"  \"entities\": "<<entities<<",\n";
+    WriteStats(o,"record_ms",Summarize(record));
+    WriteStats(o,"submit_ms",Summarize(submit));
+    WriteStats(o,"transform_ms",Summarize(transform));
+    WriteStats(o,"gpu_ms",Summarize(gpu),true);
+    o<<"}\n";
+    editor::ShutdownBackend();
+
+    if(out.empty()) std::cout<<o.str();
+    else std::ofstream(out)<<o.str();
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include "AudioDecoder.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef DANCORE_HAS_VORBISFILE
+#include <vorbis/vorbisfile.h>
+#endif
+#ifdef DANCORE_HAS_OPUSFILE
+#include <opusfile.h>
+#endif
+
+namespace dancore::audio {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+[[noreturn]] void Fail(const fs::path& file, const char* what)
+{
+    throw std::runtime_error("AudioDecoder: " + file.string() + ": " + what);
+}
+
+uint32_t U32(const unsigned char* p) { return p[0] | p[1] << 8 | p[2] << 16 | uint32_t(p[3]) << 24; }
+uint16_t U16(const unsigned char* p) { return uint16_t(p[0] | p[1] << 8); }
+
+constexpr uint32_t kMaxWavChannels = 8; // 7.1; лишние каналы всё равно отбрасываются до стерео
+
+// RIFF/WAVE: блок fmt и блок data, остальное пропускаем. Читаем кусками по мере Read
+class WavDecoder final : public AudioDecoder {
+public:
+    explicit WavDecoder(const fs::path& path) : file_(std::fopen(path.string().c_str(), "rb"))
+    {
+        if (!file_) Fail(path, "cannot open");
+        unsigned char head[12];
+        if (std::fread(head, 1, 12, file_) != 12 || std::memcmp(head, "RIFF", 4) || std::memcmp(head + 8, "WAVE", 4))
+            Close(), Fail(path, "not a RIFF/WAVE file");
+        bool haveFormat = false;
+        for (;;) {
+            unsigned char chunk[8];
+            if (std::fread(chunk, 1, 8, file_) != 8) Close(), Fail(path, "no data chunk");
+            const uint32_t size = U32(chunk + 4);
+            if (!std::memcmp(chunk, "fmt ", 4)) {
+                unsigned char fmt[40] = {};
+                if (size < 16 || std::fread(fmt, 1, std::min<uint32_t>(size, sizeof(fmt)), file_) != std::min<uint32_t>(size, sizeof(fmt)))
+                    Close(), Fail(path, "bad fmt chunk");
+                uint16_t tag = U16(fmt);
+                if (tag == 0xFFFE && size >= 26) tag = U16(fmt + 24); // WAVE_FORMAT_EXTENSIBLE: подформат
+                channels_ = U16(fmt + 2);
+                format_.sampleRate = U32(fmt + 4);
+                bits_ = U16(fmt + 14);
+                isFloat_ = tag == 3;
+                if ((tag != 1 && tag != 3) || (isFloat_ && bits_ != 32) || (!isFloat_ && bits_ != 8 && bits_ != 16 && bits_ != 24 && bits_ != 32))
+                    Close(), Fail(path, "unsupported sample format");
+                // кадр (channels_ * bits_ / 8, не больше 32 байт) должен помещаться в bytes_, иначе Read не сдвинется
+                if (!channels_ || channels_ > kMaxWavChannels || !format_.sampleRate) Close(), Fail(path, "bad fmt chunk");
+                if (size > sizeof(fmt)) std::fseek(file_, long(size - sizeof(fmt)), SEEK_CUR);
+                if (size & 1) std::fseek(file_, 1, SEEK_CUR);
+                haveFormat = true;
+            } else if (!std::memcmp(chunk, "data", 4)) {
+                if (!haveFormat) Close(), Fail(path, "data before fmt");
+                dataStart_ = std::ftell(file_);
+                frameBytes_ = channels_ * (bits_ / 8);
+                static_assert(kMaxWavChannels * 4 <= sizeof(bytes_));
+                frames_ = size / frameBytes_;
+                break;
+            } else {
+                std::fseek(file_, long(size + (size & 1)), SEEK_CUR);
+            }
+        }
+        format_.channels = std::min<uint32_t>(channels_, 2);
+    }
+    ~WavDecoder() override { Close(); }
+
+    size_t Read(float* out, size_t frames) override
+    {
+        frames = size_t(std::min<uint64_t>(frames, frames_ - position_));
+        size_t done = 0;
+        while (done < frames) {
+            const size_t n = std::min(frames - done, sizeof(bytes_) / frameBytes_);
+            const size_t got = std::fread(bytes_, frameBytes_, n, file_);
+            Convert(got, out + done * format_.channels);
+            done += got;
+            if (got < n) break;
+        }
+        position_ += done;
+        return done;
+    }
+
+    void Rewind() override
+    {
+        std::fseek(file_, dataStart_, SEEK_SET);
+        position_ = 0;
+    }
+
+private:
+    void Close()
+    {
+        if (file_) std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    float Sample(const unsigned char* p) const
+    {
+        switch (bits_) {
+        case 8: return (float(p[0]) - 128.0f) * (1.0f / 128.0f);
+        case 16: return float(int16_t(U16(p))) * (1.0f / 32768.0f);
+        case 24: return float(int32_t(uint32_t(p[0] << 8 | p[1] << 16 | p[2] << 24)) >> 8) * (1.0f / 8388608.0f);
+        default: {
+            if (isFloat_) {
+                float f;
+                std::memcpy(&f, p, 4);
+                return f;
+            }
+            return float(int32_t(U32(p))) * (1.0f / 2147483648.0f);
+        }
+        }
+    }
+
+    void Convert(size_t frames, float* out) const
+    {
+        const uint32_t step = bits_ / 8, outChannels = format_.channels;
+        for (size_t f = 0; f < frames; ++f) {
+            const unsigned char* p = bytes_ + f * frameBytes_;
+            for (uint32_t c = 0; c < outChannels; ++c) out[f * outChannels + c] = Sample(p + c * step);
+        }
+    }
+
+    std::FILE* file_ = nullptr;
+    long dataStart_ = 0;
+    uint64_t position_ = 0;
+    uint32_t channels_ = 0, bits_ = 0, frameBytes_ = 0;
+    bool isFloat_ = false;
+    unsigned char bytes_[16384];
+};
+
+#ifdef DANCORE_HAS_VORBISFILE
+class VorbisDecoder final : public AudioDecoder {
+public:
+    explicit VorbisDecoder(const fs::path& path)
+    {
+        if (ov_fopen(path.string().c_str(), &file_) != 0) Fail(path, "not an Ogg Vorbis file");
+        const vorbis_info* info = ov_info(&file_, -1);
+        format_.sampleRate = uint32_t(info->rate);
+        format_.channels = std::min(info->channels, 2);
+        const ogg_int64_t total = ov_pcm_total(&file_, -1);
+        frames_ = total > 0 ? uint64_t(total) : 0;
+    }
+    ~VorbisDecoder() override { ov_clear(&file_); }
+
+    size_t Read(float* out, size_t frames) override
+    {
+        size_t done = 0;
+        while (done < frames) {
+            float** pcm = nullptr;
+            int section = 0;
+            const long got = ov_read_float(&file_, &pcm, int(std::min<size_t>(frames - done, 4096)), &section);
+            if (got <= 0) break; // конец или битый пакет
+            const uint32_t channels = format_.channels;
+            for (long f = 0; f < got; ++f)
+                for (uint32_t c = 0; c < channels; ++c) out[(done + size_t(f)) * channels + c] = pcm[c][f];
+            done += size_t(got);
+        }
+        return done;
+    }
+
+    void Rewind() override { ov_pcm_seek(&file_, 0); }
+
+private:
+    OggVorbis_File file_{};
+};
+#endif
+
+#ifdef DANCORE_HAS_OPUSFILE
+// Opus всегда 48 кГц; декодируем сразу в стерео
+class OpusDecoder final : public AudioDecoder {
+public:
+    explicit OpusDecoder(const fs::path& path)
+    {
+        int error = 0;
+        file_ = op_open_file(path.string().c_str(), &error);
+        if (!file_) Fail(path, "not an Ogg Opus file");
+        format_.sampleRate = 48000;
+        format_.channels = 2;
+        const ogg_int64_t total = op_pcm_total(file_, -1);
+        frames_ = total > 0 ? uint64_t(total) : 0;
+    }
+    ~OpusDecoder() override { op_free(file_); }
+
+    size_t Read(float* out, size_t frames) override
+    {
+        size_t done = 0;
+        while (done < frames) {
+            const int got = op_read_float_stereo(file_, out + done * 2, int(std::min<size_t>(frames - done, 5760) * 2));
+            if (got <= 0) break;
+            done += size_t(got);
+        }
+        return done;
+    }
+
+    void Rewind() override { op_pcm_seek(file_, 0); }
+
+private:
+    OggOpusFile* file_ = nullptr;
+};
+#endif
+
+} // namespace
+
+std::unique_ptr<AudioDecoder> OpenAudioDecoder(const fs::path& path)
+{
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+    if (ext == ".wav") return std::make_unique<WavDecoder>(path);
+#ifdef DANCORE_HAS_VORBISFILE
+    if (ext == ".ogg") return std::make_unique<VorbisDecoder>(path);
+#endif
+#ifdef DANCORE_HAS_OPUSFILE
+    if (ext == ".opus") return std::make_unique<OpusDecoder>(path);
+#endif
+    Fail(path, "unsupported audio format in this build");
+}
+
+std::shared_ptr<const AudioClip> LoadAudioClip(const fs::path& path)
+{
+    DC_PROFILE_ZONE("LoadAudioClip");
+    std::unique_ptr<AudioDecoder> decoder = OpenAudioDecoder(path);
+    auto clip = std::make_shared<AudioClip>();
+    clip->format = decoder->Format();
+    const uint32_t channels = clip->format.channels;
+    size_t frames = 0;
+    clip->samples.resize(size_t(decoder->Frames() ? decoder->Frames() : 65536) * channels);
+    for (;;) {
+        if (frames * channels == clip->samples.size()) clip->samples.resize(clip->samples.size() * 2);
+        const size_t got = decoder->Read(clip->samples.data() + frames * channels, clip->samples.size() / channels - frames);
+        if (!got) break;
+        frames += got;
+    }
+    clip->samples.resize(frames * channels);
+    if (!frames) Fail(path, "no audio frames");
+    return clip;
+}
+
+} // namespace dancore::audio
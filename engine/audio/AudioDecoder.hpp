@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+// Декодеры звука в float (каналы вперемешку, 1 или 2 канала; лишние каналы отбрасываются).
+// Встроен WAV (PCM 8/16/24/32 бит и float); Ogg Vorbis (.ogg) и Opus (.opus) — если сборка
+// нашла libvorbisfile / libopusfile (DANCORE_HAS_VORBISFILE / DANCORE_HAS_OPUSFILE).
+// Ошибки открытия — std::runtime_error. Декодер — один поток за раз.
+
+namespace dancore::audio {
+
+struct AudioFormat {
+    uint32_t sampleRate = 48000;
+    uint32_t channels = 2;
+};
+
+class AudioDecoder {
+public:
+    virtual ~AudioDecoder() = default;
+
+    const AudioFormat& Format() const { return format_; }
+    uint64_t Frames() const { return frames_; } // 0 — длина неизвестна
+    // До frames кадров в out; 0 — конец потока (или ошибка чтения)
+    virtual size_t Read(float* out, size_t frames) = 0;
+    virtual void Rewind() = 0;
+
+protected:
+    AudioFormat format_;
+    uint64_t frames_ = 0;
+};
+
+// По расширению файла
+std::unique_ptr<AudioDecoder> OpenAudioDecoder(const std::filesystem::path& path);
+
+// Короткий звук целиком в памяти (эффекты). Неизменяем: голоса микшера читают его без
+// копий и без замков, а держит его shared_ptr на стороне игры
+struct AudioClip {
+    AudioFormat format;
+    std::vector<float> samples; // format.channels на кадр
+
+    uint64_t Frames() const { return samples.size() / format.channels; }
+};
+
+std::shared_ptr<const AudioClip> LoadAudioClip(const std::filesystem::path& path);
+
+} // namespace dancore::audio
@@ -0,0 +1,466 @@
+#include "AudioMixer.hpp"
+#include "core/Log.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace dancore::audio {
+
+namespace prof = dancore::core::profiler;
+
+namespace {
+
+constexpr float kHalfPi = 1.57079632679f;
+constexpr double kEdge = 1e-6; // запас, чтобы округление не вывело индекс за последний кадр
+
+// Линейная интерполяция n кадров: позиция j = base + frac + j * step. Ring — индексы по
+// маске кольца, иначе src уже сдвинут на base и вызывающий гарантирует k + 1 в пределах
+template <uint32_t Channels, bool Ring>
+void Lerp(const float* src, uint64_t base, uint64_t mask, double frac, double step, uint32_t n, float* left,
+          float* right)
+{
+    for (uint32_t j = 0; j < n; ++j) {
+        const double p = frac + double(j) * step;
+        const int32_t k = int32_t(p);
+        const float t = float(p - double(k));
+        uint64_t i0 = uint64_t(k), i1 = i0 + 1;
+        if constexpr (Ring) i0 = (base + i0) & mask, i1 = (base + i1) & mask;
+        if constexpr (Channels == 1) {
+            left[j] = src[i0] + (src[i1] - src[i0]) * t;
+        } else {
+            left[j] = src[i0 * 2] + (src[i1 * 2] - src[i0 * 2]) * t;
+            right[j] = src[i0 * 2 + 1] + (src[i1 * 2 + 1] - src[i0 * 2 + 1]) * t;
+        }
+    }
+}
+
+template <bool Ring>
+void Lerp(uint32_t channels, const float* src, uint64_t base, uint64_t mask, double frac, double step, uint32_t n,
+          float* left, float* right)
+{
+    if (channels == 1) Lerp<1, Ring>(src, base, mask, frac, step, n, left, right);
+    else Lerp<2, Ring>(src, base, mask, frac, step, n, left, right);
+}
+
+} // namespace
+
+AudioMixer::AudioMixer(const AudioMixerSettings& settings) : settings_(settings)
+{
+    if (!settings_.sampleRate) throw std::runtime_error("AudioMixer: sample rate is zero");
+    settings_.maxVoices = std::clamp<uint32_t>(settings_.maxVoices, 1, 4096); // finished_ не переполнится
+    settings_.maxBlockFrames = std::max<uint32_t>(settings_.maxBlockFrames, 1);
+    settings_.streamBufferFrames = std::bit_ceil(std::max<uint32_t>(settings_.streamBufferFrames, 4096));
+
+    slots_.resize(settings_.maxVoices);
+    voices_.resize(settings_.maxVoices);
+    freeSlots_.reserve(settings_.maxVoices);
+    for (uint32_t i = settings_.maxVoices; i-- > 0;) freeSlots_.push_back(i);
+    for (auto* buffer : {&mixL_, &mixR_, &srcL_, &srcR_}) buffer->resize(settings_.maxBlockFrames);
+    streams_.reserve(settings_.maxStreams);
+    for (uint32_t i = 0; i < settings_.maxStreams; ++i) {
+        streams_.push_back(std::make_unique<Stream>());
+        streams_.back()->ring.resize(size_t(settings_.streamBufferFrames) * 2);
+    }
+}
+
+AudioMixer::~AudioMixer() { core::jobs::Wait(decodeJobs_); }
+
+// ---------------------------------------------------------------------------
+// Поток игры
+
+VoiceId AudioMixer::Play(std::shared_ptr<const AudioClip> clip, const VoiceParams& params)
+{
+    if (!clip || !clip->Frames()) return 0;
+    return Start(std::move(clip), -1, params);
+}
+
+VoiceId AudioMixer::PlayStream(const std::filesystem::path& path, const VoiceParams& params)
+{
+    ReleaseStreams();
+    auto it = std::find_if(streams_.begin(), streams_.end(),
+                           [](const auto& s) { return !s->used && !s->busy.load(std::memory_order_acquire); });
+    if (it == streams_.end()) {
+        ++droppedVoices_;
+        return 0;
+    }
+    Stream& s = **it;
+    s.path = path;
+    s.loop = params.loop;
+    s.released = false;
+    s.written.store(0, std::memory_order_relaxed);
+    s.read.store(0, std::memory_order_relaxed);
+    s.ready.store(false, std::memory_order_relaxed);
+    s.ended.store(false, std::memory_order_relaxed);
+    s.failed.store(false, std::memory_order_relaxed);
+    // сброс публикует команда Play (release в очереди)
+    const VoiceId voice = Start(nullptr, int32_t(it - streams_.begin()), params);
+    if (!voice) return 0;
+    s.used = true;
+    Schedule(s);
+    return voice;
+}
+
+VoiceId AudioMixer::Start(std::shared_ptr<const AudioClip> clip, int32_t stream, const VoiceParams& params)
+{
+    if (freeSlots_.empty()) {
+        ++droppedVoices_;
+        return 0;
+    }
+    const uint32_t index = freeSlots_.back();
+    if (!Send({Op::Play, index, 0.0f, params, clip.get(), stream})) return 0;
+    freeSlots_.pop_back();
+    Slot& slot = slots_[index];
+    slot.used = true;
+    slot.clip = std::move(clip);
+    slot.stream = stream;
+    return VoiceId(slot.generation) << 16 | index;
+}
+
+bool AudioMixer::Send(const Command& c)
+{
+    if (commands_.TryPush(c)) return true;
+    ++droppedCommands_;
+    return false;
+}
+
+int32_t AudioMixer::SlotOf(VoiceId voice) const
+{
+    const uint32_t index = voice & 0xFFFF;
+    if (!voice || index >= slots_.size()) return -1;
+    const Slot& slot = slots_[index];
+    return slot.used && slot.generation == voice >> 16 ? int32_t(index) : -1;
+}
+
+void AudioMixer::Param(VoiceId voice, Op op, float value)
+{
+    const int32_t slot = SlotOf(voice);
+    if (slot >= 0) Send({op, uint32_t(slot), value, {}, nullptr, -1});
+}
+
+void AudioMixer::SetVolume(VoiceId voice, float volume) { Param(voice, Op::Volume, volume); }
+void AudioMixer::SetPan(VoiceId voice, float pan) { Param(voice, Op::Pan, pan); }
+void AudioMixer::SetPitch(VoiceId voice, float pitch) { Param(voice, Op::Pitch, pitch); }
+void AudioMixer::Stop(VoiceId voice) { Param(voice, Op::Stop, 0.0f); }
+void AudioMixer::SetMasterVolume(float volume) { Send({Op::Master, 0, volume, {}, nullptr, -1}); }
+bool AudioMixer::Playing(VoiceId voice) const { return SlotOf(voice) >= 0; }
+
+void AudioMixer::Update()
+{
+    DC_PROFILE_ZONE("AudioMixer::Update");
+    // звуки отпускаем здесь, а не в потоке устройства
+    uint32_t index;
+    while (finished_.TryPop(index)) {
+        Slot& slot = slots_[index];
+        if (slot.stream >= 0) streams_[size_t(slot.stream)]->released = true;
+        slot.clip.reset();
+        slot.stream = -1;
+        slot.used = false;
+        if (++slot.generation == 0) slot.generation = 1;
+        freeSlots_.push_back(index);
+    }
+    ReleaseStreams();
+
+    const uint64_t capacity = settings_.streamBufferFrames;
+    for (auto& stream : streams_) {
+        Stream& s = *stream;
+        if (!s.used || s.released || s.busy.load(std::memory_order_acquire)) continue;
+        if (s.failed.load(std::memory_order_relaxed) || s.ended.load(std::memory_order_relaxed)) continue;
+        const uint64_t filled = s.written.load(std::memory_order_relaxed) - s.read.load(std::memory_order_acquire);
+        if (capacity - filled >= capacity / 4) Schedule(s);
+    }
+}
+
+void AudioMixer::ReleaseStreams()
+{
+    for (auto& stream : streams_) {
+        Stream& s = *stream;
+        if (!s.used || !s.released || s.busy.load(std::memory_order_acquire)) continue;
+        s.decoder.reset();
+        s.used = false;
+        s.released = false;
+    }
+}
+
+void AudioMixer::Schedule(Stream& s)
+{
+    s.busy.store(true, std::memory_order_relaxed);
+    core::jobs::Run([this, &s] { Decode(s); }, &decodeJobs_);
+}
+
+// Задача job system: дописать кольцо до заполнения. Пишет только кадры после written и
+// не дальше read + ёмкость, так что Render читает свою часть без замков
+void AudioMixer::Decode(Stream& s)
+{
+    DC_PROFILE_ZONE("AudioMixer::Decode");
+    if (!s.decoder) {
+        try {
+            s.decoder = OpenAudioDecoder(s.path);
+        } catch (const std::exception& e) {
+            DC_LOG_WARN(Audio, "{}", e.what());
+            s.failed.store(true, std::memory_order_release);
+            s.busy.store(false, std::memory_order_release);
+            return;
+        }
+        s.channels = s.decoder->Format().channels;
+        s.sampleRate = s.decoder->Format().sampleRate;
+    }
+
+    const uint64_t capacity = settings_.streamBufferFrames, mask = capacity - 1;
+    uint64_t written = s.written.load(std::memory_order_relaxed);
+    bool rewound = false; // пустой файл в петле не должен крутиться вечно
+    for (;;) {
+        const uint64_t free = capacity - (written - s.read.load(std::memory_order_acquire));
+        if (!free) break;
+        const uint64_t at = written & mask;
+        const size_t got = s.decoder->Read(s.ring.data() + at * s.channels, size_t(std::min(free, capacity - at)));
+        if (got) {
+            written += got;
+            s.written.store(written, std::memory_order_release);
+            s.ready.store(true, std::memory_order_release);
+            rewound = false;
+            continue;
+        }
+        if (!s.loop || rewound) {
+            s.ended.store(true, std::memory_order_release);
+            break;
+        }
+        s.decoder->Rewind();
+        rewound = true;
+    }
+    s.ready.store(true, std::memory_order_release);
+    s.busy.store(false, std::memory_order_release);
+}
+
+AudioStats AudioMixer::Stats() const
+{
+    AudioStats stats;
+    stats.voices = activeVoices_.load(std::memory_order_relaxed);
+    stats.peakVoices = peakVoices_.load(std::memory_order_relaxed);
+    stats.streams = uint32_t(std::count_if(streams_.begin(), streams_.end(), [](const auto& s) { return s->used; }));
+    stats.framesRendered = framesRendered_.load(std::memory_order_relaxed);
+    stats.underrunFrames = underrunFrames_.load(std::memory_order_relaxed);
+    stats.underruns = underruns_.load(std::memory_order_relaxed);
+    stats.droppedCommands = droppedCommands_;
+    stats.droppedVoices = droppedVoices_;
+    const uint64_t calls = renderCalls_.load(std::memory_order_relaxed);
+    const double ns = double(renderNs_.load(std::memory_order_relaxed));
+    stats.renderMsAvg = calls ? ns / double(calls) * 1e-6 : 0.0;
+    stats.renderMsPeak = double(renderPeakNs_.load(std::memory_order_relaxed)) * 1e-6;
+    if (stats.framesRendered) stats.load = ns * 1e-9 / (double(stats.framesRendered) / settings_.sampleRate);
+    return stats;
+}
+
+// ---------------------------------------------------------------------------
+// Поток устройства: без замков, выделений и лога
+
+void AudioMixer::Render(float* out, uint32_t frames)
+{
+    const prof::Clock start = prof::Now();
+    Command c;
+    while (commands_.TryPop(c)) Apply(c);
+    for (uint32_t done = 0; done < frames;) {
+        const uint32_t n = std::min(frames - done, settings_.maxBlockFrames);
+        RenderBlock(out + size_t(done) * 2, n);
+        done += n;
+    }
+    const uint64_t ns = prof::Now() - start;
+    renderCalls_.fetch_add(1, std::memory_order_relaxed);
+    renderNs_.fetch_add(ns, std::memory_order_relaxed);
+    if (ns > renderPeakNs_.load(std::memory_order_relaxed)) renderPeakNs_.store(ns, std::memory_order_relaxed);
+    framesRendered_.fetch_add(frames, std::memory_order_relaxed);
+}
+
+void AudioMixer::Apply(const Command& c)
+{
+    if (c.op == Op::Master) {
+        master_ = c.value;
+        return;
+    }
+    Voice& v = voices_[c.slot];
+    switch (c.op) {
+    case Op::Play:
+        v = Voice{};
+        v.active = true;
+        if (c.clip) {
+            v.samples = c.clip->samples.data();
+            v.frames = c.clip->Frames();
+            v.channels = c.clip->format.channels;
+            v.sampleRate = c.clip->format.sampleRate;
+        } else {
+            v.channels = 0; // формат потока узнаем, когда задача откроет файл
+        }
+        v.stream = c.stream;
+        v.volume = c.params.volume;
+        v.pan = c.params.pan;
+        v.pitch = c.params.pitch;
+        v.loop = c.params.loop;
+        break;
+    // команды для уже закончившегося голоса приходят раньше нового Play этого слота
+    case Op::Volume: v.volume = c.value; break;
+    case Op::Pan: v.pan = c.value; break;
+    case Op::Pitch: v.pitch = c.value; break;
+    case Op::Stop: v.stopping = v.active; break;
+    case Op::Master: break;
+    }
+}
+
+void AudioMixer::RenderBlock(float* out, uint32_t frames)
+{
+    float* mixL = mixL_.data();
+    float* mixR = mixR_.data();
+    const float* srcL = srcL_.data();
+    const float* srcR = srcR_.data();
+    std::fill_n(mixL, frames, 0.0f);
+    std::fill_n(mixR, frames, 0.0f);
+    const float rampStep = 1.0f / float(frames);
+
+    uint32_t active = 0;
+    for (uint32_t index = 0; index < voices_.size(); ++index) {
+        Voice& v = voices_[index];
+        if (!v.active) continue;
+        const uint32_t produced = Resample(v, frames);
+        if (!v.channels) { // поток ещё открывается: не микшируем и не трогаем усиления
+            if (produced < frames) v.active = false, Finish(index);
+            else ++active;
+            continue;
+        }
+
+        // моно — равная мощность, стерео — баланс
+        const float pan = std::clamp(v.pan, -1.0f, 1.0f);
+        float targetL, targetR;
+        if (v.channels == 1) {
+            targetL = std::cos((pan + 1.0f) * 0.5f * kHalfPi);
+            targetR = std::sin((pan + 1.0f) * 0.5f * kHalfPi);
+        } else {
+            targetL = pan > 0 ? 1.0f - pan : 1.0f;
+            targetR = pan < 0 ? 1.0f + pan : 1.0f;
+        }
+        const float volume = v.stopping ? 0.0f : std::max(v.volume, 0.0f);
+        targetL *= volume, targetR *= volume;
+        if (!v.started) v.gainL = targetL, v.gainR = targetR, v.started = true;
+
+        const float gl = v.gainL, gr = v.gainR;
+        const float dl = (targetL - gl) * rampStep, dr = (targetR - gr) * rampStep;
+        const float* right = v.channels == 1 ? srcL : srcR;
+        for (uint32_t j = 0; j < frames; ++j) {
+            const float ramp = float(j + 1);
+            mixL[j] += srcL[j] * (gl + dl * ramp);
+            mixR[j] += right[j] * (gr + dr * ramp);
+        }
+        v.gainL = targetL, v.gainR = targetR;
+
+        if (produced < frames || v.stopping) {
+            v.active = false;
+            Finish(index);
+        } else {
+            ++active;
+        }
+    }
+
+    const float m0 = masterApplied_, dm = (master_ - m0) * rampStep;
+    for (uint32_t j = 0; j < frames; ++j) {
+        const float g = m0 + dm * float(j + 1);
+        out[j * 2] = std::clamp(mixL[j] * g, -1.0f, 1.0f);
+        out[j * 2 + 1] = std::clamp(mixR[j] * g, -1.0f, 1.0f);
+    }
+    masterApplied_ = master_;
+
+    activeVoices_.store(active, std::memory_order_relaxed);
+    if (active > peakVoices_.load(std::memory_order_relaxed)) peakVoices_.store(active, std::memory_order_relaxed);
+}
+
+uint32_t AudioMixer::Resample(Voice& v, uint32_t frames)
+{
+    float* left = srcL_.data();
+    float* right = srcR_.data();
+    uint32_t done = 0;
+    auto silence = [&] {
+        std::fill(left + done, left + frames, 0.0f);
+        std::fill(right + done, right + frames, 0.0f);
+    };
+
+    if (v.stream >= 0) {
+        Stream& s = *streams_[size_t(v.stream)];
+        if (!s.ready.load(std::memory_order_acquire)) { // файл ещё открывается
+            silence();
+            return s.failed.load(std::memory_order_acquire) ? 0 : frames;
+        }
+        v.channels = s.channels;
+        v.sampleRate = s.sampleRate;
+        // ended раньше written: если конец виден, виден и последний written
+        const bool ended = s.ended.load(std::memory_order_acquire);
+        const uint64_t written = s.written.load(std::memory_order_acquire);
+        const double step = double(v.sampleRate) / settings_.sampleRate * std::clamp(v.pitch, 1.0f / 64, 64.0f);
+        const uint64_t base = uint64_t(v.position);
+        const double frac = v.position - double(base);
+        const double room = double(written) - 1.0 - double(base) - frac - kEdge;
+        if (room > 0) {
+            done = uint32_t(std::min(double(frames), std::ceil(room / step)));
+            Lerp<true>(v.channels, s.ring.data(), base, settings_.streamBufferFrames - 1, frac, step, done, left, right);
+            v.position += done * step;
+        }
+        // хвост законченного файла: последнему кадру интерполировать не с чем
+        for (; ended && done < frames && v.position < double(written); ++done, v.position += step) {
+            const float* last = s.ring.data() + (uint64_t(v.position) & (settings_.streamBufferFrames - 1)) * v.channels;
+            left[done] = last[0];
+            right[done] = last[v.channels - 1];
+        }
+        silence();
+        s.read.store(std::min(uint64_t(v.position), written), std::memory_order_release);
+        if (done == frames || ended) return done;
+        underrunFrames_.fetch_add(frames - done, std::memory_order_relaxed);
+        underruns_.fetch_add(1, std::memory_order_relaxed);
+        return frames;
+    }
+
+    const double step = double(v.sampleRate) / settings_.sampleRate * std::clamp(v.pitch, 1.0f / 64, 64.0f);
+    const uint32_t channels = v.channels;
+    while (done < frames) {
+        if (v.position >= double(v.frames)) {
+            if (!v.loop) break;
+            v.position = std::fmod(v.position, double(v.frames));
+        }
+        const uint64_t base = uint64_t(v.position);
+        const double frac = v.position - double(base);
+        const double room = double(v.frames - 1 - base) - frac - kEdge;
+        if (room > 0) {
+            // серия кадров, у которых обе точки интерполяции внутри звука
+            const uint32_t run = uint32_t(std::min(double(frames - done), std::ceil(room / step)));
+            const float* src = v.samples + base * channels;
+            if (step == 1.0 && frac == 0.0) {
+                if (channels == 1) {
+                    std::memcpy(left + done, src, run * sizeof(float));
+                } else {
+                    for (uint32_t j = 0; j < run; ++j) left[done + j] = src[j * 2], right[done + j] = src[j * 2 + 1];
+                }
+            } else {
+                Lerp<false>(channels, src, 0, 0, frac, step, run, left + done, right + done);
+            }
+            v.position += run * step;
+            done += run;
+        } else {
+            // последний кадр: к началу, если петля
+            const uint64_t next = base + 1 < v.frames ? base + 1 : (v.loop ? 0 : base);
+            const float t = float(frac);
+            const float* a = v.samples + base * channels;
+            const float* b = v.samples + next * channels;
+            left[done] = a[0] + (b[0] - a[0]) * t;
+            if (channels == 2) right[done] = a[1] + (b[1] - a[1]) * t;
+            v.position += step;
+            ++done;
+        }
+    }
+    silence();
+    return done;
+}
+
+void AudioMixer::Finish(uint32_t slot)
+{
+    finished_.TryPush(slot); // не переполняется: слот возвращается в очередь не чаще раза за Play
+}
+
+} // namespace dancore::audio
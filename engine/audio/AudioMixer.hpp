@@ -0,0 +1,170 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "AudioDecoder.hpp"
+#include "SpscQueue.hpp"
+#include "core/JobSystem.hpp"
+
+// Микшер: игра ставит команды, поток устройства зовёт Render().
+//
+// Render() не берёт замков и не выделяет память: все буферы и голоса выделены в
+// конструкторе, команды приходят через SPSC-очередь, о завершённых голосах он сообщает
+// обратной SPSC-очередью. Звуки (AudioClip) держит сторона игры до сообщения о конце,
+// так что последний shared_ptr никогда не отпускается в потоке звука.
+//
+// Голос микшируется блоком: сначала ресемплинг (линейный, шаг = частота источника /
+// частота микшера * pitch) во временный массив, затем громкость и панорама с плавным
+// переходом за блок — простые циклы по массивам, которые компилятор векторизует.
+//
+// Потоки (.ogg/.opus/.wav) декодируются задачами job system в кольца, выделенные заранее:
+// Update() ставит задачу, когда кольцо опустело на четверть. Пустое кольцо у играющего
+// потока — недобор (underrun): голос дописывает тишину и продолжает.
+//
+// Всё, кроме Render(), — с одного потока игры.
+
+namespace dancore::audio {
+
+using VoiceId = uint32_t; // 0 — нет голоса
+
+struct AudioMixerSettings {
+    uint32_t sampleRate = 48000;
+    uint32_t maxVoices = 256;                // не больше 4096
+    uint32_t maxStreams = 16;
+    uint32_t maxBlockFrames = 1024;          // больший Render режется на блоки
+    uint32_t streamBufferFrames = 1u << 15;  // кольцо потока, степень двойки (~0.7 с при 48 кГц)
+};
+
+struct VoiceParams {
+    float volume = 1.0f;
+    float pan = 0.0f;    // -1 лево .. 1 право; у стерео — баланс
+    float pitch = 1.0f;
+    bool loop = false;
+};
+
+struct AudioStats {
+    uint32_t voices = 0;           // играют сейчас
+    uint32_t peakVoices = 0;
+    uint32_t streams = 0;          // открытые потоки (сторона игры)
+    uint64_t framesRendered = 0;
+    uint64_t underrunFrames = 0;   // тишина вместо данных потока
+    uint64_t underruns = 0;        // блоков с недобором
+    uint64_t droppedCommands = 0;  // очередь команд была полна
+    uint64_t droppedVoices = 0;    // Play без свободного голоса или потока
+    double renderMsAvg = 0, renderMsPeak = 0;
+    double load = 0;               // время Render / длительность отрисованного звука
+};
+
+class AudioMixer {
+public:
+    explicit AudioMixer(const AudioMixerSettings& settings = {});
+    ~AudioMixer();                 // ждёт задачи декодирования; устройство уже должно стоять
+    AudioMixer(const AudioMixer&) = delete;
+    AudioMixer& operator=(const AudioMixer&) = delete;
+
+    // --- поток игры ---
+    VoiceId Play(std::shared_ptr<const AudioClip> clip, const VoiceParams& params = {});
+    // Файл открывается и декодируется в задаче; ошибка — в лог, голос просто закончится
+    VoiceId PlayStream(const std::filesystem::path& path, const VoiceParams& params = {});
+    void SetVolume(VoiceId voice, float volume);
+    void SetPan(VoiceId voice, float pan);
+    void SetPitch(VoiceId voice, float pitch);
+    void Stop(VoiceId voice);      // с коротким затуханием
+    void SetMasterVolume(float volume);
+    bool Playing(VoiceId voice) const;
+
+    // Раз в кадр: забрать завершённые голоса, дозаказать декодирование потоков
+    void Update();
+    AudioStats Stats() const;
+    const AudioMixerSettings& Settings() const { return settings_; }
+
+    // --- поток устройства ---
+    // frames стерео-кадров, каналы вперемешку
+    void Render(float* out, uint32_t frames);
+
+private:
+    enum class Op : uint8_t { Play, Volume, Pan, Pitch, Stop, Master };
+
+    struct Command {
+        Op op;
+        uint32_t slot;
+        float value;
+        VoiceParams params;
+        const AudioClip* clip;     // Play звука
+        int32_t stream;            // Play потока, иначе -1
+    };
+
+    // Кольцо потока: пишет задача декодирования, читает Render
+    struct Stream {
+        std::filesystem::path path;
+        std::unique_ptr<AudioDecoder> decoder;
+        std::vector<float> ring;   // streamBufferFrames * 2, выделено заранее
+        bool loop = false;
+        bool used = false;
+        bool released = false;     // голос закончился, ждём конца задачи
+        uint32_t channels = 0, sampleRate = 0; // публикуются через ready
+        std::atomic<uint64_t> written{0}, read{0}; // в кадрах
+        std::atomic<bool> ready{false}, ended{false}, failed{false}, busy{false};
+    };
+
+    // Голос на стороне потока устройства
+    struct Voice {
+        bool active = false;
+        bool stopping = false;     // затухает за блок и заканчивается
+        const float* samples = nullptr;
+        uint64_t frames = 0;
+        uint32_t channels = 1, sampleRate = 0; // channels 0 — поток ещё не открыт
+        int32_t stream = -1;
+        double position = 0;       // в кадрах источника
+        float volume = 1, pan = 0, pitch = 1;
+        bool loop = false;
+        float gainL = 0, gainR = 0; // применённые в конце прошлого блока
+        bool started = false;
+    };
+
+    // Голос на стороне игры
+    struct Slot {
+        uint16_t generation = 1;
+        bool used = false;
+        std::shared_ptr<const AudioClip> clip;
+        int32_t stream = -1;
+    };
+
+    VoiceId Start(std::shared_ptr<const AudioClip> clip, int32_t stream, const VoiceParams& params);
+    bool Send(const Command& c);
+    void Param(VoiceId voice, Op op, float value);
+    int32_t SlotOf(VoiceId voice) const;
+    void Schedule(Stream& s);
+    void Decode(Stream& s);
+    void ReleaseStreams();
+
+    void Apply(const Command& c);
+    void RenderBlock(float* out, uint32_t frames);
+    uint32_t Resample(Voice& v, uint32_t frames); // в srcL_/srcR_, возвращает готовых кадров
+    void Finish(uint32_t slot);
+
+    AudioMixerSettings settings_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> freeSlots_;
+    std::vector<std::unique_ptr<Stream>> streams_;
+    core::jobs::JobCounter decodeJobs_;
+    uint64_t droppedCommands_ = 0, droppedVoices_ = 0;
+
+    SpscQueue<Command, 4096> commands_;   // игра -> устройство
+    SpscQueue<uint32_t, 4096> finished_;  // устройство -> игра: слоты закончившихся голосов
+
+    // поток устройства
+    std::vector<Voice> voices_;
+    std::vector<float> mixL_, mixR_, srcL_, srcR_;
+    float master_ = 1, masterApplied_ = 1;
+
+    std::atomic<uint32_t> activeVoices_{0}, peakVoices_{0};
+    std::atomic<uint64_t> framesRendered_{0}, underrunFrames_{0}, underruns_{0};
+    std::atomic<uint64_t> renderCalls_{0}, renderNs_{0}, renderPeakNs_{0};
+};
+
+} // namespace dancore::audio
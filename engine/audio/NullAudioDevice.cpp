@@ -0,0 +1,102 @@
+#include "NullAudioDevice.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace dancore::audio {
+
+namespace {
+
+void PutU32(unsigned char* p, uint32_t v) { p[0] = uint8_t(v), p[1] = uint8_t(v >> 8), p[2] = uint8_t(v >> 16), p[3] = uint8_t(v >> 24); }
+void PutU16(unsigned char* p, uint16_t v) { p[0] = uint8_t(v), p[1] = uint8_t(v >> 8); }
+
+} // namespace
+
+NullAudioDevice::NullAudioDevice(AudioMixer& mixer, const NullAudioDeviceSettings& settings)
+    : mixer_(mixer), settings_(settings)
+{
+    settings_.blockFrames = std::max<uint32_t>(settings_.blockFrames, 1);
+    buffer_.resize(size_t(settings_.blockFrames) * 2);
+    if (!settings_.wavPath.empty()) {
+        wav_ = std::fopen(settings_.wavPath.string().c_str(), "wb");
+        if (!wav_) throw std::runtime_error("NullAudioDevice: cannot create " + settings_.wavPath.string());
+        WriteHeader(); // размеры допишем при закрытии
+    }
+}
+
+NullAudioDevice::~NullAudioDevice()
+{
+    Stop();
+    if (!wav_) return;
+    WriteHeader();
+    std::fclose(wav_);
+}
+
+void NullAudioDevice::Start()
+{
+    if (running_.exchange(true)) return;
+    thread_ = std::thread([this] { Loop(); });
+}
+
+void NullAudioDevice::Stop()
+{
+    if (!running_.exchange(false)) return;
+    thread_.join();
+}
+
+void NullAudioDevice::RenderFrames(uint64_t frames)
+{
+    while (frames) {
+        const uint32_t n = uint32_t(std::min<uint64_t>(frames, settings_.blockFrames));
+        Block(n);
+        frames -= n;
+    }
+}
+
+void NullAudioDevice::Loop()
+{
+    core::profiler::SetThreadName("Audio");
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(double(settings_.blockFrames) / mixer_.Settings().sampleRate));
+    auto next = Clock::now();
+    while (running_.load(std::memory_order_acquire)) {
+        Block(settings_.blockFrames);
+        if (!settings_.realtime) continue;
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void NullAudioDevice::Block(uint32_t frames)
+{
+    mixer_.Render(buffer_.data(), frames);
+    frames_.fetch_add(frames, std::memory_order_relaxed);
+    if (wav_) std::fwrite(buffer_.data(), sizeof(float) * 2, frames, wav_);
+}
+
+// RIFF/WAVE, формат 3 (IEEE float), 2 канала
+void NullAudioDevice::WriteHeader()
+{
+    const uint64_t dataBytes = std::min<uint64_t>(Frames() * 8, 0xFFFFFFFFu - 36);
+    unsigned char h[44];
+    std::copy_n("RIFF", 4, h);
+    PutU32(h + 4, uint32_t(36 + dataBytes));
+    std::copy_n("WAVEfmt ", 8, h + 8);
+    PutU32(h + 16, 16);
+    PutU16(h + 20, 3);
+    PutU16(h + 22, 2);
+    PutU32(h + 24, mixer_.Settings().sampleRate);
+    PutU32(h + 28, mixer_.Settings().sampleRate * 8);
+    PutU16(h + 32, 8);
+    PutU16(h + 34, 32);
+    std::copy_n("data", 4, h + 36);
+    PutU32(h + 40, uint32_t(dataBytes));
+    std::fseek(wav_, 0, SEEK_SET);
+    std::fwrite(h, 1, sizeof(h), wav_);
+    std::fseek(wav_, 0, SEEK_END);
+}
+
+} // namespace dancore::audio
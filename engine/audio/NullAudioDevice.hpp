@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include "AudioMixer.hpp"
+
+// Устройство без звуковой карты: свой поток вместо callback'а ОС зовёт mixer.Render()
+// блоками по blockFrames — в темпе реального времени или так быстро, как получится.
+// Вывод выбрасывается или пишется в WAV (float 32 бит, стерео). Для серверов, CI и
+// бенчмарков; настоящий backend устроен так же: поток устройства трогает только Render().
+
+namespace dancore::audio {
+
+struct NullAudioDeviceSettings {
+    uint32_t blockFrames = 512;
+    bool realtime = true;              // false — без пауз между блоками
+    std::filesystem::path wavPath;     // пусто — без файла
+};
+
+class NullAudioDevice {
+public:
+    NullAudioDevice(AudioMixer& mixer, const NullAudioDeviceSettings& settings = {});
+    ~NullAudioDevice();                // Stop() и закрыть WAV
+    NullAudioDevice(const NullAudioDevice&) = delete;
+    NullAudioDevice& operator=(const NullAudioDevice&) = delete;
+
+    void Start();
+    void Stop();
+    // Синхронно с вызывающего потока, пока поток устройства не запущен
+    void RenderFrames(uint64_t frames);
+    uint64_t Frames() const { return frames_.load(std::memory_order_relaxed); }
+
+private:
+    void Loop();
+    void Block(uint32_t frames);
+    void WriteHeader();
+
+    AudioMixer& mixer_;
+    NullAudioDeviceSettings settings_;
+    std::vector<float> buffer_;
+    std::FILE* wav_ = nullptr;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> frames_{0};
+};
+
+} // namespace dancore::audio
@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Очередь без блокировок на одного писателя и одного читателя: кольцо фиксированного
+// размера внутри объекта, head двигает только писатель, tail — только читатель. Ни
+// TryPush, ни TryPop не выделяют память и не ждут: полная очередь отказывает сразу.
+
+namespace dancore::audio {
+
+template <class T, uint32_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    // Только писатель; false — очередь полна
+    bool TryPush(const T& value)
+    {
+        const uint32_t h = head_.load(std::memory_order_relaxed);
+        if (h - tailCache_ == Capacity) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (h - tailCache_ == Capacity) return false;
+        }
+        items_[h & (Capacity - 1)] = value;
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Только читатель; false — пусто
+    bool TryPop(T& out)
+    {
+        const uint32_t t = tail_.load(std::memory_order_relaxed);
+        if (t == headCache_) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (t == headCache_) return false;
+        }
+        out = items_[t & (Capacity - 1)];
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Приблизительно: с любой стороны
+    uint32_t Size() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+
+private:
+    T items_[Capacity];
+    alignas(64) std::atomic<uint32_t> head_{0};
+    uint32_t tailCache_ = 0;        // последний виденный писателем tail
+    alignas(64) std::atomic<uint32_t> tail_{0};
+    uint32_t headCache_ = 0;        // последний виденный читателем head
+};
+
+} // namespace dancore::audio
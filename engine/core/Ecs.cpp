@@ -0,0 +1,365 @@
+#include "Ecs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace dancore::core::ecs {
+
+namespace {
+
+std::mutex gRegistryMutex;
+std::array<ComponentInfo, kMaxComponents> gComponents; // не переаллоцируется: читаем без замка
+std::atomic<uint32_t> gComponentCount{0};
+
+size_t AlignUp(size_t v, size_t a) { return (v + a - 1) & ~(a - 1); }
+
+// Entity[capacity] в начале, затем по массиву на компонент, каждый с новой кэш-линии
+size_t LayoutBytes(const std::vector<ComponentId>& comps, uint32_t capacity)
+{
+    size_t bytes = sizeof(Entity) * capacity;
+    for (ComponentId id : comps) bytes = AlignUp(bytes, kCacheLine) + size_t(gComponents[id].size) * capacity;
+    return bytes;
+}
+
+unsigned char* NewChunkMemory()
+{
+    return static_cast<unsigned char*>(::operator new(kChunkBytes, std::align_val_t{kCacheLine}));
+}
+
+void FreeChunkMemory(unsigned char* p)
+{
+    ::operator delete(p, std::align_val_t{kCacheLine});
+}
+
+} // namespace
+
+namespace detail {
+
+ComponentId RegisterComponent(uint32_t size, uint32_t align, const void* defaultValue)
+{
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    uint32_t id = gComponentCount.load(std::memory_order_relaxed);
+    assert(id < kMaxComponents && "too many ECS component types");
+    ComponentInfo& info = gComponents[id];
+    info.size = size;
+    info.align = align;
+    const auto* p = static_cast<const unsigned char*>(defaultValue);
+    info.defaultValue.assign(p, p + size);
+    gComponentCount.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+} // namespace detail
+
+const ComponentInfo& GetComponentInfo(ComponentId id)
+{
+    assert(id < gComponentCount.load(std::memory_order_acquire));
+    return gComponents[id];
+}
+
+// ---- CommandBuffer ----
+
+Entity CommandBuffer::Create()
+{
+    Entity e{kDeferredBit | created_++, 0};
+    ops_.push_back({Op::Create, 0, e, 0});
+    return e;
+}
+
+void CommandBuffer::Destroy(Entity e)
+{
+    ops_.push_back({Op::Destroy, 0, e, 0});
+}
+
+// ---- World ----
+
+World::World() = default;
+
+World::~World()
+{
+    for (auto& [mask, a] : archetypes_)
+        for (Chunk& c : a->chunks) FreeChunkMemory(c.data);
+}
+
+Archetype& World::GetArchetype(ComponentMask mask)
+{
+    auto it = archetypes_.find(mask);
+    if (it != archetypes_.end()) return *it->second;
+
+    auto a = std::make_unique<Archetype>();
+    a->mask = mask;
+    a->offset.fill(~0u);
+    for (ComponentId id = 0; id < kMaxComponents; ++id)
+        if ((mask >> id) & 1) {
+            a->column[id] = uint8_t(a->components.size());
+            a->components.push_back(id);
+        }
+
+    size_t perEntity = sizeof(Entity);
+    for (ComponentId id : a->components) perEntity += GetComponentInfo(id).size;
+    uint32_t capacity = uint32_t(kChunkBytes / perEntity);
+    while (capacity > 1 && LayoutBytes(a->components, capacity) > kChunkBytes) --capacity;
+    assert(LayoutBytes(a->components, capacity) <= kChunkBytes && "component set does not fit a chunk");
+    a->capacity = capacity;
+
+    size_t bytes = sizeof(Entity) * capacity;
+    for (ComponentId id : a->components) {
+        bytes = AlignUp(bytes, kCacheLine);
+        a->offset[id] = uint32_t(bytes);
+        bytes += size_t(gComponents[id].size) * capacity;
+    }
+
+    Archetype* raw = a.get();
+    archetypes_.emplace(mask, std::move(a));
+    archetypeList_.push_back(raw);
+    return *raw;
+}
+
+Archetype* World::Transition(Archetype& from, ComponentId id, bool add)
+{
+    auto& edge = add ? from.addEdge[id] : from.removeEdge[id];
+    if (!edge) {
+        ComponentMask bit = ComponentMask(1) << id;
+        edge = &GetArchetype(add ? (from.mask | bit) : (from.mask & ~bit));
+    }
+    return edge;
+}
+
+void World::AddChunk(Archetype& a)
+{
+    a.chunks.push_back({NewChunkMemory(), 0});
+    a.versions.resize(a.versions.size() + a.components.size() + 1, version_);
+}
+
+void World::AllocateRow(Archetype& a, uint32_t& chunk, uint32_t& row)
+{
+    if (a.chunks.empty() || a.chunks.back().count == a.capacity) AddChunk(a);
+    chunk = uint32_t(a.chunks.size() - 1);
+    row = a.chunks.back().count++;
+    a.Versions(chunk)[0] = version_;
+}
+
+// Дыру закрываем последней сущностью архетипа: чанки остаются плотными
+void World::FreeRow(Archetype& a, uint32_t chunk, uint32_t row)
+{
+    Chunk& last = a.chunks.back();
+    uint32_t lastRow = last.count - 1;
+    if (chunk != a.chunks.size() - 1 || row != lastRow) {
+        Chunk& dst = a.chunks[chunk];
+        Entity moved = a.Entities(last)[lastRow];
+        a.Entities(dst)[row] = moved;
+        for (ComponentId id : a.components) {
+            uint32_t size = gComponents[id].size;
+            std::memcpy(static_cast<unsigned char*>(a.Column(dst, id)) + size_t(size) * row,
+                        static_cast<unsigned char*>(a.Column(last, id)) + size_t(size) * lastRow, size);
+        }
+        records_[moved.index].chunk = chunk;
+        records_[moved.index].row = row;
+        a.Versions(chunk)[0] = version_;
+    }
+    a.Versions(uint32_t(a.chunks.size() - 1))[0] = version_;
+    if (--last.count == 0) {
+        FreeChunkMemory(last.data);
+        a.chunks.pop_back();
+        a.versions.resize(a.versions.size() - a.components.size() - 1);
+    }
+}
+
+void World::InitRow(Archetype& a, uint32_t chunk, uint32_t row, ComponentMask skip)
+{
+    Chunk& c = a.chunks[chunk];
+    for (ComponentId id : a.components) {
+        if ((skip >> id) & 1) continue;
+        const ComponentInfo& info = gComponents[id];
+        std::memcpy(static_cast<unsigned char*>(a.Column(c, id)) + size_t(info.size) * row,
+                    info.defaultValue.data(), info.size);
+    }
+}
+
+Entity World::NewHandle()
+{
+    uint32_t index;
+    if (!freeList_.empty()) {
+        index = freeList_.back();
+        freeList_.pop_back();
+    } else {
+        index = uint32_t(records_.size());
+        records_.emplace_back();
+    }
+    ++alive_;
+    return {index, records_[index].generation};
+}
+
+Entity World::Create(ComponentMask mask)
+{
+    assert(!iterating_ && "structural change inside Each");
+    Archetype& a = GetArchetype(mask);
+    Entity e = NewHandle();
+    Record& r = records_[e.index];
+    r.archetype = &a;
+    AllocateRow(a, r.chunk, r.row);
+    a.Entities(a.chunks[r.chunk])[r.row] = e;
+    InitRow(a, r.chunk, r.row, 0);
+    return e;
+}
+
+void World::CreateBatch(ComponentMask mask, uint32_t count, Entity* out)
+{
+    assert(!iterating_ && "structural change inside Each");
+    Archetype& a = GetArchetype(mask);
+    records_.reserve(records_.size() + (count > freeList_.size() ? count - freeList_.size() : 0));
+    for (uint32_t i = 0; i < count;) {
+        if (a.chunks.empty() || a.chunks.back().count == a.capacity) AddChunk(a);
+        Chunk& c = a.chunks.back();
+        uint32_t chunkIndex = uint32_t(a.chunks.size() - 1);
+        a.Versions(chunkIndex)[0] = version_;
+        uint32_t n = std::min(count - i, a.capacity - c.count);
+        // значения по умолчанию раскладываем столбцами, а не построчно
+        for (ComponentId id : a.components) {
+            const ComponentInfo& info = gComponents[id];
+            auto* col = static_cast<unsigned char*>(a.Column(c, id)) + size_t(info.size) * c.count;
+            for (uint32_t k = 0; k < n; ++k) std::memcpy(col + size_t(info.size) * k, info.defaultValue.data(), info.size);
+        }
+        for (uint32_t k = 0; k < n; ++k) {
+            Entity e = NewHandle();
+            Record& r = records_[e.index];
+            r.archetype = &a;
+            r.chunk = chunkIndex;
+            r.row = c.count + k;
+            a.Entities(c)[r.row] = e;
+            if (out) out[i + k] = e;
+        }
+        c.count += n;
+        i += n;
+    }
+}
+
+bool World::Alive(Entity e) const
+{
+    return e.generation != 0 && e.index < records_.size()
+        && records_[e.index].generation == e.generation && records_[e.index].archetype;
+}
+
+void World::Destroy(Entity e)
+{
+    assert(!iterating_ && "structural change inside Each");
+    if (!Alive(e)) return;
+    Record& r = records_[e.index];
+    FreeRow(*r.archetype, r.chunk, r.row);
+    r.archetype = nullptr;
+    if (++r.generation == 0) r.generation = 1;
+    freeList_.push_back(e.index);
+    --alive_;
+}
+
+ComponentMask World::MaskOf(Entity e) const
+{
+    return Alive(e) ? records_[e.index].archetype->mask : 0;
+}
+
+void World::Move(Entity e, Archetype& to)
+{
+    Record& r = records_[e.index];
+    Archetype& from = *r.archetype;
+    uint32_t chunk, row;
+    AllocateRow(to, chunk, row);
+    Chunk& src = from.chunks[r.chunk];
+    Chunk& dst = to.chunks[chunk];
+    to.Entities(dst)[row] = e;
+    for (ComponentId id : to.components) {
+        if (from.offset[id] == ~0u) continue;
+        uint32_t size = gComponents[id].size;
+        std::memcpy(static_cast<unsigned char*>(to.Column(dst, id)) + size_t(size) * row,
+                    static_cast<unsigned char*>(from.Column(src, id)) + size_t(size) * r.row, size);
+    }
+    InitRow(to, chunk, row, from.mask);
+    FreeRow(from, r.chunk, r.row);
+    r.archetype = &to;
+    r.chunk = chunk;
+    r.row = row;
+}
+
+void* World::AddRaw(Entity e, ComponentId id, const void* value)
+{
+    assert(!iterating_ && "structural change inside Each");
+    assert(Alive(e));
+    Record& r = records_[e.index];
+    if (r.archetype->offset[id] == ~0u) Move(e, *Transition(*r.archetype, id, true));
+    void* dst = GetRaw(e, id);
+    std::memcpy(dst, value, gComponents[id].size);
+    return dst;
+}
+
+void World::RemoveRaw(Entity e, ComponentId id)
+{
+    assert(!iterating_ && "structural change inside Each");
+    if (!Alive(e)) return;
+    Record& r = records_[e.index];
+    if (r.archetype->offset[id] != ~0u) Move(e, *Transition(*r.archetype, id, false));
+}
+
+const void* World::GetRaw(Entity e, ComponentId id) const
+{
+    if (!Alive(e)) return nullptr;
+    const Record& r = records_[e.index];
+    const Archetype& a = *r.archetype;
+    if (a.offset[id] == ~0u) return nullptr;
+    return static_cast<unsigned char*>(a.Column(a.chunks[r.chunk], id)) + size_t(gComponents[id].size) * r.row;
+}
+
+void* World::GetRaw(Entity e, ComponentId id)
+{
+    const void* p = std::as_const(*this).GetRaw(e, id);
+    if (p) {
+        const Record& r = records_[e.index];
+        r.archetype->Versions(r.chunk)[1 + r.archetype->column[id]] = version_;
+    }
+    return const_cast<void*>(p);
+}
+
+void World::Playback(CommandBuffer& cmd)
+{
+    std::vector<Entity> created;
+    created.reserve(cmd.created_);
+    auto resolve = [&](Entity e) {
+        return (e.index & kDeferredBit) ? created[e.index & ~kDeferredBit] : e;
+    };
+    for (const CommandBuffer::Record& op : cmd.ops_) {
+        switch (op.op) {
+        case CommandBuffer::Op::Create:  created.push_back(Create()); break;
+        case CommandBuffer::Op::Destroy: Destroy(resolve(op.entity)); break;
+        case CommandBuffer::Op::Add:
+            // сущность могли удалить раньше в этом же буфере
+            if (Entity e = resolve(op.entity); Alive(e)) AddRaw(e, op.component, cmd.bytes_.data() + op.payload);
+            break;
+        case CommandBuffer::Op::Remove:  RemoveRaw(resolve(op.entity), op.component); break;
+        }
+    }
+    cmd.Clear();
+}
+
+const std::vector<Archetype*>& World::Match(ComponentMask need)
+{
+    Query& q = queries_[need];
+    for (; q.seen < archetypeList_.size(); ++q.seen) {
+        Archetype* a = archetypeList_[q.seen];
+        if ((a->mask & need) == need) q.matches.push_back(a);
+    }
+    return q.matches;
+}
+
+Entity World::At(uint32_t n) const
+{
+    for (const Archetype* a : archetypeList_) {
+        uint32_t count = a->Count();
+        if (n < count) return a->Entities(a->chunks[n / a->capacity])[n % a->capacity];
+        n -= count;
+    }
+    return {};
+}
+
+} // namespace dancore::core::ecs
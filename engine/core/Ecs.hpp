@@ -0,0 +1,304 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "JobSystem.hpp"
+
+// Хранилище сущностей по архетипам: сущности с одинаковым набором компонентов лежат
+// в чанках по 16 КБ, внутри чанка каждый компонент — свой непрерывный массив (SoA),
+// массивы выровнены по кэш-линии. Хэндлы — индекс + поколение, доступ O(1).
+// Структурные изменения (создание/удаление/добавление компонента) — только вне
+// итерации по запросу; из задач их пишут в CommandBuffer и проигрывают на главном потоке.
+
+namespace dancore::core::ecs {
+
+using ComponentId   = uint32_t;
+using ComponentMask = uint64_t;
+
+inline constexpr uint32_t kMaxComponents = 64;
+inline constexpr size_t   kChunkBytes    = 16 * 1024;
+inline constexpr size_t   kCacheLine     = 64;
+
+struct Entity {
+    uint32_t index = 0;
+    uint32_t generation = 0; // 0 — пустой хэндл, живые сущности начинаются с 1
+
+    explicit operator bool() const { return generation != 0; }
+    bool operator==(const Entity&) const = default;
+};
+
+struct ComponentInfo {
+    uint32_t size = 0;
+    uint32_t align = 0;
+    std::vector<unsigned char> defaultValue; // T{}: им заполняются новые компоненты
+};
+
+namespace detail {
+ComponentId RegisterComponent(uint32_t size, uint32_t align, const void* defaultValue);
+}
+
+const ComponentInfo& GetComponentInfo(ComponentId id);
+
+// Компоненты — POD: чанки копируются memcpy при переезде между архетипами
+template <class T>
+ComponentId ComponentIdOf()
+{
+    if constexpr (std::is_const_v<T>) {
+        return ComponentIdOf<std::remove_const_t<T>>(); // const T в запросах — тот же компонент
+    } else {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+                      "ECS components must be trivially copyable");
+        static_assert(alignof(T) <= kCacheLine);
+        static const ComponentId id = [] {
+            const T value{};
+            return detail::RegisterComponent(sizeof(T), alignof(T), &value);
+        }();
+        return id;
+    }
+}
+
+template <class... Ts>
+ComponentMask MaskOf() { return (ComponentMask(0) | ... | (ComponentMask(1) << ComponentIdOf<Ts>())); }
+
+struct Chunk {
+    unsigned char* data = nullptr; // kChunkBytes, выровнено по kCacheLine
+    uint32_t count = 0;
+};
+
+struct Archetype {
+    ComponentMask mask = 0;
+    uint32_t capacity = 0;                                   // сущностей на чанк
+    std::array<uint32_t, kMaxComponents> offset;             // смещение массива в чанке, ~0u — нет компонента
+    std::array<uint8_t, kMaxComponents> column{};            // номер компонента в components
+    std::vector<ComponentId> components;
+    std::vector<Chunk> chunks;                               // все, кроме последнего, заполнены до capacity
+    // Версии изменений: на чанк (1 + components.size()) значений World::Version() —
+    // [0] состав строк, дальше по массиву компонента. Отсюда инкрементальное сохранение
+    std::vector<uint32_t> versions;
+    std::array<Archetype*, kMaxComponents> addEdge{};        // кэш переходов Add/Remove
+    std::array<Archetype*, kMaxComponents> removeEdge{};
+
+    Entity* Entities(const Chunk& c) const { return reinterpret_cast<Entity*>(c.data); }
+    void* Column(const Chunk& c, ComponentId id) const { return c.data + offset[id]; }
+    uint32_t Count() const { return chunks.empty() ? 0 : uint32_t(chunks.size() - 1) * capacity + chunks.back().count; }
+    uint32_t* Versions(uint32_t chunk) { return versions.data() + size_t(chunk) * (components.size() + 1); }
+    const uint32_t* Versions(uint32_t chunk) const { return versions.data() + size_t(chunk) * (components.size() + 1); }
+};
+
+class World;
+
+// Отложенные структурные изменения. Create() возвращает временный хэндл, который
+// можно сразу передавать в Add/Remove этого же буфера; реальный появится в Playback.
+class CommandBuffer {
+public:
+    Entity Create();
+    void Destroy(Entity e);
+    template <class T> void Add(Entity e, const T& value = T{});
+    template <class T> void Remove(Entity e);
+
+    bool Empty() const { return ops_.empty(); }
+    void Clear() { ops_.clear(); bytes_.clear(); created_ = 0; }
+
+private:
+    friend class World;
+    enum class Op : uint8_t { Create, Destroy, Add, Remove };
+    struct Record { Op op; ComponentId component; Entity entity; uint32_t payload; };
+    std::vector<Record> ops_;
+    std::vector<unsigned char> bytes_; // значения для Add
+    uint32_t created_ = 0;
+};
+
+inline constexpr uint32_t kDeferredBit = 0x80000000u; // индекс временного хэндла CommandBuffer
+
+class World {
+public:
+    World();
+    ~World();
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    Entity Create(ComponentMask mask = 0);
+    // Пакетное создание: заполняет чанки подряд, без переездов между архетипами
+    void CreateBatch(ComponentMask mask, uint32_t count, Entity* out = nullptr);
+    void Destroy(Entity e);
+    bool Alive(Entity e) const;
+    uint32_t Count() const { return alive_; }
+
+    template <class T> T& Add(Entity e, const T& value = T{}); // e должна быть жива; есть — перезаписывает
+    template <class T> void Remove(Entity e);
+    template <class T> bool Has(Entity e) const;
+    template <class T> T* Get(Entity e); // nullptr, если сущность мертва или компонента нет; помечает массив изменённым
+    template <class T> const T* Get(Entity e) const; // только чтение, без пометки
+    ComponentMask MaskOf(Entity e) const;
+
+    // То же без типа, по ComponentIdOf (журнал правок, сериализация)
+    void* AddRaw(Entity e, ComponentId id, const void* value);
+    void RemoveRaw(Entity e, ComponentId id);
+    void* GetRaw(Entity e, ComponentId id);
+    const void* GetRaw(Entity e, ComponentId id) const;
+
+    void Playback(CommandBuffer& cmd);
+
+    // fn(count, entities, Ts*...) на каждый непустой чанк с нужными компонентами:
+    // массивы непрерывны, цикл внутри fn векторизуется
+    template <class... Ts, class F> void Each(F&& fn);
+    // То же по чанкам параллельно через jobs::ParallelFor; fn не должен менять структуру
+    template <class... Ts, class F> void ParallelEach(F&& fn);
+    // То же без типов (скрипты): fn(archetype, chunk) на каждый непустой чанк со всеми
+    // компонентами need; массивы из write помечаются изменёнными
+    template <class F> void EachChunk(ComponentMask need, ComponentMask write, F&& fn);
+
+    // n-я живая сущность в порядке хранения (для виртуализированных списков в редакторе)
+    Entity At(uint32_t n) const;
+
+    // Для сериализации. Версия растёт только по AdvanceVersion(); всё, что может писать в
+    // чанк (неконстантный Get, Each по неконстантному T, структурные изменения), ставит
+    // ему текущую. "Изменился после сохранения" = версия больше запомненной при сохранении.
+    uint32_t Version() const { return version_; }
+    void AdvanceVersion() { ++version_; }
+    const std::vector<Archetype*>& Archetypes() const { return archetypeList_; } // в порядке создания
+    Archetype& GetArchetype(ComponentMask mask);
+
+private:
+    struct Record {
+        Archetype* archetype = nullptr;
+        uint32_t chunk = 0, row = 0;
+        uint32_t generation = 1;
+    };
+
+    Archetype* Transition(Archetype& from, ComponentId id, bool add);
+    void AddChunk(Archetype& a);
+    void AllocateRow(Archetype& a, uint32_t& chunk, uint32_t& row);
+    void FreeRow(Archetype& a, uint32_t chunk, uint32_t row);
+    void InitRow(Archetype& a, uint32_t chunk, uint32_t row, ComponentMask skip);
+    Entity NewHandle();
+    void Move(Entity e, Archetype& to);
+    template <class T> static void MarkColumn(Archetype& a, uint32_t chunk, uint32_t version);
+    const std::vector<Archetype*>& Match(ComponentMask need);
+
+    std::vector<Record> records_;
+    std::vector<uint32_t> freeList_;
+    std::unordered_map<ComponentMask, std::unique_ptr<Archetype>> archetypes_;
+    std::vector<Archetype*> archetypeList_; // в порядке создания, только растёт
+    struct Query { size_t seen = 0; std::vector<Archetype*> matches; };
+    std::unordered_map<ComponentMask, Query> queries_;
+    uint32_t alive_ = 0;
+    uint32_t version_ = 1;
+    int iterating_ = 0; // >0: идёт Each, структурные изменения запрещены
+};
+
+// ---- шаблоны ----
+
+template <class T>
+void CommandBuffer::Add(Entity e, const T& value)
+{
+    ops_.push_back({Op::Add, ComponentIdOf<T>(), e, (uint32_t)bytes_.size()});
+    const auto* p = reinterpret_cast<const unsigned char*>(&value);
+    bytes_.insert(bytes_.end(), p, p + sizeof(T));
+}
+
+template <class T>
+void CommandBuffer::Remove(Entity e)
+{
+    ops_.push_back({Op::Remove, ComponentIdOf<T>(), e, 0});
+}
+
+template <class T>
+T& World::Add(Entity e, const T& value)
+{
+    return *static_cast<T*>(AddRaw(e, ComponentIdOf<T>(), &value));
+}
+
+template <class T>
+void World::Remove(Entity e)
+{
+    RemoveRaw(e, ComponentIdOf<T>());
+}
+
+template <class T>
+bool World::Has(Entity e) const
+{
+    return (MaskOf(e) >> ComponentIdOf<T>()) & 1;
+}
+
+template <class T>
+T* World::Get(Entity e)
+{
+    return static_cast<T*>(GetRaw(e, ComponentIdOf<T>()));
+}
+
+template <class T>
+const T* World::Get(Entity e) const
+{
+    return static_cast<const T*>(GetRaw(e, ComponentIdOf<T>()));
+}
+
+// const T — только чтение, версию не трогает
+template <class T>
+void World::MarkColumn(Archetype& a, uint32_t chunk, uint32_t version)
+{
+    if constexpr (!std::is_const_v<T>) a.Versions(chunk)[1 + a.column[ComponentIdOf<T>()]] = version;
+}
+
+template <class... Ts, class F>
+void World::Each(F&& fn)
+{
+    const ComponentMask need = ecs::MaskOf<Ts...>();
+    ++iterating_;
+    for (Archetype* a : Match(need))
+        for (uint32_t i = 0; i < a->chunks.size(); ++i) {
+            const Chunk& c = a->chunks[i];
+            if (!c.count) continue;
+            (MarkColumn<Ts>(*a, i, version_), ...);
+            fn(c.count, const_cast<const Entity*>(a->Entities(c)),
+               static_cast<Ts*>(a->Column(c, ComponentIdOf<Ts>()))...);
+        }
+    --iterating_;
+}
+
+template <class F>
+void World::EachChunk(ComponentMask need, ComponentMask write, F&& fn)
+{
+    ++iterating_;
+    for (Archetype* a : Match(need))
+        for (uint32_t i = 0; i < a->chunks.size(); ++i) {
+            const Chunk& c = a->chunks[i];
+            if (!c.count) continue;
+            for (ComponentMask m = write & need; m; m &= m - 1)
+                a->Versions(i)[1 + a->column[std::countr_zero(m)]] = version_;
+            fn(const_cast<const Archetype&>(*a), c);
+        }
+    --iterating_;
+}
+
+template <class... Ts, class F>
+void World::ParallelEach(F&& fn)
+{
+    const ComponentMask need = ecs::MaskOf<Ts...>();
+    struct Item { Archetype* a; const Chunk* c; };
+    std::vector<Item> items;
+    for (Archetype* a : Match(need))
+        for (uint32_t i = 0; i < a->chunks.size(); ++i)
+            if (a->chunks[i].count) {
+                (MarkColumn<Ts>(*a, i, version_), ...);
+                items.push_back({a, &a->chunks[i]});
+            }
+    ++iterating_;
+    jobs::ParallelFor(0, items.size(), 1, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            const Item& it = items[i];
+            fn(it.c->count, const_cast<const Entity*>(it.a->Entities(*it.c)),
+               static_cast<Ts*>(it.a->Column(*it.c, ComponentIdOf<Ts>()))...);
+        }
+    });
+    --iterating_;
+}
+
+} // namespace dancore::core::ecs
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// Быстрый некриптографический 64-битный хэш (семейство wyhash: 8 байт за шаг,
+// смешивание через 128-битное умножение). Для ключей кэшей и адресации по содержимому;
+// не для защиты от подделки. Результат не зависит от платформы (little-endian чтение).
+
+namespace dancore::core {
+
+namespace detail {
+
+inline uint64_t Mum(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)a * b;
+    return uint64_t(r) ^ uint64_t(r >> 64);
+#else
+    uint64_t ha = a >> 32, la = uint32_t(a), hb = b >> 32, lb = uint32_t(b);
+    uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+    uint64_t mid = (ll >> 32) + uint32_t(hl) + uint32_t(lh);
+    uint64_t lo = (mid << 32) | uint32_t(ll);
+    uint64_t hi = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+    return lo ^ hi;
+#endif
+}
+
+inline uint64_t Read64(const unsigned char* p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= uint64_t(p[i]) << (i * 8);
+    return v;
+}
+
+inline uint64_t Read32(const unsigned char* p)
+{
+    return uint64_t(p[0]) | uint64_t(p[1]) << 8 | uint64_t(p[2]) << 16 | uint64_t(p[3]) << 24;
+}
+
+inline constexpr uint64_t kP0 = 0xa0761d6478bd642full, kP1 = 0xe7037ed1a0b428dbull,
+                          kP2 = 0x8ebc6af09c88c6e3ull, kP3 = 0x589965cc75374cc3ull;
+
+} // namespace detail
+
+inline uint64_t Hash64(const void* data, size_t size, uint64_t seed = 0)
+{
+    using namespace detail;
+    const auto* p = static_cast<const unsigned char*>(data);
+    seed ^= Mum(seed ^ kP0, kP1);
+    uint64_t a = 0, b = 0;
+    size_t n = size;
+    if (n <= 16) {
+        if (n >= 4) {
+            a = (Read32(p) << 32) | Read32(p + ((n >> 3) << 2));
+            b = (Read32(p + n - 4) << 32) | Read32(p + n - 4 - ((n >> 3) << 2));
+        } else if (n > 0) {
+            a = (uint64_t(p[0]) << 16) | (uint64_t(p[n >> 1]) << 8) | p[n - 1];
+        }
+    } else {
+        if (n > 48) {
+            uint64_t s1 = seed, s2 = seed;
+            do {
+                seed = Mum(Read64(p) ^ kP1, Read64(p + 8) ^ seed);
+                s1 = Mum(Read64(p + 16) ^ kP2, Read64(p + 24) ^ s1);
+                s2 = Mum(Read64(p + 32) ^ kP3, Read64(p + 40) ^ s2);
+                p += 48; n -= 48;
+            } while (n > 48);
+            seed ^= s1 ^ s2;
+        }
+        while (n > 16) {
+            seed = Mum(Read64(p) ^ kP1, Read64(p + 8) ^ seed);
+            p += 16; n -= 16;
+        }
+        a = Read64(p + n - 16);
+        b = Read64(p + n - 8);
+    }
+    a ^= kP1; b ^= seed;
+    return Mum(a ^ kP0 ^ size, Mum(a, b) ^ kP1);
+}
+
+inline uint64_t Hash64(std::string_view s, uint64_t seed = 0) { return Hash64(s.data(), s.size(), seed); }
+
+// Порядко-зависимое объединение: HashCombine(h, Hash64(x))
+inline uint64_t HashCombine(uint64_t h, uint64_t v) { return detail::Mum(h ^ detail::kP0, v ^ detail::kP2); }
+
+} // namespace dancore::core
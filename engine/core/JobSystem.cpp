@@ -0,0 +1,368 @@
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dancore::core::jobs {
+
+namespace {
+
+// Chase–Lev: владелец кладёт/забирает снизу, воры крадут сверху
+class WorkStealingDeque {
+public:
+    static constexpr int64_t kCapacity = 4096;
+
+    bool Push(Job* job)
+    {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t >= kCapacity) return false;
+        buffer_[b & (kCapacity - 1)].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job* Pop()
+    {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) { bottom_.store(b + 1, std::memory_order_relaxed); return nullptr; }
+        Job* job = buffer_[b & (kCapacity - 1)].load(std::memory_order_relaxed);
+        if (t == b) {
+            // последний элемент: соревнуемся с ворами
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                job = nullptr;
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* Steal()
+    {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+        Job* job = buffer_[t & (kCapacity - 1)].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return job;
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::atomic<Job*> buffer_[kCapacity] = {};
+};
+
+// Кольцо задач потока: слот переиспользуется, когда задача из него завершилась
+struct JobRing {
+    static constexpr uint32_t kSize = 4096;
+    Job jobs[kSize];
+    uint32_t next = 0;
+};
+
+struct Worker {
+    WorkStealingDeque deque;
+    std::thread thread;
+};
+
+std::vector<std::unique_ptr<Worker>> gWorkers; // [0] — главный поток
+std::atomic<bool> gRunning{false};
+std::atomic<int64_t> gQueued{0};               // положено в деки и ещё не забрано
+std::atomic<int64_t> gExecuting{0};            // забрано из дек и ещё выполняется
+std::atomic<int32_t> gSleepers{0};
+std::mutex gSleepMutex;
+std::condition_variable gSleepCv;
+
+// задачи с посторонних потоков (без своей деки)
+std::mutex gInjectMutex;
+std::vector<Job*> gInjected;
+
+std::mutex gMainMutex;
+std::vector<std::pair<void (*)(void*), void*>> gMainQueue;
+std::atomic<void (*)()> gMainWake{nullptr};
+
+thread_local int tIndex = -1;
+// Кольца живут до конца процесса: задача из кольца может ещё стоять в деке, когда поток,
+// положивший её, уже завершился (у главного потока — к моменту ShutdownAtExit)
+std::mutex gRingsMutex;
+std::vector<std::unique_ptr<JobRing>> gRings;
+thread_local JobRing* tRing = nullptr;
+thread_local uint32_t tStealSeed = 0x9E3779B9u;
+
+void Wake()
+{
+    if (gSleepers.load(std::memory_order_seq_cst) > 0) {
+        { std::lock_guard<std::mutex> lock(gSleepMutex); }
+        gSleepCv.notify_one();
+    }
+}
+
+void Enqueue(Job* job)
+{
+    gQueued.fetch_add(1, std::memory_order_seq_cst);
+    if (tIndex >= 0 && gWorkers[tIndex]->deque.Push(job)) { Wake(); return; }
+    {
+        // дека переполнена или поток не из пула
+        std::lock_guard<std::mutex> lock(gInjectMutex);
+        gInjected.push_back(job);
+    }
+    Wake();
+}
+
+void Schedule(Job* job);
+
+void Finish(Job* job)
+{
+    JobCounter* counter = job->counter;
+    job->destroy(*job);
+    if (job->heap) delete job;
+    else job->free.store(true, std::memory_order_release);
+    if (!counter) return;
+
+    // декремент под замком: Wait() не вернётся (и счётчик на стеке не умрёт), пока замок не отпущен
+    while (counter->lock.test_and_set(std::memory_order_acquire)) {}
+    Job* list = nullptr;
+    if (counter->value.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // счётчик обнулился: запускаем всё, что ждало его
+        list = counter->continuations;
+        counter->continuations = nullptr;
+    }
+    counter->lock.clear(std::memory_order_release);
+    while (list) {
+        Job* next = list->next;
+        list->next = nullptr;
+        Schedule(list);
+        list = next;
+    }
+}
+
+void Execute(Job* job)
+{
+    job->invoke(*job);
+    Finish(job);
+}
+
+void Schedule(Job* job)
+{
+    if (!gRunning.load(std::memory_order_acquire)) { Execute(job); return; } // до Init/после Shutdown — синхронно
+    Enqueue(job);
+}
+
+Job* TakeInjected()
+{
+    std::lock_guard<std::mutex> lock(gInjectMutex);
+    if (gInjected.empty()) return nullptr;
+    Job* job = gInjected.back();
+    gInjected.pop_back();
+    return job;
+}
+
+Job* FindJob()
+{
+    Job* job = nullptr;
+    if (tIndex >= 0) job = gWorkers[tIndex]->deque.Pop();
+    if (!job) {
+        size_t n = gWorkers.size();
+        tStealSeed = tStealSeed * 1664525u + 1013904223u;
+        size_t start = tStealSeed % n;
+        for (size_t i = 0; i < n && !job; ++i) {
+            size_t victim = (start + i) % n;
+            if ((int)victim != tIndex) job = gWorkers[victim]->deque.Steal();
+        }
+    }
+    if (!job) job = TakeInjected();
+    if (job) {
+        // сначала «выполняется», потом «не в очереди»: Shutdown не увидит нуля в обоих сразу
+        gExecuting.fetch_add(1, std::memory_order_seq_cst);
+        gQueued.fetch_sub(1, std::memory_order_seq_cst);
+    }
+    return job;
+}
+
+// Задача, взятая FindJob
+void ExecuteFound(Job* job)
+{
+    Execute(job);
+    gExecuting.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void WorkerMain(int index)
+{
+    tIndex = index;
+    std::string name = "Worker " + std::to_string(index);
+    profiler::SetThreadName(name.c_str());
+    while (gRunning.load(std::memory_order_acquire)) {
+        if (Job* job = FindJob()) { ExecuteFound(job); continue; }
+        // короткий спин перед сном: задачи обычно приходят пачками
+        bool found = false;
+        for (int spin = 0; spin < 64 && !found; ++spin) {
+            std::this_thread::yield();
+            found = gQueued.load(std::memory_order_relaxed) > 0;
+        }
+        if (found) continue;
+        std::unique_lock<std::mutex> lock(gSleepMutex);
+        gSleepers.fetch_add(1, std::memory_order_seq_cst);
+        gSleepCv.wait(lock, [] {
+            return gQueued.load(std::memory_order_seq_cst) > 0 || !gRunning.load(std::memory_order_acquire);
+        });
+        gSleepers.fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+void Stop(bool drain)
+{
+    if (!gRunning.load()) return;
+    if (drain) {
+        // досчитываем хвост вместе с воркерами: выполняющаяся задача ещё может породить детей,
+        // так что пусто — это когда нет ни очереди, ни выполняющихся
+        for (;;) {
+            if (Job* job = FindJob()) { ExecuteFound(job); continue; }
+            if (gQueued.load(std::memory_order_seq_cst) == 0 && gExecuting.load(std::memory_order_seq_cst) == 0) break;
+            std::this_thread::yield();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(gSleepMutex);
+        gRunning.store(false, std::memory_order_release);
+    }
+    gSleepCv.notify_all();
+    for (size_t i = 1; i < gWorkers.size(); ++i) gWorkers[i]->thread.join();
+    // положенное посторонним потоком между проверкой и остановкой; новые задачи уже синхронные
+    if (drain)
+        while (Job* job = FindJob()) ExecuteFound(job);
+    gWorkers.clear();
+    tIndex = -1;
+    if (drain) PumpMainThread();
+}
+
+// Выход из main без Shutdown (исключение при старте) не должен виснуть на спящих воркерах.
+// Очередь не досчитывается: задачи могут ссылаться на уже размотанный стек main.
+// atexit из Init, а не статический объект: так это раньше деструкторов статиков других
+// единиц трансляции (профайлер, журнал), которыми ещё пользуются воркеры
+void ShutdownAtExit() { Stop(false); }
+
+} // namespace
+
+void Init(uint32_t workers)
+{
+    if (gRunning.load()) return;
+    if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    workers = std::max(workers, 1u);
+    gWorkers.clear();
+    for (uint32_t i = 0; i <= workers; ++i) gWorkers.push_back(std::make_unique<Worker>());
+    tIndex = 0;
+    static std::once_flag atExit;
+    std::call_once(atExit, [] { std::atexit(ShutdownAtExit); });
+    gRunning.store(true, std::memory_order_release);
+    for (uint32_t i = 1; i <= workers; ++i) gWorkers[i]->thread = std::thread(WorkerMain, (int)i);
+}
+
+void Shutdown()
+{
+    Stop(true);
+}
+
+uint32_t WorkerCount() { return gWorkers.empty() ? 0 : (uint32_t)gWorkers.size() - 1; }
+int ThreadIndex() { return tIndex; }
+
+Job* AllocateJob()
+{
+    if (!tRing) {
+        auto ring = std::make_unique<JobRing>();
+        tRing = ring.get();
+        std::lock_guard<std::mutex> lock(gRingsMutex);
+        gRings.push_back(std::move(ring));
+    }
+    JobRing& ring = *tRing;
+    // несколько слотов подряд: долгоживущая задача не должна блокировать кольцо
+    for (uint32_t probe = 0; probe < 8; ++probe) {
+        Job& job = ring.jobs[ring.next++ & (JobRing::kSize - 1)];
+        if (job.free.load(std::memory_order_acquire)) {
+            job.free.store(false, std::memory_order_relaxed);
+            job.heap = false;
+            job.next = nullptr;
+            return &job;
+        }
+    }
+    Job* job = new Job();
+    job->free.store(false, std::memory_order_relaxed);
+    job->heap = true;
+    return job;
+}
+
+void Submit(Job* job, JobCounter* counter)
+{
+    job->counter = counter;
+    if (counter) counter->value.fetch_add(1, std::memory_order_relaxed);
+    Schedule(job);
+}
+
+void SubmitAfter(JobCounter& dependency, Job* job, JobCounter* counter)
+{
+    job->counter = counter;
+    if (counter) counter->value.fetch_add(1, std::memory_order_relaxed);
+    while (dependency.lock.test_and_set(std::memory_order_acquire)) {}
+    if (dependency.Done()) {
+        dependency.lock.clear(std::memory_order_release);
+        Schedule(job);
+        return;
+    }
+    job->next = dependency.continuations;
+    dependency.continuations = job;
+    dependency.lock.clear(std::memory_order_release);
+}
+
+void Wait(JobCounter& counter)
+{
+    DC_PROFILE_ZONE("jobs::Wait");
+    while (!counter.Done()) {
+        if (gRunning.load(std::memory_order_acquire))
+            if (Job* job = FindJob()) { ExecuteFound(job); continue; }
+        std::this_thread::yield();
+    }
+    // последний Finish мог ещё не отпустить замок счётчика
+    while (counter.lock.test(std::memory_order_acquire)) std::this_thread::yield();
+}
+
+void RunOnMainThread(void (*fn)(void*), void* user)
+{
+    {
+        std::lock_guard<std::mutex> lock(gMainMutex);
+        gMainQueue.emplace_back(fn, user);
+    }
+    WakeMainThread();
+}
+
+void SetMainThreadWake(void (*wake)())
+{
+    gMainWake.store(wake, std::memory_order_release);
+}
+
+void WakeMainThread()
+{
+    if (auto wake = gMainWake.load(std::memory_order_acquire)) wake();
+}
+
+void PumpMainThread()
+{
+    std::vector<std::pair<void (*)(void*), void*>> queue;
+    {
+        std::lock_guard<std::mutex> lock(gMainMutex);
+        queue.swap(gMainQueue);
+    }
+    for (auto& [fn, user] : queue) fn(user);
+}
+
+} // namespace dancore::core::jobs
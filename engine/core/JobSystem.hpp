@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Планировщик задач: фиксированный пул воркеров (по числу аппаратных потоков),
+// у каждого потока своя lock-free дека с кражей работы (Chase–Lev), счётчики для
+// ожидания и зависимостей, parallel_for по диапазонам и очередь "только главный поток"
+// для Vulkan/ImGui. Все подсистемы планируют через него, а не через свои std::thread.
+
+namespace dancore::core::jobs {
+
+struct Job;
+
+// Счётчик незавершённых задач. Ждать можно через Wait(), а RunAfter() ставит
+// задачу, которая стартует, когда счётчик дойдёт до нуля.
+struct JobCounter {
+    std::atomic<int32_t> value{0};
+    std::atomic_flag lock = ATOMIC_FLAG_INIT; // защищает continuations
+    Job* continuations = nullptr;
+
+    bool Done() const { return value.load(std::memory_order_acquire) == 0; }
+};
+
+inline constexpr size_t kJobStorage = 48; // лямбда крупнее уходит в кучу
+
+struct Job {
+    void (*invoke)(Job&) = nullptr;
+    void (*destroy)(Job&) = nullptr;
+    JobCounter* counter = nullptr;
+    Job* next = nullptr;                 // цепочка continuations
+    std::atomic<bool> free{true};
+    bool heap = false;                   // кольцо потока было занято: задача из кучи
+    alignas(std::max_align_t) unsigned char storage[kJobStorage];
+};
+
+// workers == 0: hardware_concurrency() - 1 (главный поток тоже выполняет задачи в Wait)
+void Init(uint32_t workers = 0);
+// Досчитывает все задачи, включая порождённые во время остановки, и останавливает воркеров
+void Shutdown();
+uint32_t WorkerCount();
+// 0 — главный поток, 1..N — воркеры, -1 — посторонний поток
+int ThreadIndex();
+
+Job* AllocateJob();
+void Submit(Job* job, JobCounter* counter);
+void SubmitAfter(JobCounter& dependency, Job* job, JobCounter* counter);
+
+// Помогает выполнять задачи, пока счётчик не обнулится
+void Wait(JobCounter& counter);
+
+// Очередь главного потока: задачи с привязкой к Vulkan/ImGui, выполняются в PumpMainThread()
+void RunOnMainThread(void (*fn)(void*), void* user);
+void PumpMainThread();
+
+// Главный поток может спать в ожидании событий окна: фоновая работа, чей результат
+// надо показать, будит его. Обработчик ставит бэкенд (nullptr — снять), зовут из любого потока.
+void SetMainThreadWake(void (*wake)());
+void WakeMainThread();
+
+namespace detail {
+
+template <class F>
+Job* MakeJob(F&& f)
+{
+    using Fn = std::decay_t<F>;
+    Job* job = AllocateJob();
+    if constexpr (sizeof(Fn) <= kJobStorage && alignof(Fn) <= alignof(std::max_align_t)) {
+        new (job->storage) Fn(std::forward<F>(f));
+        job->invoke  = [](Job& j) { (*std::launder(reinterpret_cast<Fn*>(j.storage)))(); };
+        job->destroy = [](Job& j) { std::launder(reinterpret_cast<Fn*>(j.storage))->~Fn(); };
+    } else {
+        *reinterpret_cast<Fn**>(job->storage) = new Fn(std::forward<F>(f));
+        job->invoke  = [](Job& j) { (**reinterpret_cast<Fn**>(j.storage))(); };
+        job->destroy = [](Job& j) { delete *reinterpret_cast<Fn**>(j.storage); };
+    }
+    return job;
+}
+
+} // namespace detail
+
+template <class F>
+void Run(F&& f, JobCounter* counter = nullptr)
+{
+    Submit(detail::MakeJob(std::forward<F>(f)), counter);
+}
+
+template <class F>
+void RunAfter(JobCounter& dependency, F&& f, JobCounter* counter = nullptr)
+{
+    SubmitAfter(dependency, detail::MakeJob(std::forward<F>(f)), counter);
+}
+
+// fn(begin, end) по кускам не меньше grain; возвращает после выполнения всех кусков
+template <class F>
+void ParallelFor(size_t begin, size_t end, size_t grain, F&& fn)
+{
+    if (end <= begin) return;
+    if (grain == 0) grain = 1;
+    size_t count = end - begin;
+    size_t maxChunks = size_t(WorkerCount() + 1) * 4;
+    size_t chunk = count / maxChunks > grain ? count / maxChunks : grain;
+    if (chunk >= count) { fn(begin, end); return; }
+
+    JobCounter counter;
+    // первый кусок выполняет вызывающий поток, остальные — пул
+    for (size_t s = begin + chunk; s < end; s += chunk) {
+        size_t e = s + chunk < end ? s + chunk : end;
+        Run([&fn, s, e] { fn(s, e); }, &counter);
+    }
+    fn(begin, begin + chunk);
+    Wait(counter);
+}
+
+} // namespace dancore::core::jobs
@@ -0,0 +1,219 @@
+#include "Log.hpp"
+#include "Profiler.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace dancore::core::log {
+
+namespace {
+
+constexpr uint32_t kRingWords    = 1u << 15; // 256 КБ на поток между двумя Drain
+constexpr uint32_t kHeaderWords  = 3;        // время, Site*, argc | types << 8 | размер << 32
+constexpr uint32_t kBlockRecords = 1u << 16;
+constexpr size_t   kMaxBlocks    = 64;       // ~4M записей, дальше вытесняются старые блоки
+
+// SPSC: пишет поток-владелец, читает Drain на главном потоке
+struct ThreadRing {
+    uint64_t words[kRingWords];
+    alignas(64) std::atomic<uint32_t> head{0};
+    alignas(64) std::atomic<uint32_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+    uint32_t index = 0;
+};
+
+std::atomic<uint8_t> gMinLevel{uint8_t(Level::Info)};
+
+std::mutex gRingsMutex; // только регистрация потока и обход списка в Drain
+std::vector<std::unique_ptr<ThreadRing>> gRings;
+thread_local ThreadRing* tRing = nullptr;
+
+struct Block {
+    std::vector<Record> records;
+    std::vector<uint64_t> args;
+};
+std::deque<Block> gBlocks;
+uint64_t gFirst = 0; // глобальный индекс gBlocks.front().records[0]
+uint64_t gLevelCount[size_t(Level::Count)]{};
+
+ThreadRing& Self()
+{
+    if (!tRing) {
+        auto r = std::make_unique<ThreadRing>();
+        std::lock_guard<std::mutex> lock(gRingsMutex);
+        r->index = (uint32_t)gRings.size();
+        tRing = r.get();
+        gRings.push_back(std::move(r));
+    }
+    return *tRing;
+}
+
+uint64_t EndIndex()
+{
+    return gBlocks.empty() ? gFirst : gFirst + (gBlocks.size() - 1) * kBlockRecords + gBlocks.back().records.size();
+}
+
+Block& BlockFor(uint64_t index) { return gBlocks[(index - gFirst) / kBlockRecords]; }
+
+void Append(const uint64_t* ring, uint32_t t, uint32_t thread)
+{
+    auto word = [&](uint32_t i) { return ring[(t + i) & (kRingWords - 1)]; };
+    if (gBlocks.empty() || gBlocks.back().records.size() == kBlockRecords) {
+        if (gBlocks.size() == kMaxBlocks) {
+            for (const Record& r : gBlocks.front().records) --gLevelCount[size_t(r.site->level)];
+            gBlocks.pop_front();
+            gFirst += kBlockRecords;
+        }
+        gBlocks.emplace_back().records.reserve(kBlockRecords);
+    }
+    Block& b = gBlocks.back();
+    uint64_t meta = word(2);
+    uint32_t size = uint32_t(meta >> 32);
+    Record r;
+    r.time = word(0);
+    r.site = reinterpret_cast<const Site*>(word(1));
+    r.args = (uint32_t)b.args.size();
+    r.thread = uint8_t(thread);
+    r.argc = uint8_t(meta);
+    r.types = uint16_t(meta >> 8);
+    for (uint32_t i = kHeaderWords; i < size; ++i) b.args.push_back(word(i));
+    b.records.push_back(r);
+    ++gLevelCount[size_t(r.site->level)];
+}
+
+void AppendNumber(std::string& out, ArgType type, uint64_t v)
+{
+    char buf[32];
+    int n = 0;
+    switch (type) {
+    case ArgType::I64: n = std::snprintf(buf, sizeof(buf), "%lld", (long long)int64_t(v)); break;
+    case ArgType::U64: n = std::snprintf(buf, sizeof(buf), "%llu", (unsigned long long)v); break;
+    default: {
+        double d;
+        std::memcpy(&d, &v, 8);
+        n = std::snprintf(buf, sizeof(buf), "%g", d);
+    }
+    }
+    out.append(buf, size_t(n > 0 ? n : 0));
+}
+
+} // namespace
+
+const char* LevelName(Level l)
+{
+    static const char* names[] = {"Trace", "Info", "Warn", "Error"};
+    return l < Level::Count ? names[size_t(l)] : "?";
+}
+
+const char* CategoryName(Category c)
+{
+    static const char* names[] = {"Core", "Jobs", "Render", "Assets", "Physics", "Audio", "Script", "Net", "Editor"};
+    return c < Category::Count ? names[size_t(c)] : "?";
+}
+
+void SetMinLevel(Level l) { gMinLevel.store(uint8_t(l), std::memory_order_relaxed); }
+bool Enabled(Level l) { return uint8_t(l) >= gMinLevel.load(std::memory_order_relaxed); }
+
+namespace detail {
+
+Writer Begin(const Site& site, uint32_t words, uint16_t types, uint32_t argc)
+{
+    ThreadRing& r = Self();
+    uint32_t size = kHeaderWords + words;
+    uint32_t h = r.head.load(std::memory_order_relaxed);
+    if (size > kRingWords || h + size - r.tail.load(std::memory_order_acquire) > kRingWords) {
+        r.dropped.fetch_add(1, std::memory_order_relaxed);
+        return {nullptr, 0, 0};
+    }
+    Writer w{r.words, kRingWords - 1, h};
+    Put(w, profiler::Now());
+    Put(w, reinterpret_cast<uint64_t>(&site));
+    Put(w, argc | uint64_t(types) << 8 | uint64_t(size) << 32);
+    return w;
+}
+
+void Commit(const Writer& w)
+{
+    // pos уже указывает за последний аргумент: это и есть новая голова
+    tRing->head.store(w.pos, std::memory_order_release);
+}
+
+} // namespace detail
+
+void Drain()
+{
+    DC_PROFILE_ZONE("Log::Drain");
+    std::string text;
+    std::lock_guard<std::mutex> lock(gRingsMutex);
+    for (auto& ring : gRings) {
+        uint32_t t = ring->tail.load(std::memory_order_relaxed);
+        uint32_t h = ring->head.load(std::memory_order_acquire);
+        while (t != h) {
+            uint32_t size = uint32_t(ring->words[(t + 2) & (kRingWords - 1)] >> 32);
+            Append(ring->words, t, ring->index);
+            const Record& r = gBlocks.back().records.back();
+            if (r.site->level >= Level::Warn) {
+                Format(EndIndex() - 1, text);
+                std::fprintf(stderr, "[%s][%s] %s\n", LevelName(r.site->level), CategoryName(r.site->category), text.c_str());
+            }
+            t += size;
+        }
+        ring->tail.store(t, std::memory_order_release);
+    }
+}
+
+uint64_t Dropped()
+{
+    std::lock_guard<std::mutex> lock(gRingsMutex);
+    uint64_t n = 0;
+    for (auto& r : gRings) n += r->dropped.load(std::memory_order_relaxed);
+    return n;
+}
+
+uint64_t First() { return gFirst; }
+uint64_t End() { return EndIndex(); }
+
+const Record& At(uint64_t index)
+{
+    return BlockFor(index).records[(index - gFirst) % kBlockRecords];
+}
+
+void Format(uint64_t index, std::string& out)
+{
+    const Block& b = BlockFor(index);
+    const Record& r = b.records[(index - gFirst) % kBlockRecords];
+    const uint64_t* arg = b.args.data() + r.args;
+    uint32_t next = 0;
+    out.clear();
+    for (const char* p = r.site->format; *p; ++p) {
+        if (p[0] == '{' && p[1] == '{') { out += '{'; ++p; continue; }
+        if (p[0] == '}' && p[1] == '}') { out += '}'; ++p; continue; }
+        if (p[0] != '{' || p[1] != '}') { out += *p; continue; }
+        ++p;
+        if (next >= r.argc) { out += "{}"; continue; }
+        auto type = ArgType((r.types >> (next * 2)) & 3);
+        ++next;
+        if (type == ArgType::Str) {
+            size_t len = size_t(*arg++);
+            out.append(reinterpret_cast<const char*>(arg), len);
+            arg += (len + 7) / 8;
+        } else {
+            AppendNumber(out, type, *arg++);
+        }
+    }
+}
+
+void Clear()
+{
+    gFirst = EndIndex();
+    gBlocks.clear();
+    for (auto& c : gLevelCount) c = 0;
+}
+
+uint64_t Count(Level l) { return l < Level::Count ? gLevelCount[size_t(l)] : 0; }
+
+} // namespace dancore::core::log
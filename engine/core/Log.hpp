@@ -0,0 +1,154 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Журнал без блокировок на пишущей стороне: у каждого потока своё SPSC-кольцо
+// (вместе — MPSC к главному потоку), запись — метка времени, указатель на статическое
+// описание места вызова (формат, уровень, категория) и упакованные аргументы.
+// Текст не форматируется при записи: только когда строку показывают или ищут по ней.
+// Переполненное кольцо не ждёт читателя — запись отбрасывается и считается в Dropped().
+//
+// Drain() на главном потоке раз в кадр переносит записи в хранилище (блоки по 64K
+// компактных записей, старые блоки вытесняются). Всё, что ниже Drain, — только главный поток.
+//
+//   DC_LOG_WARN(Assets, "texture {} is {}x{}, expected power of two", name, w, h);
+
+namespace dancore::core::log {
+
+enum class Level : uint8_t { Trace, Info, Warn, Error, Count };
+
+enum class Category : uint8_t { Core, Jobs, Render, Assets, Physics, Audio, Script, Net, Editor, Count };
+
+const char* LevelName(Level l);
+const char* CategoryName(Category c);
+
+// Статическое описание места вызова; в записи хранится только указатель на него
+struct Site {
+    const char* format; // "{}" — следующий аргумент, "{{" — фигурная скобка
+    const char* file;
+    uint32_t line;
+    Level level;
+    Category category;
+};
+
+inline constexpr uint32_t kMaxArgs = 8;
+
+enum class ArgType : uint8_t { I64, U64, F64, Str };
+
+// Отсекается до упаковки аргументов; по умолчанию Info
+void SetMinLevel(Level l);
+bool Enabled(Level l);
+
+namespace detail {
+
+struct Writer {
+    uint64_t* words;   // nullptr — в кольце нет места, запись отброшена
+    uint32_t mask;
+    uint32_t pos;
+};
+
+Writer Begin(const Site& site, uint32_t words, uint16_t types, uint32_t argc);
+void Commit(const Writer& w);
+
+inline void Put(Writer& w, uint64_t v) { w.words[w.pos++ & w.mask] = v; }
+
+template <class T>
+constexpr ArgType TypeOf()
+{
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, bool>) return ArgType::U64;
+    else if constexpr (std::is_floating_point_v<U>) return ArgType::F64;
+    else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) return ArgType::I64;
+    else if constexpr (std::is_integral_v<U> || std::is_enum_v<U>) return ArgType::U64;
+    else if constexpr (std::is_convertible_v<const U&, std::string_view>) return ArgType::Str;
+    else static_assert(sizeof(U) == 0, "log argument must be a number or a string");
+}
+
+template <class T>
+uint32_t WordsOf(const T& v)
+{
+    if constexpr (TypeOf<T>() == ArgType::Str) return 1 + uint32_t((std::string_view(v).size() + 7) / 8);
+    else return 1;
+}
+
+template <class T>
+void PutArg(Writer& w, const T& v)
+{
+    constexpr ArgType t = TypeOf<T>();
+    if constexpr (t == ArgType::Str) {
+        std::string_view s(v);
+        Put(w, s.size());
+        for (size_t i = 0; i < s.size(); i += 8) {
+            uint64_t word = 0;
+            std::memcpy(&word, s.data() + i, s.size() - i < 8 ? s.size() - i : 8);
+            Put(w, word);
+        }
+    } else if constexpr (t == ArgType::F64) {
+        double d = double(v);
+        uint64_t word;
+        std::memcpy(&word, &d, 8);
+        Put(w, word);
+    } else if constexpr (t == ArgType::I64) {
+        Put(w, uint64_t(int64_t(v)));
+    } else {
+        Put(w, uint64_t(v));
+    }
+}
+
+} // namespace detail
+
+template <class... Ts>
+void Write(const Site& site, const Ts&... args)
+{
+    static_assert(sizeof...(Ts) <= kMaxArgs, "too many log arguments");
+    uint16_t types = 0;
+    uint32_t shift = 0;
+    ((types |= uint16_t(uint16_t(detail::TypeOf<Ts>()) << shift), shift += 2), ...);
+    uint32_t words = (0 + ... + detail::WordsOf(args));
+    detail::Writer w = detail::Begin(site, words, types, sizeof...(Ts));
+    if (!w.words) return;
+    (detail::PutArg(w, args), ...);
+    detail::Commit(w);
+}
+
+// Записи из колец — в хранилище; Warn и выше заодно печатаются в stderr
+void Drain();
+uint64_t Dropped();
+
+// ---- хранилище (главный поток) ----
+
+struct Record {
+    uint64_t time;       // profiler::Now()
+    const Site* site;
+    uint32_t args;       // смещение аргументов в блоке
+    uint8_t thread;
+    uint8_t argc;
+    uint16_t types;      // по 2 бита ArgType на аргумент
+};
+
+// Глобальные индексы живых записей: [First(), End()); растут, не переиспользуются
+uint64_t First();
+uint64_t End();
+const Record& At(uint64_t index);
+// Текст сообщения (без уровня и времени)
+void Format(uint64_t index, std::string& out);
+void Clear();
+uint64_t Count(Level l); // среди живых записей
+
+} // namespace dancore::core::log
+
+#define DC_LOG(level, category, format, ...)                                                                   \
+    do {                                                                                                       \
+        static constexpr ::dancore::core::log::Site dc_log_site_{format, __FILE__, __LINE__, level, category}; \
+        if (::dancore::core::log::Enabled(level))                                                              \
+            ::dancore::core::log::Write(dc_log_site_ __VA_OPT__(, ) __VA_ARGS__);                              \
+    } while (0)
+
+#define DC_LOG_TRACE(cat, format, ...) DC_LOG(::dancore::core::log::Level::Trace, ::dancore::core::log::Category::cat, format __VA_OPT__(, ) __VA_ARGS__)
+#define DC_LOG_INFO(cat, format, ...)  DC_LOG(::dancore::core::log::Level::Info, ::dancore::core::log::Category::cat, format __VA_OPT__(, ) __VA_ARGS__)
+#define DC_LOG_WARN(cat, format, ...)  DC_LOG(::dancore::core::log::Level::Warn, ::dancore::core::log::Category::cat, format __VA_OPT__(, ) __VA_ARGS__)
+#define DC_LOG_ERROR(cat, format, ...) DC_LOG(::dancore::core::log::Level::Error, ::dancore::core::log::Category::cat, format __VA_OPT__(, ) __VA_ARGS__)
@@ -0,0 +1,205 @@
+#include "Profiler.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace dancore::core::profiler {
+
+namespace {
+
+constexpr uint32_t kRingSize  = 1u << 13; // событий на поток между двумя EndFrame
+constexpr uint32_t kMaxDepth  = 64;
+constexpr size_t   kHistory   = 240;      // ~4 секунды при 60 Гц
+
+const auto gEpoch = std::chrono::steady_clock::now();
+
+// SPSC: пишет поток-владелец, читает EndFrame на главном потоке
+struct ThreadState {
+    ZoneEvent ring[kRingSize];
+    alignas(64) std::atomic<uint32_t> head{0};
+    alignas(64) std::atomic<uint32_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+
+    // стек открытых зон трогает только владелец
+    struct Open { const char* name; Clock begin; };
+    Open stack[kMaxDepth];
+    uint32_t depth = 0;
+
+    uint32_t index = 0;
+    std::string name;
+};
+
+std::atomic<bool> gEnabled{true};
+bool gPaused = false;
+
+std::mutex gThreadsMutex; // только регистрация потока и чтение списка
+std::vector<std::unique_ptr<ThreadState>> gThreads;
+thread_local ThreadState* tThread = nullptr;
+
+std::vector<FrameCapture> gHistory;
+FrameCapture gCurrent;
+std::vector<ZoneEvent> gPendingGpu;
+uint64_t gFrameIndex = 0;
+
+ThreadState& Self()
+{
+    if (!tThread) {
+        auto ts = std::make_unique<ThreadState>();
+        std::lock_guard<std::mutex> lock(gThreadsMutex);
+        ts->index = (uint32_t)gThreads.size();
+        ts->name = "Thread " + std::to_string(ts->index);
+        tThread = ts.get();
+        gThreads.push_back(std::move(ts));
+    }
+    return *tThread;
+}
+
+void Push(ThreadState& ts, const ZoneEvent& ev)
+{
+    uint32_t h = ts.head.load(std::memory_order_relaxed);
+    if (h - ts.tail.load(std::memory_order_acquire) >= kRingSize) {
+        ts.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ts.ring[h & (kRingSize - 1)] = ev;
+    ts.head.store(h + 1, std::memory_order_release);
+}
+
+void Drain(ThreadState& ts, std::vector<ZoneEvent>* out)
+{
+    uint32_t t = ts.tail.load(std::memory_order_relaxed);
+    uint32_t h = ts.head.load(std::memory_order_acquire);
+    if (out)
+        for (; t != h; ++t) out->push_back(ts.ring[t & (kRingSize - 1)]);
+    ts.tail.store(h, std::memory_order_release);
+}
+
+void WriteEscaped(FILE* f, const std::string& s)
+{
+    for (char c : s) {
+        if (c == '"' || c == '\\') std::fputc('\\', f);
+        std::fputc(c, f);
+    }
+}
+
+} // namespace
+
+Clock Now()
+{
+    return (Clock)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - gEpoch).count();
+}
+
+void SetEnabled(bool enabled) { gEnabled.store(enabled, std::memory_order_relaxed); }
+bool IsEnabled() { return gEnabled.load(std::memory_order_relaxed); }
+void SetPaused(bool paused) { gPaused = paused; }
+bool IsPaused() { return gPaused; }
+
+void SetThreadName(const char* name)
+{
+    ThreadState& ts = Self();
+    std::lock_guard<std::mutex> lock(gThreadsMutex);
+    ts.name = name;
+}
+
+void BeginZone(const char* name)
+{
+    ThreadState& ts = Self();
+    // стек ведётся и при выключенном профайлере, чтобы Begin/End не разъехались
+    if (ts.depth < kMaxDepth)
+        ts.stack[ts.depth] = {name, IsEnabled() ? Now() : 0};
+    ++ts.depth;
+}
+
+void EndZone()
+{
+    ThreadState& ts = Self();
+    if (ts.depth == 0) return;
+    uint32_t d = --ts.depth;
+    if (d >= kMaxDepth) return;
+    const auto& open = ts.stack[d];
+    if (!open.begin || !IsEnabled()) return;
+    Push(ts, ZoneEvent{open.name, open.begin, Now(), d, ts.index});
+}
+
+void ReportGpuZone(const char* name, Clock begin, Clock end, uint32_t depth)
+{
+    gPendingGpu.push_back(ZoneEvent{name, begin, end, depth, kGpuThread});
+}
+
+void ReportGpuFrameTime(double ms) { gCurrent.gpu_ms = ms; }
+
+void BeginFrame()
+{
+    gCurrent.index = gFrameIndex++;
+    gCurrent.begin = Now();
+}
+
+void EndFrame()
+{
+    gCurrent.end = Now();
+    gCurrent.zones.clear();
+    {
+        std::lock_guard<std::mutex> lock(gThreadsMutex);
+        for (auto& ts : gThreads) Drain(*ts, gPaused ? nullptr : &gCurrent.zones);
+    }
+    gCurrent.zones.insert(gCurrent.zones.end(), gPendingGpu.begin(), gPendingGpu.end());
+    gPendingGpu.clear();
+
+    if (!gPaused) {
+        if (gHistory.size() >= kHistory) gHistory.erase(gHistory.begin());
+        gHistory.push_back(std::move(gCurrent));
+    }
+    gCurrent = FrameCapture{};
+}
+
+const std::vector<FrameCapture>& History() { return gHistory; }
+
+std::vector<std::string> ThreadNames()
+{
+    std::lock_guard<std::mutex> lock(gThreadsMutex);
+    std::vector<std::string> names;
+    for (auto& ts : gThreads) names.push_back(ts->name);
+    return names;
+}
+
+uint64_t DroppedZones()
+{
+    std::lock_guard<std::mutex> lock(gThreadsMutex);
+    uint64_t n = 0;
+    for (auto& ts : gThreads) n += ts->dropped.load(std::memory_order_relaxed);
+    return n;
+}
+
+bool ExportChromeTrace(const char* path)
+{
+    FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+    constexpr uint32_t kGpuTid = 1000;
+    std::fputs("{\"traceEvents\":[\n", f);
+    auto names = ThreadNames();
+    bool first = true;
+    auto sep = [&]{ if (!first) std::fputs(",\n", f); first = false; };
+    for (uint32_t i = 0; i < names.size(); ++i) {
+        sep();
+        std::fprintf(f, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", i);
+        WriteEscaped(f, names[i]);
+        std::fputs("\"}}", f);
+    }
+    sep();
+    std::fprintf(f, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"GPU\"}}", kGpuTid);
+    for (const auto& frame : gHistory) {
+        for (const auto& z : frame.zones) {
+            sep();
+            std::fputs("{\"ph\":\"X\",\"name\":\"", f);
+            WriteEscaped(f, z.name);
+            std::fprintf(f, "\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                z.thread == kGpuThread ? kGpuTid : z.thread, z.begin / 1000.0, (z.end - z.begin) / 1000.0);
+        }
+    }
+    std::fputs("\n]}\n", f);
+    return std::fclose(f) == 0;
+}
+
+} // namespace dancore::core::profiler
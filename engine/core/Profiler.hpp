@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Инструментирование горячих путей: вложенные CPU-зоны на поток (lock-free кольцо на поток,
+// пишет только владелец) + GPU-зоны, которые присылает графический бэкенд.
+// Сборка кадра (EndFrame) и чтение результатов — только с главного потока.
+
+namespace dancore::core::profiler {
+
+using Clock = uint64_t; // наносекунды от старта профайлера
+
+inline constexpr uint32_t kGpuThread = 0xFFFFFFFFu; // псевдо-поток для GPU-зон
+
+struct ZoneEvent {
+    const char* name;   // строковый литерал, не копируется
+    Clock begin, end;
+    uint32_t depth;
+    uint32_t thread;    // индекс из ThreadNames() или kGpuThread
+};
+
+struct FrameCapture {
+    uint64_t index = 0;
+    Clock begin = 0, end = 0;
+    double gpu_ms = -1.0;           // -1: результаты GPU ещё не пришли
+    std::vector<ZoneEvent> zones;   // CPU-зоны, завершённые в этом кадре + GPU-зоны
+};
+
+Clock Now();
+
+void SetEnabled(bool enabled);
+bool IsEnabled();
+void SetPaused(bool paused);   // пауза: кадры не попадают в историю (панель смотрит на замороженный кадр)
+bool IsPaused();
+
+// Имя текущего потока в панели и трассе ("Main", "Worker 3", ...)
+void SetThreadName(const char* name);
+
+void BeginZone(const char* name);
+void EndZone();
+
+// GPU-зоны уже переведены на CPU-шкалу вызывающей стороной
+void ReportGpuZone(const char* name, Clock begin, Clock end, uint32_t depth);
+void ReportGpuFrameTime(double ms);
+
+void BeginFrame();
+void EndFrame();
+
+// История последних кадров, от старых к новым
+const std::vector<FrameCapture>& History();
+std::vector<std::string> ThreadNames();
+uint64_t DroppedZones();
+
+// Chrome trace JSON (chrome://tracing, Perfetto) по всей сохранённой истории
+bool ExportChromeTrace(const char* path);
+
+class ScopedZone {
+public:
+    explicit ScopedZone(const char* name) { BeginZone(name); }
+    ~ScopedZone() { EndZone(); }
+    ScopedZone(const ScopedZone&) = delete;
+    ScopedZone& operator=(const ScopedZone&) = delete;
+};
+
+} // namespace dancore::core::profiler
+
+#define DC_PROFILE_CAT2(a, b) a##b
+#define DC_PROFILE_CAT(a, b) DC_PROFILE_CAT2(a, b)
+#ifndef DANCORE_DISABLE_PROFILER
+#define DC_PROFILE_ZONE(name) ::dancore::core::profiler::ScopedZone DC_PROFILE_CAT(dc_zone_, __LINE__){name}
+#else
+#define DC_PROFILE_ZONE(name) ((void)0)
+#endif
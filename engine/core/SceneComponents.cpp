@@ -0,0 +1,70 @@
+#include "SceneComponents.hpp"
+#include "Profiler.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace dancore::core::scene {
+
+namespace {
+
+constexpr float kDegToRad = 3.14159265358979f / 180.0f;
+constexpr uint32_t kMaxChunkRows = ecs::kChunkBytes / sizeof(ecs::Entity);
+
+} // namespace
+
+ecs::ComponentMask TransformMask()
+{
+    return ecs::MaskOf<Name, Position, Rotation, Scale, LocalToWorld>();
+}
+
+void SetName(Name& n, const char* name)
+{
+    std::strncpy(n.value, name, sizeof(n.value) - 1);
+    n.value[sizeof(n.value) - 1] = '\0';
+}
+
+ecs::Entity CreateObject(ecs::World& world, const char* name)
+{
+    ecs::Entity e = world.Create(TransformMask());
+    SetName(*world.Get<Name>(e), name);
+    return e;
+}
+
+void UpdateLocalToWorld(ecs::World& world)
+{
+    DC_PROFILE_ZONE("UpdateLocalToWorld");
+    world.ParallelEach<const Position, const Rotation, const Scale, LocalToWorld>(
+        [](uint32_t count, const ecs::Entity*, const Position* p, const Rotation* r, const Scale* s, LocalToWorld* out) {
+            // синусы отдельным проходом: дальше чистая арифметика по массивам
+            float sx[kMaxChunkRows], cx[kMaxChunkRows], sy[kMaxChunkRows];
+            float cy[kMaxChunkRows], sz[kMaxChunkRows], cz[kMaxChunkRows];
+            for (uint32_t i = 0; i < count; ++i) {
+                sx[i] = std::sin(r[i].x * kDegToRad); cx[i] = std::cos(r[i].x * kDegToRad);
+                sy[i] = std::sin(r[i].y * kDegToRad); cy[i] = std::cos(r[i].y * kDegToRad);
+                sz[i] = std::sin(r[i].z * kDegToRad); cz[i] = std::cos(r[i].z * kDegToRad);
+            }
+            // M = T * Rz * Ry * Rx * S
+            for (uint32_t i = 0; i < count; ++i) {
+                float* m = out[i].m;
+                m[0]  = cy[i] * cz[i] * s[i].x;
+                m[1]  = cy[i] * sz[i] * s[i].x;
+                m[2]  = -sy[i] * s[i].x;
+                m[3]  = 0.0f;
+                m[4]  = (sx[i] * sy[i] * cz[i] - cx[i] * sz[i]) * s[i].y;
+                m[5]  = (sx[i] * sy[i] * sz[i] + cx[i] * cz[i]) * s[i].y;
+                m[6]  = sx[i] * cy[i] * s[i].y;
+                m[7]  = 0.0f;
+                m[8]  = (cx[i] * sy[i] * cz[i] + sx[i] * sz[i]) * s[i].z;
+                m[9]  = (cx[i] * sy[i] * sz[i] - sx[i] * cz[i]) * s[i].z;
+                m[10] = cx[i] * cy[i] * s[i].z;
+                m[11] = 0.0f;
+                m[12] = p[i].x;
+                m[13] = p[i].y;
+                m[14] = p[i].z;
+                m[15] = 1.0f;
+            }
+        });
+}
+
+} // namespace dancore::core::scene
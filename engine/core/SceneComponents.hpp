@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+
+#include "Ecs.hpp"
+
+// Базовые компоненты сцены, которые правят Inspector и инструменты Toolbox.
+// Позиция/поворот/масштаб — отдельные компоненты: каждый лежит своим массивом в чанке.
+
+namespace dancore::core::scene {
+
+struct Name      { char value[48] = {}; };
+struct Position  { float x = 0, y = 0, z = 0; };
+struct Rotation  { float x = 0, y = 0, z = 0; };   // углы Эйлера в градусах, порядок X, Y, Z
+struct Scale     { float x = 1, y = 1, z = 1; };
+struct LocalToWorld { float m[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1}; }; // column-major
+
+struct PhysicsBody {
+    enum Mode : uint8_t { Rigid = 0, Voxel = 1 };
+    uint8_t mode = Rigid;
+};
+
+// Name + Position + Rotation + Scale + LocalToWorld
+ecs::ComponentMask TransformMask();
+
+ecs::Entity CreateObject(ecs::World& world, const char* name);
+void SetName(Name& n, const char* name);
+
+// TRS -> LocalToWorld по всем чанкам параллельно; внутренний цикл идёт по
+// непрерывным массивам без ветвлений и векторизуется компилятором
+void UpdateLocalToWorld(ecs::World& world);
+
+} // namespace dancore::core::scene
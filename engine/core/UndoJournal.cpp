@@ -0,0 +1,314 @@
+#include "UndoJournal.hpp"
+#include "Profiler.hpp"
+
+#include <cassert>
+#include <cstring>
+
+namespace dancore::core {
+
+namespace {
+
+// Открытая запись: заголовок и полное значение (XOR для Change)
+struct RawHeader {
+    uint8_t op;
+    uint8_t pad[3];
+    uint32_t component;
+    uint32_t index, generation;
+    uint32_t size;
+};
+
+constexpr size_t kMinZeroRun = 3; // короче — дешевле оставить литералами
+
+void PutVarint(std::vector<uint8_t>& out, uint64_t v)
+{
+    for (; v >= 0x80; v >>= 7) out.push_back(uint8_t(v | 0x80));
+    out.push_back(uint8_t(v));
+}
+
+uint64_t GetVarint(const uint8_t*& p)
+{
+    uint64_t v = 0;
+    for (int shift = 0;; shift += 7) {
+        uint8_t b = *p++;
+        v |= uint64_t(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+    }
+}
+
+uint64_t ZigZag(int64_t v) { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+int64_t UnZigZag(uint64_t v) { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+uint64_t MergeKey(ecs::Entity e, ecs::ComponentId id) { return uint64_t(e.index) << 8 | id; }
+
+} // namespace
+
+size_t UndoJournal::Entry::Bytes() const
+{
+    return sizeof(Entry) + label.capacity() + data.capacity() + merge.size() * 4 * sizeof(void*);
+}
+
+UndoJournal::UndoJournal(size_t budgetBytes) : budget_(budgetBytes) {}
+
+size_t UndoJournal::Bytes() const
+{
+    return sealedBytes_ + (!entries_.empty() && entries_.back().open ? entries_.back().Bytes() : 0);
+}
+
+UndoJournal::Entry& UndoJournal::OpenEntry(const char* label, uint64_t key)
+{
+    if (group_ > 0) return entries_.back();
+    if (key && !entries_.empty() && entries_.back().open && entries_.back().key == key) return entries_.back();
+    Seal();
+    // новая правка отменяет ветку Redo
+    while (entries_.size() > applied_) {
+        sealedBytes_ -= entries_.back().Bytes();
+        entries_.pop_back();
+    }
+    Entry& entry = entries_.emplace_back();
+    entry.label = label;
+    entry.key = key;
+    applied_ = entries_.size();
+    return entry;
+}
+
+void UndoJournal::Append(Entry& entry, Op op, ecs::Entity e, ecs::ComponentId id, const void* value)
+{
+    uint32_t size = ecs::GetComponentInfo(id).size;
+    RawHeader h{uint8_t(op), {}, id, e.index, e.generation, size};
+    size_t at = entry.data.size();
+    entry.data.resize(at + sizeof(h) + size);
+    std::memcpy(entry.data.data() + at, &h, sizeof(h));
+    std::memcpy(entry.data.data() + at + sizeof(h), value, size);
+    ++entry.records;
+}
+
+void UndoJournal::Change(ecs::Entity e, ecs::ComponentId id, const void* before, const void* after,
+                         const char* label, uint64_t mergeKey)
+{
+    Entry& entry = OpenEntry(label, mergeKey);
+    uint32_t size = ecs::GetComponentInfo(id).size;
+    const auto* a = static_cast<const uint8_t*>(before);
+    const auto* b = static_cast<const uint8_t*>(after);
+
+    auto [it, fresh] = entry.merge.try_emplace(MergeKey(e, id), entry.data.size());
+    RawHeader h{};
+    if (!fresh) std::memcpy(&h, entry.data.data() + it->second, sizeof(h));
+    if (fresh || h.generation != e.generation) {
+        // новая запись: в ней before, ниже станет before ^ after
+        it->second = entry.data.size();
+        Append(entry, Op::Change, e, id, before);
+    } else {
+        // уже есть в открытой записи: XOR складываются, (a^b)^(b^c) = a^c
+        for (uint32_t i = 0; i < size; ++i) entry.data[it->second + sizeof(h) + i] ^= a[i];
+    }
+    uint8_t* x = entry.data.data() + it->second + sizeof(RawHeader);
+    for (uint32_t i = 0; i < size; ++i) x[i] ^= b[i];
+    if (!group_ && !mergeKey) Seal();
+}
+
+void UndoJournal::Added(ecs::Entity e, ecs::ComponentId id, const void* value, const char* label)
+{
+    Entry& entry = OpenEntry(label, 0);
+    entry.merge.erase(MergeKey(e, id)); // дальнейшие Change — уже после добавления
+    Append(entry, Op::Add, e, id, value);
+    if (!group_) Seal();
+}
+
+void UndoJournal::Removed(ecs::Entity e, ecs::ComponentId id, const void* value, const char* label)
+{
+    Entry& entry = OpenEntry(label, 0);
+    entry.merge.erase(MergeKey(e, id));
+    Append(entry, Op::Remove, e, id, value);
+    if (!group_) Seal();
+}
+
+void UndoJournal::BeginGroup(const char* label)
+{
+    if (group_ == 0) OpenEntry(label, 0);
+    ++group_;
+}
+
+void UndoJournal::EndGroup()
+{
+    assert(group_ > 0);
+    if (--group_ == 0) Seal();
+}
+
+void UndoJournal::Seal()
+{
+    if (group_ > 0 || entries_.empty() || !entries_.back().open) return;
+    Entry& entry = entries_.back();
+    Pack(entry);
+    if (entry.records == 0) { // правка ничего не изменила
+        entries_.pop_back();
+        applied_ = entries_.size();
+        return;
+    }
+    sealedBytes_ += entry.Bytes();
+    Evict();
+}
+
+void UndoJournal::Evict()
+{
+    // самые старые, но последнюю применённую правку оставляем в любом случае
+    while (sealedBytes_ > budget_ && applied_ > 1) {
+        sealedBytes_ -= entries_.front().Bytes();
+        entries_.pop_front();
+        --applied_;
+    }
+}
+
+// Открытая запись -> сжатая: XOR без крайних нулей, нулевые участки внутри — длинами
+void UndoJournal::Pack(Entry& entry)
+{
+    DC_PROFILE_ZONE("UndoJournal::Pack");
+    std::vector<uint8_t> out;
+    out.reserve(entry.data.size() / 2);
+    uint32_t records = 0;
+    uint32_t prevIndex = 0;
+    for (size_t at = 0; at < entry.data.size();) {
+        RawHeader h;
+        std::memcpy(&h, entry.data.data() + at, sizeof(h));
+        const uint8_t* v = entry.data.data() + at + sizeof(h);
+        at += sizeof(h) + h.size;
+
+        uint32_t first = 0, last = h.size;
+        if (Op(h.op) == Op::Change) {
+            while (first < h.size && v[first] == 0) ++first;
+            if (first == h.size) continue; // вернулось к исходному значению
+            while (v[last - 1] == 0) --last;
+        }
+        out.push_back(h.op);
+        PutVarint(out, h.component);
+        PutVarint(out, ZigZag(int64_t(h.index) - int64_t(prevIndex)));
+        PutVarint(out, h.generation);
+        prevIndex = h.index;
+        ++records;
+        if (Op(h.op) != Op::Change) {
+            PutVarint(out, h.size);
+            out.insert(out.end(), v, v + h.size);
+            continue;
+        }
+        PutVarint(out, first);
+        PutVarint(out, last - first);
+        // пары (нулей, литералов); литералы прерывает только нулевой участок от kMinZeroRun
+        for (uint32_t i = first; i < last;) {
+            uint32_t zeros = 0;
+            while (i + zeros < last && v[i + zeros] == 0) ++zeros;
+            uint32_t lit = zeros;
+            for (uint32_t z = 0; i + lit < last; ++lit) {
+                z = v[i + lit] == 0 ? z + 1 : 0;
+                if (z == kMinZeroRun) { lit -= kMinZeroRun - 1; break; }
+            }
+            PutVarint(out, zeros);
+            PutVarint(out, lit - zeros);
+            out.insert(out.end(), v + i + zeros, v + i + lit);
+            i += lit;
+        }
+    }
+    out.shrink_to_fit();
+    entry.data = std::move(out);
+    entry.records = records;
+    entry.merge = {};
+    entry.open = false;
+}
+
+void UndoJournal::Decode(const Entry& entry, std::vector<Record>& out)
+{
+    assert(!entry.open && "Undo/Redo seal the open entry first");
+    out.clear();
+    out.reserve(entry.records);
+    scratch_.clear();
+    const uint8_t* base = entry.data.data();
+    const uint8_t* end = base + entry.data.size();
+    uint32_t index = 0;
+    for (const uint8_t* p = base; p < end;) {
+        Record r{};
+        r.op = Op(*p++);
+        r.component = ecs::ComponentId(GetVarint(p));
+        index = uint32_t(int64_t(index) + UnZigZag(GetVarint(p)));
+        r.entity = {index, uint32_t(GetVarint(p))};
+        if (r.op != Op::Change) {
+            r.size = uint32_t(GetVarint(p));
+            r.bytes = size_t(p - base);
+            p += r.size;
+            out.push_back(r);
+            continue;
+        }
+        r.offset = uint32_t(GetVarint(p));
+        r.size = uint32_t(GetVarint(p));
+        r.bytes = scratch_.size();
+        r.scratch = true;
+        scratch_.resize(scratch_.size() + r.size);
+        uint8_t* x = scratch_.data() + r.bytes;
+        for (uint32_t i = 0; i < r.size;) {
+            uint32_t zeros = uint32_t(GetVarint(p));
+            uint32_t lit = uint32_t(GetVarint(p));
+            std::memset(x + i, 0, zeros);
+            std::memcpy(x + i + zeros, p, lit);
+            p += lit;
+            i += zeros + lit;
+        }
+        out.push_back(r);
+    }
+}
+
+void UndoJournal::Apply(ecs::World& world, const Entry& entry, bool undo)
+{
+    DC_PROFILE_ZONE("UndoJournal::Apply");
+    std::vector<Record> records;
+    Decode(entry, records);
+    for (size_t k = 0; k < records.size(); ++k) {
+        const Record& r = records[undo ? records.size() - 1 - k : k];
+        const uint8_t* bytes = (r.scratch ? scratch_.data() : entry.data.data()) + r.bytes;
+        bool add = (r.op == Op::Add) != undo;
+        switch (r.op) {
+        case Op::Change:
+            // XOR: одинаково в обе стороны. Мёртвую сущность или снятый компонент пропускаем
+            if (auto* p = static_cast<uint8_t*>(world.GetRaw(r.entity, r.component));
+                p && r.offset + r.size <= ecs::GetComponentInfo(r.component).size)
+                for (uint32_t i = 0; i < r.size; ++i) p[r.offset + i] ^= bytes[i];
+            break;
+        case Op::Add:
+        case Op::Remove:
+            if (!world.Alive(r.entity)) break;
+            if (add) world.AddRaw(r.entity, r.component, bytes);
+            else world.RemoveRaw(r.entity, r.component);
+            break;
+        }
+    }
+}
+
+bool UndoJournal::Undo(ecs::World& world)
+{
+    if (group_ > 0) return false;
+    Seal();
+    if (!CanUndo()) return false;
+    Apply(world, entries_[--applied_], true);
+    return true;
+}
+
+bool UndoJournal::Redo(ecs::World& world)
+{
+    if (group_ > 0) return false;
+    Seal();
+    if (!CanRedo()) return false;
+    Apply(world, entries_[applied_++], false);
+    return true;
+}
+
+void UndoJournal::Clear()
+{
+    entries_.clear();
+    applied_ = 0;
+    group_ = 0;
+    sealedBytes_ = 0;
+}
+
+void UndoJournal::SetBudget(size_t bytes)
+{
+    budget_ = bytes;
+    Evict();
+}
+
+} // namespace dancore::core
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Ecs.hpp"
+
+// Журнал правок для Undo/Redo. Хранит не снимки, а разницу: у изменённого компонента —
+// XOR старого и нового значения по отрезку, где они различаются, так что одна и та же
+// запись и откатывает, и повторяет правку, а стоимость — по объёму изменённых байт.
+//
+// Последняя запись открыта: изменения с тем же mergeKey (перетаскивание DragFloat3,
+// набор текста) вливаются в неё, пока её не закроют Seal(). Закрытая запись ужимается:
+// нулевые участки XOR — длинами, индексы сущностей — разностями varint. Сверх бюджета
+// памяти выбрасываются самые старые записи. Только главный поток.
+
+namespace dancore::core {
+
+class UndoJournal {
+public:
+    explicit UndoJournal(size_t budgetBytes = size_t(64) << 20);
+
+    // Значение компонента до и после правки (целиком). mergeKey != 0 и совпадает с
+    // ключом открытой записи — правка вливается в неё; 0 — отдельная запись
+    void Change(ecs::Entity e, ecs::ComponentId id, const void* before, const void* after,
+                const char* label, uint64_t mergeKey = 0);
+    template <class T>
+    void Change(ecs::Entity e, const T& before, const T& after, const char* label, uint64_t mergeKey = 0)
+    {
+        Change(e, ecs::ComponentIdOf<T>(), &before, &after, label, mergeKey);
+    }
+    // Компонент добавлен / удалён; value — его значение
+    void Added(ecs::Entity e, ecs::ComponentId id, const void* value, const char* label);
+    void Removed(ecs::Entity e, ecs::ComponentId id, const void* value, const char* label);
+
+    // Всё между BeginGroup и EndGroup — одна запись (массовая правка выделения)
+    void BeginGroup(const char* label);
+    void EndGroup();
+    // Закрыть открытую запись: следующая правка начнёт новую
+    void Seal();
+
+    // false — откатывать/повторять нечего
+    bool Undo(ecs::World& world);
+    bool Redo(ecs::World& world);
+    bool CanUndo() const { return applied_ > 0; }
+    bool CanRedo() const { return applied_ < entries_.size(); }
+    const char* UndoLabel() const { return CanUndo() ? entries_[applied_ - 1].label.c_str() : ""; }
+    const char* RedoLabel() const { return CanRedo() ? entries_[applied_].label.c_str() : ""; }
+
+    void Clear();
+    void SetBudget(size_t bytes);
+    size_t Budget() const { return budget_; }
+    size_t Bytes() const;
+    size_t Count() const { return entries_.size(); }
+
+private:
+    enum class Op : uint8_t { Change, Add, Remove };
+
+    struct Entry {
+        std::string label;
+        uint64_t key = 0;
+        bool open = true;            // data — несжатые записи полного размера
+        uint32_t records = 0;
+        std::vector<uint8_t> data;
+        std::unordered_map<uint64_t, size_t> merge; // сущность+компонент -> запись в data, пока открыта
+        size_t Bytes() const;
+    };
+    struct Record {
+        Op op;
+        ecs::Entity entity;
+        ecs::ComponentId component;
+        uint32_t offset, size;
+        size_t bytes;                // начало байт в data или в scratch
+        bool scratch;
+    };
+
+    Entry& OpenEntry(const char* label, uint64_t key);
+    void Append(Entry& entry, Op op, ecs::Entity e, ecs::ComponentId id, const void* value);
+    void Pack(Entry& entry);
+    void Decode(const Entry& entry, std::vector<Record>& out);
+    void Apply(ecs::World& world, const Entry& entry, bool undo);
+    void Evict();
+
+    std::deque<Entry> entries_;
+    size_t applied_ = 0;             // [0, applied_) применены, дальше — для Redo
+    int group_ = 0;
+    size_t budget_;
+    size_t sealedBytes_ = 0;         // закрытые записи; открытая считается в Bytes()
+    std::vector<uint8_t> scratch_;   // распакованные XOR при Apply
+};
+
+} // namespace dancore::core
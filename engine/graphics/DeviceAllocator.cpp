@@ -0,0 +1,478 @@
+#include "DeviceAllocator.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+namespace dancore::graphics {
+
+namespace {
+
+void Check(VkResult r, const char* where)
+{
+    if (r != VK_SUCCESS) throw std::runtime_error(std::string("DeviceAllocator: ") + where + " failed");
+}
+
+constexpr VkDeviceSize kMinBlock = 1ull << 20;
+
+} // namespace
+
+void DeviceAllocator::Init(const AllocatorDesc& desc)
+{
+    desc_ = desc;
+    vkGetPhysicalDeviceMemoryProperties(desc_.gpu, &memProps_);
+    pools_.clear();
+    pools_.resize(memProps_.memoryTypeCount * 2);
+    heapAllocated_.assign(memProps_.memoryHeapCount, 0);
+    frame_ = 0;
+}
+
+void DeviceAllocator::Shutdown()
+{
+    if (!desc_.device) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& r : retired_) {
+        if (r.buffer) vkDestroyBuffer(desc_.device, r.buffer, nullptr);
+        FreeLocked(r.alloc);
+    }
+    retired_.clear();
+    for (auto& m : managed_) {
+        if (!m.live) continue;
+        vkDestroyBuffer(desc_.device, m.buffer, nullptr);
+        FreeLocked(m.alloc);
+    }
+    managed_.clear(); freeManaged_.clear();
+    for (auto& pool : pools_)
+        for (auto& b : pool.blocks)
+            if (b) vkFreeMemory(desc_.device, b->memory, nullptr);
+    pools_.clear();
+    desc_ = {};
+}
+
+// Обязательные флаги + очки за желательные; куча сверх бюджета идёт последней
+uint32_t DeviceAllocator::FindMemoryType(uint32_t bits, MemoryUsage usage) const
+{
+    VkMemoryPropertyFlags required = 0, preferred = 0, avoid = 0;
+    switch (usage) {
+    case MemoryUsage::GpuOnly:
+        preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        avoid = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT; // BAR-память оставляем для Upload
+        break;
+    case MemoryUsage::Upload:
+        required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        avoid = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+        break;
+    case MemoryUsage::Readback:
+        required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        preferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+        break;
+    }
+    int bestScore = -1000;
+    uint32_t best = ~0u;
+    for (uint32_t i = 0; i < memProps_.memoryTypeCount; i++) {
+        if (!(bits & (1u << i))) continue;
+        VkMemoryPropertyFlags f = memProps_.memoryTypes[i].propertyFlags;
+        if ((f & required) != required) continue;
+        uint32_t heap = memProps_.memoryTypes[i].heapIndex;
+        int score = std::popcount(f & preferred) * 4 - std::popcount(f & avoid) * 2;
+        if (heapAllocated_[heap] >= memProps_.memoryHeaps[heap].size / 10 * 9) score -= 16;
+        if (score > bestScore) { bestScore = score; best = i; }
+    }
+    if (best == ~0u) throw std::runtime_error("DeviceAllocator: no suitable memory type");
+    return best;
+}
+
+VkDeviceSize DeviceAllocator::HeapBudget(uint32_t heap)
+{
+    if (desc_.memoryBudget) {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT};
+        VkPhysicalDeviceMemoryProperties2 props{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2};
+        props.pNext = &budget;
+        vkGetPhysicalDeviceMemoryProperties2(desc_.gpu, &props);
+        // usage включает чужие процессы и наши блоки: остаток бюджета = budget - usage
+        VkDeviceSize other = budget.heapUsage[heap] > heapAllocated_[heap] ? budget.heapUsage[heap] - heapAllocated_[heap] : 0;
+        return budget.heapBudget[heap] > other ? budget.heapBudget[heap] - other : 0;
+    }
+    return memProps_.memoryHeaps[heap].size / 10 * 8;
+}
+
+Allocation DeviceAllocator::AllocateDedicated(VkDeviceSize size, uint32_t type, VkBuffer buffer, VkImage image)
+{
+    VkMemoryDedicatedAllocateInfo di{VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO};
+    di.buffer = buffer; di.image = image;
+    VkMemoryAllocateInfo ai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    ai.pNext = (buffer || image) ? &di : nullptr;
+    ai.allocationSize = size; ai.memoryTypeIndex = type;
+    Allocation a;
+    Check(vkAllocateMemory(desc_.device, &ai, nullptr, &a.memory), "vkAllocateMemory (dedicated)");
+    a.size = size;
+    a.memoryType = type;
+    a.block = Allocation::kDedicated;
+    if (memProps_.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        Check(vkMapMemory(desc_.device, a.memory, 0, VK_WHOLE_SIZE, 0, &a.mapped), "vkMapMemory");
+    heapAllocated_[memProps_.memoryTypes[type].heapIndex] += size;
+    ++dedicatedCount_;
+    dedicatedBytes_ += size;
+    return a;
+}
+
+bool DeviceAllocator::NewBlock(uint32_t pool, VkDeviceSize minSize)
+{
+    uint32_t type = pool / 2;
+    uint32_t heap = memProps_.memoryTypes[type].heapIndex;
+    VkDeviceSize size = std::min(desc_.blockSize, std::max(memProps_.memoryHeaps[heap].size / 8, kMinBlock));
+    minSize = (minSize + kMinBlock - 1) / kMinBlock * kMinBlock;
+    size = std::max(size, minSize);
+    // под бюджет: блок поменьше, чем свалиться в подкачку драйвера
+    VkDeviceSize budget = HeapBudget(heap);
+    VkDeviceSize room = budget > heapAllocated_[heap] ? budget - heapAllocated_[heap] : 0;
+    while (size / 2 >= minSize && size > room) size /= 2;
+
+    auto block = std::make_unique<Block>();
+    for (;; size /= 2) {
+        VkMemoryAllocateInfo ai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        ai.allocationSize = size; ai.memoryTypeIndex = type;
+        if (vkAllocateMemory(desc_.device, &ai, nullptr, &block->memory) == VK_SUCCESS) break;
+        if (size / 2 < minSize) return false;
+    }
+    block->size = size;
+    block->tlsf.Init(size);
+    if (memProps_.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        Check(vkMapMemory(desc_.device, block->memory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&block->mapped)),
+              "vkMapMemory");
+    heapAllocated_[heap] += size;
+
+    auto& blocks = pools_[pool].blocks;
+    auto slot = std::find(blocks.begin(), blocks.end(), nullptr);
+    if (slot != blocks.end()) *slot = std::move(block);
+    else blocks.push_back(std::move(block));
+    return true;
+}
+
+bool DeviceAllocator::AllocateFromPool(uint32_t pool, VkDeviceSize size, VkDeviceSize align, uint32_t skipBlock, Allocation& out)
+{
+    auto& blocks = pools_[pool].blocks;
+    for (uint32_t i = 0; i < blocks.size(); ++i) {
+        Block* b = blocks[i].get();
+        if (!b || i == skipBlock || b->size - b->tlsf.UsedBytes() < size) continue;
+        uint64_t offset = 0;
+        uint32_t node = b->tlsf.Allocate(size, align, &offset);
+        if (node == Tlsf::kNull) continue;
+        out.memory = b->memory;
+        out.offset = offset;
+        out.size = size;
+        out.mapped = b->mapped ? b->mapped + offset : nullptr;
+        out.memoryType = pool / 2;
+        out.pool = pool;
+        out.block = i;
+        out.node = node;
+        return true;
+    }
+    return false;
+}
+
+Allocation DeviceAllocator::Allocate(const VkMemoryRequirements& req, MemoryUsage usage, bool optimalImage, bool dedicated,
+                                     VkBuffer dedicatedBuffer, VkImage dedicatedImage)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t type = FindMemoryType(req.memoryTypeBits, usage);
+    if (dedicated || req.size >= desc_.blockSize / 2) return AllocateDedicated(req.size, type, dedicatedBuffer, dedicatedImage);
+
+    uint32_t pool = type * 2 + (optimalImage ? 1 : 0);
+    Allocation a;
+    if (AllocateFromPool(pool, req.size, req.alignment, Allocation::kDedicated, a)) return a;
+    if (NewBlock(pool, req.size + req.alignment) && AllocateFromPool(pool, req.size, req.alignment, Allocation::kDedicated, a))
+        return a;
+    return AllocateDedicated(req.size, type, dedicatedBuffer, dedicatedImage);
+}
+
+void DeviceAllocator::FreeLocked(Allocation& a)
+{
+    if (!a) return;
+    uint32_t heap = memProps_.memoryTypes[a.memoryType].heapIndex;
+    if (a.block == Allocation::kDedicated) {
+        vkFreeMemory(desc_.device, a.memory, nullptr);
+        heapAllocated_[heap] -= a.size;
+        --dedicatedCount_;
+        dedicatedBytes_ -= a.size;
+        a = {};
+        return;
+    }
+    auto& blocks = pools_[a.pool].blocks;
+    Block& b = *blocks[a.block];
+    b.tlsf.Free(a.node);
+    // пустой блок отдаём драйверу, если в пуле есть другой: один держим про запас
+    if (b.tlsf.Empty()) {
+        bool other = std::any_of(blocks.begin(), blocks.end(), [&](const auto& p) { return p && p.get() != &b; });
+        if (other) {
+            heapAllocated_[heap] -= b.size;
+            vkFreeMemory(desc_.device, b.memory, nullptr);
+            blocks[a.block].reset();
+        }
+    }
+    a = {};
+}
+
+void DeviceAllocator::Free(Allocation& a)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    FreeLocked(a);
+}
+
+VkBuffer DeviceAllocator::CreateBuffer(const VkBufferCreateInfo& ci, MemoryUsage usage, Allocation* out)
+{
+    VkBuffer buffer{};
+    Check(vkCreateBuffer(desc_.device, &ci, nullptr, &buffer), "vkCreateBuffer");
+    VkMemoryDedicatedRequirements dr{VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS};
+    VkMemoryRequirements2 req{VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2};
+    req.pNext = &dr;
+    VkBufferMemoryRequirementsInfo2 ri{VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2};
+    ri.buffer = buffer;
+    vkGetBufferMemoryRequirements2(desc_.device, &ri, &req);
+    Allocation a;
+    try {
+        a = Allocate(req.memoryRequirements, usage, false, dr.prefersDedicatedAllocation, buffer, VK_NULL_HANDLE);
+        Check(vkBindBufferMemory(desc_.device, buffer, a.memory, a.offset), "vkBindBufferMemory");
+    } catch (...) {
+        vkDestroyBuffer(desc_.device, buffer, nullptr);
+        Free(a);
+        throw;
+    }
+    *out = a;
+    return buffer;
+}
+
+VkImage DeviceAllocator::CreateImage(const VkImageCreateInfo& ci, MemoryUsage usage, Allocation* out, bool dedicated)
+{
+    VkImage image{};
+    Check(vkCreateImage(desc_.device, &ci, nullptr, &image), "vkCreateImage");
+    VkMemoryDedicatedRequirements dr{VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS};
+    VkMemoryRequirements2 req{VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2};
+    req.pNext = &dr;
+    VkImageMemoryRequirementsInfo2 ri{VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2};
+    ri.image = image;
+    vkGetImageMemoryRequirements2(desc_.device, &ri, &req);
+    Allocation a;
+    try {
+        a = Allocate(req.memoryRequirements, usage, ci.tiling == VK_IMAGE_TILING_OPTIMAL,
+                     dedicated || dr.prefersDedicatedAllocation, VK_NULL_HANDLE, image);
+        Check(vkBindImageMemory(desc_.device, image, a.memory, a.offset), "vkBindImageMemory");
+    } catch (...) {
+        vkDestroyImage(desc_.device, image, nullptr);
+        Free(a);
+        throw;
+    }
+    *out = a;
+    return image;
+}
+
+void DeviceAllocator::DestroyBuffer(VkBuffer buffer, Allocation& a)
+{
+    if (buffer) vkDestroyBuffer(desc_.device, buffer, nullptr);
+    Free(a);
+}
+
+void DeviceAllocator::DestroyImage(VkImage image, Allocation& a)
+{
+    if (image) vkDestroyImage(desc_.device, image, nullptr);
+    Free(a);
+}
+
+BufferHandle DeviceAllocator::CreateManagedBuffer(const VkBufferCreateInfo& ci)
+{
+    Managed m;
+    m.info = ci;
+    m.info.pNext = nullptr;
+    m.info.usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT; // для переноса копией
+    m.buffer = CreateBuffer(m.info, MemoryUsage::GpuOnly, &m.alloc);
+    m.live = true;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t index;
+    if (!freeManaged_.empty()) {
+        index = freeManaged_.back();
+        freeManaged_.pop_back();
+        managed_[index] = m;
+    } else {
+        index = (uint32_t)managed_.size();
+        managed_.push_back(m);
+    }
+    return {index};
+}
+
+VkBuffer DeviceAllocator::Get(BufferHandle h) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return h && h.index < managed_.size() && managed_[h.index].live ? managed_[h.index].buffer : VK_NULL_HANDLE;
+}
+
+uint32_t DeviceAllocator::Version(BufferHandle h) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return h && h.index < managed_.size() ? managed_[h.index].version : 0;
+}
+
+void DeviceAllocator::DestroyManagedBuffer(BufferHandle h)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!h || h.index >= managed_.size() || !managed_[h.index].live) return;
+    Managed& m = managed_[h.index];
+    retired_.push_back({m.buffer, m.alloc, frame_});
+    m = Managed{};
+    freeManaged_.push_back(h.index);
+}
+
+void DeviceAllocator::BeginFrame(uint64_t frameNumber)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame_ = frameNumber;
+    std::erase_if(retired_, [&](Retired& r) {
+        if (frame_ < r.frame + desc_.framesInFlight) return false;
+        if (r.buffer) vkDestroyBuffer(desc_.device, r.buffer, nullptr);
+        FreeLocked(r.alloc);
+        return true;
+    });
+}
+
+VkDeviceSize DeviceAllocator::DefragStep(VkCommandBuffer cmd, VkDeviceSize maxBytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (managed_.empty()) return 0;
+    DC_PROFILE_ZONE("DeviceAllocator::DefragStep");
+    VkDeviceSize moved = 0;
+    bool barrier = false;
+    for (uint32_t p = 0; p < pools_.size() && moved < maxBytes; ++p) {
+        auto& blocks = pools_[p].blocks;
+        // источник — самый пустой из непустых блоков; имеет смысл, только если блоков больше одного
+        uint32_t src = Allocation::kDedicated, live = 0;
+        for (uint32_t i = 0; i < blocks.size(); ++i) {
+            if (!blocks[i]) continue;
+            ++live;
+            if (!blocks[i]->tlsf.Empty() &&
+                (src == Allocation::kDedicated || blocks[i]->tlsf.UsedBytes() < blocks[src]->tlsf.UsedBytes()))
+                src = i;
+        }
+        if (live < 2 || src == Allocation::kDedicated) continue;
+
+        for (Managed& m : managed_) {
+            if (moved >= maxBytes) break;
+            if (!m.live || m.alloc.pool != p || m.alloc.block != src) continue;
+            VkMemoryRequirements req{};
+            vkGetBufferMemoryRequirements(desc_.device, m.buffer, &req);
+            Allocation dst;
+            if (!AllocateFromPool(p, req.size, req.alignment, src, dst)) continue;
+            VkBuffer buffer{};
+            if (vkCreateBuffer(desc_.device, &m.info, nullptr, &buffer) != VK_SUCCESS) { FreeLocked(dst); continue; }
+            if (vkBindBufferMemory(desc_.device, buffer, dst.memory, dst.offset) != VK_SUCCESS) {
+                vkDestroyBuffer(desc_.device, buffer, nullptr);
+                FreeLocked(dst);
+                continue;
+            }
+            if (!barrier) {
+                // прошлые записи в буферы должны закончиться до чтения копией
+                VkMemoryBarrier mb{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+                mb.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT; mb.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+                vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                     0, 1, &mb, 0, nullptr, 0, nullptr);
+                barrier = true;
+            }
+            VkBufferCopy region{0, 0, m.info.size};
+            vkCmdCopyBuffer(cmd, m.buffer, buffer, 1, &region);
+            // старое место освободится, когда кадры, видевшие старый VkBuffer, завершатся
+            retired_.push_back({m.buffer, m.alloc, frame_});
+            m.buffer = buffer;
+            m.alloc = dst;
+            ++m.version;
+            moved += m.info.size;
+        }
+    }
+    if (barrier) {
+        VkMemoryBarrier mb{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        mb.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        mb.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0, 1, &mb, 0, nullptr, 0, nullptr);
+    }
+    defragMoved_ += moved;
+    return moved;
+}
+
+MemoryStats DeviceAllocator::Stats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    MemoryStats s;
+    s.budgetExtension = desc_.memoryBudget;
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT};
+    if (desc_.memoryBudget) {
+        VkPhysicalDeviceMemoryProperties2 props{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2};
+        props.pNext = &budget;
+        vkGetPhysicalDeviceMemoryProperties2(desc_.gpu, &props);
+    }
+    for (uint32_t i = 0; i < memProps_.memoryHeapCount; ++i) {
+        MemoryStats::Heap h;
+        h.size = memProps_.memoryHeaps[i].size;
+        h.deviceLocal = memProps_.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+        h.allocated = heapAllocated_[i];
+        h.budget = desc_.memoryBudget ? budget.heapBudget[i] : h.size / 10 * 8;
+        h.usage = desc_.memoryBudget ? budget.heapUsage[i] : h.allocated;
+        s.heaps.push_back(h);
+    }
+    for (const auto& pool : pools_)
+        for (const auto& b : pool.blocks) {
+            if (!b) continue;
+            ++s.blocks;
+            s.blockBytes += b->size;
+            s.usedBytes += b->tlsf.UsedBytes();
+            s.largestFree = std::max<uint64_t>(s.largestFree, b->tlsf.LargestFree());
+            s.allocations += b->tlsf.Allocations();
+        }
+    s.dedicated = dedicatedCount_;
+    s.dedicatedBytes = dedicatedBytes_;
+    s.vkAllocations = s.blocks + s.dedicated;
+    s.defragMovedBytes = defragMoved_;
+    return s;
+}
+
+// ---- FrameArena ----
+
+void FrameArena::Init(DeviceAllocator& allocator, uint32_t frames, VkDeviceSize bytesPerFrame, VkBufferUsageFlags usage)
+{
+    allocator_ = &allocator;
+    capacity_ = bytesPerFrame;
+    frames_.resize(frames);
+    for (auto& f : frames_) {
+        VkBufferCreateInfo ci{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+        ci.size = bytesPerFrame; ci.usage = usage; ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        f.buffer = allocator.CreateBuffer(ci, MemoryUsage::Upload, &f.alloc);
+    }
+    current_ = 0;
+    head_ = peak_ = 0;
+    overflows_ = 0;
+}
+
+void FrameArena::Shutdown()
+{
+    for (auto& f : frames_) allocator_->DestroyBuffer(f.buffer, f.alloc);
+    frames_.clear();
+}
+
+void FrameArena::Begin(uint32_t slot)
+{
+    current_ = slot;
+    head_ = 0;
+}
+
+FrameArena::Slice FrameArena::Allocate(VkDeviceSize size, VkDeviceSize align)
+{
+    Frame& f = frames_[current_];
+    VkDeviceSize offset = (head_ + align - 1) / align * align;
+    if (offset + size > capacity_) { ++overflows_; return {}; }
+    head_ = offset + size;
+    peak_ = std::max(peak_, head_);
+    return {f.buffer, offset, static_cast<unsigned char*>(f.alloc.mapped) + offset};
+}
+
+} // namespace dancore::graphics
@@ -0,0 +1,163 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "MemoryStats.hpp"
+#include "Tlsf.hpp"
+
+// Суб-аллокатор VkDeviceMemory: крупные блоки на тип памяти режутся TLSF, буферы и
+// optimal-образы живут в разных блоках (bufferImageGranularity не нужен). Крупные ресурсы
+// и то, что драйвер просит выделять отдельно (рендер-таргеты), получают свою VkDeviceMemory.
+// Размер новых блоков ограничивается бюджетом кучи (VK_EXT_memory_budget, если включён).
+// Перемещаемые буферы (CreateManagedBuffer) дефрагментируются по шагу за кадр.
+// Потокобезопасно; FrameArena — только главный поток.
+
+namespace dancore::graphics {
+
+enum class MemoryUsage {
+    GpuOnly,   // DEVICE_LOCAL
+    Upload,    // HOST_VISIBLE | HOST_COHERENT, постоянно отображена; предпочтительно DEVICE_LOCAL (ReBAR)
+    Readback,  // HOST_VISIBLE | HOST_CACHED
+};
+
+struct Allocation {
+    static constexpr uint32_t kDedicated = ~0u;
+
+    VkDeviceMemory memory{};
+    VkDeviceSize offset = 0, size = 0;
+    void* mapped = nullptr;          // для host-visible типов
+    uint32_t memoryType = 0;
+    uint32_t pool = 0;               // memoryType * 2 + (optimal-образ ? 1 : 0)
+    uint32_t block = kDedicated;
+    uint32_t node = 0;
+
+    explicit operator bool() const { return memory != VK_NULL_HANDLE; }
+};
+
+struct AllocatorDesc {
+    VkPhysicalDevice gpu{};
+    VkDevice device{};
+    bool memoryBudget = false;            // VK_EXT_memory_budget включён на устройстве
+    VkDeviceSize blockSize = 64ull << 20;
+    uint32_t framesInFlight = 2;          // сколько кадров держать отложенные освобождения
+};
+
+struct BufferHandle {
+    uint32_t index = ~0u;
+    explicit operator bool() const { return index != ~0u; }
+};
+
+class DeviceAllocator {
+public:
+    void Init(const AllocatorDesc& desc);
+    void Shutdown();
+
+    // optimalImage: ресурс — образ с VK_IMAGE_TILING_OPTIMAL; бросает std::runtime_error, если памяти нет
+    Allocation Allocate(const VkMemoryRequirements& req, MemoryUsage usage, bool optimalImage, bool dedicated = false,
+                        VkBuffer dedicatedBuffer = VK_NULL_HANDLE, VkImage dedicatedImage = VK_NULL_HANDLE);
+    void Free(Allocation& a);
+
+    VkBuffer CreateBuffer(const VkBufferCreateInfo& ci, MemoryUsage usage, Allocation* out);
+    VkImage CreateImage(const VkImageCreateInfo& ci, MemoryUsage usage, Allocation* out, bool dedicated = false);
+    void DestroyBuffer(VkBuffer buffer, Allocation& a);
+    void DestroyImage(VkImage image, Allocation& a);
+
+    // GpuOnly-буфер, который дефрагментация может перенести: VkBuffer брать через Get()
+    // каждый кадр; Version() растёт при каждом переносе (пора обновить дескрипторы).
+    // Удаление отложено на framesInFlight кадров.
+    BufferHandle CreateManagedBuffer(const VkBufferCreateInfo& ci);
+    VkBuffer Get(BufferHandle h) const;
+    uint32_t Version(BufferHandle h) const;
+    void DestroyManagedBuffer(BufferHandle h);
+
+    // После ожидания fence кадра: освобождает то, что больше не может использоваться GPU
+    void BeginFrame(uint64_t frameNumber);
+    // Переносит до maxBytes перемещаемых буферов из самого пустого блока в остальные,
+    // копии пишутся в cmd графической очереди вне render pass. Возвращает перенесённые байты.
+    VkDeviceSize DefragStep(VkCommandBuffer cmd, VkDeviceSize maxBytes);
+
+    MemoryStats Stats();
+    VkDevice Device() const { return desc_.device; }
+
+private:
+    struct Block {
+        VkDeviceMemory memory{};
+        VkDeviceSize size = 0;
+        unsigned char* mapped = nullptr;
+        Tlsf tlsf;
+    };
+    struct Pool {
+        std::vector<std::unique_ptr<Block>> blocks; // nullptr — освобождённый слот
+    };
+    struct Managed {
+        VkBufferCreateInfo info{};
+        VkBuffer buffer{};
+        Allocation alloc;
+        uint32_t version = 0;
+        bool live = false;
+    };
+    struct Retired {
+        VkBuffer buffer{};
+        Allocation alloc;
+        uint64_t frame = 0;
+    };
+
+    uint32_t FindMemoryType(uint32_t bits, MemoryUsage usage) const;
+    Allocation AllocateDedicated(VkDeviceSize size, uint32_t type, VkBuffer buffer, VkImage image);
+    bool AllocateFromPool(uint32_t pool, VkDeviceSize size, VkDeviceSize align, uint32_t skipBlock, Allocation& out);
+    bool NewBlock(uint32_t pool, VkDeviceSize minSize);
+    void FreeLocked(Allocation& a);
+    VkDeviceSize HeapBudget(uint32_t heap);
+
+    AllocatorDesc desc_{};
+    VkPhysicalDeviceMemoryProperties memProps_{};
+    mutable std::mutex mutex_;
+    std::vector<Pool> pools_;
+    std::vector<VkDeviceSize> heapAllocated_;
+    std::vector<Managed> managed_;
+    std::vector<uint32_t> freeManaged_;
+    std::vector<Retired> retired_;
+    uint64_t frame_ = 0;
+    uint32_t dedicatedCount_ = 0;
+    VkDeviceSize dedicatedBytes_ = 0;
+    VkDeviceSize defragMoved_ = 0;
+};
+
+// Линейная арена на кадр в полёте для временных uniform/vertex-данных:
+// один host-visible буфер на слот, выделение — сдвиг указателя, сброс — в Begin().
+class FrameArena {
+public:
+    struct Slice {
+        VkBuffer buffer{};
+        VkDeviceSize offset = 0;
+        void* data = nullptr;
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    void Init(DeviceAllocator& allocator, uint32_t frames, VkDeviceSize bytesPerFrame, VkBufferUsageFlags usage);
+    void Shutdown();
+
+    void Begin(uint32_t slot); // после ожидания fence этого слота
+    // Пустой Slice при переполнении: вызывающий решает, рисовать ли без данных
+    Slice Allocate(VkDeviceSize size, VkDeviceSize align = 256);
+
+    VkDeviceSize Capacity() const { return capacity_; }
+    VkDeviceSize Peak() const { return peak_; }
+    uint32_t Overflows() const { return overflows_; }
+
+private:
+    struct Frame {
+        VkBuffer buffer{};
+        Allocation alloc;
+    };
+    DeviceAllocator* allocator_ = nullptr;
+    std::vector<Frame> frames_;
+    uint32_t current_ = 0;
+    VkDeviceSize head_ = 0, capacity_ = 0, peak_ = 0;
+    uint32_t overflows_ = 0;
+};
+
+} // namespace dancore::graphics
@@ -0,0 +1,102 @@
+#include "GpuProfiler.hpp"
+
+#include <algorithm>
+
+namespace dancore::graphics {
+
+void GpuProfiler::Init(VkPhysicalDevice gpu, VkDevice dev, uint32_t queueFamily, uint32_t framesInFlight, uint32_t maxZones)
+{
+    dev_ = dev;
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(gpu, &props);
+    uint32_t qn = 0; vkGetPhysicalDeviceQueueFamilyProperties(gpu, &qn, nullptr);
+    std::vector<VkQueueFamilyProperties> qp(qn); vkGetPhysicalDeviceQueueFamilyProperties(gpu, &qn, qp.data());
+    uint32_t bits = queueFamily < qn ? qp[queueFamily].timestampValidBits : 0;
+    validMask_ = bits >= 64 ? ~0ull : (bits ? (1ull << bits) - 1 : 0);
+    period_ = props.limits.timestampPeriod;
+    if (!validMask_) return;
+
+    maxQueries_ = maxZones * 2;
+    results_.resize(maxQueries_);
+    slots_.resize(framesInFlight);
+    for (auto& s : slots_) {
+        VkQueryPoolCreateInfo qi{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+        qi.queryType = VK_QUERY_TYPE_TIMESTAMP; qi.queryCount = maxQueries_;
+        if (vkCreateQueryPool(dev_, &qi, nullptr, &s.pool) != VK_SUCCESS) { Shutdown(); validMask_ = 0; return; }
+        s.zones.reserve(maxZones);
+    }
+}
+
+void GpuProfiler::Shutdown()
+{
+    for (auto& s : slots_) if (s.pool) vkDestroyQueryPool(dev_, s.pool, nullptr);
+    slots_.clear();
+}
+
+double GpuProfiler::Collect(uint32_t slot)
+{
+    if (!Supported() || slot >= slots_.size()) return -1.0;
+    Slot& s = slots_[slot];
+    if (!s.pending || !s.used) return -1.0;
+    s.pending = false;
+    if (vkGetQueryPoolResults(dev_, s.pool, 0, s.used, s.used * sizeof(uint64_t), results_.data(),
+                              sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+        return -1.0;
+
+    uint64_t origin = results_[s.zones.front().begin];
+    double rootMs = -1.0;
+    for (const auto& z : s.zones) {
+        if (z.end == UINT32_MAX) continue; // зона не закрыта до конца кадра
+        uint64_t b = (results_[z.begin] - origin) & validMask_;
+        uint64_t e = (results_[z.end] - origin) & validMask_;
+        auto toNs = [&](uint64_t ticks) { return (core::profiler::Clock)(ticks * period_); };
+        core::profiler::ReportGpuZone(z.name, s.submitted + toNs(b), s.submitted + toNs(std::max(b, e)), z.depth);
+        if (z.depth == 0 && rootMs < 0.0) rootMs = double(e - b) * period_ * 1e-6;
+    }
+    if (rootMs >= 0.0) core::profiler::ReportGpuFrameTime(rootMs);
+    return rootMs;
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer cmd, uint32_t slot)
+{
+    if (!Supported()) return;
+    current_ = slot;
+    Slot& s = slots_[slot];
+    s.zones.clear(); s.used = 0; s.pending = false;
+    open_.clear();
+    vkCmdResetQueryPool(cmd, s.pool, 0, maxQueries_);
+}
+
+void GpuProfiler::BeginZone(VkCommandBuffer cmd, const char* name, VkPipelineStageFlagBits stage)
+{
+    if (!Supported()) return;
+    Slot& s = slots_[current_];
+    // конец пары резервируется вместе с началом; без места зона пропускается целиком
+    if (s.used + 2 > maxQueries_) { open_.push_back(UINT32_MAX); return; }
+    uint32_t q = s.used; s.used += 2;
+    open_.push_back((uint32_t)s.zones.size());
+    s.zones.push_back(Zone{name, q, UINT32_MAX, (uint32_t)open_.size() - 1});
+    vkCmdWriteTimestamp(cmd, stage, s.pool, q);
+}
+
+void GpuProfiler::EndZone(VkCommandBuffer cmd, VkPipelineStageFlagBits stage)
+{
+    if (!Supported() || open_.empty()) return;
+    uint32_t zi = open_.back();
+    open_.pop_back();
+    if (zi == UINT32_MAX) return;
+    Slot& s = slots_[current_];
+    Zone& z = s.zones[zi];
+    z.end = z.begin + 1;
+    vkCmdWriteTimestamp(cmd, stage, s.pool, z.end);
+}
+
+void GpuProfiler::MarkSubmitted()
+{
+    if (!Supported()) return;
+    Slot& s = slots_[current_];
+    s.submitted = core::profiler::Now();
+    s.pending = true;
+}
+
+} // namespace dancore::graphics
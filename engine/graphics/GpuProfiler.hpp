@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "core/Profiler.hpp"
+
+// GPU-зоны на vkCmdWriteTimestamp: свой query pool на каждый кадр в полёте.
+// Результаты слота читаются только после ожидания его fence, без VK_QUERY_RESULT_WAIT_BIT,
+// и уходят в core::profiler на CPU-шкале (якорь — момент vkQueueSubmit этого кадра).
+
+namespace dancore::graphics {
+
+class GpuProfiler {
+public:
+    void Init(VkPhysicalDevice gpu, VkDevice dev, uint32_t queueFamily, uint32_t framesInFlight, uint32_t maxZones = 32);
+    void Shutdown();
+
+    // Сразу после ожидания fence слота. Возвращает длительность корневой зоны в мс или -1.
+    double Collect(uint32_t slot);
+
+    void BeginFrame(VkCommandBuffer cmd, uint32_t slot);
+    void BeginZone(VkCommandBuffer cmd, const char* name, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    void EndZone(VkCommandBuffer cmd, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    void MarkSubmitted();
+
+    bool Supported() const { return validMask_ != 0; }
+
+private:
+    struct Zone { const char* name; uint32_t begin, end, depth; };
+    struct Slot {
+        VkQueryPool pool{};
+        std::vector<Zone> zones;
+        uint32_t used = 0;
+        core::profiler::Clock submitted = 0;
+        bool pending = false;
+    };
+
+    VkDevice dev_{};
+    std::vector<Slot> slots_;
+    std::vector<uint64_t> results_;
+    std::vector<uint32_t> open_;
+    uint32_t maxQueries_ = 0;
+    uint32_t current_ = 0;
+    uint64_t validMask_ = 0;
+    double period_ = 1.0; // нс на тик
+};
+
+} // namespace dancore::graphics
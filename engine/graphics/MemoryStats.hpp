@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Снимок состояния аллокатора видеопамяти для панели редактора (без Vulkan-типов).
+
+namespace dancore::graphics {
+
+struct MemoryStats {
+    struct Heap {
+        uint64_t size = 0;
+        uint64_t budget = 0;     // VK_EXT_memory_budget, иначе оценка 80% размера
+        uint64_t usage = 0;      // всего процессом по данным драйвера (или наши блоки)
+        uint64_t allocated = 0;  // наши блоки + выделенные целиком
+        bool deviceLocal = false;
+    };
+    std::vector<Heap> heaps;
+    bool budgetExtension = false;
+
+    uint32_t blocks = 0;           // крупные VkDeviceMemory под суб-аллокации
+    uint64_t blockBytes = 0;
+    uint64_t usedBytes = 0;        // занято внутри блоков
+    uint64_t largestFree = 0;
+    uint32_t allocations = 0;      // суб-аллокации
+    uint32_t dedicated = 0;        // отдельные VkDeviceMemory (рендер-таргеты)
+    uint64_t dedicatedBytes = 0;
+    uint32_t vkAllocations = 0;    // живые vkAllocateMemory всего
+
+    uint64_t arenaBytes = 0;       // линейные арены кадра: ёмкость одного кадра
+    uint64_t arenaPeak = 0;        // максимум за кадр
+    uint32_t arenaOverflows = 0;
+
+    uint64_t defragMovedBytes = 0; // перенесено дефрагментацией за всё время
+
+    uint32_t transientImages = 0;  // временные образы графа кадра
+    uint64_t transientBytes = 0;   // их сумма по отдельности
+    uint64_t transientHeapBytes = 0; // сколько они заняли с aliasing
+
+    // 1 - largestFree / free: 0 — всё свободное место одним куском
+    float Fragmentation() const
+    {
+        uint64_t free = blockBytes - usedBytes;
+        return free ? 1.0f - float(double(largestFree) / double(free)) : 0.0f;
+    }
+};
+
+} // namespace dancore::graphics
@@ -0,0 +1,162 @@
+#include "PipelineCache.hpp"
+#include "core/Hash.hpp"
+#include "core/Profiler.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace dancore::graphics {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint32_t kMagic = 0x43504344; // "DCPC"
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+    uint32_t magic = kMagic;
+    uint32_t version = kVersion;
+    uint32_t vendorID = 0, deviceID = 0, driverVersion = 0;
+    uint8_t uuid[VK_UUID_SIZE]{};
+    uint64_t dataSize = 0;
+    uint64_t dataHash = 0;
+};
+
+bool SameDevice(const FileHeader& h, const VkPhysicalDeviceProperties& p)
+{
+    return h.magic == kMagic && h.version == kVersion && h.vendorID == p.vendorID && h.deviceID == p.deviceID &&
+           h.driverVersion == p.driverVersion && !std::memcmp(h.uuid, p.pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+} // namespace
+
+bool PipelineCache::Init(VkPhysicalDevice gpu, VkDevice device, const fs::path& dir)
+{
+    DC_PROFILE_ZONE("PipelineCache::Init");
+    device_ = device;
+    vkGetPhysicalDeviceProperties(gpu, &props_);
+    uint64_t key = core::Hash64(props_.pipelineCacheUUID, VK_UUID_SIZE);
+    key = core::HashCombine(key, (uint64_t(props_.vendorID) << 32) | props_.deviceID);
+    key = core::HashCombine(key, props_.driverVersion);
+    char name[40];
+    std::snprintf(name, sizeof(name), "pipelines-%016llx.bin", (unsigned long long)key);
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    file_ = dir / name;
+
+    std::vector<char> data;
+    std::ifstream f(file_, std::ios::binary);
+    FileHeader h;
+    if (f.read(reinterpret_cast<char*>(&h), sizeof(h)) && SameDevice(h, props_) && h.dataSize < (1ull << 31)) {
+        data.resize(h.dataSize);
+        if (!f.read(data.data(), (std::streamsize)data.size()) || core::Hash64(data.data(), data.size()) != h.dataHash)
+            data.clear();
+    }
+
+    VkPipelineCacheCreateInfo ci{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    ci.initialDataSize = data.size();
+    ci.pInitialData = data.empty() ? nullptr : data.data();
+    if (vkCreatePipelineCache(device_, &ci, nullptr, &cache_) != VK_SUCCESS) {
+        // драйвер всё же отверг данные: начинаем с пустого кэша
+        ci.initialDataSize = 0; ci.pInitialData = nullptr;
+        data.clear();
+        if (vkCreatePipelineCache(device_, &ci, nullptr, &cache_) != VK_SUCCESS)
+            throw std::runtime_error("PipelineCache: vkCreatePipelineCache failed");
+    }
+    loaded_ = data.size();
+    return loaded_ != 0;
+}
+
+void PipelineCache::Save()
+{
+    if (!cache_) return;
+    DC_PROFILE_ZONE("PipelineCache::Save");
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device_, cache_, &size, nullptr) != VK_SUCCESS || !size) return;
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(device_, cache_, &size, data.data()) != VK_SUCCESS) return;
+    data.resize(size);
+
+    FileHeader h;
+    h.vendorID = props_.vendorID; h.deviceID = props_.deviceID; h.driverVersion = props_.driverVersion;
+    std::memcpy(h.uuid, props_.pipelineCacheUUID, VK_UUID_SIZE);
+    h.dataSize = data.size();
+    h.dataHash = core::Hash64(data.data(), data.size());
+
+    fs::path tmp = file_;
+    tmp += ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        f.write(data.data(), (std::streamsize)data.size());
+        if (!f) return;
+    }
+    std::error_code ec;
+    fs::rename(tmp, file_, ec); // упавший посреди записи процесс оставит только .tmp
+}
+
+void PipelineCache::Shutdown()
+{
+    if (!cache_) return;
+    Save();
+    vkDestroyPipelineCache(device_, cache_, nullptr);
+    cache_ = VK_NULL_HANDLE;
+}
+
+// ---- PipelineCompiler ----
+
+void PipelineCompiler::Init(VkDevice device, VkPipelineCache cache)
+{
+    device_ = device;
+    cache_ = cache;
+}
+
+void PipelineCompiler::Shutdown()
+{
+    core::jobs::Wait(pending_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& e : entries_)
+        if (VkPipeline p = e.pipeline.load(std::memory_order_acquire)) vkDestroyPipeline(device_, p, nullptr);
+    entries_.clear();
+}
+
+PipelineHandle PipelineCompiler::Request(Build build, VkPipeline fallback)
+{
+    Entry* e;
+    uint32_t index;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        index = (uint32_t)entries_.size();
+        e = &entries_.emplace_back();
+        e->fallback = fallback;
+    }
+    // VkPipelineCache внутренне синхронизирован: воркеры пишут в него одновременно
+    core::jobs::Run([this, e, build = std::move(build)] {
+        DC_PROFILE_ZONE("CompilePipeline");
+        e->pipeline.store(build(device_, cache_), std::memory_order_release);
+        e->done.store(true, std::memory_order_release);
+    }, &pending_);
+    return {index};
+}
+
+VkPipeline PipelineCompiler::Get(PipelineHandle h) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!h || h.index >= entries_.size()) return VK_NULL_HANDLE;
+    const Entry& e = entries_[h.index];
+    VkPipeline p = e.pipeline.load(std::memory_order_acquire);
+    return p ? p : e.fallback;
+}
+
+bool PipelineCompiler::Ready(PipelineHandle h) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return h && h.index < entries_.size() && entries_[h.index].done.load(std::memory_order_acquire);
+}
+
+} // namespace dancore::graphics
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <vulkan/vulkan.h>
+
+#include "core/JobSystem.hpp"
+
+// VkPipelineCache на диске: файл на устройство (имя — хэш pipelineCacheUUID, vendor/device ID
+// и версии драйвера), загружается после создания устройства, сохраняется при выходе.
+// Свой заголовок с размером и хэшем данных: битый или чужой файл молча игнорируется,
+// а не уходит в драйвер. Запись — во временный файл и rename.
+//
+// PipelineCompiler собирает пайплайны в задачах job system через этот кэш; пока пайплайн
+// не готов, Get() отдаёт запасной (например, однотонный), кадр не ждёт компиляции.
+
+namespace dancore::graphics {
+
+class PipelineCache {
+public:
+    // dir — каталог кэша; true, если данные с диска подошли этому драйверу
+    bool Init(VkPhysicalDevice gpu, VkDevice device, const std::filesystem::path& dir);
+    void Save();
+    void Shutdown(); // Save() + уничтожение
+
+    VkPipelineCache Handle() const { return cache_; }
+    size_t LoadedBytes() const { return loaded_; }
+
+private:
+    VkDevice device_{};
+    VkPipelineCache cache_{};
+    std::filesystem::path file_;
+    VkPhysicalDeviceProperties props_{};
+    size_t loaded_ = 0;
+};
+
+struct PipelineHandle {
+    uint32_t index = ~0u;
+    explicit operator bool() const { return index != ~0u; }
+};
+
+class PipelineCompiler {
+public:
+    // Выполняется на воркере; VK_NULL_HANDLE — ошибка (остаётся запасной пайплайн)
+    using Build = std::function<VkPipeline(VkDevice, VkPipelineCache)>;
+
+    void Init(VkDevice device, VkPipelineCache cache);
+    void Shutdown(); // ждёт незавершённые сборки и уничтожает готовые пайплайны
+
+    // fallback не принадлежит компилятору и должен жить, пока используется Get()
+    PipelineHandle Request(Build build, VkPipeline fallback);
+    VkPipeline Get(PipelineHandle h) const;
+    bool Ready(PipelineHandle h) const;
+    uint32_t Pending() const { return (uint32_t)pending_.value.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        std::atomic<VkPipeline> pipeline{VK_NULL_HANDLE};
+        VkPipeline fallback{};
+        std::atomic<bool> done{false};
+    };
+
+    VkDevice device_{};
+    VkPipelineCache cache_{};
+    mutable std::mutex mutex_;
+    std::deque<Entry> entries_; // deque: адреса стабильны, пока задачи пишут в них
+    core::jobs::JobCounter pending_;
+};
+
+} // namespace dancore::graphics
@@ -0,0 +1,670 @@
+#include "RenderGraph.hpp"
+#include "GpuProfiler.hpp"
+#include "core/Hash.hpp"
+#include "core/JobSystem.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+namespace dancore::graphics {
+
+namespace {
+
+void Check(VkResult r, const char* where)
+{
+    if (r != VK_SUCCESS) throw std::runtime_error(std::string("RenderGraph: ") + where + " failed");
+}
+
+VkImageAspectFlags Aspect(VkFormat format)
+{
+    switch (format) {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    case VK_FORMAT_S8_UINT:
+        return VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+constexpr VkAccessFlags kWriteAccess = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                       VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+constexpr uint64_t kFramebufferFrames = 64; // сколько кадров держать неиспользуемый framebuffer
+
+VkDeviceSize AlignUp(VkDeviceSize v, VkDeviceSize a) { return (v + a - 1) / a * a; }
+
+} // namespace
+
+// ---------------- объявление кадра ----------------
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Color(RGImage image, VkAttachmentLoadOp load, VkClearColorValue clear)
+{
+    Access a{image.index, Use::Color, load};
+    a.clear.color = clear;
+    a.stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    graph_.passes_[pass_].accesses.push_back(a);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Depth(RGImage image, VkAttachmentLoadOp load, float clear)
+{
+    Access a{image.index, Use::Depth, load};
+    a.clear.depthStencil = {clear, 0};
+    a.stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    graph_.passes_[pass_].accesses.push_back(a);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Sample(RGImage image, VkPipelineStageFlags stages)
+{
+    Access a{image.index, Use::Sample};
+    a.stages = stages;
+    graph_.passes_[pass_].accesses.push_back(a);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::CopySource(RGImage image)
+{
+    Access a{image.index, Use::CopySource};
+    a.stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    graph_.passes_[pass_].accesses.push_back(a);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::CopyDestination(RGImage image)
+{
+    Access a{image.index, Use::CopyDestination, VK_ATTACHMENT_LOAD_OP_DONT_CARE};
+    a.stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    graph_.passes_[pass_].accesses.push_back(a);
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::SideEffect()
+{
+    graph_.passes_[pass_].sideEffect = true;
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Record(RecordFn fn)
+{
+    graph_.passes_[pass_].record = std::move(fn);
+    return *this;
+}
+
+VkImage RGPassContext::Image(RGImage image) const
+{
+    const auto& r = graph->resources_[image.index];
+    return r.imported ? r.image : graph->heap_.images[r.physical].image;
+}
+
+VkImageView RGPassContext::View(RGImage image) const
+{
+    const auto& r = graph->resources_[image.index];
+    return r.imported ? r.view : graph->heap_.images[r.physical].view;
+}
+
+void RenderGraph::Init(const RenderGraphDesc& desc)
+{
+    desc_ = desc;
+    pools_.assign(desc_.framesInFlight, {});
+}
+
+void RenderGraph::Shutdown()
+{
+    if (!desc_.device) return;
+    DestroyHeap(heap_);
+    for (auto& h : retired_) DestroyHeap(h);
+    retired_.clear();
+    for (auto& [key, fb] : framebuffers_) vkDestroyFramebuffer(desc_.device, fb.framebuffer, nullptr);
+    framebuffers_.clear();
+    for (auto& [key, rp] : renderPasses_) vkDestroyRenderPass(desc_.device, rp, nullptr);
+    renderPasses_.clear();
+    for (auto& slot : pools_)
+        for (auto& p : slot) vkDestroyCommandPool(desc_.device, p.pool, nullptr);
+    pools_.clear();
+    desc_ = {};
+}
+
+void RenderGraph::Begin(uint64_t frameNumber, uint32_t slot)
+{
+    frame_ = frameNumber;
+    slot_ = slot;
+    passes_.clear();
+    resources_.clear();
+    order_.clear();
+    stats_ = {};
+
+    // слот дождался своего fence: кадры до frameNumber - framesInFlight завершены
+    std::erase_if(retired_, [&](Heap& h) {
+        if (h.frame + desc_.framesInFlight > frameNumber) return false;
+        DestroyHeap(h);
+        return true;
+    });
+    // framebuffer'ы образов swapchain используются через кадр-другой: держим с запасом
+    std::erase_if(framebuffers_, [&](auto& kv) {
+        if (kv.second.lastUsed + std::max<uint64_t>(desc_.framesInFlight, kFramebufferFrames) >= frameNumber) return false;
+        vkDestroyFramebuffer(desc_.device, kv.second.framebuffer, nullptr);
+        return true;
+    });
+
+    auto& pools = pools_[slot];
+    pools.resize(core::jobs::WorkerCount() + 1);
+    for (auto& p : pools) {
+        if (!p.pool) {
+            VkCommandPoolCreateInfo ci{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+            ci.queueFamilyIndex = desc_.queueFamily;
+            ci.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            Check(vkCreateCommandPool(desc_.device, &ci, nullptr, &p.pool), "vkCreateCommandPool");
+        } else if (p.used) {
+            Check(vkResetCommandPool(desc_.device, p.pool, 0), "vkResetCommandPool");
+        }
+        p.used = 0;
+    }
+}
+
+RGImage RenderGraph::Create(const char* name, const RGImageDesc& desc)
+{
+    Resource r;
+    r.name = name;
+    r.desc = desc;
+    resources_.push_back(r);
+    return {uint32_t(resources_.size() - 1)};
+}
+
+RGImage RenderGraph::Import(const char* name, VkImage image, VkImageView view, const RGImageDesc& desc,
+                            RGImageState* state, VkImageLayout finalLayout)
+{
+    Resource r;
+    r.name = name;
+    r.desc = desc;
+    r.imported = true;
+    r.image = image;
+    r.view = view;
+    r.state = state;
+    r.finalLayout = finalLayout;
+    resources_.push_back(r);
+    return {uint32_t(resources_.size() - 1)};
+}
+
+RenderGraph::PassBuilder RenderGraph::AddPass(const char* name)
+{
+    passes_.emplace_back();
+    passes_.back().name = name;
+    return PassBuilder(*this, uint32_t(passes_.size() - 1));
+}
+
+// ---------------- компиляция ----------------
+
+// С конца кадра: проход жив, если пишет то, что кому-то нужно дальше. Запись без LOAD
+// закрывает потребность (раньше писать незачем), чтение её открывает.
+void RenderGraph::Cull()
+{
+    auto writes = [](const Access& a) {
+        return a.use == Use::Color || a.use == Use::Depth || a.use == Use::CopyDestination;
+    };
+    auto reads = [](const Access& a) {
+        return a.use == Use::Sample || a.use == Use::CopySource ||
+               ((a.use == Use::Color || a.use == Use::Depth) && a.load == VK_ATTACHMENT_LOAD_OP_LOAD);
+    };
+    for (auto& r : resources_) r.needed = r.imported && r.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+    for (size_t i = passes_.size(); i-- > 0;) {
+        Pass& p = passes_[i];
+        p.live = p.sideEffect;
+        for (const Access& a : p.accesses)
+            if (writes(a) && resources_[a.image].needed) p.live = true;
+        if (!p.live) { ++stats_.culled; continue; }
+        for (Access& a : p.accesses) {
+            if (!writes(a)) continue;
+            a.store = resources_[a.image].needed;
+            if (!reads(a)) resources_[a.image].needed = false;
+        }
+        for (const Access& a : p.accesses)
+            if (reads(a)) resources_[a.image].needed = true;
+    }
+    for (uint32_t i = 0; i < passes_.size(); ++i)
+        if (passes_[i].live) order_.push_back(i);
+}
+
+// Временные образы: набор (формат, размер, использование, время жизни) тот же — память та же
+void RenderGraph::Place()
+{
+    std::vector<uint32_t> transients;
+    uint64_t key = 0x9E3779B97F4A7C15ull;
+    for (uint32_t i = 0; i < resources_.size(); ++i) {
+        const Resource& r = resources_[i];
+        if (r.imported || r.first == ~0u) continue;
+        transients.push_back(i);
+        const uint64_t v[5] = {uint64_t(r.desc.format), uint64_t(r.desc.extent.width) << 32 | r.desc.extent.height,
+                               r.usage, r.first, r.last};
+        key = core::HashCombine(key, core::Hash64(v, sizeof(v)));
+    }
+    if (key != heap_.key || heap_.images.size() != transients.size()) {
+        if (!heap_.images.empty()) {
+            heap_.frame = frame_;
+            retired_.push_back(std::move(heap_));
+        }
+        heap_ = {};
+        BuildHeap(key, transients);
+    }
+    stats_.transients = uint32_t(transients.size());
+    for (uint32_t k = 0; k < transients.size(); ++k) {
+        resources_[transients[k]].physical = k;
+        stats_.transientBytes += heap_.images[k].size;
+    }
+    for (const Allocation& a : heap_.memory) stats_.heapBytes += a.size;
+}
+
+// Жадная укладка интервалов: крупные образы первыми, каждый — на наименьшее смещение,
+// не пересекающееся с уже уложенными образами, чьи времена жизни пересекаются с его
+void RenderGraph::BuildHeap(uint64_t key, const std::vector<uint32_t>& transients)
+{
+    DC_PROFILE_ZONE("RenderGraph::BuildHeap");
+    VkDevice dev = desc_.device;
+    heap_.key = key;
+    heap_.memory.resize(1);
+    const size_t n = transients.size();
+    heap_.images.resize(n);
+    std::vector<VkMemoryRequirements> reqs(n);
+    for (size_t k = 0; k < n; ++k) {
+        const Resource& r = resources_[transients[k]];
+        Physical& ph = heap_.images[k];
+        ph.desc = r.desc;
+        ph.usage = r.usage;
+        VkImageCreateInfo ci{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+        ci.imageType = VK_IMAGE_TYPE_2D;
+        ci.format = r.desc.format;
+        ci.extent = {r.desc.extent.width, r.desc.extent.height, 1};
+        ci.mipLevels = 1;
+        ci.arrayLayers = 1;
+        ci.samples = VK_SAMPLE_COUNT_1_BIT;
+        ci.tiling = VK_IMAGE_TILING_OPTIMAL;
+        ci.usage = r.usage;
+        ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        Check(vkCreateImage(dev, &ci, nullptr, &ph.image), "vkCreateImage");
+        vkGetImageMemoryRequirements(dev, ph.image, &reqs[k]);
+        ph.size = reqs[k].size;
+    }
+
+    std::vector<uint32_t> bySize(n);
+    for (uint32_t k = 0; k < n; ++k) bySize[k] = k;
+    std::stable_sort(bySize.begin(), bySize.end(), [&](uint32_t a, uint32_t b) { return reqs[a].size > reqs[b].size; });
+    uint32_t typeBits = ~0u;
+    VkDeviceSize total = 0, align = 1;
+    std::vector<uint32_t> placed;
+    std::vector<std::pair<VkDeviceSize, VkDeviceSize>> busy;
+    for (uint32_t k : bySize) {
+        Physical& ph = heap_.images[k];
+        const Resource& r = resources_[transients[k]];
+        if (!(typeBits & reqs[k].memoryTypeBits)) {
+            // несовместимый тип памяти: свой блок, без aliasing
+            ph.heap = uint32_t(heap_.memory.size());
+            heap_.memory.push_back(desc_.memory->Allocate(reqs[k], MemoryUsage::GpuOnly, true, true, VK_NULL_HANDLE, ph.image));
+            continue;
+        }
+        typeBits &= reqs[k].memoryTypeBits;
+        align = std::max(align, reqs[k].alignment);
+        busy.clear();
+        for (uint32_t j : placed) {
+            const Resource& o = resources_[transients[j]];
+            if (o.last < r.first || r.last < o.first) continue;
+            busy.emplace_back(heap_.images[j].offset, heap_.images[j].offset + heap_.images[j].size);
+        }
+        std::sort(busy.begin(), busy.end());
+        VkDeviceSize offset = 0;
+        for (auto [begin, end] : busy) {
+            if (offset + ph.size <= begin) break;
+            if (end > offset) offset = AlignUp(end, reqs[k].alignment);
+        }
+        ph.offset = offset;
+        total = std::max(total, offset + ph.size);
+        placed.push_back(k);
+    }
+    if (total) {
+        VkMemoryRequirements req{total, align, typeBits};
+        heap_.memory[0] = desc_.memory->Allocate(req, MemoryUsage::GpuOnly, true, true);
+    }
+
+    for (Physical& ph : heap_.images) {
+        const Allocation& a = heap_.memory[ph.heap];
+        Check(vkBindImageMemory(dev, ph.image, a.memory, a.offset + ph.offset), "vkBindImageMemory");
+        VkImageViewCreateInfo vi{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+        vi.image = ph.image;
+        vi.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        vi.format = ph.desc.format;
+        vi.subresourceRange = {Aspect(ph.desc.format), 0, 1, 0, 1};
+        Check(vkCreateImageView(dev, &vi, nullptr, &ph.view), "vkCreateImageView");
+    }
+}
+
+void RenderGraph::DestroyHeap(Heap& heap)
+{
+    for (Physical& ph : heap.images) {
+        if (ph.view) {
+            ReleaseView(ph.view);
+            vkDestroyImageView(desc_.device, ph.view, nullptr);
+        }
+        if (ph.image) vkDestroyImage(desc_.device, ph.image, nullptr);
+    }
+    for (Allocation& a : heap.memory)
+        if (a) desc_.memory->Free(a);
+    heap = {};
+}
+
+void RenderGraph::ReleaseView(VkImageView view)
+{
+    std::erase_if(framebuffers_, [&](auto& kv) {
+        if (std::find(kv.second.views.begin(), kv.second.views.end(), view) == kv.second.views.end()) return false;
+        vkDestroyFramebuffer(desc_.device, kv.second.framebuffer, nullptr);
+        return true;
+    });
+}
+
+// ---------------- render pass'ы ----------------
+
+VkRenderPass RenderGraph::GetRenderPass(const Pass& pass)
+{
+    std::vector<VkAttachmentDescription> atts;
+    std::vector<VkAttachmentReference> colors;
+    VkAttachmentReference depth{VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED};
+    uint64_t key = 0;
+    for (const Access& a : pass.accesses) {
+        if (a.use != Use::Color && a.use != Use::Depth) continue;
+        VkAttachmentDescription d{};
+        d.format = resources_[a.image].desc.format;
+        d.samples = VK_SAMPLE_COUNT_1_BIT;
+        d.loadOp = a.load;
+        d.storeOp = a.store ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        d.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        d.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        d.initialLayout = d.finalLayout = a.use == Use::Color ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+                                                              : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        if (a.use == Use::Color) colors.push_back({uint32_t(atts.size()), d.initialLayout});
+        else depth = {uint32_t(atts.size()), d.initialLayout};
+        const uint64_t v[4] = {uint64_t(d.format), uint64_t(d.loadOp), uint64_t(d.storeOp), uint64_t(a.use)};
+        key = core::HashCombine(key, core::Hash64(v, sizeof(v)));
+        atts.push_back(d);
+    }
+    auto it = renderPasses_.find(key);
+    if (it != renderPasses_.end()) return it->second;
+
+    VkSubpassDescription sub{};
+    sub.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    sub.colorAttachmentCount = uint32_t(colors.size());
+    sub.pColorAttachments = colors.data();
+    if (depth.attachment != VK_ATTACHMENT_UNUSED) sub.pDepthStencilAttachment = &depth;
+    VkRenderPassCreateInfo ci{VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
+    ci.attachmentCount = uint32_t(atts.size());
+    ci.pAttachments = atts.data();
+    ci.subpassCount = 1;
+    ci.pSubpasses = &sub;
+    VkRenderPass rp{};
+    Check(vkCreateRenderPass(desc_.device, &ci, nullptr, &rp), "vkCreateRenderPass");
+    renderPasses_.emplace(key, rp);
+    return rp;
+}
+
+VkFramebuffer RenderGraph::GetFramebuffer(VkRenderPass renderPass, const std::vector<VkImageView>& views, VkExtent2D extent)
+{
+    uint64_t key = core::Hash64(views.data(), views.size() * sizeof(VkImageView), uint64_t(uintptr_t(renderPass)));
+    key = core::HashCombine(key, uint64_t(extent.width) << 32 | extent.height);
+    Framebuffer& fb = framebuffers_[key];
+    fb.lastUsed = frame_;
+    if (fb.framebuffer) return fb.framebuffer;
+    VkFramebufferCreateInfo ci{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
+    ci.renderPass = renderPass;
+    ci.attachmentCount = uint32_t(views.size());
+    ci.pAttachments = views.data();
+    ci.width = extent.width;
+    ci.height = extent.height;
+    ci.layers = 1;
+    Check(vkCreateFramebuffer(desc_.device, &ci, nullptr, &fb.framebuffer), "vkCreateFramebuffer");
+    fb.views = views;
+    return fb.framebuffer;
+}
+
+void RenderGraph::PrepareRenderPass(Pass& pass)
+{
+    std::vector<VkImageView> views;
+    pass.clears.clear();
+    RGPassContext ctx;
+    ctx.graph = this;
+    for (const Access& a : pass.accesses) {
+        if (a.use != Use::Color && a.use != Use::Depth) continue;
+        if (views.empty()) pass.extent = resources_[a.image].desc.extent;
+        views.push_back(ctx.View({a.image}));
+        pass.clears.push_back(a.clear);
+    }
+    if (views.empty()) return;
+    pass.renderPass = GetRenderPass(pass);
+    pass.framebuffer = GetFramebuffer(pass.renderPass, views, pass.extent);
+}
+
+// ---------------- запись ----------------
+
+RGImageState& RenderGraph::State(Resource& r)
+{
+    return r.imported ? *r.state : heap_.images[r.physical].state;
+}
+
+void RenderGraph::Barriers(VkCommandBuffer cmd, const Pass& pass)
+{
+    VkPipelineStageFlags src = 0, dst = 0;
+    VkImageMemoryBarrier barriers[16];
+    uint32_t count = 0;
+    const uint32_t index = uint32_t(&pass - passes_.data());
+    for (const Access& a : pass.accesses) {
+        Resource& r = resources_[a.image];
+        VkImageLayout layout{};
+        VkAccessFlags access = 0;
+        switch (a.use) {
+        case Use::Color:
+            layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                     (a.load == VK_ATTACHMENT_LOAD_OP_LOAD ? VK_ACCESS_COLOR_ATTACHMENT_READ_BIT : 0);
+            break;
+        case Use::Depth:
+            layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                     (a.load == VK_ATTACHMENT_LOAD_OP_LOAD ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT : 0);
+            break;
+        case Use::Sample:
+            layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            access = VK_ACCESS_SHADER_READ_BIT;
+            break;
+        case Use::CopySource:
+            layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            access = VK_ACCESS_TRANSFER_READ_BIT;
+            break;
+        case Use::CopyDestination:
+            layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            access = VK_ACCESS_TRANSFER_WRITE_BIT;
+            break;
+        }
+        const bool write = access & kWriteAccess;
+        const bool discard = write && a.load != VK_ATTACHMENT_LOAD_OP_LOAD;
+        RGImageState& st = State(r);
+
+        VkImageMemoryBarrier b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+        b.srcQueueFamilyIndex = b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.image = RGPassContext{VK_NULL_HANDLE, {}, this}.Image({a.image});
+        b.subresourceRange = {Aspect(r.desc.format), 0, 1, 0, 1};
+        b.newLayout = layout;
+        b.dstAccessMask = access;
+        bool emit = false;
+        if (!r.imported && r.first == index) {
+            // первое использование в кадре: после всех, кто занимал эту память, содержимое не нужно
+            const Physical& me = heap_.images[r.physical];
+            VkPipelineStageFlags stages = 0;
+            VkAccessFlags writes = 0;
+            for (const Physical& o : heap_.images) {
+                if (o.heap != me.heap || o.offset >= me.offset + me.size || me.offset >= o.offset + o.size) continue;
+                stages |= o.state.stages;
+                writes |= o.state.writes;
+            }
+            src |= stages;
+            b.srcAccessMask = writes;
+            b.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            emit = true;
+            st = {layout, a.stages, write ? (access & kWriteAccess) : 0, write ? 0u : a.stages};
+        } else if (st.layout != layout || write) {
+            src |= st.stages;
+            b.srcAccessMask = st.writes;
+            b.oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : st.layout;
+            emit = true;
+            if (write) st = {layout, a.stages, access & kWriteAccess, 0};
+            else st = {layout, st.stages | a.stages, st.writes, a.stages}; // стадия записи остаётся для srcAccess
+        } else {
+            // чтение в той же раскладке: барьер, только если запись ещё не видна этой стадии
+            if (st.writes && (st.visible & a.stages) != a.stages) {
+                src |= st.stages;
+                b.srcAccessMask = st.writes;
+                b.oldLayout = layout;
+                emit = true;
+                st.visible |= a.stages;
+            }
+            st.stages |= a.stages;
+        }
+        if (!emit) continue;
+        dst |= a.stages;
+        if (count == std::size(barriers)) {
+            vkCmdPipelineBarrier(cmd, src, dst, 0, 0, nullptr, 0, nullptr, count, barriers);
+            ++stats_.barriers;
+            count = 0;
+        }
+        barriers[count++] = b;
+        ++stats_.imageBarriers;
+    }
+    if (!count) return;
+    vkCmdPipelineBarrier(cmd, src ? src : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dst, 0, 0, nullptr, 0, nullptr, count, barriers);
+    ++stats_.barriers;
+}
+
+void RenderGraph::RecordPass(Pass& pass)
+{
+    int thread = std::max(core::jobs::ThreadIndex(), 0);
+    CommandPool& pool = pools_[slot_][thread];
+    if (pool.used == pool.buffers.size()) {
+        VkCommandBufferAllocateInfo ai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        ai.commandPool = pool.pool;
+        ai.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        ai.commandBufferCount = 1;
+        VkCommandBuffer cmd{};
+        Check(vkAllocateCommandBuffers(desc_.device, &ai, &cmd), "vkAllocateCommandBuffers");
+        pool.buffers.push_back(cmd);
+    }
+    VkCommandBuffer cmd = pool.buffers[pool.used++];
+    VkCommandBufferInheritanceInfo inherit{VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+    inherit.renderPass = pass.renderPass;
+    inherit.framebuffer = pass.framebuffer;
+    VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+               (pass.renderPass ? VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT : 0);
+    bi.pInheritanceInfo = &inherit;
+    Check(vkBeginCommandBuffer(cmd, &bi), "vkBeginCommandBuffer");
+    RGPassContext ctx;
+    ctx.cmd = cmd;
+    ctx.extent = pass.extent;
+    ctx.graph = this;
+    pass.record(ctx);
+    Check(vkEndCommandBuffer(cmd), "vkEndCommandBuffer");
+    pass.secondary = cmd;
+}
+
+void RenderGraph::Execute(VkCommandBuffer primary, GpuProfiler* profiler)
+{
+    DC_PROFILE_ZONE("RenderGraph::Execute");
+    stats_.passes = uint32_t(passes_.size());
+    Cull();
+    for (uint32_t pos = 0; pos < order_.size(); ++pos) {
+        for (const Access& a : passes_[order_[pos]].accesses) {
+            Resource& r = resources_[a.image];
+            r.first = std::min(r.first, order_[pos]);
+            r.last = order_[pos];
+            switch (a.use) {
+            case Use::Color: r.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; break;
+            case Use::Depth: r.usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT; break;
+            case Use::Sample: r.usage |= VK_IMAGE_USAGE_SAMPLED_BIT; break;
+            case Use::CopySource: r.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT; break;
+            case Use::CopyDestination: r.usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT; break;
+            }
+        }
+    }
+    Place();
+    for (uint32_t i : order_) PrepareRenderPass(passes_[i]);
+
+    // вторичные буферы: проходы независимы при записи, порядок и синхронизация — в первичном
+    std::vector<uint32_t> recorded;
+    for (uint32_t i : order_)
+        if (passes_[i].record) recorded.push_back(i);
+    std::atomic<uint64_t> threads{0};
+    auto record = [&](size_t begin, size_t end) {
+        DC_PROFILE_ZONE("RenderGraph::Record");
+        threads.fetch_or(1ull << (std::max(core::jobs::ThreadIndex(), 0) & 63), std::memory_order_relaxed);
+        for (size_t k = begin; k < end; ++k) RecordPass(passes_[recorded[k]]);
+    };
+    if (desc_.parallel && recorded.size() > 1) core::jobs::ParallelFor(0, recorded.size(), 1, record);
+    else if (!recorded.empty()) record(0, recorded.size());
+    stats_.threads = uint32_t(std::popcount(threads.load()));
+
+    for (uint32_t i : order_) {
+        Pass& p = passes_[i];
+        Barriers(primary, p);
+        if (profiler) profiler->BeginZone(primary, p.name);
+        if (p.renderPass) {
+            VkRenderPassBeginInfo rp{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+            rp.renderPass = p.renderPass;
+            rp.framebuffer = p.framebuffer;
+            rp.renderArea.extent = p.extent;
+            rp.clearValueCount = uint32_t(p.clears.size());
+            rp.pClearValues = p.clears.data();
+            vkCmdBeginRenderPass(primary, &rp, p.secondary ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                                                           : VK_SUBPASS_CONTENTS_INLINE);
+        }
+        if (p.secondary) vkCmdExecuteCommands(primary, 1, &p.secondary);
+        if (p.renderPass) vkCmdEndRenderPass(primary);
+        if (profiler) profiler->EndZone(primary);
+    }
+
+    // выходы кадра — в раскладку, которую ждёт потребитель (present, копия на CPU)
+    VkImageMemoryBarrier finals[8];
+    uint32_t count = 0;
+    VkPipelineStageFlags src = 0;
+    auto flush = [&] {
+        vkCmdPipelineBarrier(primary, src ? src : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0, 0, nullptr, 0, nullptr, count, finals);
+        ++stats_.barriers;
+        stats_.imageBarriers += count;
+        count = 0;
+        src = 0;
+    };
+    for (Resource& r : resources_) {
+        if (!r.imported || r.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || r.state->layout == r.finalLayout) continue;
+        if (count == std::size(finals)) flush(); // выходов больше, чем влезает: пачками, как в Barriers
+        VkImageMemoryBarrier& b = finals[count++];
+        b = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+        b.srcQueueFamilyIndex = b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.image = r.image;
+        b.subresourceRange = {Aspect(r.desc.format), 0, 1, 0, 1};
+        b.oldLayout = r.state->layout;
+        b.newLayout = r.finalLayout;
+        b.srcAccessMask = r.state->writes;
+        src |= r.state->stages;
+        // следующее использование ждёт ALL_COMMANDS: так оно упорядочено и после этого перехода
+        *r.state = {r.finalLayout, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0};
+    }
+    if (count) flush();
+}
+
+} // namespace dancore::graphics
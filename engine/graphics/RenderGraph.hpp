@@ -0,0 +1,210 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "DeviceAllocator.hpp"
+
+// Граф кадра. Проходы объявляют, какие образы пишут и читают, остальное делает граф:
+//  - отбрасывает проходы, чей результат никто не читает (корни — выходы кадра и SideEffect);
+//  - ставит барьеры: один vkCmdPipelineBarrier перед проходом, переход раскладки только когда
+//    он нужен, чтение после чтения без барьера, содержимое под CLEAR не сохраняется;
+//  - кладёт временные образы в одну VkDeviceMemory: образы с непересекающимися временами
+//    жизни делят память, первое использование — из UNDEFINED после всех, кто жил на этом месте;
+//  - пишет проходы во вторичные буферы команд параллельно (jobs::ParallelFor), первичный
+//    буфер только собирает барьеры, render pass'ы и vkCmdExecuteCommands.
+// Раскладки меняют только барьеры графа: у его VkRenderPass начальная и конечная раскладка
+// совпадают с раскладкой подпрохода. Размещение пересобирается, только когда меняется набор
+// временных образов (размер viewport'а, новые проходы). Всё, кроме Record-функций, — главный поток.
+
+namespace dancore::graphics {
+
+class GpuProfiler;
+
+struct RGImage {
+    uint32_t index = ~0u;
+    explicit operator bool() const { return index != ~0u; }
+};
+
+struct RGImageDesc {
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkExtent2D extent{};
+};
+
+// Состояние образа между проходами и кадрами. Для импортированных образов его хранит владелец
+struct RGImageState {
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkPipelineStageFlags stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT; // последняя запись и чтения после неё
+    VkAccessFlags writes = 0;                                        // запись, ещё не видимая читателям
+    VkPipelineStageFlags visible = 0;                                // стадии, которым она уже видима
+};
+
+class RenderGraph;
+
+// Что видит Record-функция прохода (вызывается на любом потоке job system)
+struct RGPassContext {
+    VkCommandBuffer cmd{};
+    VkExtent2D extent{};            // область render pass'а; у проходов без вложений — 0x0
+    const RenderGraph* graph = nullptr;
+
+    VkImage Image(RGImage image) const;
+    VkImageView View(RGImage image) const;
+};
+
+struct RenderGraphDesc {
+    VkDevice device{};
+    DeviceAllocator* memory = nullptr;
+    uint32_t queueFamily = 0;
+    uint32_t framesInFlight = 2;
+    bool parallel = true;           // false: все проходы пишет главный поток
+};
+
+struct RenderGraphStats {
+    uint32_t passes = 0;            // объявлено за кадр
+    uint32_t culled = 0;
+    uint32_t barriers = 0;          // вызовов vkCmdPipelineBarrier
+    uint32_t imageBarriers = 0;
+    uint32_t threads = 0;           // потоков записывали проходы
+    uint32_t transients = 0;
+    VkDeviceSize transientBytes = 0; // сумма размеров временных образов
+    VkDeviceSize heapBytes = 0;      // сколько они заняли с aliasing
+};
+
+class RenderGraph {
+public:
+    using RecordFn = std::function<void(const RGPassContext&)>;
+
+    class PassBuilder {
+    public:
+        // load: CLEAR/DONT_CARE — прежнее содержимое не нужно, LOAD — проход его читает
+        PassBuilder& Color(RGImage image, VkAttachmentLoadOp load, VkClearColorValue clear = {});
+        PassBuilder& Depth(RGImage image, VkAttachmentLoadOp load, float clear = 1.0f);
+        PassBuilder& Sample(RGImage image, VkPipelineStageFlags stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        PassBuilder& CopySource(RGImage image);
+        PassBuilder& CopyDestination(RGImage image); // образ перезаписывается целиком
+        PassBuilder& SideEffect();                   // не отсекать (запись вне графа)
+        PassBuilder& Record(RecordFn fn);
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, uint32_t pass) : graph_(graph), pass_(pass) {}
+        RenderGraph& graph_;
+        uint32_t pass_;
+    };
+
+    RenderGraph() = default;
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    void Init(const RenderGraphDesc& desc);
+    void Shutdown(); // после vkDeviceWaitIdle
+
+    // Новый кадр, после ожидания fence слота: его пулы команд сбрасываются
+    void Begin(uint64_t frameNumber, uint32_t slot);
+    RGImage Create(const char* name, const RGImageDesc& desc);
+    // finalLayout != UNDEFINED: выход кадра (корень отсечения), после графа образ в этой раскладке
+    RGImage Import(const char* name, VkImage image, VkImageView view, const RGImageDesc& desc, RGImageState* state,
+                   VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+    // name — строковый литерал: он же имя зоны GPU-профайлера
+    PassBuilder AddPass(const char* name);
+    // Отсечение, размещение, запись проходов и сборка первичного буфера
+    void Execute(VkCommandBuffer primary, GpuProfiler* profiler = nullptr);
+
+    // Владелец импортированного образа уничтожает view: framebuffer'ы с ним больше не нужны
+    void ReleaseView(VkImageView view);
+
+    const RenderGraphStats& Stats() const { return stats_; }
+
+private:
+    friend struct RGPassContext;
+
+    enum class Use : uint8_t { Color, Depth, Sample, CopySource, CopyDestination };
+    struct Access {
+        uint32_t image;
+        Use use;
+        VkAttachmentLoadOp load = VK_ATTACHMENT_LOAD_OP_LOAD;
+        VkClearValue clear{};
+        VkPipelineStageFlags stages = 0;
+        bool store = true;            // содержимое нужно после прохода (решает отсечение)
+    };
+    struct Pass {
+        const char* name = nullptr;
+        std::vector<Access> accesses;
+        RecordFn record;
+        bool sideEffect = false;
+        bool live = false;
+        // заполняет Execute
+        VkRenderPass renderPass{};
+        VkFramebuffer framebuffer{};
+        VkExtent2D extent{};
+        std::vector<VkClearValue> clears;
+        VkCommandBuffer secondary{};
+    };
+    struct Resource {
+        const char* name = nullptr;
+        RGImageDesc desc;
+        bool imported = false;
+        VkImage image{};
+        VkImageView view{};
+        RGImageState* state = nullptr;      // импортированный: состояние владельца
+        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageUsageFlags usage = 0;
+        uint32_t first = ~0u, last = 0;     // живые проходы, использующие образ
+        uint32_t physical = ~0u;            // временный: индекс в heap_.images
+        bool needed = false;
+    };
+    // Временный образ в общей памяти; state — последнее использование на этом месте
+    struct Physical {
+        RGImageDesc desc;
+        VkImageUsageFlags usage = 0;
+        VkImage image{};
+        VkImageView view{};
+        VkDeviceSize offset = 0, size = 0;
+        uint32_t heap = 0;                  // 0 — общая память, иначе своя (несовместимые типы)
+        RGImageState state;
+    };
+    struct Heap {
+        uint64_t key = 0;
+        std::vector<Physical> images;
+        std::vector<Allocation> memory;     // [0] — общая
+        uint64_t frame = 0;                 // кадр, после которого можно уничтожить
+    };
+    struct Framebuffer {
+        VkFramebuffer framebuffer{};
+        std::vector<VkImageView> views;
+        uint64_t lastUsed = 0;
+    };
+    struct CommandPool {
+        VkCommandPool pool{};
+        std::vector<VkCommandBuffer> buffers;
+        uint32_t used = 0;
+    };
+
+    void Cull();
+    void Place();
+    void BuildHeap(uint64_t key, const std::vector<uint32_t>& transients);
+    void DestroyHeap(Heap& heap);
+    void PrepareRenderPass(Pass& pass);
+    VkRenderPass GetRenderPass(const Pass& pass);
+    VkFramebuffer GetFramebuffer(VkRenderPass renderPass, const std::vector<VkImageView>& views, VkExtent2D extent);
+    void RecordPass(Pass& pass);
+    void Barriers(VkCommandBuffer cmd, const Pass& pass);
+    RGImageState& State(Resource& r);
+
+    RenderGraphDesc desc_{};
+    std::vector<Pass> passes_;
+    std::vector<Resource> resources_;
+    std::vector<uint32_t> order_;           // живые проходы по порядку
+    Heap heap_;
+    std::vector<Heap> retired_;
+    std::unordered_map<uint64_t, VkRenderPass> renderPasses_;
+    std::unordered_map<uint64_t, Framebuffer> framebuffers_;
+    std::vector<std::vector<CommandPool>> pools_; // [слот][поток]
+    uint64_t frame_ = 0;
+    uint32_t slot_ = 0;
+    RenderGraphStats stats_;
+};
+
+} // namespace dancore::graphics
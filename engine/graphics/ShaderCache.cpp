@@ -0,0 +1,163 @@
+#include "ShaderCache.hpp"
+#include "core/Hash.hpp"
+#include "core/Profiler.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+namespace dancore::graphics {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Меняется при смене флагов компиляции: старые .spv просто перестают совпадать
+constexpr const char* kCompilerTag = "dxc-spirv-1";
+
+bool ReadFile(const fs::path& path, std::string& out)
+{
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    out = std::move(ss).str();
+    return true;
+}
+
+// Хэш файла и всех #include "..." (рекурсивно, каждый файл один раз)
+bool HashSources(const fs::path& path, uint64_t& h, std::unordered_set<std::string>& seen, std::string* log)
+{
+    std::string canonical = fs::weakly_canonical(path).string();
+    if (!seen.insert(canonical).second) return true;
+    std::string text;
+    if (!ReadFile(path, text)) {
+        if (log) *log = "cannot read " + path.string();
+        return false;
+    }
+    h = core::HashCombine(h, core::Hash64(text));
+    size_t pos = 0;
+    while ((pos = text.find("#include", pos)) != std::string::npos) {
+        pos += 8;
+        size_t open = text.find_first_not_of(" \t", pos);
+        if (open == std::string::npos || text[open] != '"') continue;
+        size_t close = text.find('"', open + 1);
+        if (close == std::string::npos) break;
+        // системные <...> и ненайденные файлы ключ не меняют: их разрешит (или отвергнет) dxc
+        fs::path inc = path.parent_path() / text.substr(open + 1, close - open - 1);
+        if (fs::exists(inc) && !HashSources(inc, h, seen, log)) return false;
+        pos = close;
+    }
+    return true;
+}
+
+const char* Profile(ShaderStage s)
+{
+    switch (s) {
+    case ShaderStage::Vertex: return "vs_6_0";
+    case ShaderStage::Pixel:  return "ps_6_0";
+    default:                  return "cs_6_0";
+    }
+}
+
+std::string Quote(const std::string& s) { return "\"" + s + "\""; }
+
+} // namespace
+
+void ShaderCache::Init(const fs::path& dir, std::string compiler)
+{
+    dir_ = dir;
+    compiler_ = std::move(compiler);
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+}
+
+uint64_t ShaderCache::Key(const ShaderSource& src, std::string* log) const
+{
+    uint64_t h = core::Hash64(kCompilerTag);
+    std::unordered_set<std::string> seen;
+    if (!HashSources(src.path, h, seen, log)) return 0;
+    h = core::HashCombine(h, core::Hash64(src.entry));
+    h = core::HashCombine(h, uint64_t(src.stage));
+    for (const auto& d : src.defines) h = core::HashCombine(h, core::Hash64(d));
+    return h ? h : 1; // 0 — признак ошибки
+}
+
+bool ShaderCache::Compile(const ShaderSource& src, const fs::path& out, std::string* log) const
+{
+    fs::path err = out;
+    err += ".log";
+    std::string cmd = Quote(compiler_) + " -spirv -fspv-target-env=vulkan1.2 -T " + Profile(src.stage) +
+                      " -E " + Quote(src.entry) + " -I " + Quote(src.path.parent_path().string());
+    for (const auto& d : src.defines) cmd += " -D " + Quote(d);
+    cmd += " -Fo " + Quote(out.string()) + " " + Quote(src.path.string()) + " 2> " + Quote(err.string());
+    int rc = std::system(cmd.c_str());
+    if (log) ReadFile(err, *log);
+    std::error_code ec;
+    fs::remove(err, ec);
+    if (rc != 0) {
+        fs::remove(out, ec); // dxc может оставить обрезанный файл
+        return false;
+    }
+    return true;
+}
+
+std::vector<uint32_t> ShaderCache::Get(const ShaderSource& src, std::string* log)
+{
+    DC_PROFILE_ZONE("ShaderCache::Get");
+    uint64_t key = Key(src, log);
+    if (!key) return {};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = memory_.find(key);
+        if (it != memory_.end()) { hits_.fetch_add(1, std::memory_order_relaxed); return it->second; }
+    }
+
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx.spv", (unsigned long long)key);
+    fs::path file = dir_ / name;
+    std::string bytes;
+    bool cached = ReadFile(file, bytes) && !bytes.empty() && bytes.size() % 4 == 0;
+    if (cached) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        // компиляция во временный файл и rename: параллельный Get того же ключа не прочитает половину
+        fs::path tmp = file;
+        tmp += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+        if (!Compile(src, tmp, log)) return {};
+        std::error_code ec;
+        fs::rename(tmp, file, ec);
+        if (ec || !ReadFile(file, bytes) || bytes.empty() || bytes.size() % 4) {
+            if (log) *log += "\ncannot read compiled " + file.string();
+            return {};
+        }
+    }
+
+    std::vector<uint32_t> spirv(bytes.size() / 4);
+    std::memcpy(spirv.data(), bytes.data(), bytes.size());
+    std::lock_guard<std::mutex> lock(mutex_);
+    memory_[key] = spirv;
+    return spirv;
+}
+
+VkShaderModule ShaderCache::CreateModule(VkDevice device, const ShaderSource& src, std::string* log)
+{
+    std::vector<uint32_t> spirv = Get(src, log);
+    if (spirv.empty()) return VK_NULL_HANDLE;
+    VkShaderModuleCreateInfo ci{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+    ci.codeSize = spirv.size() * 4;
+    ci.pCode = spirv.data();
+    VkShaderModule module{};
+    if (vkCreateShaderModule(device, &ci, nullptr, &module) != VK_SUCCESS) {
+        if (log) *log = "vkCreateShaderModule failed for " + src.path.string();
+        return VK_NULL_HANDLE;
+    }
+    return module;
+}
+
+} // namespace dancore::graphics
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Кэш SPIR-V по содержимому: ключ — хэш текста шейдера вместе со всеми #include "...",
+// точки входа, стадии, дефайнов и версии компилятора. Попадание — чтение <dir>/<ключ>.spv,
+// промах — компиляция HLSL через dxc (-spirv) и запись результата. Неизменённые шейдеры
+// не перекомпилируются между запусками. Потокобезопасно: компилировать можно из задач.
+
+namespace dancore::graphics {
+
+enum class ShaderStage : uint8_t { Vertex, Pixel, Compute };
+
+struct ShaderSource {
+    std::filesystem::path path;       // HLSL-файл; каталог файла — корень для #include
+    std::string entry = "main";
+    ShaderStage stage = ShaderStage::Vertex;
+    std::vector<std::string> defines; // "NAME" или "NAME=VALUE"
+};
+
+class ShaderCache {
+public:
+    // compiler: исполняемый dxc (ищется в PATH, если без пути)
+    void Init(const std::filesystem::path& dir, std::string compiler = "dxc");
+
+    // Пустой вектор при ошибке; текст ошибки компилятора — в log
+    std::vector<uint32_t> Get(const ShaderSource& src, std::string* log = nullptr);
+    // VK_NULL_HANDLE при ошибке
+    VkShaderModule CreateModule(VkDevice device, const ShaderSource& src, std::string* log = nullptr);
+
+    uint32_t Hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint32_t Misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    uint64_t Key(const ShaderSource& src, std::string* log) const;
+    bool Compile(const ShaderSource& src, const std::filesystem::path& out, std::string* log) const;
+
+    std::filesystem::path dir_;
+    std::string compiler_;
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> memory_; // уже прочитанное за сессию
+    std::atomic<uint32_t> hits_{0}, misses_{0};
+};
+
+} // namespace dancore::graphics
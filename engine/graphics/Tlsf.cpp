@@ -0,0 +1,194 @@
+#include "Tlsf.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace dancore::graphics {
+
+void Tlsf::Init(uint64_t size)
+{
+    nodes_.clear();
+    spareNodes_.clear();
+    for (auto& fl : heads_) std::fill(std::begin(fl), std::end(fl), kNull);
+    flBitmap_ = 0;
+    std::fill(std::begin(slBitmap_), std::end(slBitmap_), 0u);
+    capacity_ = size;
+    used_ = 0;
+    allocations_ = 0;
+    uint32_t n = NewNode();
+    nodes_[n].offset = 0;
+    nodes_[n].size = size;
+    InsertFree(n);
+}
+
+// Мелкие размеры — линейные классы в fl = 0, дальше fl = log2 - (kSlBits + 3)
+void Tlsf::Mapping(uint64_t size, uint32_t& fl, uint32_t& sl)
+{
+    if (size < kSmall) {
+        fl = 0;
+        sl = uint32_t(size / (kSmall / kSlCount));
+        return;
+    }
+    uint32_t log2 = 63u - uint32_t(std::countl_zero(size));
+    fl = log2 - (kSlBits + 3);
+    sl = uint32_t(size >> (log2 - kSlBits)) & (kSlCount - 1);
+}
+
+// Поиск с округлением вверх до границы подкласса: любой блок найденного класса подходит
+uint32_t Tlsf::FindFree(uint64_t size) const
+{
+    if (size >= kSmall) {
+        uint32_t log2 = 63u - uint32_t(std::countl_zero(size));
+        size += (1ull << (log2 - kSlBits)) - 1;
+    } else {
+        size += kSmall / kSlCount - 1;
+    }
+    uint32_t fl, sl;
+    Mapping(size, fl, sl);
+    if (fl >= kFlCount) return kNull;
+    uint32_t slMap = slBitmap_[fl] & (~0u << sl);
+    if (!slMap) {
+        uint64_t flMap = flBitmap_ & (~0ull << (fl + 1));
+        if (fl + 1 >= 64 || !flMap) return kNull;
+        fl = uint32_t(std::countr_zero(flMap));
+        slMap = slBitmap_[fl];
+    }
+    sl = uint32_t(std::countr_zero(slMap));
+    return heads_[fl][sl];
+}
+
+void Tlsf::InsertFree(uint32_t n)
+{
+    Node& node = nodes_[n];
+    uint32_t fl, sl;
+    Mapping(node.size, fl, sl);
+    node.free = true;
+    node.prevFree = kNull;
+    node.nextFree = heads_[fl][sl];
+    if (node.nextFree != kNull) nodes_[node.nextFree].prevFree = n;
+    heads_[fl][sl] = n;
+    flBitmap_ |= 1ull << fl;
+    slBitmap_[fl] |= 1u << sl;
+}
+
+void Tlsf::RemoveFree(uint32_t n)
+{
+    Node& node = nodes_[n];
+    uint32_t fl, sl;
+    Mapping(node.size, fl, sl);
+    if (node.prevFree != kNull) nodes_[node.prevFree].nextFree = node.nextFree;
+    else heads_[fl][sl] = node.nextFree;
+    if (node.nextFree != kNull) nodes_[node.nextFree].prevFree = node.prevFree;
+    if (heads_[fl][sl] == kNull) {
+        slBitmap_[fl] &= ~(1u << sl);
+        if (!slBitmap_[fl]) flBitmap_ &= ~(1ull << fl);
+    }
+    node.free = false;
+    node.prevFree = node.nextFree = kNull;
+}
+
+uint32_t Tlsf::NewNode()
+{
+    if (!spareNodes_.empty()) {
+        uint32_t n = spareNodes_.back();
+        spareNodes_.pop_back();
+        nodes_[n] = Node{};
+        return n;
+    }
+    nodes_.emplace_back();
+    return uint32_t(nodes_.size() - 1);
+}
+
+void Tlsf::ReleaseNode(uint32_t n)
+{
+    spareNodes_.push_back(n);
+}
+
+uint32_t Tlsf::Allocate(uint64_t size, uint64_t align, uint64_t* offset)
+{
+    if (!size) size = 1;
+    if (!align) align = 1;
+    auto fits = [&](uint32_t n) {
+        uint64_t aligned = (nodes_[n].offset + align - 1) & ~(align - 1);
+        return aligned + size <= nodes_[n].offset + nodes_[n].size;
+    };
+    uint32_t n = FindFree(size);
+    if (n == kNull || !fits(n)) n = FindFree(size + align - 1); // запас на выравнивание
+    if (n == kNull || !fits(n)) return kNull;
+    RemoveFree(n);
+
+    // отступ под выравнивание — отдельный свободный блок перед выделением
+    uint64_t aligned = (nodes_[n].offset + align - 1) & ~(align - 1);
+    if (uint64_t pad = aligned - nodes_[n].offset) {
+        uint32_t p = NewNode();
+        Node& node = nodes_[n];
+        Node& front = nodes_[p];
+        front.offset = node.offset;
+        front.size = pad;
+        front.prevPhys = node.prevPhys;
+        front.nextPhys = n;
+        if (front.prevPhys != kNull) nodes_[front.prevPhys].nextPhys = p;
+        node.prevPhys = p;
+        node.offset = aligned;
+        node.size -= pad;
+        // слева не может быть свободного соседа: свободные блоки всегда слиты
+        InsertFree(p);
+    }
+    // хвост
+    if (nodes_[n].size - size >= kMinSplit) {
+        uint32_t t = NewNode();
+        Node& node = nodes_[n];
+        Node& tail = nodes_[t];
+        tail.offset = node.offset + size;
+        tail.size = node.size - size;
+        tail.prevPhys = n;
+        tail.nextPhys = node.nextPhys;
+        if (tail.nextPhys != kNull) nodes_[tail.nextPhys].prevPhys = t;
+        node.nextPhys = t;
+        node.size = size;
+        InsertFree(t);
+    }
+    used_ += nodes_[n].size;
+    ++allocations_;
+    *offset = nodes_[n].offset;
+    return n;
+}
+
+void Tlsf::Free(uint32_t n)
+{
+    assert(n < nodes_.size() && !nodes_[n].free);
+    used_ -= nodes_[n].size;
+    --allocations_;
+    // слияние с соседями по памяти
+    uint32_t prev = nodes_[n].prevPhys;
+    if (prev != kNull && nodes_[prev].free) {
+        RemoveFree(prev);
+        nodes_[prev].size += nodes_[n].size;
+        nodes_[prev].nextPhys = nodes_[n].nextPhys;
+        if (nodes_[n].nextPhys != kNull) nodes_[nodes_[n].nextPhys].prevPhys = prev;
+        ReleaseNode(n);
+        n = prev;
+    }
+    uint32_t next = nodes_[n].nextPhys;
+    if (next != kNull && nodes_[next].free) {
+        RemoveFree(next);
+        nodes_[n].size += nodes_[next].size;
+        nodes_[n].nextPhys = nodes_[next].nextPhys;
+        if (nodes_[next].nextPhys != kNull) nodes_[nodes_[next].nextPhys].prevPhys = n;
+        ReleaseNode(next);
+    }
+    InsertFree(n);
+}
+
+uint64_t Tlsf::LargestFree() const
+{
+    if (!flBitmap_) return 0;
+    uint32_t fl = 63u - uint32_t(std::countl_zero(flBitmap_));
+    uint32_t sl = 31u - uint32_t(std::countl_zero(slBitmap_[fl]));
+    uint64_t best = 0;
+    for (uint32_t n = heads_[fl][sl]; n != kNull; n = nodes_[n].nextFree) best = std::max(best, nodes_[n].size);
+    return best;
+}
+
+} // namespace dancore::graphics
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// TLSF (two-level segregated fit) над диапазоном [0, size): O(1) выделение и
+// освобождение, соседние свободные блоки сливаются сразу. Сама память не трогается —
+// только смещения, поэтому годится для нарезки VkDeviceMemory.
+
+namespace dancore::graphics {
+
+class Tlsf {
+public:
+    static constexpr uint32_t kNull = ~0u;
+
+    void Init(uint64_t size);
+
+    // Возвращает узел (для Free) или kNull; offset кратен align (степень двойки)
+    uint32_t Allocate(uint64_t size, uint64_t align, uint64_t* offset);
+    void Free(uint32_t node);
+
+    uint64_t Offset(uint32_t node) const { return nodes_[node].offset; }
+    uint64_t Size(uint32_t node) const { return nodes_[node].size; }
+
+    uint64_t Capacity() const { return capacity_; }
+    uint64_t UsedBytes() const { return used_; }
+    uint64_t LargestFree() const;
+    bool Empty() const { return used_ == 0; }
+    uint32_t Allocations() const { return allocations_; }
+
+private:
+    static constexpr uint32_t kSlBits = 4;                 // 16 подклассов на класс
+    static constexpr uint32_t kSlCount = 1u << kSlBits;
+    static constexpr uint32_t kFlCount = 40;               // до 2^46 байт
+    static constexpr uint64_t kSmall = 1ull << (kSlBits + 4); // ниже — линейные классы по 16 байт
+    static constexpr uint64_t kMinSplit = 64;              // меньший хвост остаётся в блоке
+
+    struct Node {
+        uint64_t offset = 0, size = 0;
+        uint32_t prevPhys = kNull, nextPhys = kNull;
+        uint32_t prevFree = kNull, nextFree = kNull;
+        bool free = false;
+    };
+
+    static void Mapping(uint64_t size, uint32_t& fl, uint32_t& sl);
+    uint32_t FindFree(uint64_t size) const;
+    void InsertFree(uint32_t n);
+    void RemoveFree(uint32_t n);
+    uint32_t NewNode();
+    void ReleaseNode(uint32_t n);
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> spareNodes_;
+    uint32_t heads_[kFlCount][kSlCount];
+    uint64_t flBitmap_ = 0;
+    uint32_t slBitmap_[kFlCount] = {};
+    uint64_t capacity_ = 0, used_ = 0;
+    uint32_t allocations_ = 0;
+};
+
+} // namespace dancore::graphics
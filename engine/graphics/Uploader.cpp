@@ -0,0 +1,340 @@
+#include "Uploader.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace dancore::graphics {
+
+namespace {
+
+void Check(VkResult r, const char* where)
+{
+    if (r != VK_SUCCESS) throw std::runtime_error(std::string("Uploader: ") + where + " failed");
+}
+
+VkDeviceSize AlignUp(VkDeviceSize v, VkDeviceSize a) { return (v + a - 1) / a * a; }
+
+uint32_t FindMemoryType(VkPhysicalDevice gpu, uint32_t bits, VkMemoryPropertyFlags flags)
+{
+    VkPhysicalDeviceMemoryProperties mp{};
+    vkGetPhysicalDeviceMemoryProperties(gpu, &mp);
+    for (uint32_t i = 0; i < mp.memoryTypeCount; i++)
+        if ((bits & (1u << i)) && (mp.memoryTypes[i].propertyFlags & flags) == flags) return i;
+    throw std::runtime_error("Uploader: no host-visible memory type");
+}
+
+} // namespace
+
+uint32_t FindTransferQueueFamily(VkPhysicalDevice gpu, uint32_t graphicsFamily)
+{
+    uint32_t qn = 0; vkGetPhysicalDeviceQueueFamilyProperties(gpu, &qn, nullptr);
+    std::vector<VkQueueFamilyProperties> qp(qn); vkGetPhysicalDeviceQueueFamilyProperties(gpu, &qn, qp.data());
+    constexpr VkQueueFlags gc = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+    for (uint32_t i = 0; i < qn; i++)
+        if ((qp[i].queueFlags & VK_QUEUE_TRANSFER_BIT) && !(qp[i].queueFlags & gc)) return i;
+    // async compute тоже умеет копировать и не мешает графике
+    for (uint32_t i = 0; i < qn; i++)
+        if ((qp[i].queueFlags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT)) && !(qp[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+            return i;
+    return graphicsFamily;
+}
+
+void Uploader::Init(const UploaderDesc& desc)
+{
+    desc_ = desc;
+    VkDevice dev = desc_.device;
+
+    VkPhysicalDeviceProperties props{};
+    vkGetPhysicalDeviceProperties(desc_.gpu, &props);
+    // 16 покрывает размер блока любого формата, кроме 3-компонентных
+    copyAlign_ = std::max<VkDeviceSize>({16, props.limits.optimalBufferCopyOffsetAlignment, props.limits.nonCoherentAtomSize});
+
+    VkBufferCreateInfo bi{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    bi.size = desc_.ringBytes; bi.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT; bi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    Check(vkCreateBuffer(dev, &bi, nullptr, &ring_), "vkCreateBuffer");
+    VkMemoryRequirements req{}; vkGetBufferMemoryRequirements(dev, ring_, &req);
+    VkMemoryAllocateInfo ai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    ai.allocationSize = req.size;
+    ai.memoryTypeIndex = FindMemoryType(desc_.gpu, req.memoryTypeBits,
+                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    Check(vkAllocateMemory(dev, &ai, nullptr, &ringMemory_), "vkAllocateMemory");
+    Check(vkBindBufferMemory(dev, ring_, ringMemory_, 0), "vkBindBufferMemory");
+    Check(vkMapMemory(dev, ringMemory_, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&mapped_)), "vkMapMemory");
+
+    VkSemaphoreTypeCreateInfo ti{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    ti.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE; ti.initialValue = 0;
+    VkSemaphoreCreateInfo si{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO}; si.pNext = &ti;
+    Check(vkCreateSemaphore(dev, &si, nullptr, &timeline_), "vkCreateSemaphore");
+
+    VkCommandPoolCreateInfo pi{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    pi.queueFamilyIndex = desc_.transferFamily;
+    pi.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    Check(vkCreateCommandPool(dev, &pi, nullptr, &pool_), "vkCreateCommandPool");
+
+    head_ = used_ = 0;
+    nextValue_ = 1;
+    completed_ = 0;
+}
+
+void Uploader::Shutdown()
+{
+    if (!desc_.device) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        FlushLocked();
+        if (nextValue_ > 1) WaitValue(nextValue_ - 1);
+        Reclaim();
+    }
+    VkDevice dev = desc_.device;
+    vkDestroyCommandPool(dev, pool_, nullptr);
+    vkDestroySemaphore(dev, timeline_, nullptr);
+    vkUnmapMemory(dev, ringMemory_);
+    vkDestroyBuffer(dev, ring_, nullptr);
+    vkFreeMemory(dev, ringMemory_, nullptr);
+    freeCmds_.clear(); acquires_.clear();
+    desc_ = {};
+}
+
+uint64_t Uploader::CompletedValue()
+{
+    uint64_t v = 0;
+    if (vkGetSemaphoreCounterValue(desc_.device, timeline_, &v) == VK_SUCCESS) completed_ = std::max(completed_, v);
+    return completed_;
+}
+
+void Uploader::WaitValue(uint64_t value)
+{
+    if (value <= completed_) return;
+    DC_PROFILE_ZONE("Uploader::Wait");
+    VkSemaphoreWaitInfo wi{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    wi.semaphoreCount = 1; wi.pSemaphores = &timeline_; wi.pValues = &value;
+    Check(vkWaitSemaphores(desc_.device, &wi, UINT64_MAX), "vkWaitSemaphores");
+    completed_ = std::max(completed_, value);
+}
+
+void Uploader::Reclaim()
+{
+    if (inFlight_.empty()) return;
+    uint64_t done = CompletedValue();
+    while (!inFlight_.empty() && inFlight_.front().value <= done) {
+        Batch& b = inFlight_.front();
+        used_ -= b.bytes;
+        vkResetCommandBuffer(b.cmd, 0);
+        freeCmds_.push_back(b.cmd);
+        inFlight_.pop_front();
+    }
+}
+
+// Кольцо: занятая область непрерывна от самого старого пакета до head_, поэтому
+// хватает счётчика used_; хвост в конце буфера при переходе через край тоже считается занятым
+VkDeviceSize Uploader::Allocate(VkDeviceSize size, VkDeviceSize align)
+{
+    assert(size <= desc_.ringBytes);
+    for (;;) {
+        Reclaim();
+        if (used_ == 0) head_ = 0;
+        VkDeviceSize offset = AlignUp(head_, align), need;
+        if (offset + size > desc_.ringBytes) { offset = 0; need = desc_.ringBytes - head_ + size; }
+        else need = offset - head_ + size;
+        if (used_ + need <= desc_.ringBytes) {
+            head_ = offset + size;
+            used_ += need;
+            current_.bytes += need;
+            return offset;
+        }
+        // места нет: отдаём накопленное и ждём самый старый пакет
+        if (inFlight_.empty()) FlushLocked();
+        WaitValue(inFlight_.front().value);
+    }
+}
+
+VkCommandBuffer Uploader::CurrentCmd()
+{
+    if (current_.cmd) return current_.cmd;
+    if (!freeCmds_.empty()) {
+        current_.cmd = freeCmds_.back();
+        freeCmds_.pop_back();
+    } else {
+        VkCommandBufferAllocateInfo ai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        ai.commandPool = pool_; ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; ai.commandBufferCount = 1;
+        Check(vkAllocateCommandBuffers(desc_.device, &ai, &current_.cmd), "vkAllocateCommandBuffers");
+    }
+    VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    Check(vkBeginCommandBuffer(current_.cmd, &bi), "vkBeginCommandBuffer");
+    return current_.cmd;
+}
+
+UploadTicket Uploader::UploadBuffer(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size)
+{
+    if (!size) return {};
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto* src = static_cast<const unsigned char*>(data);
+    // куски по четверти кольца: пока один летит, следующий уже копируется
+    const VkDeviceSize piece = std::max<VkDeviceSize>(desc_.ringBytes / 4, copyAlign_);
+    for (VkDeviceSize done = 0; done < size;) {
+        VkDeviceSize n = std::min(piece, size - done);
+        VkDeviceSize offset = Allocate(n, copyAlign_);
+        std::memcpy(mapped_ + offset, src + done, n);
+        VkBufferCopy region{offset, dstOffset + done, n};
+        vkCmdCopyBuffer(CurrentCmd(), ring_, dst, 1, &region);
+        done += n;
+    }
+
+    VkBufferMemoryBarrier b{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+    b.buffer = dst; b.offset = dstOffset; b.size = size;
+    b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    if (DedicatedQueue()) {
+        // release: доступ на стороне получателя задаёт acquire
+        b.srcQueueFamilyIndex = desc_.transferFamily; b.dstQueueFamilyIndex = desc_.graphicsFamily;
+        vkCmdPipelineBarrier(CurrentCmd(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 1, &b, 0, nullptr);
+        Acquire a{nextValue_, {}, b};
+        a.buffer.srcAccessMask = 0; a.buffer.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        acquires_.push_back(a);
+    } else {
+        b.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        b.srcQueueFamilyIndex = b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vkCmdPipelineBarrier(CurrentCmd(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0, 0, nullptr, 1, &b, 0, nullptr);
+    }
+    return {nextValue_};
+}
+
+UploadTicket Uploader::UploadImage(VkImage dst, VkImageAspectFlags aspect, uint32_t mip, uint32_t layer,
+                                   VkExtent3D extent, uint32_t blockRows, const void* data, VkDeviceSize size,
+                                   VkImageLayout finalLayout)
+{
+    if (!size || !blockRows) return {};
+    assert(extent.depth == 1 && size % blockRows == 0);
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    VkImageMemoryBarrier b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    b.image = dst;
+    b.subresourceRange = {aspect, mip, 1, layer, 1};
+    b.srcQueueFamilyIndex = b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    b.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED; b.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    b.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(CurrentCmd(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &b);
+
+    // полосы строк: образ крупнее кольца грузится частями, пакеты идут в одну очередь по порядку
+    const auto* src = static_cast<const unsigned char*>(data);
+    const VkDeviceSize rowBytes = size / blockRows;
+    const uint32_t texelRows = (extent.height + blockRows - 1) / blockRows; // 1 или высота блока
+    const uint32_t bandRows = (uint32_t)std::clamp<VkDeviceSize>(desc_.ringBytes / 4 / rowBytes, 1, blockRows);
+    for (uint32_t row = 0; row < blockRows; row += bandRows) {
+        uint32_t n = std::min(bandRows, blockRows - row);
+        VkDeviceSize offset = Allocate(n * rowBytes, copyAlign_);
+        std::memcpy(mapped_ + offset, src + row * rowBytes, n * rowBytes);
+        VkBufferImageCopy region{};
+        region.bufferOffset = offset;
+        region.imageSubresource = {aspect, mip, layer, 1};
+        region.imageOffset = {0, int32_t(row * texelRows), 0};
+        region.imageExtent = {extent.width, std::min(extent.height - row * texelRows, n * texelRows), 1};
+        vkCmdCopyBufferToImage(CurrentCmd(), ring_, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    }
+
+    b.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL; b.newLayout = finalLayout;
+    b.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    const VkAccessFlags readAccess = finalLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                                   ? VK_ACCESS_SHADER_READ_BIT : VK_ACCESS_MEMORY_READ_BIT;
+    if (DedicatedQueue()) {
+        b.dstAccessMask = 0;
+        b.srcQueueFamilyIndex = desc_.transferFamily; b.dstQueueFamilyIndex = desc_.graphicsFamily;
+        vkCmdPipelineBarrier(CurrentCmd(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &b);
+        Acquire a{nextValue_, b, {}};
+        a.image.srcAccessMask = 0; a.image.dstAccessMask = readAccess;
+        acquires_.push_back(a);
+    } else {
+        b.dstAccessMask = readAccess;
+        vkCmdPipelineBarrier(CurrentCmd(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &b);
+    }
+    return {nextValue_};
+}
+
+UploadTicket Uploader::FlushLocked()
+{
+    if (!current_.cmd) return {nextValue_ - 1};
+    DC_PROFILE_ZONE("Uploader::Flush");
+    Check(vkEndCommandBuffer(current_.cmd), "vkEndCommandBuffer");
+
+    uint64_t signal = nextValue_;
+    VkTimelineSemaphoreSubmitInfo ti{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+    ti.signalSemaphoreValueCount = 1; ti.pSignalSemaphoreValues = &signal;
+    VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    si.pNext = &ti;
+    si.commandBufferCount = 1; si.pCommandBuffers = &current_.cmd;
+    si.signalSemaphoreCount = 1; si.pSignalSemaphores = &timeline_;
+    {
+        std::unique_lock<std::mutex> queueLock;
+        if (desc_.queueMutex) queueLock = std::unique_lock<std::mutex>(*desc_.queueMutex);
+        Check(vkQueueSubmit(desc_.transferQueue, 1, &si, VK_NULL_HANDLE), "vkQueueSubmit");
+    }
+
+    current_.value = signal;
+    inFlight_.push_back(current_);
+    current_ = {};
+    ++nextValue_;
+    return {signal};
+}
+
+UploadTicket Uploader::Flush()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Reclaim();
+    return FlushLocked();
+}
+
+bool Uploader::IsComplete(UploadTicket t)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return t.value <= CompletedValue();
+}
+
+void Uploader::Wait(UploadTicket t)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (t.value >= nextValue_) FlushLocked();
+    lock.unlock();
+    // vkWaitSemaphores без замка: другие потоки могут грузить, пока этот ждёт
+    DC_PROFILE_ZONE("Uploader::Wait");
+    VkSemaphoreWaitInfo wi{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    wi.semaphoreCount = 1; wi.pSemaphores = &timeline_; wi.pValues = &t.value;
+    Check(vkWaitSemaphores(desc_.device, &wi, UINT64_MAX), "vkWaitSemaphores");
+}
+
+bool Uploader::PendingAcquires()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !acquires_.empty();
+}
+
+uint64_t Uploader::RecordAcquires(VkCommandBuffer graphicsCmd)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (acquires_.empty()) return 0;
+    std::vector<VkImageMemoryBarrier> images;
+    std::vector<VkBufferMemoryBarrier> buffers;
+    uint64_t wait = 0;
+    // только пакеты, которые уже отправлены: их release гарантированно раньше по семафору
+    std::erase_if(acquires_, [&](const Acquire& a) {
+        if (a.value >= nextValue_) return false;
+        if (a.image.image) images.push_back(a.image);
+        else buffers.push_back(a.buffer);
+        wait = std::max(wait, a.value);
+        return true;
+    });
+    if (!wait) return 0;
+    vkCmdPipelineBarrier(graphicsCmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                         0, nullptr, (uint32_t)buffers.size(), buffers.data(), (uint32_t)images.size(), images.data());
+    return wait;
+}
+
+} // namespace dancore::graphics
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Загрузка данных на GPU без остановки устройства: постоянно отображённое staging-кольцо,
+// копии копятся в пакет и уходят одним submit на очередь передачи (выделенную, если есть),
+// завершение отслеживается timeline-семафором. Место в кольце освобождается по мере того,
+// как семафор догоняет пакеты. Потокобезопасно (один мьютекс на всё).
+//
+// С выделенной очередью ресурсы меняют владельца: release пишется в пакет передачи,
+// acquire — в графический буфер команд через RecordAcquires(), а графический submit
+// ждёт на Timeline() значение, которое тот вернул.
+
+namespace dancore::graphics {
+
+struct UploadTicket {
+    uint64_t value = 0; // значение timeline-семафора пакета; 0 — ничего не загружалось
+};
+
+struct UploaderDesc {
+    VkPhysicalDevice gpu{};
+    VkDevice device{};
+    uint32_t graphicsFamily = 0;
+    uint32_t transferFamily = 0;     // == graphicsFamily: копии идут в графическую очередь
+    VkQueue transferQueue{};
+    std::mutex* queueMutex = nullptr; // очередь общая с графикой: тот же мьютекс, что у её vkQueueSubmit
+    VkDeviceSize ringBytes = 64ull << 20;
+};
+
+// Семейство только с TRANSFER (DMA-движок), иначе без GRAPHICS, иначе graphicsFamily
+uint32_t FindTransferQueueFamily(VkPhysicalDevice gpu, uint32_t graphicsFamily);
+
+class Uploader {
+public:
+    void Init(const UploaderDesc& desc);
+    void Shutdown();
+
+    // Данные копируются в кольцо сразу, память вызывающего можно освобождать.
+    // Крупные загрузки режутся на куски; при заполненном кольце пакет отправляется
+    // и ждётся самый старый, поэтому вызов может блокироваться.
+    UploadTicket UploadBuffer(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+    // Один mip/слой 2D-образа. blockRows — строк блоков в data (height для обычных форматов,
+    // ceil(height/4) для BC/ASTC 4x4); образ переводится из UNDEFINED в finalLayout.
+    UploadTicket UploadImage(VkImage dst, VkImageAspectFlags aspect, uint32_t mip, uint32_t layer,
+                             VkExtent3D extent, uint32_t blockRows, const void* data, VkDeviceSize size,
+                             VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    // Отправить накопленный пакет; раз в кадр из бэкенда или явно перед Wait
+    UploadTicket Flush();
+
+    bool IsComplete(UploadTicket t);
+    void Wait(UploadTicket t);
+
+    // Графическая сторона: acquire-барьеры для уже отправленных пакетов.
+    // Возвращает значение Timeline(), которое должен ждать submit этого cmd (0 — не нужно).
+    uint64_t RecordAcquires(VkCommandBuffer graphicsCmd);
+    // Есть барьеры, ждущие графического cmd: кадр нельзя пропускать, иначе загрузка не дойдёт
+    bool PendingAcquires();
+    VkSemaphore Timeline() const { return timeline_; }
+
+    bool DedicatedQueue() const { return desc_.transferFamily != desc_.graphicsFamily; }
+    VkDeviceSize RingBytes() const { return desc_.ringBytes; }
+    VkDeviceSize BytesInFlight() const { return used_; }
+
+private:
+    struct Batch {
+        VkCommandBuffer cmd{};
+        uint64_t value = 0;
+        VkDeviceSize bytes = 0; // занято в кольце, включая выравнивание и хвост при переходе через край
+    };
+    struct Acquire {
+        uint64_t value;
+        VkImageMemoryBarrier image;   // image.image == VK_NULL_HANDLE: барьер буфера
+        VkBufferMemoryBarrier buffer;
+    };
+
+    VkDeviceSize Allocate(VkDeviceSize size, VkDeviceSize align);
+    VkCommandBuffer CurrentCmd();
+    UploadTicket FlushLocked();
+    void Reclaim();
+    void WaitValue(uint64_t value);
+    uint64_t CompletedValue();
+
+    UploaderDesc desc_{};
+    std::mutex mutex_;
+    VkBuffer ring_{};
+    VkDeviceMemory ringMemory_{};
+    unsigned char* mapped_ = nullptr;
+    VkDeviceSize head_ = 0, used_ = 0, copyAlign_ = 16;
+    VkSemaphore timeline_{};
+    uint64_t nextValue_ = 1;         // значение, которое получит текущий (ещё не отправленный) пакет
+    uint64_t completed_ = 0;
+    VkCommandPool pool_{};
+    Batch current_{};
+    std::deque<Batch> inFlight_;
+    std::vector<VkCommandBuffer> freeCmds_;
+    std::vector<Acquire> acquires_;
+};
+
+} // namespace dancore::graphics
@@ -0,0 +1,133 @@
+#include "ViewportScene.hpp"
+#include "core/Hash.hpp"
+#include "core/Profiler.hpp"
+#include "core/SceneComponents.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dancore::graphics {
+
+namespace {
+
+constexpr float kDegToRad = 3.14159265358979f / 180.0f;
+constexpr float kNear = 0.1f;
+constexpr int kCell = 4;
+
+struct Basis {
+    float eye[3], right[3], up[3], forward[3];
+};
+
+Basis MakeBasis(const ViewportCamera& c)
+{
+    const float yaw = c.yaw * kDegToRad, pitch = c.pitch * kDegToRad;
+    const float back[3] = {std::cos(pitch) * std::sin(yaw), std::sin(pitch), std::cos(pitch) * std::cos(yaw)};
+    Basis b;
+    for (int i = 0; i < 3; ++i) {
+        b.eye[i] = c.target[i] + back[i] * c.distance;
+        b.forward[i] = -back[i];
+    }
+    // right = forward x (0,1,0), up = right x forward; pitch ограничен, вырождения нет
+    const float rl = std::sqrt(b.forward[0] * b.forward[0] + b.forward[2] * b.forward[2]);
+    b.right[0] = -b.forward[2] / rl;
+    b.right[1] = 0.0f;
+    b.right[2] = b.forward[0] / rl;
+    b.up[0] = b.right[1] * b.forward[2] - b.right[2] * b.forward[1];
+    b.up[1] = b.right[2] * b.forward[0] - b.right[0] * b.forward[2];
+    b.up[2] = b.right[0] * b.forward[1] - b.right[1] * b.forward[0];
+    return b;
+}
+
+} // namespace
+
+void ViewportCamera::Orbit(float dYaw, float dPitch)
+{
+    yaw = std::fmod(yaw + dYaw, 360.0f);
+    pitch = std::clamp(pitch + dPitch, -89.0f, 89.0f);
+}
+
+void ViewportCamera::Zoom(float wheel)
+{
+    distance = std::clamp(distance * std::pow(0.9f, wheel), 0.5f, 5000.0f);
+}
+
+uint64_t BuildViewportMarkers(core::ecs::World& world, const ViewportCamera& camera, uint32_t width, uint32_t height,
+                              core::ecs::Entity selected, std::vector<ViewportMarker>& out)
+{
+    DC_PROFILE_ZONE("BuildViewportMarkers");
+    out.clear();
+    if (!width || !height) return 0;
+    const Basis b = MakeBasis(camera);
+    const float focal = 0.5f * float(height) / std::tan(0.5f * camera.fovY * kDegToRad);
+    const float cx = 0.5f * float(width), cy = 0.5f * float(height);
+    const uint32_t cellsX = (width + kCell - 1) / kCell, cellsY = (height + kCell - 1) / kCell;
+
+    // клетка -> индекс метки в out (~0u — пусто) и глубина метки
+    std::vector<uint32_t> cells(size_t(cellsX) * cellsY, ~0u);
+    std::vector<float> depth;
+    const core::ecs::ComponentMask bodyMask = core::ecs::MaskOf<core::scene::PhysicsBody>();
+    const core::ecs::ComponentId ltwId = core::ecs::ComponentIdOf<core::scene::LocalToWorld>();
+    world.EachChunk(core::ecs::MaskOf<core::scene::LocalToWorld>(), 0,
+                    [&](const core::ecs::Archetype& a, const core::ecs::Chunk& c) {
+        const core::ecs::Entity* entities = a.Entities(c);
+        const auto* ltw = static_cast<const core::scene::LocalToWorld*>(a.Column(c, ltwId));
+        const uint8_t kind = (a.mask & bodyMask) ? ViewportMarker::Body : ViewportMarker::Plain;
+        for (uint32_t i = 0; i < c.count; ++i) {
+            const float* m = ltw[i].m;
+            const float d[3] = {m[12] - b.eye[0], m[13] - b.eye[1], m[14] - b.eye[2]};
+            const float z = d[0] * b.forward[0] + d[1] * b.forward[1] + d[2] * b.forward[2];
+            if (z < kNear) continue;
+            const float inv = focal / z;
+            const float sx = cx + (d[0] * b.right[0] + d[1] * b.right[1] + d[2] * b.right[2]) * inv;
+            const float sy = cy - (d[0] * b.up[0] + d[1] * b.up[1] + d[2] * b.up[2]) * inv;
+            if (sx < 0.0f || sy < 0.0f || sx >= float(width) || sy >= float(height)) continue;
+            uint32_t& slot = cells[uint32_t(sy) / kCell * cellsX + uint32_t(sx) / kCell];
+            const bool isSelected = entities[i] == selected;
+            if (slot != ~0u && !isSelected && (out[slot].kind == ViewportMarker::Selected || z >= depth[slot])) continue;
+            // сторона — диаметр объекта по наибольшему масштабу, не меньше клетки
+            const float scale = std::sqrt(std::max({m[0] * m[0] + m[1] * m[1] + m[2] * m[2],
+                                                    m[4] * m[4] + m[5] * m[5] + m[6] * m[6],
+                                                    m[8] * m[8] + m[9] * m[9] + m[10] * m[10]}));
+            ViewportMarker mk;
+            mk.x = int16_t(sx);
+            mk.y = int16_t(sy);
+            mk.size = uint16_t(std::clamp(scale * inv, float(kCell), 64.0f));
+            mk.kind = isSelected ? uint8_t(ViewportMarker::Selected) : kind;
+            // оттенок — по глубине относительно цели камеры
+            mk.shade = uint8_t(std::min(uint32_t(std::min(camera.distance / z, 2.0f) * 0.5f * kViewportShades),
+                                        kViewportShades - 1));
+            mk.entity = entities[i];
+            if (slot == ~0u) {
+                slot = uint32_t(out.size());
+                out.push_back(mk);
+                depth.push_back(z);
+            } else {
+                out[slot] = mk;
+                depth[slot] = z;
+            }
+        }
+    });
+
+    // от дальних оттенков к ближним (устойчиво, подсчётом): ближние рисуются поверх
+    uint32_t start[kViewportShades + 1] = {};
+    for (const ViewportMarker& mk : out) ++start[mk.shade + 1];
+    for (uint32_t s = 0; s < kViewportShades; ++s) start[s + 1] += start[s];
+    std::vector<ViewportMarker> sorted(out.size());
+    for (const ViewportMarker& mk : out) sorted[start[mk.shade]++] = mk;
+    out.swap(sorted);
+
+    const uint32_t size[2] = {width, height};
+    return core::HashCombine(core::Hash64(size, sizeof(size)), core::Hash64(out.data(), out.size() * sizeof(ViewportMarker)));
+}
+
+core::ecs::Entity PickViewportMarker(const std::vector<ViewportMarker>& markers, float x, float y)
+{
+    for (size_t i = markers.size(); i-- > 0;) {
+        const ViewportMarker& m = markers[i];
+        const float half = 0.5f * float(m.size);
+        if (std::fabs(x - float(m.x)) <= half && std::fabs(y - float(m.y)) <= half) return m.entity;
+    }
+    return {};
+}
+
+} // namespace dancore::graphics
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "core/Ecs.hpp"
+
+// Что рисует Viewport редактора, без Vulkan: сущности с LocalToWorld, спроецированные
+// орбитальной камерой в квадратные метки. Один список на кадр нужен и UI (выбор мышью,
+// хэш для простоя), и бэкенду (проход "Scene" графа кадра).
+// В одной клетке 4x4 пикселя остаётся ближайшая сущность: меток не больше, чем клеток,
+// сколько бы объектов ни было в сцене.
+
+namespace dancore::graphics {
+
+struct ViewportCamera {
+    float target[3] = {0, 0, 0};
+    float yaw = 45.0f;      // градусы, вокруг Y
+    float pitch = 30.0f;    // градусы, над горизонтом
+    float distance = 20.0f;
+    float fovY = 60.0f;
+
+    void Orbit(float dYaw, float dPitch);
+    void Zoom(float wheel); // шаг колеса — 10% расстояния
+};
+
+struct ViewportMarker {
+    enum Kind : uint8_t { Plain = 0, Body = 1, Selected = 2 };
+    int16_t x = 0, y = 0;   // центр в пикселях viewport'а
+    uint16_t size = 0;      // сторона в пикселях
+    uint8_t kind = Plain;
+    uint8_t shade = 0;      // 0 — дальние, kViewportShades - 1 — ближние
+    core::ecs::Entity entity;
+};
+inline constexpr uint32_t kViewportShades = 8;
+
+// Метки в порядке от дальних к ближним; возвращает хэш списка вместе с размером viewport'а
+uint64_t BuildViewportMarkers(core::ecs::World& world, const ViewportCamera& camera, uint32_t width, uint32_t height,
+                              core::ecs::Entity selected, std::vector<ViewportMarker>& out);
+// Ближайшая метка под точкой (пиксели viewport'а), иначе пустой хэндл
+core::ecs::Entity PickViewportMarker(const std::vector<ViewportMarker>& markers, float x, float y);
+
+} // namespace dancore::graphics
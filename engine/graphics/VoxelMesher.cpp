@@ -0,0 +1,205 @@
+#include "VoxelMesher.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace dancore::graphics {
+
+using physics::VoxelBrick;
+using physics::VoxelChunk;
+using physics::VoxelMaterial;
+using physics::kVoxelBrickCells;
+using physics::kVoxelBrickSize;
+using physics::kVoxelBricksPerAxis;
+using physics::kVoxelChunkSize;
+
+namespace {
+
+constexpr int kMaxPad = kVoxelChunkSize + 2;
+
+struct Scratch {
+    VoxelMaterial full[kVoxelChunkSize * kVoxelChunkSize * kVoxelChunkSize];
+    VoxelMaterial dense[kMaxPad * kMaxPad * kMaxPad];      // материалы внутренности, индекс с рамкой
+    uint64_t row[kMaxPad * kMaxPad];                       // z * p + y; бит x, с рамкой из соседей
+    uint64_t column[3][kVoxelChunkSize * kVoxelChunkSize]; // ось, v * n + u; бит — padded координата вдоль оси
+    uint64_t square[64];                                   // для транспонирования
+    uint32_t plane[6][kVoxelChunkSize][kVoxelChunkSize];   // грань, глубина, v; бит — u
+};
+
+// Есть ли твёрдая ячейка в блоке s³ с углом (x0, y0, z0); только маски занятости
+bool SolidBlock(const VoxelChunk& c, int x0, int y0, int z0, int s)
+{
+    if (c.Uniform()) return c.UniformMaterial() != 0;
+    for (int z = z0; z < z0 + s; ++z)
+        for (int y = y0; y < y0 + s; ++y)
+            for (int x = x0; x < x0 + s; ++x)
+                if (c.Solid(x, y, z)) return true;
+    return false;
+}
+
+// Битовая матрица 64x64 на месте: бит x слова y -> бит y слова x (SWAR, 6 проходов)
+void Transpose64(uint64_t a[64])
+{
+    uint64_t m = 0x00000000FFFFFFFFull;
+    for (int j = 32; j; j >>= 1, m ^= m << j)
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+}
+
+} // namespace
+
+void MeshVoxelChunk(const VoxelChunk& chunk, const VoxelChunk* const neighbors[6], int lod, VoxelMesh& out)
+{
+    DC_PROFILE_ZONE("MeshVoxelChunk");
+    out.lod = lod;
+    out.version = chunk.Version();
+    out.quads.clear();
+    if (chunk.Uniform()) {
+        if (chunk.UniformMaterial() == 0) return;
+        bool closed = true;
+        for (int f = 0; f < 6; ++f) closed &= neighbors[f] && neighbors[f]->Uniform() && neighbors[f]->UniformMaterial() != 0;
+        if (closed) return; // сплошной камень без единой открытой грани
+    }
+
+    thread_local Scratch s;
+    const int n = kVoxelChunkSize >> lod, p = n + 2, step = 1 << lod;
+    auto at = [&](int x, int y, int z) -> VoxelMaterial& { return s.dense[x + p * (y + p * z)]; };
+
+    // внутренность: кирпичи целиком (для LOD — в полный массив и прореживание)
+    if (chunk.Uniform()) {
+        for (int z = 1; z <= n; ++z)
+            for (int y = 1; y <= n; ++y) std::fill_n(&at(1, y, z), n, chunk.UniformMaterial());
+    } else {
+        VoxelMaterial cells[kVoxelBrickCells];
+        for (int bz = 0; bz < kVoxelBricksPerAxis; ++bz)
+            for (int by = 0; by < kVoxelBricksPerAxis; ++by)
+                for (int bx = 0; bx < kVoxelBricksPerAxis; ++bx) {
+                    chunk.Brick(bx, by, bz).Decode(cells);
+                    for (int z = 0; z < kVoxelBrickSize; ++z)
+                        for (int y = 0; y < kVoxelBrickSize; ++y) {
+                            const int gx = bx * kVoxelBrickSize, gy = by * kVoxelBrickSize + y, gz = bz * kVoxelBrickSize + z;
+                            VoxelMaterial* dst = lod ? s.full + gx + kVoxelChunkSize * (gy + kVoxelChunkSize * gz) : &at(gx + 1, gy + 1, gz + 1);
+                            std::copy_n(cells + kVoxelBrickSize * (y + kVoxelBrickSize * z), kVoxelBrickSize, dst);
+                        }
+                }
+        auto full = [&](int x, int y, int z) { return s.full[x + kVoxelChunkSize * (y + kVoxelChunkSize * z)]; };
+        if (lod)
+            for (int z = 0; z < n; ++z)
+                for (int y = 0; y < n; ++y)
+                    for (int x = 0; x < n; ++x) {
+                        VoxelMaterial m = 0;
+                        for (int i = 0; i < step * step * step && !m; ++i)
+                            m = full((x << lod) + (i & (step - 1)), (y << lod) + ((i >> lod) & (step - 1)), (z << lod) + (i >> (2 * lod)));
+                        at(x + 1, y + 1, z + 1) = m;
+                    }
+    }
+
+    // строки занятости по x и однородность материала
+    std::fill_n(s.row, p * p, uint64_t(0));
+    VoxelMaterial first = 0;
+    bool single = true;
+    for (int z = 1; z <= n; ++z)
+        for (int y = 1; y <= n; ++y) {
+            const VoxelMaterial* line = &at(0, y, z);
+            uint64_t bits = 0;
+            for (int x = 1; x <= n; ++x) bits |= uint64_t(line[x] != 0) << x;
+            s.row[z * p + y] = bits;
+            if (bits && single) {
+                if (!first) first = line[std::countr_zero(bits)];
+                for (int x = 1; x <= n; ++x) single &= !line[x] || line[x] == first;
+            }
+        }
+
+    // рамка: ближний к чанку слой соседа, прорежённый так же; нужна только занятость
+    const int last = kVoxelChunkSize - step;
+    for (int f = 0; f < 6; ++f) {
+        const VoxelChunk* nb = neighbors[f];
+        if (!nb || (nb->Uniform() && nb->UniformMaterial() == 0)) continue;
+        const int axis = f >> 1, layer = (f & 1) ? p - 1 : 0, src = (f & 1) ? 0 : last;
+        for (int b = 0; b < n; ++b)
+            for (int a = 0; a < n; ++a) {
+                int c[3], d[3];
+                c[axis] = layer, d[axis] = src;
+                c[axis == 0 ? 1 : 0] = a + 1, d[axis == 0 ? 1 : 0] = a << lod;
+                c[axis == 2 ? 1 : 2] = b + 1, d[axis == 2 ? 1 : 2] = b << lod;
+                if (SolidBlock(*nb, d[0], d[1], d[2], step)) s.row[c[2] * p + c[1]] |= uint64_t(1) << c[0];
+            }
+    }
+
+    // колонки по трём осям: x — строки как есть, y и z — транспонированием срезов
+    for (int z = 1; z <= n; ++z)
+        std::copy_n(&s.row[z * p + 1], n, &s.column[0][(z - 1) * n]);
+    for (int z = 1; z <= n; ++z) {
+        std::fill(std::copy_n(&s.row[z * p], p, s.square), s.square + 64, uint64_t(0));
+        Transpose64(s.square);
+        std::copy_n(s.square + 1, n, &s.column[1][(z - 1) * n]);
+    }
+    for (int y = 1; y <= n; ++y) {
+        for (int z = 0; z < p; ++z) s.square[z] = s.row[z * p + y];
+        std::fill(s.square + p, s.square + 64, uint64_t(0));
+        Transpose64(s.square);
+        std::copy_n(s.square + 1, n, &s.column[2][(y - 1) * n]);
+    }
+
+    // видимые грани: твёрдая ячейка внутри, за ней по оси воздух
+    const uint64_t interior = ((uint64_t(1) << n) - 1) << 1;
+    for (int f = 0; f < 6; ++f)
+        for (int d = 0; d < n; ++d) std::fill_n(s.plane[f][d], n, 0u);
+    for (int axis = 0; axis < 3; ++axis) {
+        const uint64_t* col = s.column[axis];
+        for (int i = 0; i < n * n; ++i) {
+            uint64_t c = col[i];
+            uint64_t pos = (c & ~(c >> 1) & interior) >> 1;
+            uint64_t neg = (c & ~(c << 1) & interior) >> 1;
+            const int u = i % n, v = i / n;
+            for (; pos; pos &= pos - 1) s.plane[axis * 2][std::countr_zero(pos)][v] |= 1u << u;
+            for (; neg; neg &= neg - 1) s.plane[axis * 2 + 1][std::countr_zero(neg)][v] |= 1u << u;
+        }
+    }
+
+    // жадное слияние по строкам каждой плоскости
+    for (int f = 0; f < 6; ++f) {
+        const int axis = f >> 1;
+        for (int d = 0; d < n; ++d) {
+            uint32_t* rows = s.plane[f][d];
+            auto material = [&](int u, int v) {
+                int c[3];
+                c[axis] = d + 1;
+                c[axis == 0 ? 1 : 0] = u + 1;
+                c[axis == 2 ? 1 : 2] = v + 1;
+                return at(c[0], c[1], c[2]);
+            };
+            auto same = [&](int u, int w, int v, VoxelMaterial m) {
+                for (int k = 0; k < w; ++k)
+                    if (material(u + k, v) != m) return false;
+                return true;
+            };
+            for (int v = 0; v < n; ++v) {
+                while (uint32_t row = rows[v]) {
+                    const int u = std::countr_zero(row);
+                    int w = std::countr_one(row >> u);
+                    VoxelMaterial m = single ? first : material(u, v);
+                    if (!single)
+                        for (int k = 1; k < w; ++k)
+                            if (material(u + k, v) != m) { w = k; break; }
+                    const uint32_t mask = uint32_t((uint64_t(1) << w) - 1) << u;
+                    int h = 1;
+                    while (v + h < n && (rows[v + h] & mask) == mask && (single || same(u, w, v + h, m))) ++h;
+                    for (int k = 0; k < h; ++k) rows[v + k] &= ~mask;
+
+                    int c[3];
+                    c[axis] = d;
+                    c[axis == 0 ? 1 : 0] = u;
+                    c[axis == 2 ? 1 : 2] = v;
+                    out.quads.push_back({uint8_t(c[0]), uint8_t(c[1]), uint8_t(c[2]), uint8_t(w), uint8_t(h), VoxelFace(f), m});
+                }
+            }
+        }
+    }
+}
+
+} // namespace dancore::graphics
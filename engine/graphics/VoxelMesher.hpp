@@ -0,0 +1,41 @@
+#pragma once
+#include "physics/VoxelGrid.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Жадный мешер воксельного чанка на битовых масках, без Vulkan.
+//
+// Чанк (с одним слоем соседей) разворачивается в плотный массив материалов, из него —
+// 64-битные колонки занятости по трём осям. Видимые грани колонки — col & ~(col >> 1)
+// и col & ~(col << 1): по 32 ячейки за операцию, циклы по колонкам векторизуются
+// компилятором. Грани раскладываются по плоскостям из 32-битных строк, и прямоугольники
+// набираются по строкам: ширина — бегом единиц (ctz), высота — сравнением масок строк.
+
+namespace dancore::graphics {
+
+enum class VoxelFace : uint8_t { PosX, NegX, PosY, NegY, PosZ, NegZ };
+
+// Прямоугольник граней в ячейках LOD: (x, y, z) — первая ячейка, w и h — вдоль осей
+// плоскости (X-грани: y и z; Y-грани: x и z; Z-грани: x и y). Мировой размер ячейки —
+// 1 << lod вокселей.
+struct VoxelQuad {
+    uint8_t x, y, z;
+    uint8_t w, h;
+    VoxelFace face;
+    physics::VoxelMaterial material;
+};
+static_assert(sizeof(VoxelQuad) == 8);
+
+struct VoxelMesh {
+    int lod = 0;
+    uint32_t version = 0;            // VoxelChunk::Version() на момент мешинга
+    std::vector<VoxelQuad> quads;
+};
+
+// neighbors — соседи по граням в порядке -x +x -y +y -z +z, nullptr — воздух.
+// lod 0..kVoxelChunkBits-1: ячейка LOD — куб 2^lod, материал — первый твёрдый внутри.
+// Потокобезопасна для неизменяемых чанков; рабочие буферы — thread_local.
+void MeshVoxelChunk(const physics::VoxelChunk& chunk, const physics::VoxelChunk* const neighbors[6], int lod, VoxelMesh& out);
+
+} // namespace dancore::graphics
@@ -0,0 +1,144 @@
+#include "VoxelRemesher.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dancore::graphics {
+
+namespace jobs = dancore::core::jobs;
+using physics::VoxelChunkKey;
+using physics::kVoxelChunkSize;
+
+namespace {
+
+float ChunkDistance(VoxelChunkKey key, const float camera[3])
+{
+    int32_t c[3];
+    physics::UnpackChunkKey(key, c[0], c[1], c[2]);
+    float d2 = 0;
+    for (int a = 0; a < 3; ++a) {
+        float d = (float(c[a]) + 0.5f) * kVoxelChunkSize - camera[a];
+        d2 += d * d;
+    }
+    return std::sqrt(d2);
+}
+
+} // namespace
+
+VoxelRemesher::VoxelRemesher(physics::VoxelGrid& grid, VoxelRemeshSettings settings) : grid_(grid), settings_(settings)
+{
+    settings_.maxLod = std::clamp(settings_.maxLod, 0, physics::kVoxelChunkBits - 1);
+    settings_.maxInFlight = std::max<size_t>(settings_.maxInFlight, 1);
+}
+
+VoxelRemesher::~VoxelRemesher()
+{
+    jobs::Wait(counter_);
+}
+
+int VoxelRemesher::LodFor(VoxelChunkKey key, const float camera[3]) const
+{
+    float d = ChunkDistance(key, camera);
+    int lod = 0;
+    while (lod < settings_.maxLod && d >= settings_.lodDistance * float(1 << lod)) ++lod;
+    return lod;
+}
+
+const VoxelMesh* VoxelRemesher::Mesh(VoxelChunkKey key) const
+{
+    auto it = meshes_.find(key);
+    return it == meshes_.end() ? nullptr : &it->second;
+}
+
+void VoxelRemesher::TakeUpdated(std::vector<VoxelChunkKey>& out)
+{
+    out.assign(updated_.begin(), updated_.end());
+    updated_.clear();
+}
+
+void VoxelRemesher::Collect()
+{
+    auto finished = std::partition(tasks_.begin(), tasks_.end(), [](const auto& t) { return !t->done.load(std::memory_order_acquire); });
+    for (auto it = finished; it != tasks_.end(); ++it) {
+        Task& t = **it;
+        if (t.chunk) meshes_[t.key] = std::move(t.mesh);
+        else meshes_.erase(t.key);
+        inFlight_.erase(t.key);
+        updated_.insert(t.key);
+    }
+    tasks_.erase(finished, tasks_.end());
+}
+
+void VoxelRemesher::Dispatch(const float camera[3])
+{
+    if (pending_.empty() || tasks_.size() >= settings_.maxInFlight) return;
+    std::vector<std::pair<float, VoxelChunkKey>> order;
+    order.reserve(pending_.size());
+    for (VoxelChunkKey key : pending_)
+        if (!inFlight_.count(key)) order.push_back({ChunkDistance(key, camera), key});
+    size_t take = std::min(order.size(), settings_.maxInFlight - tasks_.size());
+    std::partial_sort(order.begin(), order.begin() + ptrdiff_t(take), order.end());
+
+    static const int kDir[6][3] = {{-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+    for (size_t i = 0; i < take; ++i) {
+        VoxelChunkKey key = order[i].second;
+        pending_.erase(key);
+        std::shared_ptr<const physics::VoxelChunk> chunk = grid_.Chunk(key);
+        if (!chunk && !meshes_.count(key)) continue; // пустой сосед правки: меша не было и нет
+        auto task = std::make_unique<Task>();
+        task->key = key;
+        task->lod = LodFor(key, camera);
+        task->chunk = std::move(chunk);
+        if (task->chunk) {
+            int32_t c[3];
+            physics::UnpackChunkKey(key, c[0], c[1], c[2]);
+            for (int f = 0; f < 6; ++f)
+                task->neighbors[f] = grid_.Chunk(physics::PackChunkKey(c[0] + kDir[f][0], c[1] + kDir[f][1], c[2] + kDir[f][2]));
+        }
+        Task* t = task.get();
+        inFlight_.insert(key);
+        tasks_.push_back(std::move(task));
+        jobs::Run([t] {
+            if (t->chunk) {
+                const physics::VoxelChunk* neighbors[6];
+                for (int f = 0; f < 6; ++f) neighbors[f] = t->neighbors[f].get();
+                MeshVoxelChunk(*t->chunk, neighbors, t->lod, t->mesh);
+            }
+            t->done.store(true, std::memory_order_release);
+        }, &counter_);
+    }
+}
+
+void VoxelRemesher::Update(const float camera[3])
+{
+    DC_PROFILE_ZONE("VoxelRemesher::Update");
+    Collect();
+    grid_.TakeDirty(dirty_);
+    pending_.insert(dirty_.begin(), dirty_.end());
+
+    // LOD пересматривается, когда камера ушла на четверть порога
+    float moved = 0;
+    for (int a = 0; a < 3; ++a) moved += (camera[a] - lodCamera_[a]) * (camera[a] - lodCamera_[a]);
+    if (!lodValid_ || moved >= settings_.lodDistance * settings_.lodDistance / 16) {
+        for (const auto& [key, mesh] : meshes_)
+            if (mesh.lod != LodFor(key, camera)) pending_.insert(key);
+        std::copy(camera, camera + 3, lodCamera_);
+        lodValid_ = true;
+    }
+    Dispatch(camera);
+}
+
+void VoxelRemesher::Flush()
+{
+    DC_PROFILE_ZONE("VoxelRemesher::Flush");
+    grid_.TakeDirty(dirty_);
+    pending_.insert(dirty_.begin(), dirty_.end());
+    while (!pending_.empty() || !tasks_.empty()) {
+        Dispatch(lodCamera_); // до первого Update — от начала координат
+        jobs::Wait(counter_);
+        Collect();
+    }
+}
+
+} // namespace dancore::graphics
@@ -0,0 +1,73 @@
+#pragma once
+#include "VoxelMesher.hpp"
+#include "core/JobSystem.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Инкрементальное перемешивание VoxelGrid в job system.
+//
+// Каждый кадр Update() забирает у сетки грязные чанки, пересчитывает LOD по расстоянию
+// до камеры и ставит задачи мешинга, ближние первыми. Задача держит shared_ptr на чанк
+// и соседей, поэтому правки сетки во время мешинга её не задевают (копия при записи).
+// Готовые меши подхватываются следующим Update(); пока чанк в работе, новая задача для
+// него не ставится — результаты не обгоняют друг друга. Только главный поток; грязные
+// чанки сетки забирает только этот объект.
+
+namespace dancore::graphics {
+
+struct VoxelRemeshSettings {
+    float lodDistance = 128.0f;      // до этого расстояния (в вокселях) — LOD 0, дальше удвоение на уровень
+    int maxLod = 3;
+    size_t maxInFlight = 256;        // задач одновременно; остальное ждёт следующих кадров
+};
+
+class VoxelRemesher {
+public:
+    explicit VoxelRemesher(physics::VoxelGrid& grid, VoxelRemeshSettings settings = {});
+    ~VoxelRemesher();                // дожидается задач
+    VoxelRemesher(const VoxelRemesher&) = delete;
+    VoxelRemesher& operator=(const VoxelRemesher&) = delete;
+
+    void Update(const float camera[3]);
+    // Дождаться всего поставленного и собрать результаты (загрузка сцены, бенчмарк)
+    void Flush();
+
+    const VoxelMesh* Mesh(physics::VoxelChunkKey key) const;
+    size_t MeshCount() const { return meshes_.size(); }
+    // Чанки, чей меш обновился или пропал (Mesh() == nullptr), с прошлого вызова
+    void TakeUpdated(std::vector<physics::VoxelChunkKey>& out);
+    size_t Pending() const { return pending_.size() + tasks_.size(); }
+    int LodFor(physics::VoxelChunkKey key, const float camera[3]) const;
+
+private:
+    struct Task {
+        physics::VoxelChunkKey key = 0;
+        int lod = 0;
+        std::shared_ptr<const physics::VoxelChunk> chunk; // nullptr — чанк удалён
+        std::shared_ptr<const physics::VoxelChunk> neighbors[6];
+        VoxelMesh mesh;
+        std::atomic<bool> done{false};
+    };
+
+    void Collect();
+    void Dispatch(const float camera[3]);
+
+    physics::VoxelGrid& grid_;
+    VoxelRemeshSettings settings_;
+    std::unordered_map<physics::VoxelChunkKey, VoxelMesh> meshes_;
+    std::unordered_set<physics::VoxelChunkKey> pending_;
+    std::unordered_set<physics::VoxelChunkKey> inFlight_;
+    std::unordered_set<physics::VoxelChunkKey> updated_;
+    std::vector<std::unique_ptr<Task>> tasks_;
+    std::vector<physics::VoxelChunkKey> dirty_;
+    core::jobs::JobCounter counter_;
+    float lodCamera_[3] = {};        // где камера была при последней проверке LOD
+    bool lodValid_ = false;
+};
+
+} // namespace dancore::graphics
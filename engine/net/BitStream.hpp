@@ -0,0 +1,126 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Побитовая упаковка пакетов: младшие биты первыми, накопитель 64 бита, в буфер — по 32 бита
+// (little-endian). Чтение за концом буфера даёт нули и ставит Overflow() — разбор пакета
+// проверяет его один раз в конце, а не на каждом поле.
+
+namespace dancore::net {
+
+// Сколько бит нужно для значений 0..maxValue
+constexpr uint32_t BitsFor(uint32_t maxValue) { return maxValue ? uint32_t(std::bit_width(maxValue)) : 1; }
+
+class BitWriter {
+public:
+    // capacity — в байтах, кратно 4
+    BitWriter(unsigned char* data, size_t capacity) : data_(data), capacity_(capacity) {}
+
+    void Write(uint32_t value, uint32_t bits)
+    {
+        scratch_ |= uint64_t(value & Mask(bits)) << scratchBits_;
+        scratchBits_ += bits;
+        bits_ += bits;
+        if (scratchBits_ >= 32) {
+            if (word_ + 4 <= capacity_) Store(uint32_t(scratch_));
+            else overflow_ = true;
+            word_ += 4;
+            scratch_ >>= 32;
+            scratchBits_ -= 32;
+        }
+    }
+    void WriteBool(bool value) { Write(value ? 1 : 0, 1); }
+
+    // Небольшие числа: 0 — один бит, иначе 1 + 5 бит длины + значение без старшей единицы
+    void WriteVar(uint32_t value)
+    {
+        if (!value) { Write(0, 1); return; }
+        const uint32_t n = std::bit_width(value);
+        Write(1, 1);
+        Write(n - 1, 5);
+        if (n > 1) Write(value, n - 1);
+    }
+    static uint32_t VarBits(uint32_t value)
+    {
+        return value ? 6 + uint32_t(std::bit_width(value)) - 1 : 1;
+    }
+
+    // Дописать хвост; возвращает размер в байтах
+    size_t Flush()
+    {
+        if (scratchBits_) {
+            const size_t bytes = (scratchBits_ + 7) / 8;
+            if (word_ + bytes <= capacity_)
+                for (size_t i = 0; i < bytes; ++i) data_[word_ + i] = (unsigned char)(scratch_ >> (i * 8));
+            else
+                overflow_ = true;
+            word_ += bytes;
+            scratch_ = 0;
+            scratchBits_ = 0;
+        }
+        return word_;
+    }
+
+    uint32_t Bits() const { return bits_; }
+    bool Overflow() const { return overflow_; }
+
+private:
+    static uint32_t Mask(uint32_t bits) { return bits >= 32 ? ~0u : (1u << bits) - 1; }
+    void Store(uint32_t v)
+    {
+        for (int i = 0; i < 4; ++i) data_[word_ + i] = (unsigned char)(v >> (i * 8));
+    }
+
+    unsigned char* data_;
+    size_t capacity_;
+    size_t word_ = 0;
+    uint64_t scratch_ = 0;
+    uint32_t scratchBits_ = 0;
+    uint32_t bits_ = 0;
+    bool overflow_ = false;
+};
+
+class BitReader {
+public:
+    BitReader(const unsigned char* data, size_t size) : data_(data), size_(size) {}
+
+    uint32_t Read(uint32_t bits)
+    {
+        if (scratchBits_ < bits) {
+            uint64_t v = 0;
+            for (size_t i = 0; i < 4 && byte_ + i < size_; ++i) v |= uint64_t(data_[byte_ + i]) << (i * 8);
+            scratch_ |= v << scratchBits_;
+            scratchBits_ += 32;
+            byte_ += 4;
+        }
+        consumed_ += bits;
+        if (consumed_ > size_ * 8) overflow_ = true;
+        const uint32_t r = uint32_t(scratch_ & (bits >= 32 ? 0xffffffffull : (1ull << bits) - 1));
+        scratch_ >>= bits;
+        scratchBits_ -= bits;
+        return r;
+    }
+    bool ReadBool() { return Read(1) != 0; }
+
+    uint32_t ReadVar()
+    {
+        if (!Read(1)) return 0;
+        const uint32_t n = Read(5) + 1;
+        return n > 1 ? (1u << (n - 1)) | Read(n - 1) : 1;
+    }
+
+    bool Overflow() const { return overflow_; }
+
+private:
+    const unsigned char* data_;
+    size_t size_;
+    size_t byte_ = 0;
+    size_t consumed_ = 0;
+    uint64_t scratch_ = 0;
+    uint32_t scratchBits_ = 0;
+    bool overflow_ = false;
+};
+
+} // namespace dancore::net
@@ -0,0 +1,824 @@
+#include "Replication.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "BitStream.hpp"
+#include "core/Hash.hpp"
+#include "core/JobSystem.hpp"
+#include "core/Log.hpp"
+#include "core/Profiler.hpp"
+#include "core/SceneComponents.hpp"
+
+namespace dancore::net {
+
+using namespace core::ecs;
+namespace prof = core::profiler;
+
+namespace {
+
+// Пакеты: тип (8 бит), дальше по типу
+//   Hello:    хэш схемы (64)
+//   Snapshot: номер (16), тик (32), записей (16), записи
+//   Ack:      старший принятый номер (16), маска 64 предыдущих (64)
+//   Bye
+enum PacketType : uint32_t { kHello = 1, kSnapshot = 2, kAck = 3, kBye = 4 };
+
+constexpr uint32_t kHistory = 256;           // пакетов помнят обе стороны; разность номеров — 8 бит
+constexpr uint32_t kMaxPacketsPerTick = 16;
+constexpr uint32_t kBaselineWindow = kHistory - kMaxPacketsPerTick; // база не старее, чтобы разность влезла
+constexpr uint32_t kHeaderBits = 8 + 16 + 32 + 16;
+constexpr uint32_t kMaxWords = 256;
+constexpr uint32_t kMaxSchemaComponents = 32;
+
+double Ms(prof::Clock begin) { return double(prof::Now() - begin) / 1e6; }
+
+uint32_t LowMask(uint32_t bits) { return bits >= 32 ? ~0u : (1u << bits) - 1; }
+
+// Номер пакета из младших 16 бит: ближайший к reference
+uint32_t ExtendSequence(uint32_t reference, uint32_t low16)
+{
+    return reference + uint32_t(int32_t(int16_t(uint16_t(low16 - reference))));
+}
+
+// Счётчик бит с интерфейсом BitWriter: размер записи без самой записи
+struct BitCounter {
+    uint32_t bits = 0;
+    void Write(uint32_t, uint32_t n) { bits += n; }
+    void WriteVar(uint32_t v) { bits += BitWriter::VarBits(v); }
+};
+
+template <class Out>
+void WriteField(Out& out, const ReplicationSchema::Field& f, uint32_t value, uint32_t base)
+{
+    if (value == base) { out.Write(0, 1); return; }
+    out.Write(1, 1);
+    if (f.smallBits) {
+        const uint32_t shift = 32 - f.bits;
+        const int32_t d = int32_t(((value - base) & LowMask(f.bits)) << shift) >> shift;
+        const uint32_t zigzag = uint32_t(d << 1) ^ uint32_t(d >> 31);
+        if (zigzag < (1u << f.smallBits)) {
+            out.Write(0, 1);
+            out.Write(zigzag, f.smallBits);
+            return;
+        }
+        out.Write(1, 1);
+    }
+    out.Write(value, f.bits);
+}
+
+uint32_t ReadField(BitReader& in, const ReplicationSchema::Field& f, uint32_t base)
+{
+    if (!in.ReadBool()) return base;
+    if (f.smallBits && !in.ReadBool()) {
+        const uint32_t zigzag = in.Read(f.smallBits);
+        const uint32_t d = (zigzag >> 1) ^ (0u - (zigzag & 1));
+        return (base + d) & LowMask(f.bits);
+    }
+    return in.Read(f.bits);
+}
+
+// Запись сущности после индекса. Без базы (новая сущность или база потеряна) компоненты
+// кодируются разностью от значений по умолчанию: нулевые байты имени стоят по биту
+struct Baseline {
+    uint32_t delta = 0;       // номер пакета - номер пакета базы
+    uint32_t mask = 0;
+    const uint32_t* words = nullptr;
+};
+
+template <class Out>
+void WriteEntity(Out& out, const ReplicationSchema& schema, uint32_t generation, uint32_t mask, const uint32_t* words,
+                 const Baseline* base)
+{
+    const auto& components = schema.Components();
+    const auto& fields = schema.Fields();
+    const uint32_t maskBits = uint32_t(components.size());
+    out.Write(generation ? 0 : 1, 1);
+    if (!generation) return;
+    if (base) {
+        out.Write(1, 1);
+        out.Write(base->delta, 8);
+        if (mask == base->mask) out.Write(0, 1);
+        else { out.Write(1, 1); out.Write(mask, maskBits); }
+    } else {
+        out.Write(0, 1);
+        out.WriteVar(generation);
+        out.Write(mask, maskBits);
+    }
+    for (uint32_t m = mask; m; m &= m - 1) {
+        const auto& c = components[std::countr_zero(m)];
+        const uint32_t* v = words + c.firstField;
+        const uint32_t* b = (base && (base->mask & (m & (0u - m))) ? base->words : schema.Defaults().data())
+                            + c.firstField;
+        if (!std::memcmp(v, b, c.fieldCount * sizeof(uint32_t))) { out.Write(0, 1); continue; }
+        out.Write(1, 1);
+        for (uint32_t f = 0; f < c.fieldCount; ++f) WriteField(out, fields[c.firstField + f], v[f], b[f]);
+    }
+}
+
+} // namespace
+
+// ---- схема ----
+
+ReplicationSchema& ReplicationSchema::Add(ComponentId id, uint32_t size, const Field& field)
+{
+    if (components_.size() == kMaxSchemaComponents)
+        throw std::runtime_error("ReplicationSchema: more than 32 replicated components");
+    if ((mask_ >> id) & 1) throw std::runtime_error("ReplicationSchema: component replicated twice");
+    Component c;
+    c.id = id;
+    c.size = size;
+    c.firstField = uint32_t(fields_.size());
+    c.fieldCount = (size + 3) / 4;
+    if (c.firstField + c.fieldCount > kMaxWords) throw std::runtime_error("ReplicationSchema: record too large");
+    fields_.insert(fields_.end(), c.fieldCount, field);
+    components_.push_back(c);
+    mask_ |= ComponentMask(1) << id;
+    defaults_.resize(fields_.size());
+    Quantize(uint32_t(components_.size() - 1), GetComponentInfo(id).defaultValue.data(), &defaults_[c.firstField]);
+    return *this;
+}
+
+ReplicationSchema& ReplicationSchema::AddFloats(ComponentId id, uint32_t size, float min, float max, float precision,
+                                                uint32_t smallBits)
+{
+    if (!(max > min) || !(precision > 0)) throw std::runtime_error("ReplicationSchema: bad float range");
+    const double steps = std::ceil(double(max - min) / precision);
+    if (steps >= double(1u << 31)) throw std::runtime_error("ReplicationSchema: float range needs more than 31 bits");
+    Field f;
+    f.kind = FieldKind::Float;
+    f.bits = uint8_t(BitsFor(uint32_t(steps)));
+    f.smallBits = uint8_t(std::min<uint32_t>(smallBits ? smallBits : std::max(4, (f.bits + 2) / 3), f.bits - 1));
+    f.min = min;
+    f.step = float(double(max - min) / steps);
+    return Add(id, size, f);
+}
+
+ReplicationSchema& ReplicationSchema::AddAngles(ComponentId id, uint32_t size, uint32_t bits, uint32_t smallBits)
+{
+    if (bits < 2 || bits > 31) throw std::runtime_error("ReplicationSchema: angle bits must be 2..31");
+    Field f;
+    f.kind = FieldKind::Angle;
+    f.bits = uint8_t(bits);
+    f.smallBits = uint8_t(std::min(smallBits ? smallBits : (bits + 1) / 2, bits - 1));
+    f.step = 360.0f / float(1u << bits);
+    return Add(id, size, f);
+}
+
+ReplicationSchema& ReplicationSchema::AddBytes(ComponentId id, uint32_t size)
+{
+    return Add(id, size, Field{});
+}
+
+uint64_t ReplicationSchema::Hash() const
+{
+    uint64_t h = core::HashCombine(0, components_.size());
+    for (const Component& c : components_) h = core::HashCombine(h, uint64_t(c.size) << 32 | c.fieldCount);
+    for (const Field& f : fields_) {
+        uint32_t range[2];
+        std::memcpy(&range[0], &f.min, 4);
+        std::memcpy(&range[1], &f.step, 4);
+        h = core::HashCombine(h, uint64_t(f.kind) | uint64_t(f.bits) << 8 | uint64_t(f.smallBits) << 16);
+        h = core::HashCombine(h, uint64_t(range[0]) << 32 | range[1]);
+    }
+    return h;
+}
+
+void ReplicationSchema::Quantize(uint32_t component, const void* value, uint32_t* words) const
+{
+    const Component& c = components_[component];
+    const auto* p = static_cast<const unsigned char*>(value);
+    for (uint32_t i = 0; i < c.fieldCount; ++i) {
+        const Field& f = fields_[c.firstField + i];
+        if (f.kind == FieldKind::Raw) {
+            uint32_t w = 0;
+            std::memcpy(&w, p + i * 4, std::min<uint32_t>(4, c.size - i * 4));
+            words[i] = w;
+            continue;
+        }
+        float v;
+        std::memcpy(&v, p + i * 4, 4);
+        if (f.kind == FieldKind::Float) {
+            float q = (v - f.min) / f.step;
+            if (!(q >= 0)) q = 0; // и NaN
+            words[i] = uint32_t(std::min(std::lround(q), long(LowMask(f.bits))));
+        } else {
+            double t = double(v) / 360.0;
+            t -= std::floor(t);
+            words[i] = uint32_t(std::llround(t * double(1u << f.bits))) & LowMask(f.bits);
+        }
+    }
+}
+
+void ReplicationSchema::Dequantize(uint32_t component, const uint32_t* words, void* value) const
+{
+    const Component& c = components_[component];
+    auto* p = static_cast<unsigned char*>(value);
+    for (uint32_t i = 0; i < c.fieldCount; ++i) {
+        const Field& f = fields_[c.firstField + i];
+        if (f.kind == FieldKind::Raw) {
+            std::memcpy(p + i * 4, &words[i], std::min<uint32_t>(4, c.size - i * 4));
+            continue;
+        }
+        const float v = f.kind == FieldKind::Float ? f.min + float(words[i]) * f.step : float(words[i]) * f.step;
+        std::memcpy(p + i * 4, &v, 4);
+    }
+}
+
+ReplicationSchema SceneReplicationSchema()
+{
+    using namespace core::scene;
+    ReplicationSchema schema;
+    schema.Bytes<Name>()
+        .Floats<Position>(-4096.0f, 4096.0f, 1.0f / 512)
+        .Angles<Rotation>(12)
+        .Floats<Scale>(0.0f, 256.0f, 1.0f / 1024)
+        .Bytes<PhysicsBody>();
+    return schema;
+}
+
+// ---- сервер ----
+
+// Что ушло в пакете: по записи на сущность, база для следующих разностей после подтверждения
+struct ReplicationServer::Sent {
+    uint32_t seq = 0; // 0 — пусто
+    uint32_t tick = 0;
+    bool acked = false;
+    std::vector<uint32_t> index, generation, mask;
+    std::vector<uint32_t> words;
+};
+
+struct ReplicationServer::Client {
+    NetAddress address;
+    uint32_t lastHeard = 0;
+    uint32_t seq = 0;                 // последний отправленный пакет
+    float allowance = 0;              // байт можно отправить (копится тиками)
+    // подтверждённое клиентом, по индексу сущности
+    std::vector<uint32_t> ackedSeq, ackedTick, ackedGeneration;
+    std::vector<uint16_t> ackedSlot;
+    std::vector<float> priority;
+    std::array<Sent, kHistory> sent;
+    struct Candidate { float priority; uint32_t index; uint32_t bits; uint32_t packet; };
+    std::vector<Candidate> candidates;
+    std::vector<Datagram> out;
+    uint32_t pending = 0, entities = 0;
+    uint64_t bytes = 0;
+};
+
+ReplicationServer::ReplicationServer(ReplicationSchema schema, const ReplicationSettings& settings)
+    : schema_(std::move(schema)), settings_(settings)
+{
+    if (schema_.Components().empty()) throw std::runtime_error("ReplicationServer: empty schema");
+    settings_.packetBytes = std::clamp<uint32_t>(settings_.packetBytes, 64, kMaxDatagram);
+    settings_.tickRate = std::max(settings_.tickRate, 1u);
+}
+
+ReplicationServer::~ReplicationServer() = default;
+
+void ReplicationServer::Receive(const Datagram* datagrams, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const Datagram& d = datagrams[i];
+        BitReader in(d.data, d.size);
+        const uint32_t type = in.Read(8);
+        auto it = std::find_if(clients_.begin(), clients_.end(),
+                               [&](const auto& c) { return c->address == d.address; });
+        Client* client = it != clients_.end() ? it->get() : nullptr;
+        if (type == kHello) {
+            const uint64_t hash = in.Read(32) | uint64_t(in.Read(32)) << 32;
+            if (in.Overflow()) continue;
+            if (hash != schema_.Hash()) {
+                DC_LOG_WARN(Net, "{}: replication schema mismatch, connection refused", ToString(d.address));
+                continue;
+            }
+            if (!client) {
+                if (clients_.size() >= settings_.maxClients) continue;
+                clients_.push_back(std::make_unique<Client>());
+                client = clients_.back().get();
+                client->address = d.address;
+                client->allowance = float(settings_.packetBytes);
+                DC_LOG_INFO(Net, "client {} connected ({} total)", ToString(d.address), clients_.size());
+            }
+            client->lastHeard = tick_;
+        } else if (type == kAck && client) {
+            const uint32_t latest = in.Read(16);
+            const uint64_t bits = in.Read(32) | uint64_t(in.Read(32)) << 32;
+            if (in.Overflow()) continue;
+            client->lastHeard = tick_;
+            const uint32_t seq = client->seq - uint16_t(uint16_t(client->seq) - latest);
+            Acknowledge(*client, seq);
+            for (uint64_t b = bits; b; b &= b - 1) Acknowledge(*client, seq - 1 - uint32_t(std::countr_zero(b)));
+        } else if (type == kBye && client) {
+            DC_LOG_INFO(Net, "client {} disconnected", ToString(d.address));
+            clients_.erase(it);
+        }
+    }
+}
+
+void ReplicationServer::Acknowledge(Client& client, uint32_t seq)
+{
+    Sent& s = client.sent[seq % kHistory];
+    if (!seq || s.seq != seq || s.acked) return;
+    s.acked = true;
+    for (uint32_t i = 0; i < s.index.size(); ++i) {
+        const uint32_t e = s.index[i];
+        if (client.ackedSeq[e] >= seq) continue; // уже подтверждено более новое
+        client.ackedSeq[e] = seq;
+        client.ackedSlot[e] = uint16_t(i);
+        client.ackedTick[e] = s.tick;
+        client.ackedGeneration[e] = s.generation[i];
+    }
+}
+
+void ReplicationServer::Tick(World& world)
+{
+    DC_PROFILE_ZONE("Replication::Tick");
+    ++tick_;
+    prof::Clock t = prof::Now();
+    Capture(world);
+    stats_.snapshotMs = Ms(t);
+
+    for (size_t i = 0; i < clients_.size();) {
+        if (tick_ - clients_[i]->lastHeard > settings_.timeoutTicks) {
+            DC_LOG_INFO(Net, "client {} timed out", ToString(clients_[i]->address));
+            clients_.erase(clients_.begin() + i);
+        } else {
+            ++i;
+        }
+    }
+
+    t = prof::Now();
+    core::jobs::ParallelFor(0, clients_.size(), 1, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) Build(*clients_[i]);
+    });
+    size_t total = 0;
+    for (const auto& c : clients_) total += c->out.size();
+    outgoing_.resize(total);
+    stats_.clients = uint32_t(clients_.size());
+    stats_.pending = stats_.sent = stats_.packets = 0;
+    stats_.bytes = 0;
+    size_t n = 0;
+    for (const auto& c : clients_) {
+        for (const Datagram& d : c->out) {
+            Datagram& o = outgoing_[n++];
+            o.address = d.address;
+            o.size = d.size;
+            std::memcpy(o.data, d.data, d.size);
+            stats_.bytes += d.size;
+        }
+        stats_.pending += c->pending;
+        stats_.sent += c->entities;
+        stats_.packets += uint32_t(c->out.size());
+    }
+    stats_.encodeMs = Ms(t);
+    stats_.totalBytes += stats_.bytes;
+    stats_.totalPackets += stats_.packets;
+    stats_.totalSent += stats_.sent;
+}
+
+// Квантует чанки, где с прошлого тика что-то писали, и находит исчезнувшие сущности
+void ReplicationServer::Capture(World& world)
+{
+    DC_PROFILE_ZONE("Replication::Capture");
+    const auto& components = schema_.Components();
+    const uint32_t W = schema_.Words();
+    const ComponentId priorityId = ComponentIdOf<NetPriority>();
+
+    struct Item { const Archetype* a; uint32_t chunk; uint32_t mask; };
+    std::vector<Item> dirty;
+    uint32_t capacity = capacity_, chunks = 0;
+    bool structural = false;
+    for (const Archetype* a : world.Archetypes()) {
+        if (!(a->mask & schema_.Mask())) continue;
+        uint32_t mask = 0;
+        for (uint32_t c = 0; c < components.size(); ++c)
+            if ((a->mask >> components[c].id) & 1) mask |= 1u << c;
+        for (uint32_t i = 0; i < a->chunks.size(); ++i) {
+            const Chunk& chunk = a->chunks[i];
+            if (!chunk.count) continue;
+            ++chunks;
+            const uint32_t* v = a->Versions(i);
+            bool changed = v[0] >= since_;
+            structural |= changed;
+            for (uint32_t m = mask; m && !changed; m &= m - 1)
+                changed = v[1 + a->column[components[std::countr_zero(m)].id]] >= since_;
+            if (a->offset[priorityId] != ~0u) changed |= v[1 + a->column[priorityId]] >= since_;
+            if (!changed) continue;
+            const Entity* entities = a->Entities(chunk);
+            for (uint32_t r = 0; r < chunk.count; ++r)
+                if (entities[r].index < settings_.maxEntities) capacity = std::max(capacity, entities[r].index + 1);
+            dirty.push_back({a, i, mask});
+        }
+    }
+    if (capacity > capacity_) {
+        capacity_ = capacity;
+        generation_.resize(capacity, 0);
+        mask_.resize(capacity, 0);
+        words_.resize(size_t(capacity) * W, 0);
+        changed_.resize(capacity, 0);
+        weight_.resize(capacity, 1.0f);
+    }
+
+    std::atomic<uint32_t> changedCount{0};
+    core::jobs::ParallelFor(0, dirty.size(), 1, [&](size_t b, size_t e) {
+        uint32_t record[kMaxWords];
+        uint32_t n = 0;
+        for (size_t i = b; i < e; ++i) {
+            const Item& it = dirty[i];
+            const Chunk& chunk = it.a->chunks[it.chunk];
+            const Entity* entities = it.a->Entities(chunk);
+            const auto* priority = it.a->offset[priorityId] != ~0u
+                                       ? static_cast<const NetPriority*>(it.a->Column(chunk, priorityId)) : nullptr;
+            for (uint32_t r = 0; r < chunk.count; ++r) {
+                const uint32_t index = entities[r].index;
+                if (index >= settings_.maxEntities) continue; // клиенты такой индекс не примут
+                std::memset(record, 0, W * sizeof(uint32_t));
+                for (uint32_t m = it.mask; m; m &= m - 1) {
+                    const uint32_t c = std::countr_zero(m);
+                    const auto* column = static_cast<const unsigned char*>(it.a->Column(chunk, components[c].id));
+                    schema_.Quantize(c, column + size_t(components[c].size) * r, record + components[c].firstField);
+                }
+                uint32_t* current = &words_[size_t(index) * W];
+                if (generation_[index] != entities[r].generation || mask_[index] != it.mask
+                    || std::memcmp(current, record, W * sizeof(uint32_t))) {
+                    generation_[index] = entities[r].generation;
+                    mask_[index] = it.mask;
+                    std::memcpy(current, record, W * sizeof(uint32_t));
+                    changed_[index] = tick_;
+                    ++n;
+                }
+                weight_[index] = priority ? std::max(priority[r].weight, 0.0f) : 1.0f;
+            }
+        }
+        changedCount += n;
+    });
+
+    // удалённые и потерявшие все реплицируемые компоненты: только если менялся состав чанков
+    if (structural || chunks != lastChunks_) {
+        for (uint32_t index = 0; index < capacity_; ++index) {
+            if (!generation_[index]) continue;
+            const Entity e{index, generation_[index]};
+            if (world.Alive(e) && (world.MaskOf(e) & schema_.Mask())) continue;
+            generation_[index] = 0;
+            mask_[index] = 0;
+            changed_[index] = tick_;
+            ++changedCount;
+        }
+    }
+    lastChunks_ = chunks;
+
+    // записи после этого снимка получат новую версию
+    since_ = world.Version() + 1;
+    world.AdvanceVersion();
+
+    uint32_t entities = 0;
+    for (uint32_t index = 0; index < capacity_; ++index) entities += generation_[index] != 0;
+    stats_.entities = entities;
+    stats_.changed = changedCount;
+    stats_.dirtyChunks = uint32_t(dirty.size());
+}
+
+// Пакеты одному клиенту: выбор по приоритету в пределах бюджета, затем запись по возрастанию индекса
+void ReplicationServer::Build(Client& client)
+{
+    const uint32_t W = schema_.Words();
+    if (client.priority.size() < capacity_) {
+        client.ackedSeq.resize(capacity_, 0);
+        client.ackedTick.resize(capacity_, 0);
+        client.ackedGeneration.resize(capacity_, 0);
+        client.ackedSlot.resize(capacity_, 0);
+        client.priority.resize(capacity_, 0.0f);
+    }
+    client.out.clear();
+    client.entities = 0;
+
+    const float perTick = float(settings_.bytesPerSecond) / float(settings_.tickRate);
+    client.allowance = std::min(client.allowance + perTick, std::max(2 * perTick, float(settings_.packetBytes)));
+
+    auto& candidates = client.candidates;
+    candidates.clear();
+    for (uint32_t e = 0; e < capacity_; ++e) {
+        const uint32_t g = generation_[e], known = client.ackedGeneration[e];
+        const bool need = g ? known != g || changed_[e] > client.ackedTick[e] : known != 0;
+        if (!need) continue;
+        client.priority[e] += g ? weight_[e] : 4.0f; // удаление дешёвое и освобождает индекс
+        candidates.push_back({client.priority[e], e, 0, 0});
+    }
+    client.pending = uint32_t(candidates.size());
+
+    const uint32_t budgetBits = uint32_t(client.allowance) * 8;
+    if (candidates.empty() || budgetBits < kHeaderBits + 8) return;
+
+    // окно баз считается от номера до этого тика: оценка размера и запись выбирают одну базу
+    const uint32_t firstSeq = client.seq;
+    auto baseline = [&](uint32_t e, uint32_t packetSeq, Baseline& out) -> bool {
+        const uint32_t seq = client.ackedSeq[e];
+        if (!seq || !generation_[e] || client.ackedGeneration[e] != generation_[e] || firstSeq - seq >= kBaselineWindow)
+            return false;
+        const Sent& s = client.sent[seq % kHistory];
+        if (s.seq != seq) return false;
+        const uint32_t slot = client.ackedSlot[e];
+        out.delta = packetSeq - seq;
+        out.mask = s.mask[slot];
+        out.words = &s.words[size_t(slot) * W];
+        return true;
+    };
+
+    // кандидаты по убыванию приоритета, сортируются порциями: в бюджет обычно влезает малая их часть
+    auto higher = [](const Client::Candidate& a, const Client::Candidate& b) {
+        return a.priority != b.priority ? a.priority > b.priority : a.index < b.index;
+    };
+    const size_t batch = std::max<size_t>(32, budgetBits / 64);
+    size_t sorted = 0;
+
+    const uint32_t packetBits = settings_.packetBytes * 8;
+    const uint32_t indexBits = BitWriter::VarBits(capacity_);
+    uint32_t total = kHeaderBits, current = kHeaderBits, packets = 1, chosen = 0, misses = 0;
+    for (size_t i = 0; i < candidates.size() && misses < 8; ++i) {
+        if (i == sorted) {
+            const auto first = candidates.begin() + sorted;
+            const size_t n = std::min(batch, candidates.size() - sorted);
+            if (n < candidates.size() - sorted) std::nth_element(first, first + n, candidates.end(), higher);
+            std::sort(first, first + n, higher);
+            sorted += n;
+        }
+        Client::Candidate& c = candidates[i];
+        const uint32_t e = c.index;
+        Baseline base;
+        BitCounter counter;
+        const bool hasBase = baseline(e, client.seq + 1, base);
+        WriteEntity(counter, schema_, generation_[e], mask_[e], &words_[size_t(e) * W], hasBase ? &base : nullptr);
+        const uint32_t bits = counter.bits + indexBits;
+        const bool fresh = current + bits > packetBits;
+        const uint32_t cost = bits + (fresh ? kHeaderBits : 0);
+        if (total + cost > budgetBits || (fresh && packets == kMaxPacketsPerTick) || kHeaderBits + bits > packetBits) {
+            ++misses;
+            continue;
+        }
+        if (fresh) { ++packets; current = kHeaderBits; }
+        current += bits;
+        total += cost;
+        c.bits = bits;
+        c.packet = packets - 1;
+        candidates[chosen++] = c;
+    }
+    if (!chosen) return;
+    std::sort(candidates.begin(), candidates.begin() + chosen, [](const auto& a, const auto& b) {
+        return a.packet != b.packet ? a.packet < b.packet : a.index < b.index;
+    });
+
+    for (uint32_t begin = 0; begin < chosen;) {
+        uint32_t end = begin;
+        while (end < chosen && candidates[end].packet == candidates[begin].packet) ++end;
+        const uint32_t seq = ++client.seq;
+        Sent& s = client.sent[seq % kHistory];
+        s.seq = seq;
+        s.tick = tick_;
+        s.acked = false;
+        s.index.clear();
+        s.generation.clear();
+        s.mask.clear();
+        s.words.clear();
+
+        Datagram& d = client.out.emplace_back();
+        d.address = client.address;
+        BitWriter out(d.data, kMaxDatagram);
+        out.Write(kSnapshot, 8);
+        out.Write(seq, 16);
+        out.Write(tick_, 32);
+        out.Write(end - begin, 16);
+        uint32_t previous = ~0u;
+        for (uint32_t i = begin; i < end; ++i) {
+            const uint32_t e = candidates[i].index;
+            Baseline base;
+            const bool hasBase = baseline(e, seq, base);
+            const uint32_t* words = &words_[size_t(e) * W];
+            out.WriteVar(e - previous - 1);
+            previous = e;
+            WriteEntity(out, schema_, generation_[e], mask_[e], words, hasBase ? &base : nullptr);
+            s.index.push_back(e);
+            s.generation.push_back(generation_[e]);
+            s.mask.push_back(mask_[e]);
+            s.words.insert(s.words.end(), words, words + W);
+            client.priority[e] = 0;
+        }
+        d.size = uint32_t(out.Flush());
+        client.allowance -= float(d.size);
+        client.bytes += d.size;
+        client.entities += end - begin;
+        begin = end;
+    }
+}
+
+// ---- клиент ----
+
+// Принятый пакет: записи по возрастанию индекса
+struct ReplicationClient::Received {
+    uint32_t seq = 0;
+    uint32_t tick = 0;
+    std::vector<uint32_t> index, generation, mask;
+    std::vector<uint32_t> words;
+};
+
+ReplicationClient::ReplicationClient(ReplicationSchema schema, const ReplicationSettings& settings)
+    : schema_(std::move(schema)), maxEntities_(std::min(settings.maxEntities, 1u << 31)), history_(kHistory + 1)
+{
+    if (schema_.Components().empty()) throw std::runtime_error("ReplicationClient: empty schema");
+}
+
+ReplicationClient::~ReplicationClient() = default;
+
+void ReplicationClient::Connect(const NetAddress& server)
+{
+    server_ = server;
+    connected_ = false;
+    latest_ = 0;
+    ackBits_ = 0;
+    ackPending_ = false;
+    for (Received& r : history_) r.seq = 0;
+}
+
+Entity ReplicationClient::Find(uint32_t serverIndex) const
+{
+    return serverIndex < local_.size() ? local_[serverIndex] : Entity{};
+}
+
+void ReplicationClient::Receive(const Datagram* datagrams, size_t count, World& world)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const Datagram& d = datagrams[i];
+        if (!(d.address == server_)) continue;
+        if (!Decode(d, world)) ++stats_.rejected;
+    }
+}
+
+bool ReplicationClient::Decode(const Datagram& d, World& world)
+{
+    const auto& components = schema_.Components();
+    const auto& fields = schema_.Fields();
+    const uint32_t W = schema_.Words();
+    const uint32_t maskBits = uint32_t(components.size());
+
+    BitReader in(d.data, d.size);
+    if (in.Read(8) != kSnapshot) return true;
+    const uint32_t low = in.Read(16);
+    const uint32_t tick = in.Read(32);
+    const uint32_t count = in.Read(16);
+    if (in.Overflow()) return false;
+    const uint32_t seq = connected_ ? ExtendSequence(latest_, low) : low;
+    if (!seq) return false;
+    Received& slot = history_[seq % kHistory];
+    if (slot.seq == seq) { ackPending_ = true; return true; } // повтор
+
+    // разбираем в запасной элемент: неразобранный пакет не должен затереть базу
+    Received& r = history_[kHistory];
+    r.seq = seq;
+    r.tick = tick;
+    r.index.clear();
+    r.generation.clear();
+    r.mask.clear();
+    r.words.resize(size_t(count) * W);
+    uint32_t index = ~0u;
+    for (uint32_t n = 0; n < count; ++n) {
+        index += in.ReadVar() + 1;
+        uint32_t* words = &r.words[size_t(n) * W];
+        std::memset(words, 0, W * sizeof(uint32_t));
+        uint32_t generation = 0, mask = 0;
+        const uint32_t* base = nullptr;
+        uint32_t baseMask = 0;
+        if (!in.ReadBool()) {
+            if (in.ReadBool()) {
+                const uint32_t baseSeq = seq - in.Read(8);
+                const Received& b = history_[baseSeq % kHistory];
+                if (b.seq != baseSeq) return false;
+                auto it = std::lower_bound(b.index.begin(), b.index.end(), index);
+                if (it == b.index.end() || *it != index) return false;
+                const size_t at = size_t(it - b.index.begin());
+                generation = b.generation[at];
+                baseMask = b.mask[at];
+                base = &b.words[at * W];
+                mask = in.ReadBool() ? in.Read(maskBits) : baseMask;
+            } else {
+                generation = in.ReadVar();
+                mask = in.Read(maskBits);
+            }
+            for (uint32_t m = mask; m; m &= m - 1) {
+                const auto& c = components[std::countr_zero(m)];
+                uint32_t* v = words + c.firstField;
+                const uint32_t* b = (base && (baseMask & (m & (0u - m))) ? base : schema_.Defaults().data())
+                                    + c.firstField;
+                if (!in.ReadBool()) { std::memcpy(v, b, c.fieldCount * sizeof(uint32_t)); continue; }
+                for (uint32_t f = 0; f < c.fieldCount; ++f) v[f] = ReadField(in, fields[c.firstField + f], b[f]);
+            }
+        }
+        if (in.Overflow() || index >= maxEntities_ || (generation && !mask)) return false;
+        r.index.push_back(index);
+        r.generation.push_back(generation);
+        r.mask.push_back(mask);
+    }
+    if (in.Overflow()) return false;
+
+    for (uint32_t n = 0; n < count; ++n)
+        Apply(world, r.index[n], r.generation[n], r.mask[n], &r.words[size_t(n) * W], tick);
+    std::swap(slot, r);
+
+    if (!connected_) {
+        connected_ = true;
+        latest_ = seq;
+        ackBits_ = 0;
+    } else if (seq > latest_) {
+        const uint32_t shift = seq - latest_;
+        ackBits_ = (shift < 64 ? ackBits_ << shift : 0) | (shift <= 64 ? 1ull << (shift - 1) : 0);
+        latest_ = seq;
+    } else if (latest_ - seq - 1 < 64) {
+        ackBits_ |= 1ull << (latest_ - seq - 1);
+    }
+    ackPending_ = true;
+    ++stats_.packets;
+    stats_.bytes += d.size;
+    stats_.entities += count;
+    stats_.tick = std::max(stats_.tick, tick);
+    return true;
+}
+
+void ReplicationClient::Apply(World& world, uint32_t index, uint32_t generation, uint32_t mask, const uint32_t* words,
+                              uint32_t tick)
+{
+    if (index >= local_.size()) {
+        local_.resize(index + 1);
+        generation_.resize(index + 1, 0);
+        applied_.resize(index + 1, 0);
+    }
+    if (applied_[index] > tick) { ++stats_.stale; return; }
+    applied_[index] = tick;
+    Entity& e = local_[index];
+    if (!generation) {
+        world.Destroy(e);
+        e = {};
+        generation_[index] = 0;
+        return;
+    }
+    const auto& components = schema_.Components();
+    ComponentMask want = 0;
+    for (uint32_t m = mask; m; m &= m - 1) want |= ComponentMask(1) << components[std::countr_zero(m)].id;
+    if (generation_[index] != generation || !world.Alive(e)) {
+        world.Destroy(e);
+        e = world.Create(want);
+        generation_[index] = generation;
+    } else {
+        const ComponentMask have = world.MaskOf(e) & schema_.Mask();
+        for (ComponentMask m = want & ~have; m; m &= m - 1) {
+            const ComponentId id = ComponentId(std::countr_zero(m));
+            world.AddRaw(e, id, GetComponentInfo(id).defaultValue.data());
+        }
+        for (ComponentMask m = have & ~want; m; m &= m - 1) world.RemoveRaw(e, ComponentId(std::countr_zero(m)));
+    }
+    for (uint32_t m = mask; m; m &= m - 1) {
+        const uint32_t c = std::countr_zero(m);
+        schema_.Dequantize(c, words + components[c].firstField, world.GetRaw(e, components[c].id));
+    }
+}
+
+void ReplicationClient::Flush(std::vector<Datagram>& out)
+{
+    if (!server_) return;
+    if (!connected_) {
+        Datagram& d = out.emplace_back();
+        d.address = server_;
+        BitWriter w(d.data, kMaxDatagram);
+        const uint64_t hash = schema_.Hash();
+        w.Write(kHello, 8);
+        w.Write(uint32_t(hash), 32);
+        w.Write(uint32_t(hash >> 32), 32);
+        d.size = uint32_t(w.Flush());
+    } else if (ackPending_) {
+        Datagram& d = out.emplace_back();
+        d.address = server_;
+        BitWriter w(d.data, kMaxDatagram);
+        w.Write(kAck, 8);
+        w.Write(latest_, 16);
+        w.Write(uint32_t(ackBits_), 32);
+        w.Write(uint32_t(ackBits_ >> 32), 32);
+        d.size = uint32_t(w.Flush());
+        ackPending_ = false;
+    }
+}
+
+void ReplicationClient::Disconnect(std::vector<Datagram>& out)
+{
+    if (!server_) return;
+    Datagram& d = out.emplace_back();
+    d.address = server_;
+    BitWriter w(d.data, kMaxDatagram);
+    w.Write(kBye, 8);
+    d.size = uint32_t(w.Flush());
+    server_ = {};
+    connected_ = false;
+}
+
+} // namespace dancore::net
@@ -0,0 +1,206 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "UdpSocket.hpp"
+#include "core/Ecs.hpp"
+
+// Репликация состояния мира снимками. Каждый тик сервер квантует реплицируемые компоненты
+// в плотный снимок (по индексу сущности), и каждому клиенту уходят только изменения
+// относительно того, что клиент подтвердил:
+//  - базой для сущности служит её последняя подтверждённая запись (номер пакета + место в нём);
+//    клиент хранит 256 последних принятых пакетов и находит ту же запись у себя;
+//  - поле — "не изменилось" (1 бит), малая разность со знаком или новое значение целиком;
+//    компонент без изменений — 1 бит, индексы сущностей — разности в порядке возрастания;
+//  - что не влезло в бюджет клиента (байт в секунду), копит приоритет и уходит в следующих
+//    тиках: сначала самые долго ждущие с наибольшим весом (NetPriority).
+// Чанки, у которых ни один реплицируемый массив не менялся с прошлого тика (версии ECS),
+// снимок пропускает; пакеты клиентам собираются параллельно (jobs::ParallelFor).
+//
+// Транспорт — датаграммы: вызывающий принимает их UdpSocket'ом в Receive, после Tick/Flush
+// отправляет Outgoing(). Всё — с одного потока.
+
+namespace dancore::net {
+
+// Вес сущности при выборе, кого отправить в этот тик (по умолчанию 1)
+struct NetPriority { float weight = 1.0f; };
+
+// Какие компоненты реплицируются и как квантуется каждое их 32-битное поле.
+// Сервер и клиент строят схему одинаково: порядок вызовов — номер компонента в протоколе.
+class ReplicationSchema {
+public:
+    enum class FieldKind : uint8_t { Float, Angle, Raw };
+    struct Field {
+        FieldKind kind = FieldKind::Raw;
+        uint8_t bits = 32;        // ширина квантованного значения
+        uint8_t smallBits = 0;    // ширина малой разности (зигзаг), 0 — только целиком
+        float min = 0, step = 1;  // Float: min + q * step
+    };
+    struct Component {
+        core::ecs::ComponentId id = 0;
+        uint32_t size = 0;
+        uint32_t firstField = 0, fieldCount = 0; // поле = 32-битное слово компонента
+    };
+
+    // Все float компонента: [min, max] с шагом precision, вне диапазона — прижимаются
+    template <class T> ReplicationSchema& Floats(float min, float max, float precision, uint32_t smallBits = 0)
+    {
+        static_assert(sizeof(T) % sizeof(float) == 0);
+        return AddFloats(core::ecs::ComponentIdOf<T>(), sizeof(T), min, max, precision, smallBits);
+    }
+    // Углы в градусах по модулю 360, bits на угол
+    template <class T> ReplicationSchema& Angles(uint32_t bits, uint32_t smallBits = 0)
+    {
+        static_assert(sizeof(T) % sizeof(float) == 0);
+        return AddAngles(core::ecs::ComponentIdOf<T>(), sizeof(T), bits, smallBits);
+    }
+    // Байты как есть (имена, флаги); изменённое слово уходит целиком
+    template <class T> ReplicationSchema& Bytes()
+    {
+        return AddBytes(core::ecs::ComponentIdOf<T>(), sizeof(T));
+    }
+
+    const std::vector<Component>& Components() const { return components_; }
+    const std::vector<Field>& Fields() const { return fields_; }
+    uint32_t Words() const { return uint32_t(fields_.size()); } // слов в записи сущности
+    const std::vector<uint32_t>& Defaults() const { return defaults_; } // запись из значений T{}
+    core::ecs::ComponentMask Mask() const { return mask_; }     // маска ECS всех компонентов схемы
+    uint64_t Hash() const;                                      // сверяется при подключении
+
+    // Квантование компонента в слова записи и обратно
+    void Quantize(uint32_t component, const void* value, uint32_t* words) const;
+    void Dequantize(uint32_t component, const uint32_t* words, void* value) const;
+
+private:
+    ReplicationSchema& AddFloats(core::ecs::ComponentId id, uint32_t size, float min, float max, float precision,
+                                 uint32_t smallBits);
+    ReplicationSchema& AddAngles(core::ecs::ComponentId id, uint32_t size, uint32_t bits, uint32_t smallBits);
+    ReplicationSchema& AddBytes(core::ecs::ComponentId id, uint32_t size);
+    ReplicationSchema& Add(core::ecs::ComponentId id, uint32_t size, const Field& field);
+
+    std::vector<Component> components_;
+    std::vector<Field> fields_;
+    std::vector<uint32_t> defaults_;
+    core::ecs::ComponentMask mask_ = 0;
+};
+
+// Name, Position (±4096 м, 1/512 м), Rotation (12 бит на угол), Scale, PhysicsBody
+ReplicationSchema SceneReplicationSchema();
+
+struct ReplicationSettings {
+    uint32_t tickRate = 30;
+    uint32_t bytesPerSecond = 64 * 1024;  // бюджет на клиента
+    uint32_t packetBytes = 1200;          // не больше kMaxDatagram
+    uint32_t maxClients = 64;
+    uint32_t timeoutTicks = 150;          // столько тиков без пакетов — клиент отключён
+    // Индексы сущностей не больше этого: сервер не реплицирует сущности дальше, клиент отбрасывает
+    // пакеты с такими индексами (адрес отправителя UDP подделывается, а по индексу растут массивы)
+    uint32_t maxEntities = 1u << 20;
+};
+
+struct ReplicationStats {
+    uint32_t clients = 0;
+    uint32_t entities = 0;        // реплицируемых в снимке
+    uint32_t changed = 0;         // изменились за тик
+    uint32_t dirtyChunks = 0;     // чанков прошло квантование (остальные пропущены по версиям)
+    uint32_t pending = 0;         // сущностей ждут отправки (сумма по клиентам)
+    uint32_t sent = 0;            // записей сущностей ушло за тик
+    uint32_t packets = 0;
+    uint64_t bytes = 0;           // полезная нагрузка за тик
+    double snapshotMs = 0, encodeMs = 0;
+    uint64_t totalBytes = 0, totalPackets = 0, totalSent = 0;
+};
+
+class ReplicationServer {
+public:
+    explicit ReplicationServer(ReplicationSchema schema, const ReplicationSettings& settings = {});
+    ~ReplicationServer();
+    ReplicationServer(const ReplicationServer&) = delete;
+    ReplicationServer& operator=(const ReplicationServer&) = delete;
+
+    // Подключения и подтверждения от клиентов
+    void Receive(const Datagram* datagrams, size_t count);
+    // Снимок мира и пакеты клиентам в Outgoing()
+    void Tick(core::ecs::World& world);
+    const std::vector<Datagram>& Outgoing() const { return outgoing_; }
+
+    uint32_t Clients() const { return uint32_t(clients_.size()); }
+    uint32_t CurrentTick() const { return tick_; }
+    const ReplicationSchema& Schema() const { return schema_; }
+    const ReplicationStats& Stats() const { return stats_; }
+
+private:
+    struct Client;
+    struct Sent;
+
+    void Capture(core::ecs::World& world);
+    void Build(Client& client);
+    void Acknowledge(Client& client, uint32_t seq);
+
+    ReplicationSchema schema_;
+    ReplicationSettings settings_;
+    std::vector<std::unique_ptr<Client>> clients_;
+    std::vector<Datagram> outgoing_;
+    uint32_t tick_ = 0;
+    uint32_t since_ = 0;          // версия мира после прошлого снимка
+    uint32_t lastChunks_ = 0;     // непустых чанков с реплицируемыми компонентами
+    // снимок: запись сущности по её индексу
+    uint32_t capacity_ = 0;
+    std::vector<uint32_t> generation_; // 0 — индекс пуст
+    std::vector<uint32_t> mask_;       // компоненты схемы, бит = номер в схеме
+    std::vector<uint32_t> words_;      // capacity_ * Words()
+    std::vector<uint32_t> changed_;    // тик последнего изменения записи
+    std::vector<float> weight_;
+    ReplicationStats stats_;
+};
+
+struct ReplicationClientStats {
+    uint64_t packets = 0, bytes = 0;
+    uint64_t entities = 0;        // принято записей
+    uint64_t stale = 0;           // записей старее уже применённых (пакеты пришли не по порядку)
+    uint64_t rejected = 0;        // пакетов не разобрано (нет базы, обрыв)
+    uint32_t tick = 0;            // последний тик сервера
+};
+
+class ReplicationClient {
+public:
+    explicit ReplicationClient(ReplicationSchema schema, const ReplicationSettings& settings = {});
+    ~ReplicationClient();
+    ReplicationClient(const ReplicationClient&) = delete;
+    ReplicationClient& operator=(const ReplicationClient&) = delete;
+
+    void Connect(const NetAddress& server);
+    // Пакеты сервера: сущности создаются, меняются и удаляются в world
+    void Receive(const Datagram* datagrams, size_t count, core::ecs::World& world);
+    // Подтверждения (или приветствие, пока нет снимков) — дописываются в out
+    void Flush(std::vector<Datagram>& out);
+    // Сообщить серверу об уходе; дальше клиент молчит до Connect
+    void Disconnect(std::vector<Datagram>& out);
+
+    bool Connected() const { return connected_; }
+    // Локальная сущность для индекса сущности сервера
+    core::ecs::Entity Find(uint32_t serverIndex) const;
+    const ReplicationClientStats& Stats() const { return stats_; }
+
+private:
+    struct Received;
+
+    bool Decode(const Datagram& d, core::ecs::World& world);
+    void Apply(core::ecs::World& world, uint32_t index, uint32_t generation, uint32_t mask, const uint32_t* words,
+               uint32_t tick);
+
+    ReplicationSchema schema_;
+    uint32_t maxEntities_;
+    NetAddress server_;
+    bool connected_ = false;
+    std::vector<Received> history_;       // 256 последних пакетов: базы для разностей
+    uint32_t latest_ = 0;                 // старший принятый номер пакета
+    uint64_t ackBits_ = 0;                // бит i — принят пакет latest_ - 1 - i
+    bool ackPending_ = false;
+    std::vector<core::ecs::Entity> local_;
+    std::vector<uint32_t> generation_, applied_; // по индексу сервера
+    ReplicationClientStats stats_;
+};
+
+} // namespace dancore::net
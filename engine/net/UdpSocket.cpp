@@ -0,0 +1,218 @@
+#include "UdpSocket.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace dancore::net {
+
+namespace {
+
+constexpr size_t kBatch = 64; // датаграмм на sendmmsg/recvmmsg
+
+#if defined(_WIN32)
+void CloseHandle(uintptr_t h) { closesocket(SOCKET(h)); }
+#else
+void CloseHandle(int h) { close(h); }
+#endif
+
+std::string LastError()
+{
+#if defined(_WIN32)
+    return "error " + std::to_string(WSAGetLastError());
+#else
+    return std::strerror(errno);
+#endif
+}
+
+sockaddr_in ToSockaddr(const NetAddress& a)
+{
+    sockaddr_in s{};
+    s.sin_family = AF_INET;
+    s.sin_addr.s_addr = htonl(a.ip);
+    s.sin_port = htons(a.port);
+    return s;
+}
+
+NetAddress FromSockaddr(const sockaddr_in& s)
+{
+    return {ntohl(s.sin_addr.s_addr), ntohs(s.sin_port)};
+}
+
+} // namespace
+
+bool ParseAddress(const char* text, NetAddress& out, uint16_t defaultPort)
+{
+    unsigned a = 0, b = 0, c = 0, d = 0, port = defaultPort;
+    const char* colon = std::strrchr(text, ':');
+    if (colon) port = (unsigned)std::atoi(colon + 1);
+    const std::string host(text, colon ? size_t(colon - text) : std::strlen(text));
+    if (host == "localhost") a = 127, d = 1;
+    else if (std::sscanf(host.c_str(), "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255)
+        return false;
+    if (!port || port > 65535) return false;
+    out = {a << 24 | b << 16 | c << 8 | d, uint16_t(port)};
+    return true;
+}
+
+std::string ToString(const NetAddress& a)
+{
+    char text[24];
+    std::snprintf(text, sizeof(text), "%u.%u.%u.%u:%u", a.ip >> 24, (a.ip >> 16) & 255, (a.ip >> 8) & 255, a.ip & 255,
+                  unsigned(a.port));
+    return text;
+}
+
+UdpSocket::~UdpSocket()
+{
+    Close();
+}
+
+void UdpSocket::Open(uint16_t port, bool loopbackOnly)
+{
+    Close();
+#if defined(_WIN32)
+    static const bool started = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    if (!started) throw std::runtime_error("UdpSocket: WSAStartup failed");
+#endif
+    Handle h = Handle(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+    if (h == kInvalid) throw std::runtime_error("UdpSocket: socket: " + LastError());
+
+    sockaddr_in addr = ToSockaddr({loopbackOnly ? 0x7f000001u : 0u, port});
+    if (!loopbackOnly) addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    // буферы побольше: сервер отдаёт всем клиентам за тик одной пачкой
+    int bufferBytes = 4 << 20;
+    setsockopt(h, SOL_SOCKET, SO_SNDBUF, (const char*)&bufferBytes, sizeof(bufferBytes));
+    setsockopt(h, SOL_SOCKET, SO_RCVBUF, (const char*)&bufferBytes, sizeof(bufferBytes));
+#if defined(_WIN32)
+    u_long nonBlocking = 1;
+    const bool configured = ioctlsocket(SOCKET(h), FIONBIO, &nonBlocking) == 0;
+#else
+    const bool configured = fcntl(h, F_SETFL, fcntl(h, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    if (!configured || bind(h, (const sockaddr*)&addr, sizeof(addr)) != 0) {
+        const std::string error = LastError();
+        CloseHandle(h);
+        throw std::runtime_error("UdpSocket: bind port " + std::to_string(port) + ": " + error);
+    }
+    sockaddr_in bound{};
+    socklen_t length = sizeof(bound);
+    getsockname(h, (sockaddr*)&bound, &length);
+    handle_ = h;
+    port_ = ntohs(bound.sin_port);
+}
+
+void UdpSocket::Close()
+{
+    if (handle_ == kInvalid) return;
+    CloseHandle(handle_);
+    handle_ = kInvalid;
+    port_ = 0;
+}
+
+size_t UdpSocket::Send(const Datagram* datagrams, size_t count)
+{
+    size_t sent = 0;
+#if defined(__linux__)
+    sockaddr_in addrs[kBatch];
+    iovec iov[kBatch];
+    mmsghdr msgs[kBatch];
+    while (sent < count) {
+        const size_t n = std::min(kBatch, count - sent);
+        for (size_t i = 0; i < n; ++i) {
+            const Datagram& d = datagrams[sent + i];
+            addrs[i] = ToSockaddr(d.address);
+            iov[i] = {const_cast<unsigned char*>(d.data), d.size};
+            msgs[i] = {};
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        ++sendCalls_;
+        const int r = sendmmsg(handle_, msgs, unsigned(n), 0);
+        if (r <= 0) {
+            if (r < 0 && errno == EINTR) continue;
+            break; // EAGAIN (буфер полон) или ошибка: хвост пачки теряется
+        }
+        sent += size_t(r);
+    }
+#else
+    for (; sent < count; ++sent) {
+        const Datagram& d = datagrams[sent];
+        const sockaddr_in addr = ToSockaddr(d.address);
+        ++sendCalls_;
+        if (sendto(handle_, (const char*)d.data, int(d.size), 0, (const sockaddr*)&addr, sizeof(addr)) < 0) break;
+    }
+#endif
+    dropped_ += count - sent;
+    return sent;
+}
+
+size_t UdpSocket::Receive(Datagram* out, size_t max)
+{
+    size_t received = 0;
+#if defined(__linux__)
+    sockaddr_in addrs[kBatch];
+    iovec iov[kBatch];
+    mmsghdr msgs[kBatch];
+    while (received < max) {
+        const size_t n = std::min(kBatch, max - received);
+        for (size_t i = 0; i < n; ++i) {
+            iov[i] = {out[received + i].data, kMaxDatagram};
+            msgs[i] = {};
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        const int r = recvmmsg(handle_, msgs, unsigned(n), MSG_DONTWAIT, nullptr);
+        if (r <= 0) {
+            if (r < 0 && errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < r; ++i) {
+            out[received + i].address = FromSockaddr(addrs[i]);
+            out[received + i].size = msgs[i].msg_len;
+        }
+        received += size_t(r);
+        if (size_t(r) < n) break; // очередь сокета пуста
+    }
+#else
+    while (received < max) {
+        sockaddr_in addr{};
+        socklen_t length = sizeof(addr);
+        const auto r = recvfrom(handle_, (char*)out[received].data, int(kMaxDatagram), 0, (sockaddr*)&addr, &length);
+        if (r < 0) {
+#if defined(_WIN32)
+            if (WSAGetLastError() == WSAECONNRESET) continue; // ICMP "порт недоступен" от ушедшего клиента
+#endif
+            break;
+        }
+        out[received].address = FromSockaddr(addr);
+        out[received].size = uint32_t(r);
+        ++received;
+    }
+#endif
+    return received;
+}
+
+} // namespace dancore::net
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Неблокирующий UDP-сокет (IPv4). Send/Receive работают пачками: на Linux пачка уходит одним
+// sendmmsg/recvmmsg (до 64 датаграмм за системный вызов), на остальных платформах —
+// циклом sendto/recvfrom. Полный буфер отправки не ждётся: неотправленный хвост пачки
+// отбрасывается и считается в Dropped() — для снимков состояния это та же потеря пакета.
+
+namespace dancore::net {
+
+inline constexpr uint32_t kMaxDatagram = 1400; // без IP/UDP-заголовков, меньше типичного MTU
+
+struct NetAddress {
+    uint32_t ip = 0;     // порядок байтов хоста: 127.0.0.1 = 0x7f000001
+    uint16_t port = 0;
+
+    bool operator==(const NetAddress&) const = default;
+    explicit operator bool() const { return port != 0; }
+};
+
+// "host:port" или "host" (тогда defaultPort); host — IPv4 в точечной записи или localhost
+bool ParseAddress(const char* text, NetAddress& out, uint16_t defaultPort = 0);
+std::string ToString(const NetAddress& address); // "a.b.c.d:port"
+
+struct Datagram {
+    NetAddress address;
+    uint32_t size = 0;
+    unsigned char data[kMaxDatagram];
+};
+
+class UdpSocket {
+public:
+    UdpSocket() = default;
+    ~UdpSocket();
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+
+    // port 0 — любой свободный; loopbackOnly — слушать только 127.0.0.1
+    void Open(uint16_t port = 0, bool loopbackOnly = false);
+    void Close();
+    bool IsOpen() const { return handle_ != kInvalid; }
+    uint16_t Port() const { return port_; }
+
+    // Сколько датаграмм ушло; остальные отброшены
+    size_t Send(const Datagram* datagrams, size_t count);
+    // Всё, что уже пришло, но не больше max; не ждёт
+    size_t Receive(Datagram* out, size_t max);
+
+    uint64_t Dropped() const { return dropped_; }
+    uint64_t SendCalls() const { return sendCalls_; } // системных вызовов отправки
+
+private:
+#if defined(_WIN32)
+    using Handle = uintptr_t;
+    static constexpr Handle kInvalid = ~Handle(0);
+#else
+    using Handle = int;
+    static constexpr Handle kInvalid = -1;
+#endif
+    Handle handle_ = kInvalid;
+    uint16_t port_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t sendCalls_ = 0;
+};
+
+} // namespace dancore::net
@@ -0,0 +1,836 @@
+#include "RigidWorld.hpp"
+#include "core/Hash.hpp"
+#include "core/JobSystem.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iterator>
+
+namespace dancore::physics {
+
+namespace jobs = dancore::core::jobs;
+namespace prof = dancore::core::profiler;
+
+namespace {
+
+constexpr uint32_t kGround = ~0u;          // второе тело манифолда с плоскостью земли
+constexpr int kMaxPoints = 4;
+constexpr float kMargin = 0.02f;          // манифолд живёт и чуть разойдясь: тёплый старт не теряется
+constexpr size_t kBodyGrain = 1024;        // тел на задачу в проходах по телам
+
+struct Vec3 {
+    float x = 0, y = 0, z = 0;
+    float& operator[](int i) { return (&x)[i]; }
+    float operator[](int i) const { return (&x)[i]; }
+};
+
+Vec3 operator+(Vec3 a, Vec3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+Vec3 operator-(Vec3 a, Vec3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+Vec3 operator-(Vec3 a) { return {-a.x, -a.y, -a.z}; }
+Vec3 operator*(Vec3 a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+float Dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+Vec3 Cross(Vec3 a, Vec3 b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+float Length(Vec3 a) { return std::sqrt(Dot(a, a)); }
+
+// Столбцы — оси тела в мире
+struct Mat3 {
+    Vec3 c[3];
+};
+
+Mat3 FromQuat(float x, float y, float z, float w)
+{
+    return {{{1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w)},
+             {2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w)},
+             {2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y)}}};
+}
+
+Vec3 Mul(const Mat3& m, Vec3 v) { return m.c[0] * v.x + m.c[1] * v.y + m.c[2] * v.z; }
+Vec3 MulT(const Mat3& m, Vec3 v) { return {Dot(m.c[0], v), Dot(m.c[1], v), Dot(m.c[2], v)}; }
+
+// Симметричная 3x3 построчно: xx xy xz yx yy yz zx zy zz
+Vec3 MulSym(const float* m, Vec3 v)
+{
+    return {m[0] * v.x + m[1] * v.y + m[2] * v.z, m[3] * v.x + m[4] * v.y + m[5] * v.z, m[6] * v.x + m[7] * v.y + m[8] * v.z};
+}
+
+struct Shape {
+    RigidShape type;
+    Vec3 c, h;
+    Mat3 r;
+};
+
+Shape LoadShape(const RigidBodies& b, uint32_t i)
+{
+    return {RigidShape(b.shape[i]), {b.px[i], b.py[i], b.pz[i]}, {b.hx[i], b.hy[i], b.hz[i]},
+            FromQuat(b.qx[i], b.qy[i], b.qz[i], b.qw[i])};
+}
+
+struct RawPoint {
+    Vec3 p;                                // мировая точка посередине между поверхностями
+    float depth;
+    uint32_t id;                           // признак точки для тёплого старта
+};
+
+struct Contacts {
+    Vec3 normal;                           // от A к B
+    int count = 0;
+    RawPoint points[8];
+};
+
+bool SphereSphere(const Shape& a, const Shape& b, Contacts& out)
+{
+    Vec3 d = b.c - a.c;
+    float dist = Length(d), r = a.h.x + b.h.x;
+    if (dist > r + kMargin) return false;
+    out.normal = dist > 1e-6f ? d * (1.0f / dist) : Vec3{0, 1, 0};
+    float depth = r - dist;
+    out.points[out.count++] = {a.c + out.normal * (a.h.x - 0.5f * depth), depth, 0};
+    return true;
+}
+
+// Нормаль от коробки к сфере
+bool BoxSphere(const Shape& box, const Shape& sphere, Contacts& out)
+{
+    Vec3 local = MulT(box.r, sphere.c - box.c), clamped;
+    for (int i = 0; i < 3; ++i) clamped[i] = std::clamp(local[i], -box.h[i], box.h[i]);
+    Vec3 diff = local - clamped;
+    float r = sphere.h.x, dist2 = Dot(diff, diff);
+    if (dist2 > (r + kMargin) * (r + kMargin)) return false;
+    Vec3 n;
+    float depth;
+    if (dist2 > 1e-12f) {
+        float dist = std::sqrt(dist2);
+        n = diff * (1.0f / dist);
+        depth = r - dist;
+    } else {
+        // центр внутри: наружу через ближайшую грань
+        int axis = 0;
+        float best = FLT_MAX;
+        for (int i = 0; i < 3; ++i)
+            if (float gap = box.h[i] - std::abs(local[i]); gap < best) best = gap, axis = i;
+        n = {};
+        n[axis] = local[axis] >= 0 ? 1.0f : -1.0f;
+        clamped[axis] = box.h[axis] * n[axis];
+        depth = r + best;
+    }
+    out.normal = Mul(box.r, n);
+    // точка на грани коробки, сдвинутая на полпути к самой глубокой точке сферы
+    out.points[out.count++] = {box.c + Mul(box.r, clamped) - out.normal * (0.5f * depth), depth, 0};
+    return true;
+}
+
+// Многоугольник по одну сторону плоскости dot(n, p) <= d (Сазерленд-Ходжмен)
+int ClipPolygon(const Vec3* in, int count, Vec3 n, float d, Vec3* out)
+{
+    int m = 0;
+    for (int i = 0; i < count; ++i) {
+        Vec3 a = in[i], b = in[(i + 1) % count];
+        float da = Dot(n, a) - d, db = Dot(n, b) - d;
+        if (da <= 0) out[m++] = a;
+        if ((da < 0 && db > 0) || (da > 0 && db < 0)) out[m++] = a + (b - a) * (da / (da - db));
+    }
+    return m;
+}
+
+// Разделяющие оси: 3 грани A, 3 грани B, 9 рёбер. Грани предпочтительнее рёбер —
+// контакт гранью устойчивее, ребро берётся, только если оно заметно мельче.
+bool BoxBox(const Shape& A, const Shape& B, Contacts& out)
+{
+    Vec3 d = B.c - A.c, dA = MulT(A.r, d), dB = MulT(B.r, d);
+    float C[3][3], absC[3][3];
+    bool parallel = false;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j) {
+            C[i][j] = Dot(A.r.c[i], B.r.c[j]);
+            absC[i][j] = std::abs(C[i][j]) + 1e-6f;
+            parallel |= absC[i][j] >= 1.0f - 1e-5f;
+        }
+
+    float best = -FLT_MAX;
+    int axis = -1; // 0..2 грань A, 3..5 грань B, 6.. ребро
+    Vec3 n;
+    for (int i = 0; i < 3; ++i) {
+        float s = std::abs(dA[i]) - (A.h[i] + B.h.x * absC[i][0] + B.h.y * absC[i][1] + B.h.z * absC[i][2]);
+        if (s > kMargin) return false;
+        if (s > best) best = s, axis = i, n = A.r.c[i] * (dA[i] < 0 ? -1.0f : 1.0f);
+    }
+    for (int j = 0; j < 3; ++j) {
+        float s = std::abs(dB[j]) - (B.h[j] + A.h.x * absC[0][j] + A.h.y * absC[1][j] + A.h.z * absC[2][j]);
+        if (s > kMargin) return false;
+        if (s > best + 1e-4f) best = s, axis = 3 + j, n = B.r.c[j] * (dB[j] < 0 ? -1.0f : 1.0f);
+    }
+    const float faceBest = best;
+    if (!parallel)
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) {
+                int i1 = (i + 1) % 3, i2 = (i + 2) % 3, j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+                Vec3 L = Cross(A.r.c[i], B.r.c[j]);
+                float len = Length(L);
+                if (len < 1e-4f) continue;
+                float ra = A.h[i1] * absC[i2][j] + A.h[i2] * absC[i1][j];
+                float rb = B.h[j1] * absC[i][j2] + B.h[j2] * absC[i][j1];
+                float proj = dA[i2] * C[i1][j] - dA[i1] * C[i2][j];
+                float s = (std::abs(proj) - (ra + rb)) / len;
+                if (s > kMargin) return false;
+                if (s > 0.95f * faceBest + 0.005f && s > best) {
+                    best = s, axis = 6 + i * 3 + j;
+                    n = L * ((proj < 0 ? -1.0f : 1.0f) / len);
+                }
+            }
+
+    out.normal = n;
+    if (axis >= 6) {
+        // ребро с ребром: ближайшие точки отрезков
+        int i = (axis - 6) / 3, j = (axis - 6) % 3;
+        Vec3 pa = A.c, pb = B.c;
+        for (int k = 0; k < 3; ++k) {
+            if (k != i) pa = pa + A.r.c[k] * (Dot(A.r.c[k], n) > 0 ? A.h[k] : -A.h[k]);
+            if (k != j) pb = pb + B.r.c[k] * (Dot(B.r.c[k], n) > 0 ? -B.h[k] : B.h[k]);
+        }
+        Vec3 ua = A.r.c[i], ub = B.r.c[j], r = pa - pb;
+        float b = Dot(ua, ub), c = Dot(ua, r), f = Dot(ub, r), denom = 1 - b * b;
+        float s = denom > 1e-6f ? std::clamp((b * f - c) / denom, -A.h[i], A.h[i]) : 0.0f;
+        float t = std::clamp(b * s + f, -B.h[j], B.h[j]);
+        s = std::clamp(b * t - c, -A.h[i], A.h[i]);
+        Vec3 ca = pa + ua * s, cb = pb + ub * t;
+        out.points[out.count++] = {(ca + cb) * 0.5f, -best, 0x1000u | uint32_t(i * 3 + j)};
+        return true;
+    }
+
+    // грань: опорная — грань A или B, падающая — самая встречная грань другой коробки
+    const bool faceA = axis < 3;
+    const Shape& ref = faceA ? A : B;
+    const Shape& inc = faceA ? B : A;
+    const int ra = faceA ? axis : axis - 3;
+    const Vec3 rn = faceA ? n : -n; // от опорной к падающей
+    int ia = 0;
+    float most = -1;
+    for (int k = 0; k < 3; ++k)
+        if (float v = std::abs(Dot(inc.r.c[k], rn)); v > most) most = v, ia = k;
+    const float is = Dot(inc.r.c[ia], rn) > 0 ? -1.0f : 1.0f;
+    const int i1 = (ia + 1) % 3, i2 = (ia + 2) % 3;
+    Vec3 ic = inc.c + inc.r.c[ia] * (inc.h[ia] * is), e1 = inc.r.c[i1] * inc.h[i1], e2 = inc.r.c[i2] * inc.h[i2];
+    Vec3 poly[8] = {ic + e1 + e2, ic - e1 + e2, ic - e1 - e2, ic + e1 - e2}, tmp[8];
+    int count = 4;
+    for (int k = 1; k < 3 && count; ++k) {
+        int side = (ra + k) % 3;
+        Vec3 sn = ref.r.c[side];
+        float off = Dot(sn, ref.c);
+        count = ClipPolygon(poly, count, sn, off + ref.h[side], tmp);
+        count = ClipPolygon(tmp, count, -sn, -off + ref.h[side], poly);
+    }
+    const float faceOff = Dot(rn, ref.c) + ref.h[ra];
+    const uint32_t feature = uint32_t(axis) << 4 | uint32_t(ia * 2 + (is > 0)) << 8;
+    // признак точки — четверть опорной грани: порядок после отсечения от шага к шагу плавает
+    const Vec3 s1 = ref.r.c[(ra + 1) % 3], s2 = ref.r.c[(ra + 2) % 3];
+    for (int k = 0; k < count; ++k) {
+        float sep = Dot(rn, poly[k]) - faceOff;
+        if (sep > kMargin) continue;
+        uint32_t quadrant = uint32_t(Dot(s1, poly[k] - ref.c) > 0) | uint32_t(Dot(s2, poly[k] - ref.c) > 0) << 1;
+        out.points[out.count++] = {poly[k] - rn * (0.5f * sep), -sep, feature | quadrant};
+    }
+    if (out.count > kMaxPoints) {
+        // четыре: самая глубокая, самая дальняя от неё, дальше всех от их прямой, по другую сторону
+        RawPoint* p = out.points;
+        std::swap(p[0], *std::max_element(p, p + out.count, [](const RawPoint& x, const RawPoint& y) { return x.depth < y.depth; }));
+        auto farthest = [&](int from, auto score) {
+            int bestK = from;
+            float bestV = -FLT_MAX;
+            for (int k = from; k < out.count; ++k)
+                if (float v = score(p[k].p); v > bestV) bestV = v, bestK = k;
+            std::swap(p[from], p[bestK]);
+        };
+        farthest(1, [&](Vec3 q) { return Dot(q - p[0].p, q - p[0].p); });
+        farthest(2, [&](Vec3 q) { return Dot(Cross(p[1].p - p[0].p, q - p[0].p), rn); });
+        farthest(3, [&](Vec3 q) { return -Dot(Cross(p[1].p - p[0].p, q - p[0].p), rn); });
+        out.count = kMaxPoints;
+    }
+    return out.count > 0;
+}
+
+// Плоскость y = ground под телом; нормаль от тела к плоскости
+bool ShapeGround(const Shape& s, float ground, Contacts& out)
+{
+    out.normal = {0, -1, 0};
+    if (s.type == RigidShape::Sphere) {
+        float depth = ground - (s.c.y - s.h.x);
+        if (depth < -kMargin) return false;
+        out.points[out.count++] = {{s.c.x, s.c.y - s.h.x + 0.5f * depth, s.c.z}, depth, 0};
+        return true;
+    }
+    for (uint32_t k = 0; k < 8; ++k) {
+        Vec3 p = s.c + s.r.c[0] * ((k & 1) ? s.h.x : -s.h.x) + s.r.c[1] * ((k & 2) ? s.h.y : -s.h.y) + s.r.c[2] * ((k & 4) ? s.h.z : -s.h.z);
+        float depth = ground - p.y;
+        if (depth >= -kMargin) out.points[out.count++] = {{p.x, p.y + 0.5f * depth, p.z}, depth, k};
+    }
+    if (out.count > kMaxPoints) {
+        std::partial_sort(out.points, out.points + kMaxPoints, out.points + out.count,
+                          [](const RawPoint& x, const RawPoint& y) { return x.depth > y.depth || (x.depth == y.depth && x.id < y.id); });
+        out.count = kMaxPoints;
+    }
+    return out.count > 0;
+}
+
+bool Collide(const Shape& a, const Shape& b, Contacts& out)
+{
+    if (a.type == RigidShape::Sphere && b.type == RigidShape::Sphere) return SphereSphere(a, b, out);
+    if (a.type == RigidShape::Box && b.type == RigidShape::Box) return BoxBox(a, b, out);
+    if (a.type == RigidShape::Box) return BoxSphere(a, b, out);
+    if (!BoxSphere(b, a, out)) return false;
+    out.normal = -out.normal;
+    return true;
+}
+
+void Tangents(Vec3 n, Vec3& t1, Vec3& t2)
+{
+    t1 = std::abs(n.x) >= 0.57735f ? Vec3{n.y, -n.x, 0} : Vec3{0, n.z, -n.y};
+    t1 = t1 * (1.0f / Length(t1));
+    t2 = Cross(n, t1);
+}
+
+uint64_t PairKey(uint32_t a, uint32_t b) { return uint64_t(a) << 32 | b; }
+
+} // namespace
+
+struct RigidWorld::Manifold {
+    struct Point {
+        Vec3 rA, rB;                       // от центров тел
+        float depth;
+        float normalMass;
+        float bias;                        // целевая скорость сближения: зазор и отскок
+        float push;                        // скорость выталкивания из проникновения
+        float pn, pp;                      // накопленные импульсы; pp — выталкивающий
+        uint32_t id;
+    };
+    uint32_t a, b;                         // a < b; b == kGround — плоскость земли
+    Vec3 normal, t1, t2;                   // нормаль от a к b
+    float friction, restitution;
+    uint32_t count;
+    Point points[kMaxPoints];
+    // трение — одно на манифолд, в центре пятна: два касательных и кручение вокруг нормали
+    Vec3 cA, cB;
+    float radius;                          // средний радиус пятна, плечо трения кручения
+    float tangentMass[2], twistMass;
+    float ft[2], twist;                    // накопленные импульсы трения
+
+    uint64_t Key() const { return PairKey(a, b); }
+};
+
+RigidWorld::RigidWorld(const RigidSettings& settings) : settings_(settings)
+{
+    settings_.maxSubSteps = std::max(settings_.maxSubSteps, 1);
+    settings_.iterations = std::max(settings_.iterations, 1);
+}
+
+RigidWorld::~RigidWorld() = default;
+
+BodyId RigidWorld::Add(const RigidBodyDesc& d)
+{
+    RigidBodies& b = bodies_;
+    BodyId id = BodyId(b.Size());
+    float q[4] = {d.orientation[0], d.orientation[1], d.orientation[2], d.orientation[3]};
+    float ql = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for (float& c : q) c = ql > 0 ? c / ql : 0;
+    if (!(ql > 0)) q[3] = 1;
+    b.px.push_back(d.position[0]), b.py.push_back(d.position[1]), b.pz.push_back(d.position[2]);
+    b.qx.push_back(q[0]), b.qy.push_back(q[1]), b.qz.push_back(q[2]), b.qw.push_back(q[3]);
+    b.vx.push_back(d.linearVelocity[0]), b.vy.push_back(d.linearVelocity[1]), b.vz.push_back(d.linearVelocity[2]);
+    b.wx.push_back(d.angularVelocity[0]), b.wy.push_back(d.angularVelocity[1]), b.wz.push_back(d.angularVelocity[2]);
+    float h[3] = {std::max(d.halfExtents[0], 1e-3f), std::max(d.halfExtents[1], 1e-3f), std::max(d.halfExtents[2], 1e-3f)};
+    if (d.shape == RigidShape::Sphere) h[1] = h[2] = h[0];
+    b.hx.push_back(h[0]), b.hy.push_back(h[1]), b.hz.push_back(h[2]);
+    float inv = d.mass > 0 ? 1.0f / d.mass : 0.0f, I[3];
+    if (d.shape == RigidShape::Sphere) I[0] = I[1] = I[2] = 0.4f * d.mass * h[0] * h[0];
+    else {
+        I[0] = d.mass / 3.0f * (h[1] * h[1] + h[2] * h[2]);
+        I[1] = d.mass / 3.0f * (h[0] * h[0] + h[2] * h[2]);
+        I[2] = d.mass / 3.0f * (h[0] * h[0] + h[1] * h[1]);
+    }
+    b.invMass.push_back(inv);
+    b.ix.push_back(inv > 0 ? 1.0f / I[0] : 0), b.iy.push_back(inv > 0 ? 1.0f / I[1] : 0), b.iz.push_back(inv > 0 ? 1.0f / I[2] : 0);
+    b.friction.push_back(d.friction);
+    b.restitution.push_back(d.restitution);
+    b.sleepTimer.push_back(0);
+    b.shape.push_back(uint8_t(d.shape));
+    b.awake.push_back(inv > 0);
+    order_.push_back(id);
+    return id;
+}
+
+void RigidWorld::Clear()
+{
+    bodies_ = {};
+    order_.clear();
+    pairs_.clear();
+    manifolds_.clear();
+    previous_.clear();
+    accumulator_ = 0;
+    stats_ = {};
+}
+
+void RigidWorld::GetPosition(BodyId id, float out[3]) const
+{
+    out[0] = bodies_.px[id], out[1] = bodies_.py[id], out[2] = bodies_.pz[id];
+}
+
+void RigidWorld::GetOrientation(BodyId id, float out[4]) const
+{
+    out[0] = bodies_.qx[id], out[1] = bodies_.qy[id], out[2] = bodies_.qz[id], out[3] = bodies_.qw[id];
+}
+
+void RigidWorld::SetLinearVelocity(BodyId id, const float v[3])
+{
+    bodies_.vx[id] = v[0], bodies_.vy[id] = v[1], bodies_.vz[id] = v[2];
+    if (bodies_.invMass[id] > 0) bodies_.awake[id] = 1, bodies_.sleepTimer[id] = 0;
+}
+
+int RigidWorld::Advance(double frameSeconds)
+{
+    accumulator_ += std::max(frameSeconds, 0.0);
+    int steps = 0;
+    while (accumulator_ >= settings_.fixedDt && steps < settings_.maxSubSteps) {
+        Step();
+        accumulator_ -= settings_.fixedDt;
+        ++steps;
+    }
+    // не успели — отстаём, а не копим долг на следующие кадры (спираль смерти)
+    if (accumulator_ >= settings_.fixedDt) accumulator_ = std::fmod(accumulator_, settings_.fixedDt);
+    return steps;
+}
+
+void RigidWorld::Step()
+{
+    DC_PROFILE_ZONE("RigidWorld::Step");
+    const float dt = float(settings_.fixedDt);
+    uint32_t count = uint32_t(bodies_.Size());
+    stats_ = {};
+    stats_.bodies = count;
+    if (!count) return;
+
+    prof::Clock t0 = prof::Now();
+    IntegrateVelocities(dt);
+    Broadphase();
+    prof::Clock t1 = prof::Now();
+    Narrowphase();
+    prof::Clock t2 = prof::Now();
+    BuildIslands();
+    Solve(dt);
+    IntegratePositions(dt);
+    prof::Clock t3 = prof::Now();
+
+    stats_.broadMs = double(t1 - t0) / 1e6;
+    stats_.narrowMs = double(t2 - t1) / 1e6;
+    stats_.solveMs = double(t3 - t2) / 1e6;
+    stats_.pairs = uint32_t(pairs_.size());
+    stats_.manifolds = uint32_t(manifolds_.size());
+    for (const Manifold& m : manifolds_) stats_.contacts += m.count;
+    for (uint8_t a : bodies_.awake) stats_.awake += a;
+}
+
+void RigidWorld::IntegrateVelocities(float dt)
+{
+    DC_PROFILE_ZONE("Rigid::IntegrateVelocities");
+    RigidBodies& b = bodies_;
+    const size_t n = b.Size();
+    minX_.resize(n), minY_.resize(n), minZ_.resize(n), maxX_.resize(n), maxY_.resize(n), maxZ_.resize(n);
+    invInertia_.resize(n * 9);
+    push_.assign(n * 6, 0.0f);
+    const Vec3 g{settings_.gravity[0] * dt, settings_.gravity[1] * dt, settings_.gravity[2] * dt};
+    jobs::ParallelFor(0, n, kBodyGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Mat3 r = FromQuat(b.qx[i], b.qy[i], b.qz[i], b.qw[i]);
+            if (b.awake[i]) {
+                b.vx[i] += g.x, b.vy[i] += g.y, b.vz[i] += g.z;
+            }
+            // R diag(I^-1) R^T
+            float* m = &invInertia_[i * 9];
+            const float d[3] = {b.ix[i], b.iy[i], b.iz[i]};
+            for (int row = 0; row < 3; ++row)
+                for (int col = 0; col < 3; ++col)
+                    m[row * 3 + col] = r.c[0][row] * d[0] * r.c[0][col] + r.c[1][row] * d[1] * r.c[1][col] + r.c[2][row] * d[2] * r.c[2][col];
+            // AABB: |R| * h плюс зазор контакта
+            Vec3 e;
+            for (int a = 0; a < 3; ++a)
+                e[a] = b.shape[i] == uint8_t(RigidShape::Sphere)
+                           ? b.hx[i]
+                           : std::abs(r.c[0][a]) * b.hx[i] + std::abs(r.c[1][a]) * b.hy[i] + std::abs(r.c[2][a]) * b.hz[i];
+            e = e + Vec3{kMargin, kMargin, kMargin};
+            minX_[i] = b.px[i] - e.x, maxX_[i] = b.px[i] + e.x;
+            minY_[i] = b.py[i] - e.y, maxY_[i] = b.py[i] + e.y;
+            minZ_[i] = b.pz[i] - e.z, maxZ_[i] = b.pz[i] + e.z;
+        }
+    });
+}
+
+void RigidWorld::Broadphase()
+{
+    DC_PROFILE_ZONE("Rigid::Broadphase");
+    const size_t n = bodies_.Size();
+    // порядок прошлого шага почти верен: вставками за O(n + перестановки)
+    auto less = [&](uint32_t a, uint32_t b) { return minX_[a] < minX_[b] || (minX_[a] == minX_[b] && a < b); };
+    for (size_t i = 1; i < n; ++i) {
+        uint32_t v = order_[i];
+        size_t j = i;
+        for (; j > 0 && less(v, order_[j - 1]); --j) order_[j] = order_[j - 1];
+        order_[j] = v;
+    }
+    sMinX_.resize(n), sMaxX_.resize(n), sMinY_.resize(n), sMaxY_.resize(n), sMinZ_.resize(n), sMaxZ_.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        uint32_t i = order_[k];
+        sMinX_[k] = minX_[i], sMaxX_[k] = maxX_[i];
+        sMinY_[k] = minY_[i], sMaxY_[k] = maxY_[i];
+        sMinZ_[k] = minZ_[i], sMaxZ_[k] = maxZ_[i];
+    }
+
+    // куски диапазона пишут свои списки; склейка по порядку — как в один поток
+    const size_t ranges = std::min<size_t>((n + kBodyGrain - 1) / kBodyGrain, size_t(jobs::WorkerCount() + 1) * 4);
+    const size_t per = (n + ranges - 1) / ranges;
+    rangePairs_.resize(ranges);
+    const RigidBodies& b = bodies_;
+    jobs::ParallelFor(0, ranges, 1, [&](size_t r0, size_t r1) {
+        std::vector<uint8_t> hit;
+        for (size_t r = r0; r < r1; ++r) {
+            std::vector<Pair>& out = rangePairs_[r];
+            out.clear();
+            for (size_t k = r * per; k < std::min(n, (r + 1) * per); ++k) {
+                const uint32_t i = order_[k];
+                const bool iDynamic = b.awake[i] != 0;
+                const float x1 = sMaxX_[k], y0 = sMinY_[k], y1 = sMaxY_[k], z0 = sMinZ_[k], z1 = sMaxZ_[k];
+                size_t end = size_t(std::upper_bound(sMinX_.begin() + ptrdiff_t(k + 1), sMinX_.end(), x1) - sMinX_.begin());
+                if (end == k + 1) continue;
+                // пересечение по y/z для всех кандидатов сразу — без ветвлений, векторизуется
+                hit.resize(end - k - 1);
+                const float *mnY = &sMinY_[k + 1], *mxY = &sMaxY_[k + 1], *mnZ = &sMinZ_[k + 1], *mxZ = &sMaxZ_[k + 1];
+                for (size_t j = 0; j < hit.size(); ++j)
+                    hit[j] = uint8_t((mnY[j] <= y1) & (mxY[j] >= y0) & (mnZ[j] <= z1) & (mxZ[j] >= z0));
+                for (size_t j = 0; j < hit.size(); ++j) {
+                    if (!hit[j]) continue;
+                    const uint32_t o = order_[k + 1 + j];
+                    // хоть одно тело должно двигаться; спящее со спящим или статикой — нет
+                    if (!iDynamic && !b.awake[o]) continue;
+                    out.push_back(i < o ? Pair{i, o} : Pair{o, i});
+                }
+            }
+        }
+    });
+    pairs_.clear();
+    for (const auto& r : rangePairs_) pairs_.insert(pairs_.end(), r.begin(), r.end());
+    std::sort(pairs_.begin(), pairs_.end(), [](const Pair& x, const Pair& y) { return PairKey(x.a, x.b) < PairKey(y.a, y.b); });
+}
+
+void RigidWorld::Narrowphase()
+{
+    DC_PROFILE_ZONE("Rigid::Narrowphase");
+    previous_.swap(manifolds_);
+    manifolds_.clear();
+    const RigidBodies& b = bodies_;
+
+    // тёплый старт: импульсы прошлого шага той же пары и точки
+    auto build = [&](uint32_t a, uint32_t o, const Shape& sa, const Contacts& c, Manifold& m) {
+        m.a = a, m.b = o;
+        m.normal = c.normal;
+        Tangents(m.normal, m.t1, m.t2);
+        m.friction = o == kGround ? b.friction[a] : std::sqrt(b.friction[a] * b.friction[o]);
+        m.restitution = o == kGround ? b.restitution[a] : std::max(b.restitution[a], b.restitution[o]);
+        m.count = uint32_t(c.count);
+        const Vec3 cb = o == kGround ? Vec3{} : Vec3{b.px[o], b.py[o], b.pz[o]};
+        auto prev = std::lower_bound(previous_.begin(), previous_.end(), m.Key(), [](const Manifold& x, uint64_t k) { return x.Key() < k; });
+        const Manifold* old = prev != previous_.end() && prev->Key() == m.Key() ? &*prev : nullptr;
+        Vec3 center{};
+        for (int k = 0; k < c.count; ++k) {
+            Manifold::Point& p = m.points[k];
+            p = {};
+            p.rA = c.points[k].p - sa.c;
+            p.rB = o == kGround ? Vec3{} : c.points[k].p - cb;
+            p.depth = c.points[k].depth;
+            p.id = c.points[k].id;
+            center = center + c.points[k].p;
+            if (old)
+                for (uint32_t q = 0; q < old->count; ++q)
+                    if (old->points[q].id == p.id) {
+                        p.pn = old->points[q].pn;
+                        break;
+                    }
+        }
+        center = center * (1.0f / float(c.count));
+        m.cA = center - sa.c;
+        m.cB = o == kGround ? Vec3{} : center - cb;
+        m.radius = 0;
+        for (int k = 0; k < c.count; ++k) m.radius += Length(c.points[k].p - center);
+        m.radius /= float(c.count);
+        m.ft[0] = old ? old->ft[0] : 0.0f, m.ft[1] = old ? old->ft[1] : 0.0f;
+        m.twist = old ? old->twist : 0.0f;
+    };
+
+    const size_t n = b.Size();
+    const size_t work = pairs_.size() + n; // пары, затем проверки земли по телам
+    const size_t ranges = std::max<size_t>(1, std::min<size_t>((work + kBodyGrain - 1) / kBodyGrain, size_t(jobs::WorkerCount() + 1) * 4));
+    const size_t per = (work + ranges - 1) / ranges;
+    std::vector<std::vector<Manifold>> out(ranges);
+    jobs::ParallelFor(0, ranges, 1, [&](size_t r0, size_t r1) {
+        for (size_t r = r0; r < r1; ++r)
+            for (size_t w = r * per; w < std::min(work, (r + 1) * per); ++w) {
+                Contacts c;
+                if (w < pairs_.size()) {
+                    const Pair& p = pairs_[w];
+                    Shape sa = LoadShape(b, p.a), sb = LoadShape(b, p.b);
+                    if (!Collide(sa, sb, c)) continue;
+                    build(p.a, p.b, sa, c, out[r].emplace_back());
+                } else {
+                    uint32_t i = uint32_t(w - pairs_.size());
+                    if (!settings_.ground || !b.awake[i] || minY_[i] > settings_.groundY) continue;
+                    Shape s = LoadShape(b, i);
+                    if (!ShapeGround(s, settings_.groundY, c)) continue;
+                    build(i, kGround, s, c, out[r].emplace_back());
+                }
+            }
+    });
+    for (auto& r : out) manifolds_.insert(manifolds_.end(), r.begin(), r.end());
+    std::sort(manifolds_.begin(), manifolds_.end(), [](const Manifold& x, const Manifold& y) { return x.Key() < y.Key(); });
+}
+
+void RigidWorld::BuildIslands()
+{
+    DC_PROFILE_ZONE("Rigid::BuildIslands");
+    RigidBodies& b = bodies_;
+    const uint32_t n = uint32_t(b.Size());
+    parent_.resize(n);
+    for (uint32_t i = 0; i < n; ++i) parent_[i] = i;
+    auto find = [&](uint32_t i) {
+        while (parent_[i] != i) i = parent_[i] = parent_[parent_[i]];
+        return i;
+    };
+    // статика острова не связывает: на неё опираются многие независимые группы
+    for (const Manifold& m : manifolds_) {
+        if (m.b == kGround || b.invMass[m.a] == 0 || b.invMass[m.b] == 0) continue;
+        uint32_t x = find(m.a), y = find(m.b);
+        if (x != y) parent_[std::max(x, y)] = std::min(x, y); // корень — меньший номер: порядок не зависит от обхода
+    }
+
+    // остров бодрствует, если бодрствует хоть одно тело; номера — по наименьшему телу
+    std::vector<uint32_t> island(n, ~0u);
+    islandAwake_.clear();
+    uint32_t islands = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        if (b.invMass[i] == 0) continue;
+        uint32_t root = find(i);
+        if (island[root] == ~0u) island[root] = islands++, islandAwake_.push_back(0);
+        island[i] = island[root];
+        islandAwake_[island[i]] |= b.awake[i];
+    }
+
+    // тела и манифолды подряд по островам (сортировка подсчётом)
+    islandBodies_.assign(islands + 1, 0);
+    islandManifolds_.assign(islands + 1, 0);
+    for (uint32_t i = 0; i < n; ++i)
+        if (island[i] != ~0u && islandAwake_[island[i]]) ++islandBodies_[island[i] + 1];
+    auto owner = [&](const Manifold& m) { return b.invMass[m.a] > 0 ? island[m.a] : island[m.b]; };
+    for (const Manifold& m : manifolds_)
+        if (islandAwake_[owner(m)]) ++islandManifolds_[owner(m) + 1];
+    for (uint32_t k = 0; k < islands; ++k) {
+        islandBodies_[k + 1] += islandBodies_[k];
+        islandManifolds_[k + 1] += islandManifolds_[k];
+    }
+    islandBodyList_.resize(islandBodies_[islands]);
+    islandManifoldList_.resize(islandManifolds_[islands]);
+    std::vector<uint32_t> cursor(islandBodies_.begin(), islandBodies_.end() - 1);
+    for (uint32_t i = 0; i < n; ++i)
+        if (island[i] != ~0u && islandAwake_[island[i]]) {
+            islandBodyList_[cursor[island[i]]++] = i;
+            if (!b.awake[i]) b.awake[i] = 1, b.sleepTimer[i] = 0; // задели — проснулся весь остров
+        }
+    cursor.assign(islandManifolds_.begin(), islandManifolds_.end() - 1);
+    for (uint32_t k = 0; k < manifolds_.size(); ++k)
+        if (islandAwake_[owner(manifolds_[k])]) islandManifoldList_[cursor[owner(manifolds_[k])]++] = k;
+    for (uint8_t a : islandAwake_) stats_.islands += a;
+}
+
+void RigidWorld::Solve(float dt)
+{
+    DC_PROFILE_ZONE("Rigid::Solve");
+    RigidBodies& b = bodies_;
+    const uint32_t islands = uint32_t(islandAwake_.size());
+    const float inv = 1.0f / dt;
+
+    jobs::ParallelFor(0, islands, 1, [&](size_t i0, size_t i1) {
+        for (size_t is = i0; is < i1; ++is) {
+            if (!islandAwake_[is]) continue;
+            const uint32_t* mlist = islandManifoldList_.data() + islandManifolds_[is];
+            const uint32_t mcount = islandManifolds_[is + 1] - islandManifolds_[is];
+
+            // скорость точки тела; статика и земля — нули и в них не пишем
+            auto velocity = [&](uint32_t i, Vec3 r) {
+                if (i == kGround) return Vec3{};
+                return Vec3{b.vx[i], b.vy[i], b.vz[i]} + Cross(Vec3{b.wx[i], b.wy[i], b.wz[i]}, r);
+            };
+            auto apply = [&](uint32_t i, Vec3 r, Vec3 P) {
+                if (i == kGround || b.invMass[i] == 0) return;
+                b.vx[i] += P.x * b.invMass[i], b.vy[i] += P.y * b.invMass[i], b.vz[i] += P.z * b.invMass[i];
+                Vec3 dw = MulSym(&invInertia_[i * 9], Cross(r, P));
+                b.wx[i] += dw.x, b.wy[i] += dw.y, b.wz[i] += dw.z;
+            };
+            auto pushVelocity = [&](uint32_t i, Vec3 r) {
+                if (i == kGround) return Vec3{};
+                const float* v = &push_[i * 6];
+                return Vec3{v[0], v[1], v[2]} + Cross(Vec3{v[3], v[4], v[5]}, r);
+            };
+            auto applyPush = [&](uint32_t i, Vec3 r, Vec3 P) {
+                if (i == kGround || b.invMass[i] == 0) return;
+                float* v = &push_[i * 6];
+                Vec3 dw = MulSym(&invInertia_[i * 9], Cross(r, P));
+                v[0] += P.x * b.invMass[i], v[1] += P.y * b.invMass[i], v[2] += P.z * b.invMass[i];
+                v[3] += dw.x, v[4] += dw.y, v[5] += dw.z;
+            };
+            auto mass = [&](uint32_t i, Vec3 r, Vec3 dir) {
+                if (i == kGround || b.invMass[i] == 0) return 0.0f;
+                Vec3 rd = Cross(r, dir);
+                return b.invMass[i] + Dot(rd, MulSym(&invInertia_[i * 9], rd));
+            };
+
+            auto angular = [&](uint32_t i) {
+                return i == kGround ? Vec3{} : Vec3{b.wx[i], b.wy[i], b.wz[i]};
+            };
+            auto applyAngular = [&](uint32_t i, Vec3 L) {
+                if (i == kGround || b.invMass[i] == 0) return;
+                Vec3 dw = MulSym(&invInertia_[i * 9], L);
+                b.wx[i] += dw.x, b.wy[i] += dw.y, b.wz[i] += dw.z;
+            };
+            auto angularMass = [&](uint32_t i, Vec3 axis) {
+                if (i == kGround || b.invMass[i] == 0) return 0.0f;
+                return Dot(axis, MulSym(&invInertia_[i * 9], axis));
+            };
+
+            for (uint32_t k = 0; k < mcount; ++k) {
+                Manifold& m = manifolds_[mlist[k]];
+                for (uint32_t q = 0; q < m.count; ++q) {
+                    Manifold::Point& p = m.points[q];
+                    // точка в зазоре (depth < 0) не толкает: опережающий контакт раскачивает высокие стопки
+                    if (p.depth < 0) {
+                        p.normalMass = 0, p.bias = 0, p.push = 0, p.pn = 0, p.pp = 0;
+                        continue;
+                    }
+                    p.normalMass = 1.0f / std::max(mass(m.a, p.rA, m.normal) + mass(m.b, p.rB, m.normal), 1e-9f);
+                    float vn = Dot(velocity(m.b, p.rB) - velocity(m.a, p.rA), m.normal);
+                    p.bias = vn < -1.0f ? m.restitution * vn : 0.0f;
+                    // проникновение глубже slop выталкиваем отдельно: в скорость тел это не попадает
+                    p.push = p.depth > settings_.slop ? settings_.baumgarte * inv * (p.depth - settings_.slop) : 0.0f;
+                    p.pp = 0;
+                    apply(m.a, p.rA, -m.normal * p.pn);
+                    apply(m.b, p.rB, m.normal * p.pn);
+                }
+                m.tangentMass[0] = 1.0f / std::max(mass(m.a, m.cA, m.t1) + mass(m.b, m.cB, m.t1), 1e-9f);
+                m.tangentMass[1] = 1.0f / std::max(mass(m.a, m.cA, m.t2) + mass(m.b, m.cB, m.t2), 1e-9f);
+                m.twistMass = 1.0f / std::max(angularMass(m.a, m.normal) + angularMass(m.b, m.normal), 1e-9f);
+                Vec3 P = m.t1 * m.ft[0] + m.t2 * m.ft[1];
+                apply(m.a, m.cA, -P);
+                apply(m.b, m.cB, P);
+                applyAngular(m.a, -m.normal * m.twist);
+                applyAngular(m.b, m.normal * m.twist);
+            }
+            for (int it = 0; it < settings_.iterations; ++it)
+                for (uint32_t k = 0; k < mcount; ++k) {
+                    Manifold& m = manifolds_[mlist[k]];
+                    // трение в пределах конуса по текущей сумме нормальных импульсов
+                    float total = 0;
+                    for (uint32_t q = 0; q < m.count; ++q) total += m.points[q].pn;
+                    for (int t = 0; t < 2; ++t) {
+                        Vec3 dir = t ? m.t2 : m.t1;
+                        float vt = Dot(velocity(m.b, m.cB) - velocity(m.a, m.cA), dir);
+                        float limit = m.friction * total;
+                        float old = m.ft[t];
+                        m.ft[t] = std::clamp(old - vt * m.tangentMass[t], -limit, limit);
+                        Vec3 P = dir * (m.ft[t] - old);
+                        apply(m.a, m.cA, -P);
+                        apply(m.b, m.cB, P);
+                    }
+                    {
+                        float wn = Dot(angular(m.b) - angular(m.a), m.normal);
+                        float limit = m.friction * m.radius * total;
+                        float old = m.twist;
+                        m.twist = std::clamp(old - wn * m.twistMass, -limit, limit);
+                        applyAngular(m.a, -m.normal * (m.twist - old));
+                        applyAngular(m.b, m.normal * (m.twist - old));
+                    }
+                    for (uint32_t q = 0; q < m.count; ++q) {
+                        Manifold::Point& p = m.points[q];
+                        float vn = Dot(velocity(m.b, p.rB) - velocity(m.a, p.rA), m.normal);
+                        float old = p.pn;
+                        p.pn = std::max(old - (vn + p.bias) * p.normalMass, 0.0f);
+                        Vec3 P = m.normal * (p.pn - old);
+                        apply(m.a, p.rA, -P);
+                        apply(m.b, p.rB, P);
+                    }
+                }
+
+            // выталкивание — своими скоростями, которые живут один шаг: стопки не раскачиваются
+            for (int it = 0; it < settings_.iterations; ++it)
+                for (uint32_t k = 0; k < mcount; ++k) {
+                    Manifold& m = manifolds_[mlist[k]];
+                    for (uint32_t q = 0; q < m.count; ++q) {
+                        Manifold::Point& p = m.points[q];
+                        if (p.push == 0 && p.pp == 0) continue;
+                        float vn = Dot(pushVelocity(m.b, p.rB) - pushVelocity(m.a, p.rA), m.normal);
+                        float old = p.pp;
+                        p.pp = std::max(old + (p.push - vn) * p.normalMass, 0.0f);
+                        Vec3 P = m.normal * (p.pp - old);
+                        applyPush(m.a, p.rA, -P);
+                        applyPush(m.b, p.rB, P);
+                    }
+                }
+
+            // сон: весь остров разом, когда каждое тело стоит дольше sleepTime
+            const uint32_t* list = islandBodyList_.data() + islandBodies_[is];
+            const uint32_t count = islandBodies_[is + 1] - islandBodies_[is];
+            const float still = settings_.sleepVelocity * settings_.sleepVelocity;
+            float minTimer = FLT_MAX;
+            for (uint32_t k = 0; k < count; ++k) {
+                uint32_t i = list[k];
+                float v2 = b.vx[i] * b.vx[i] + b.vy[i] * b.vy[i] + b.vz[i] * b.vz[i];
+                float w2 = b.wx[i] * b.wx[i] + b.wy[i] * b.wy[i] + b.wz[i] * b.wz[i];
+                b.sleepTimer[i] = v2 > still || w2 > still ? 0.0f : b.sleepTimer[i] + dt;
+                minTimer = std::min(minTimer, b.sleepTimer[i]);
+            }
+            if (minTimer >= settings_.sleepTime)
+                for (uint32_t k = 0; k < count; ++k) {
+                    uint32_t i = list[k];
+                    b.awake[i] = 0;
+                    b.vx[i] = b.vy[i] = b.vz[i] = b.wx[i] = b.wy[i] = b.wz[i] = 0;
+                }
+        }
+    });
+}
+
+void RigidWorld::IntegratePositions(float dt)
+{
+    DC_PROFILE_ZONE("Rigid::IntegratePositions");
+    RigidBodies& b = bodies_;
+    jobs::ParallelFor(0, b.Size(), kBodyGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (!b.awake[i]) continue;
+            const float* p = &push_[i * 6];
+            b.px[i] += (b.vx[i] + p[0]) * dt, b.py[i] += (b.vy[i] + p[1]) * dt, b.pz[i] += (b.vz[i] + p[2]) * dt;
+            // q += 0.5 * dt * (w, 0) * q
+            const float h = 0.5f * dt, x = b.qx[i], y = b.qy[i], z = b.qz[i], w = b.qw[i];
+            const float ax = b.wx[i] + p[3], ay = b.wy[i] + p[4], az = b.wz[i] + p[5];
+            const float nx = x + h * (ax * w + ay * z - az * y);
+            const float ny = y + h * (ay * w + az * x - ax * z);
+            const float nz = z + h * (az * w + ax * y - ay * x);
+            const float nw = w - h * (ax * x + ay * y + az * z);
+            const float l = 1.0f / std::sqrt(nx * nx + ny * ny + nz * nz + nw * nw);
+            b.qx[i] = nx * l, b.qy[i] = ny * l, b.qz[i] = nz * l, b.qw[i] = nw * l;
+        }
+    });
+}
+
+uint64_t RigidWorld::StateHash() const
+{
+    const RigidBodies& b = bodies_;
+    const std::vector<float>* arrays[] = {&b.px, &b.py, &b.pz, &b.qx, &b.qy, &b.qz, &b.qw, &b.vx, &b.vy, &b.vz, &b.wx, &b.wy, &b.wz};
+    uint64_t h[std::size(arrays)];
+    for (size_t k = 0; k < std::size(arrays); ++k) h[k] = core::Hash64(arrays[k]->data(), arrays[k]->size() * sizeof(float));
+    return core::Hash64(h, sizeof(h));
+}
+
+} // namespace dancore::physics
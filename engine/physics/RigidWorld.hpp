@@ -0,0 +1,143 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Твёрдые тела в раскладке SoA: каждое поле — свой массив по номеру тела.
+//
+// Шаг фиксированный (Advance копит время кадра и делает 0..maxSubSteps шагов):
+//   широкая фаза — sweep-and-prune по x, порядок сохраняется между шагами, так что
+//     сортировка вставками почти линейна; пересечения y/z — векторизуемым проходом по
+//     отсортированным массивам AABB, параллельно по диапазонам;
+//   узкая фаза — параллельно по парам (коробка/сфера/плоскость земли, до 4 точек);
+//   острова — связные по контактам группы динамических тел; каждый решается
+//     последовательными импульсами целиком в одной задаче. Трение — одно на манифолд
+//     (в центре пятна плюс кручение), выталкивание из проникновения — отдельными
+//     скоростями на один шаг, чтобы не добавлять энергии.
+// Результат не зависит от числа потоков: пары, контакты и острова идут в порядке номеров
+// тел, а внутри острова всё считается последовательно. Острова, которые долго стоят,
+// засыпают и не считаются, пока их не заденет бодрствующее тело.
+//
+// Тела добавляются до симуляции; удаления нет — для нового набора Clear() и Add заново.
+// Только главный поток (задачи ставит сам).
+
+namespace dancore::physics {
+
+using BodyId = uint32_t;
+
+enum class RigidShape : uint8_t { Box, Sphere };
+
+struct RigidBodyDesc {
+    RigidShape shape = RigidShape::Box;
+    float halfExtents[3] = {0.5f, 0.5f, 0.5f}; // сфера: радиус — halfExtents[0]
+    float position[3] = {};
+    float orientation[4] = {0, 0, 0, 1};        // кватернион x, y, z, w
+    float linearVelocity[3] = {};
+    float angularVelocity[3] = {};
+    float mass = 1.0f;                          // 0 — статическое тело
+    float friction = 0.5f;
+    float restitution = 0.0f;
+};
+
+struct RigidSettings {
+    float gravity[3] = {0, -9.81f, 0};
+    double fixedDt = 1.0 / 120.0;              // мелкий шаг держит стопки лучше лишних итераций
+    int maxSubSteps = 8;                       // больше за кадр не догоняем: время теряется
+    int iterations = 4;                        // проходов солвера на шаг
+    float baumgarte = 0.2f;                    // доля проникновения, выталкиваемая за шаг
+    float slop = 0.005f;                       // допустимое проникновение, м
+    float sleepVelocity = 0.05f;               // м/с и рад/с
+    float sleepTime = 0.5f;                    // с покоя до засыпания острова
+    bool ground = true;                        // бесконечная плоскость y = groundY
+    float groundY = 0.0f;
+};
+
+struct RigidStats {
+    uint32_t bodies = 0;
+    uint32_t awake = 0;
+    uint32_t pairs = 0;                        // после широкой фазы
+    uint32_t manifolds = 0;
+    uint32_t contacts = 0;
+    uint32_t islands = 0;                      // бодрствующие
+    double broadMs = 0, narrowMs = 0, solveMs = 0;
+};
+
+// Состояние тел по массивам; индексы — BodyId
+struct RigidBodies {
+    std::vector<float> px, py, pz;
+    std::vector<float> qx, qy, qz, qw;
+    std::vector<float> vx, vy, vz;
+    std::vector<float> wx, wy, wz;
+    std::vector<float> hx, hy, hz;             // полуразмеры (сфера — радиус в hx)
+    std::vector<float> invMass;
+    std::vector<float> ix, iy, iz;             // обратный тензор инерции в осях тела
+    std::vector<float> friction, restitution;
+    std::vector<float> sleepTimer;
+    std::vector<uint8_t> shape;                // RigidShape
+    std::vector<uint8_t> awake;
+
+    size_t Size() const { return px.size(); }
+};
+
+class RigidWorld {
+public:
+    explicit RigidWorld(const RigidSettings& settings = {});
+    ~RigidWorld();
+
+    BodyId Add(const RigidBodyDesc& desc);
+    void Clear();
+    size_t Count() const { return bodies_.Size(); }
+
+    // Время кадра -> фиксированные шаги; возвращает число сделанных шагов
+    int Advance(double frameSeconds);
+    // Доля шага, оставшаяся в накопителе: для интерполяции при отрисовке
+    float Alpha() const { return float(accumulator_ / settings_.fixedDt); }
+    void Step();
+
+    const RigidBodies& Bodies() const { return bodies_; }
+    void GetPosition(BodyId id, float out[3]) const;
+    void GetOrientation(BodyId id, float out[4]) const;
+    void SetLinearVelocity(BodyId id, const float v[3]); // будит тело
+    bool Awake(BodyId id) const { return bodies_.awake[id] != 0; }
+
+    const RigidSettings& Settings() const { return settings_; }
+    const RigidStats& Stats() const { return stats_; }
+    // Хэш позиций, поворотов и скоростей: одинаков при любом числе потоков
+    uint64_t StateHash() const;
+
+private:
+    struct Manifold;
+    struct Pair { uint32_t a, b; };
+
+    void IntegrateVelocities(float dt);
+    void Broadphase();
+    void Narrowphase();
+    void BuildIslands();
+    void Solve(float dt);
+    void IntegratePositions(float dt);
+
+    RigidSettings settings_;
+    RigidBodies bodies_;
+    double accumulator_ = 0;
+
+    // мировые AABB и повёрнутые обратные тензоры (9 на тело), пересчёт каждый шаг
+    std::vector<float> minX_, minY_, minZ_, maxX_, maxY_, maxZ_;
+    std::vector<float> invInertia_;
+    std::vector<float> push_;             // скорости выталкивания (6 на тело), только на шаг
+    // широкая фаза: порядок по minX и отсортированные копии AABB
+    std::vector<uint32_t> order_;
+    std::vector<float> sMinX_, sMaxX_, sMinY_, sMaxY_, sMinZ_, sMaxZ_;
+    std::vector<std::vector<Pair>> rangePairs_;
+    std::vector<Pair> pairs_;
+    // узкая фаза: манифолды этого и прошлого шага (тёплый старт по паре и признаку точки)
+    std::vector<Manifold> manifolds_, previous_;
+    // острова: тела и манифолды подряд, границы в islandBodies_/islandManifolds_
+    std::vector<uint32_t> parent_;
+    std::vector<uint32_t> islandBodyList_, islandManifoldList_;
+    std::vector<uint32_t> islandBodies_, islandManifolds_; // префиксные границы, size = islands + 1
+    std::vector<uint8_t> islandAwake_;
+
+    RigidStats stats_;
+};
+
+} // namespace dancore::physics
@@ -0,0 +1,97 @@
+#include "ScenePhysics.hpp"
+#include "core/Log.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dancore::physics {
+
+namespace scene = dancore::core::scene;
+
+namespace {
+
+constexpr float kDegToRad = 3.14159265358979f / 180.0f;
+constexpr float kRadToDeg = 180.0f / 3.14159265358979f;
+
+// Углы Эйлера редактора (M = Rz * Ry * Rx) -> кватернион qz * qy * qx
+void EulerToQuat(const scene::Rotation& r, float q[4])
+{
+    const float hx = 0.5f * r.x * kDegToRad, hy = 0.5f * r.y * kDegToRad, hz = 0.5f * r.z * kDegToRad;
+    const float sx = std::sin(hx), cx = std::cos(hx), sy = std::sin(hy), cy = std::cos(hy);
+    const float sz = std::sin(hz), cz = std::cos(hz);
+    q[0] = sx * cy * cz - cx * sy * sz;
+    q[1] = cx * sy * cz + sx * cy * sz;
+    q[2] = cx * cy * sz - sx * sy * cz;
+    q[3] = cx * cy * cz + sx * sy * sz;
+}
+
+// Обратно по элементам матрицы поворота, как их раскладывает UpdateLocalToWorld
+scene::Rotation QuatToEuler(const float q[4])
+{
+    const float x = q[0], y = q[1], z = q[2], w = q[3];
+    const float m0 = 1 - 2 * (y * y + z * z), m1 = 2 * (x * y + z * w), m2 = 2 * (x * z - y * w);
+    const float m6 = 2 * (y * z + x * w), m10 = 1 - 2 * (x * x + y * y);
+    return {std::atan2(m6, m10) * kRadToDeg, std::asin(std::clamp(-m2, -1.0f, 1.0f)) * kRadToDeg,
+            std::atan2(m1, m0) * kRadToDeg};
+}
+
+} // namespace
+
+ScenePhysics::ScenePhysics(const RigidSettings& settings) : rigid_(settings) {}
+
+void ScenePhysics::Begin(core::ecs::World& world)
+{
+    if (running_) End(world);
+    rigid_.Clear();
+    bindings_.clear();
+    world.Each<const scene::PhysicsBody, const scene::Position, const scene::Rotation, const scene::Scale>(
+        [&](uint32_t count, const core::ecs::Entity* entities, const scene::PhysicsBody* body, const scene::Position* p,
+            const scene::Rotation* r, const scene::Scale* s) {
+            for (uint32_t i = 0; i < count; ++i) {
+                if (body[i].mode != scene::PhysicsBody::Rigid) continue;
+                RigidBodyDesc d;
+                d.halfExtents[0] = 0.5f * std::abs(s[i].x);
+                d.halfExtents[1] = 0.5f * std::abs(s[i].y);
+                d.halfExtents[2] = 0.5f * std::abs(s[i].z);
+                d.position[0] = p[i].x, d.position[1] = p[i].y, d.position[2] = p[i].z;
+                EulerToQuat(r[i], d.orientation);
+                d.mass = 8.0f * d.halfExtents[0] * d.halfExtents[1] * d.halfExtents[2];
+                bindings_.push_back({entities[i], rigid_.Add(d), p[i], r[i]});
+            }
+        });
+    running_ = true;
+    DC_LOG_INFO(Physics, "play: {} rigid bodies", bindings_.size());
+}
+
+void ScenePhysics::Update(core::ecs::World& world, double frameSeconds)
+{
+    DC_PROFILE_ZONE("ScenePhysics::Update");
+    if (!running_ || !rigid_.Advance(frameSeconds)) return;
+    for (const Binding& b : bindings_) {
+        // спящие не трогаем: чанк не помечается изменённым
+        if (!rigid_.Awake(b.body)) continue;
+        scene::Position* p = world.Get<scene::Position>(b.entity);
+        scene::Rotation* r = world.Get<scene::Rotation>(b.entity);
+        if (!p || !r) continue; // удалена во время Play
+        float pos[3], q[4];
+        rigid_.GetPosition(b.body, pos);
+        rigid_.GetOrientation(b.body, q);
+        *p = {pos[0], pos[1], pos[2]};
+        *r = QuatToEuler(q);
+    }
+}
+
+void ScenePhysics::End(core::ecs::World& world)
+{
+    if (!running_) return;
+    for (const Binding& b : bindings_) {
+        if (scene::Position* p = world.Get<scene::Position>(b.entity)) *p = b.position;
+        if (scene::Rotation* r = world.Get<scene::Rotation>(b.entity)) *r = b.rotation;
+    }
+    bindings_.clear();
+    rigid_.Clear();
+    running_ = false;
+}
+
+} // namespace dancore::physics
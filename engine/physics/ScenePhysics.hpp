@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+
+#include "RigidWorld.hpp"
+#include "core/SceneComponents.hpp"
+
+// Мост сцены и RigidWorld для режима Play в редакторе.
+//
+// Begin собирает сущности с PhysicsBody::Rigid и трансформом в тела: коробка по Scale
+// (куб 1 м в масштабе), масса — объём при плотности 1, земля — плоскость y = 0.
+// Update делает шаги и пишет позы бодрствующих тел обратно в Position/Rotation, мимо
+// журнала правок. End возвращает трансформы, какими они были до Begin.
+// Только главный поток.
+
+namespace dancore::physics {
+
+class ScenePhysics {
+public:
+    explicit ScenePhysics(const RigidSettings& settings = {});
+
+    void Begin(core::ecs::World& world);
+    void Update(core::ecs::World& world, double frameSeconds);
+    void End(core::ecs::World& world);
+
+    bool Running() const { return running_; }
+    const RigidWorld& Rigid() const { return rigid_; }
+
+private:
+    struct Binding {
+        core::ecs::Entity entity;
+        BodyId body;
+        core::scene::Position position; // до Play
+        core::scene::Rotation rotation;
+    };
+
+    RigidWorld rigid_;
+    std::vector<Binding> bindings_;
+    bool running_ = false;
+};
+
+} // namespace dancore::physics
@@ -0,0 +1,459 @@
+#include "VoxelGrid.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace dancore::physics {
+
+namespace {
+
+constexpr uint64_t kKeyMask = (uint64_t(1) << 21) - 1;
+constexpr int kBrickMask = kVoxelBrickSize - 1;
+constexpr int kChunkMask = kVoxelChunkSize - 1;
+
+int Cell(int x, int y, int z) { return x + kVoxelBrickSize * (y + kVoxelBrickSize * z); }
+
+bool Full(const uint64_t (&occupancy)[kVoxelBrickSize])
+{
+    uint64_t all = ~uint64_t(0);
+    for (uint64_t w : occupancy) all &= w;
+    return all == ~uint64_t(0);
+}
+
+bool Empty(const uint64_t (&occupancy)[kVoxelBrickSize])
+{
+    uint64_t any = 0;
+    for (uint64_t w : occupancy) any |= w;
+    return any == 0;
+}
+
+uint8_t BitsFor(size_t paletteSize)
+{
+    uint8_t bits = 0;
+    while ((size_t(1) << bits) < paletteSize) bits = bits ? uint8_t(bits * 2) : 1;
+    return bits;
+}
+
+uint32_t ReadIndex(const VoxelBrickData& d, int cell)
+{
+    size_t bit = size_t(cell) * d.bits;
+    return uint32_t(d.indices[bit >> 6] >> (bit & 63)) & ((1u << d.bits) - 1);
+}
+
+void WriteIndex(VoxelBrickData& d, int cell, uint32_t index)
+{
+    size_t bit = size_t(cell) * d.bits;
+    uint64_t mask = ((uint64_t(1) << d.bits) - 1) << (bit & 63);
+    d.indices[bit >> 6] = (d.indices[bit >> 6] & ~mask) | (uint64_t(index) << (bit & 63) & mask);
+}
+
+// Фигуры для VoxelGrid::Fill: границы в ячейках и классификация блока [min, max]
+enum class Cover { Outside, Inside, Partial };
+
+struct BoxShape {
+    int32_t lo[3], hi[3];
+    Cover Classify(const int32_t min[3], const int32_t max[3]) const
+    {
+        bool inside = true;
+        for (int a = 0; a < 3; ++a) {
+            if (max[a] < lo[a] || min[a] > hi[a]) return Cover::Outside;
+            inside &= min[a] >= lo[a] && max[a] <= hi[a];
+        }
+        return inside ? Cover::Inside : Cover::Partial;
+    }
+    bool Contains(int32_t x, int32_t y, int32_t z) const
+    {
+        return x >= lo[0] && x <= hi[0] && y >= lo[1] && y <= hi[1] && z >= lo[2] && z <= hi[2];
+    }
+};
+
+// Ячейка внутри, если внутри её центр
+struct SphereShape {
+    int32_t lo[3], hi[3];
+    float c[3], r2;
+    Cover Classify(const int32_t min[3], const int32_t max[3]) const
+    {
+        float nearest = 0, farthest = 0;
+        for (int a = 0; a < 3; ++a) {
+            float b0 = float(min[a]) + 0.5f, b1 = float(max[a]) + 0.5f; // центры крайних ячеек
+            float n = std::clamp(c[a], b0, b1) - c[a];
+            float f = std::max(std::abs(b0 - c[a]), std::abs(b1 - c[a]));
+            nearest += n * n;
+            farthest += f * f;
+        }
+        if (nearest > r2) return Cover::Outside;
+        return farthest <= r2 ? Cover::Inside : Cover::Partial;
+    }
+    bool Contains(int32_t x, int32_t y, int32_t z) const
+    {
+        float dx = float(x) + 0.5f - c[0], dy = float(y) + 0.5f - c[1], dz = float(z) + 0.5f - c[2];
+        return dx * dx + dy * dy + dz * dz <= r2;
+    }
+};
+
+} // namespace
+
+VoxelChunkKey PackChunkKey(int32_t cx, int32_t cy, int32_t cz)
+{
+    return (uint64_t(uint32_t(cx)) & kKeyMask) | (uint64_t(uint32_t(cy)) & kKeyMask) << 21 | (uint64_t(uint32_t(cz)) & kKeyMask) << 42;
+}
+
+void UnpackChunkKey(VoxelChunkKey key, int32_t& cx, int32_t& cy, int32_t& cz)
+{
+    auto unpack = [](uint64_t v) { return int32_t(uint32_t(v & kKeyMask) << 11) >> 11; };
+    cx = unpack(key);
+    cy = unpack(key >> 21);
+    cz = unpack(key >> 42);
+}
+
+// ---- VoxelBrick ----
+
+VoxelBrick::VoxelBrick(const VoxelBrick& o) : uniform_(o.uniform_)
+{
+    if (o.data_) data_ = std::make_unique<VoxelBrickData>(*o.data_);
+}
+
+VoxelBrick& VoxelBrick::operator=(const VoxelBrick& o)
+{
+    if (this != &o) {
+        uniform_ = o.uniform_;
+        data_ = o.data_ ? std::make_unique<VoxelBrickData>(*o.data_) : nullptr;
+    }
+    return *this;
+}
+
+VoxelMaterial VoxelBrick::Get(int cell) const
+{
+    if (!data_) return uniform_;
+    const VoxelBrickData& d = *data_;
+    if (!((d.occupancy[cell >> 6] >> (cell & 63)) & 1)) return 0;
+    return d.palette[d.bits ? ReadIndex(d, cell) : 0];
+}
+
+void VoxelBrick::Repack(uint8_t bits)
+{
+    VoxelBrickData& d = *data_;
+    std::vector<uint64_t> old;
+    old.swap(d.indices);
+    uint8_t oldBits = d.bits;
+    d.bits = bits;
+    d.indices.assign(size_t(kVoxelBrickCells) * bits / 64, 0);
+    if (!oldBits) return; // была одна запись: все индексы 0
+    for (int cell = 0; cell < kVoxelBrickCells; ++cell) {
+        size_t bit = size_t(cell) * oldBits;
+        WriteIndex(d, cell, uint32_t(old[bit >> 6] >> (bit & 63)) & ((1u << oldBits) - 1));
+    }
+}
+
+uint32_t VoxelBrick::PaletteIndex(VoxelMaterial m)
+{
+    VoxelBrickData& d = *data_;
+    auto it = std::find(d.palette.begin(), d.palette.end(), m);
+    if (it != d.palette.end()) return uint32_t(it - d.palette.begin());
+    d.palette.push_back(m);
+    if (uint8_t bits = BitsFor(d.palette.size()); bits != d.bits) Repack(bits);
+    return uint32_t(d.palette.size() - 1);
+}
+
+void VoxelBrick::Set(int cell, VoxelMaterial m)
+{
+    if (!data_) {
+        if (m == uniform_) return;
+        data_ = std::make_unique<VoxelBrickData>();
+        if (uniform_) {
+            std::memset(data_->occupancy, 0xFF, sizeof(data_->occupancy));
+            data_->palette.push_back(uniform_);
+        }
+    }
+    VoxelBrickData& d = *data_;
+    uint64_t bit = uint64_t(1) << (cell & 63);
+    if (m == 0) {
+        d.occupancy[cell >> 6] &= ~bit;
+        if (Empty(d.occupancy)) Fill(0);
+        return;
+    }
+    uint32_t index = PaletteIndex(m);
+    if (d.bits) WriteIndex(d, cell, index);
+    d.occupancy[cell >> 6] |= bit;
+    if (d.palette.size() == 1 && Full(d.occupancy)) Fill(m);
+}
+
+void VoxelBrick::Decode(VoxelMaterial* out) const
+{
+    if (!data_) {
+        std::fill(out, out + kVoxelBrickCells, uniform_);
+        return;
+    }
+    // индексы слово за словом (запись не пересекает границу слова), воздух — по маске
+    const VoxelBrickData& d = *data_;
+    if (d.bits) {
+        const int perWord = 64 / d.bits;
+        const uint64_t mask = (uint64_t(1) << d.bits) - 1;
+        for (size_t w = 0; w < d.indices.size(); ++w) {
+            uint64_t v = d.indices[w];
+            for (int k = 0; k < perWord; ++k, v >>= d.bits) out[w * perWord + k] = d.palette[v & mask];
+        }
+    } else {
+        std::fill(out, out + kVoxelBrickCells, d.palette[0]);
+    }
+    for (int cell = 0; cell < kVoxelBrickCells; ++cell)
+        out[cell] = VoxelMaterial(out[cell] * ((d.occupancy[cell >> 6] >> (cell & 63)) & 1));
+}
+
+void VoxelBrick::Compact()
+{
+    if (!data_) return;
+    VoxelMaterial cells[kVoxelBrickCells];
+    Decode(cells);
+    if (std::all_of(cells + 1, cells + kVoxelBrickCells, [&](VoxelMaterial m) { return m == cells[0]; })) {
+        Fill(cells[0]);
+        return;
+    }
+    VoxelBrickData& d = *data_;
+    d.palette.clear();
+    for (VoxelMaterial m : cells)
+        if (m && std::find(d.palette.begin(), d.palette.end(), m) == d.palette.end()) d.palette.push_back(m);
+    d.bits = BitsFor(d.palette.size());
+    d.indices.assign(size_t(kVoxelBrickCells) * d.bits / 64, 0);
+    d.indices.shrink_to_fit();
+    d.palette.shrink_to_fit();
+    if (d.bits)
+        for (int cell = 0; cell < kVoxelBrickCells; ++cell)
+            if (cells[cell])
+                WriteIndex(d, cell, uint32_t(std::find(d.palette.begin(), d.palette.end(), cells[cell]) - d.palette.begin()));
+}
+
+size_t VoxelBrick::MemoryBytes() const
+{
+    if (!data_) return 0;
+    return sizeof(VoxelBrickData) + data_->palette.capacity() * sizeof(VoxelMaterial) + data_->indices.capacity() * 8;
+}
+
+// ---- VoxelChunk ----
+
+VoxelMaterial VoxelChunk::Get(int x, int y, int z) const
+{
+    if (bricks_.empty()) return uniform_;
+    return Brick(x >> 3, y >> 3, z >> 3).Get(Cell(x & kBrickMask, y & kBrickMask, z & kBrickMask));
+}
+
+bool VoxelChunk::Solid(int x, int y, int z) const
+{
+    if (bricks_.empty()) return uniform_ != 0;
+    return Brick(x >> 3, y >> 3, z >> 3).Solid(Cell(x & kBrickMask, y & kBrickMask, z & kBrickMask));
+}
+
+VoxelBrick& VoxelChunk::MutableBrick(int bx, int by, int bz)
+{
+    if (bricks_.empty()) bricks_.assign(kVoxelBricksPerAxis * kVoxelBricksPerAxis * kVoxelBricksPerAxis, VoxelBrick(uniform_));
+    return bricks_[bx + kVoxelBricksPerAxis * (by + kVoxelBricksPerAxis * bz)];
+}
+
+void VoxelChunk::Collapse()
+{
+    if (bricks_.empty() || !bricks_[0].Uniform()) return;
+    VoxelMaterial m = bricks_[0].UniformMaterial();
+    for (const VoxelBrick& b : bricks_)
+        if (!b.Uniform() || b.UniformMaterial() != m) return;
+    uniform_ = m;
+    std::vector<VoxelBrick>().swap(bricks_);
+}
+
+size_t VoxelChunk::MemoryBytes() const
+{
+    size_t bytes = sizeof(VoxelChunk) + bricks_.capacity() * sizeof(VoxelBrick);
+    for (const VoxelBrick& b : bricks_) bytes += b.MemoryBytes();
+    return bytes;
+}
+
+// ---- VoxelGrid ----
+
+VoxelChunk* VoxelGrid::MutableChunk(VoxelChunkKey key)
+{
+    std::shared_ptr<VoxelChunk>& p = chunks_[key];
+    if (!p) p = std::make_shared<VoxelChunk>();
+    else if (p.use_count() > 1) p = std::make_shared<VoxelChunk>(*p); // старую версию дочитывает задача мешинга
+    return p.get();
+}
+
+void VoxelGrid::Touch(int32_t cx, int32_t cy, int32_t cz, unsigned faces)
+{
+    dirty_.insert(PackChunkKey(cx, cy, cz));
+    static const int kDir[6][3] = {{-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+    for (int f = 0; f < 6; ++f)
+        if ((faces >> f) & 1) dirty_.insert(PackChunkKey(cx + kDir[f][0], cy + kDir[f][1], cz + kDir[f][2]));
+}
+
+void VoxelGrid::Release(VoxelChunkKey key)
+{
+    auto it = chunks_.find(key);
+    if (it != chunks_.end() && it->second->Uniform() && it->second->UniformMaterial() == 0) chunks_.erase(it);
+}
+
+std::shared_ptr<const VoxelChunk> VoxelGrid::Chunk(VoxelChunkKey key) const
+{
+    auto it = chunks_.find(key);
+    return it == chunks_.end() ? nullptr : it->second;
+}
+
+VoxelMaterial VoxelGrid::Get(int32_t x, int32_t y, int32_t z) const
+{
+    auto it = chunks_.find(PackChunkKey(x >> kVoxelChunkBits, y >> kVoxelChunkBits, z >> kVoxelChunkBits));
+    return it == chunks_.end() ? 0 : it->second->Get(x & kChunkMask, y & kChunkMask, z & kChunkMask);
+}
+
+void VoxelGrid::Set(int32_t x, int32_t y, int32_t z, VoxelMaterial m)
+{
+    if (Get(x, y, z) == m) return; // без копии чанка и без перемешивания
+    int32_t cx = x >> kVoxelChunkBits, cy = y >> kVoxelChunkBits, cz = z >> kVoxelChunkBits;
+    int lx = x & kChunkMask, ly = y & kChunkMask, lz = z & kChunkMask;
+    VoxelChunkKey key = PackChunkKey(cx, cy, cz);
+    VoxelChunk* chunk = MutableChunk(key);
+    chunk->MutableBrick(lx >> 3, ly >> 3, lz >> 3).Set(Cell(lx & kBrickMask, ly & kBrickMask, lz & kBrickMask), m);
+    chunk->Collapse();
+    ++chunk->version_;
+    // соседу меш нужен заново, только если ячейка на общей грани
+    unsigned faces = unsigned(lx == 0) | unsigned(lx == kChunkMask) << 1 | unsigned(ly == 0) << 2 |
+                     unsigned(ly == kChunkMask) << 3 | unsigned(lz == 0) << 4 | unsigned(lz == kChunkMask) << 5;
+    Touch(cx, cy, cz, faces);
+    if (m == 0) Release(key);
+}
+
+template <class Shape>
+void VoxelGrid::Fill(const Shape& shape, VoxelMaterial m)
+{
+    DC_PROFILE_ZONE("VoxelGrid::Fill");
+    int32_t c0[3], c1[3];
+    for (int a = 0; a < 3; ++a) {
+        c0[a] = shape.lo[a] >> kVoxelChunkBits;
+        c1[a] = shape.hi[a] >> kVoxelChunkBits;
+    }
+    for (int32_t cz = c0[2]; cz <= c1[2]; ++cz)
+        for (int32_t cy = c0[1]; cy <= c1[1]; ++cy)
+            for (int32_t cx = c0[0]; cx <= c1[0]; ++cx) {
+                const int32_t base[3] = {cx * kVoxelChunkSize, cy * kVoxelChunkSize, cz * kVoxelChunkSize};
+                const int32_t top[3] = {base[0] + kChunkMask, base[1] + kChunkMask, base[2] + kChunkMask};
+                Cover cover = shape.Classify(base, top);
+                if (cover == Cover::Outside) continue;
+                VoxelChunkKey key = PackChunkKey(cx, cy, cz);
+                if (m == 0 && !chunks_.count(key)) continue; // стирать нечего
+                VoxelChunk* chunk = MutableChunk(key);
+                if (cover == Cover::Inside) {
+                    std::vector<VoxelBrick>().swap(chunk->bricks_);
+                    chunk->uniform_ = m;
+                } else {
+                    for (int bz = 0; bz < kVoxelBricksPerAxis; ++bz)
+                        for (int by = 0; by < kVoxelBricksPerAxis; ++by)
+                            for (int bx = 0; bx < kVoxelBricksPerAxis; ++bx) {
+                                const int32_t b0[3] = {base[0] + bx * kVoxelBrickSize, base[1] + by * kVoxelBrickSize, base[2] + bz * kVoxelBrickSize};
+                                const int32_t b1[3] = {b0[0] + kBrickMask, b0[1] + kBrickMask, b0[2] + kBrickMask};
+                                Cover bc = shape.Classify(b0, b1);
+                                if (bc == Cover::Outside) continue;
+                                VoxelBrick& brick = chunk->MutableBrick(bx, by, bz);
+                                if (bc == Cover::Inside) {
+                                    brick.Fill(m);
+                                    continue;
+                                }
+                                if (brick.Uniform() && brick.UniformMaterial() == m) continue;
+                                for (int z = 0; z < kVoxelBrickSize; ++z)
+                                    for (int y = 0; y < kVoxelBrickSize; ++y)
+                                        for (int x = 0; x < kVoxelBrickSize; ++x)
+                                            if (shape.Contains(b0[0] + x, b0[1] + y, b0[2] + z)) brick.Set(Cell(x, y, z), m);
+                                brick.Compact();
+                            }
+                    chunk->Collapse();
+                }
+                ++chunk->version_;
+                Touch(cx, cy, cz, 0x3F);
+                if (m == 0) Release(key);
+            }
+}
+
+void VoxelGrid::FillBox(const int32_t min[3], const int32_t max[3], VoxelMaterial m)
+{
+    BoxShape box{};
+    for (int a = 0; a < 3; ++a) {
+        if (min[a] > max[a]) return;
+        box.lo[a] = min[a];
+        box.hi[a] = max[a];
+    }
+    Fill(box, m);
+}
+
+void VoxelGrid::FillSphere(const float center[3], float radius, VoxelMaterial m)
+{
+    if (!(radius > 0)) return;
+    SphereShape sphere{};
+    for (int a = 0; a < 3; ++a) {
+        sphere.c[a] = center[a];
+        sphere.lo[a] = int32_t(std::floor(center[a] - radius));
+        sphere.hi[a] = int32_t(std::ceil(center[a] + radius));
+    }
+    sphere.r2 = radius * radius;
+    Fill(sphere, m);
+}
+
+bool VoxelGrid::Raycast(const float origin[3], const float dir[3], float maxDistance, VoxelHit& hit) const
+{
+    float len = std::sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+    if (!(len > 0)) return false;
+    float d[3] = {dir[0] / len, dir[1] / len, dir[2] / len};
+    int32_t cell[3], step[3];
+    float tMax[3], tDelta[3];
+    for (int a = 0; a < 3; ++a) {
+        cell[a] = int32_t(std::floor(origin[a]));
+        step[a] = d[a] > 0 ? 1 : d[a] < 0 ? -1 : 0;
+        tDelta[a] = step[a] ? std::abs(1.0f / d[a]) : INFINITY;
+        float next = step[a] > 0 ? float(cell[a] + 1) - origin[a] : origin[a] - float(cell[a]);
+        tMax[a] = step[a] ? next * tDelta[a] : INFINITY;
+    }
+    // кэш последнего чанка: соседние ячейки луча почти всегда в нём
+    VoxelChunkKey lastKey = ~VoxelChunkKey(0);
+    const VoxelChunk* chunk = nullptr;
+    int axis = -1;
+    float t = 0;
+    while (t <= maxDistance) {
+        VoxelChunkKey key = PackChunkKey(cell[0] >> kVoxelChunkBits, cell[1] >> kVoxelChunkBits, cell[2] >> kVoxelChunkBits);
+        if (key != lastKey) {
+            auto it = chunks_.find(key);
+            chunk = it == chunks_.end() ? nullptr : it->second.get();
+            lastKey = key;
+        }
+        if (chunk) {
+            VoxelMaterial m = chunk->Get(cell[0] & kChunkMask, cell[1] & kChunkMask, cell[2] & kChunkMask);
+            if (m) {
+                hit = {cell[0], cell[1], cell[2], 0, 0, 0, t, m};
+                if (axis >= 0) (&hit.nx)[axis] = -step[axis];
+                return true;
+            }
+        }
+        axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+        t = tMax[axis];
+        tMax[axis] += tDelta[axis];
+        cell[axis] += step[axis];
+    }
+    return false;
+}
+
+VoxelGridStats VoxelGrid::Stats() const
+{
+    VoxelGridStats s;
+    s.bytes = chunks_.bucket_count() * sizeof(void*);
+    for (const auto& [key, chunk] : chunks_) {
+        ++s.chunks;
+        s.uniformChunks += chunk->Uniform();
+        s.bytes += chunk->MemoryBytes() + sizeof(key) + sizeof(chunk) + 2 * sizeof(void*);
+        for (const VoxelBrick& b : chunk->bricks_) s.detailedBricks += !b.Uniform();
+    }
+    return s;
+}
+
+void VoxelGrid::TakeDirty(std::vector<VoxelChunkKey>& out)
+{
+    out.assign(dirty_.begin(), dirty_.end());
+    dirty_.clear();
+}
+
+} // namespace dancore::physics
@@ -0,0 +1,139 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Разреженное воксельное поле: чанки 32³ в хэш-таблице, чанк — 4³ кирпичей по 8³.
+//
+// Однородный кирпич (весь воздух или весь один материал) хранит только материал;
+// неоднородный — битовую маску занятости 512 бит и индексы в палитру своих
+// материалов по 0..16 бит на ячейку. Однородный чанк не хранит кирпичей, пустой не
+// хранится вовсе. Так память растёт с площадью поверхности, а не с объёмом.
+//
+// Чанки неизменяемы для читателей: правка копирует чанк, если его ещё держит задача
+// мешинга (shared_ptr), так что задачи читают без замков. Правки — с главного потока.
+
+namespace dancore::physics {
+
+using VoxelMaterial = uint16_t; // 0 — воздух
+
+inline constexpr int kVoxelChunkBits = 5;
+inline constexpr int kVoxelChunkSize = 1 << kVoxelChunkBits;   // 32
+inline constexpr int kVoxelBrickSize = 8;
+inline constexpr int kVoxelBricksPerAxis = kVoxelChunkSize / kVoxelBrickSize;
+inline constexpr int kVoxelBrickCells = kVoxelBrickSize * kVoxelBrickSize * kVoxelBrickSize;
+
+// Чанк по координатам чанка, по 21 бит на ось со знаком
+using VoxelChunkKey = uint64_t;
+VoxelChunkKey PackChunkKey(int32_t cx, int32_t cy, int32_t cz);
+void UnpackChunkKey(VoxelChunkKey key, int32_t& cx, int32_t& cy, int32_t& cz);
+
+struct VoxelBrickData {
+    uint64_t occupancy[kVoxelBrickSize] = {}; // слово z, бит x + 8 * y
+    uint8_t bits = 0;                         // на индекс палитры: 0 (одна запись), 1, 2, 4, 8, 16
+    std::vector<VoxelMaterial> palette;       // только твёрдые материалы
+    std::vector<uint64_t> indices;            // kVoxelBrickCells * bits бит, ячейка x + 8y + 64z
+};
+
+class VoxelBrick {
+public:
+    VoxelBrick() = default;
+    explicit VoxelBrick(VoxelMaterial uniform) : uniform_(uniform) {}
+    VoxelBrick(const VoxelBrick& o);
+    VoxelBrick& operator=(const VoxelBrick& o);
+    VoxelBrick(VoxelBrick&&) = default;
+    VoxelBrick& operator=(VoxelBrick&&) = default;
+
+    bool Uniform() const { return !data_; }
+    VoxelMaterial UniformMaterial() const { return uniform_; } // при Uniform()
+    const VoxelBrickData* Data() const { return data_.get(); }
+
+    VoxelMaterial Get(int cell) const;
+    bool Solid(int cell) const { return data_ ? (data_->occupancy[cell >> 6] >> (cell & 63)) & 1 : uniform_ != 0; }
+    void Set(int cell, VoxelMaterial m);
+    void Fill(VoxelMaterial m) { data_.reset(); uniform_ = m; }
+    // Все 512 ячеек подряд
+    void Decode(VoxelMaterial* out) const;
+    // Пересобрать палитру по факту и схлопнуть в однородный, если можно
+    void Compact();
+    size_t MemoryBytes() const;
+
+private:
+    uint32_t PaletteIndex(VoxelMaterial m);
+    void Repack(uint8_t bits);
+
+    VoxelMaterial uniform_ = 0;
+    std::unique_ptr<VoxelBrickData> data_;
+};
+
+class VoxelChunk {
+public:
+    bool Uniform() const { return bricks_.empty(); }
+    VoxelMaterial UniformMaterial() const { return uniform_; }
+    const VoxelBrick& Brick(int bx, int by, int bz) const { return bricks_[bx + kVoxelBricksPerAxis * (by + kVoxelBricksPerAxis * bz)]; }
+    VoxelMaterial Get(int x, int y, int z) const; // локальные 0..31
+    bool Solid(int x, int y, int z) const;         // только по маске занятости, без палитры
+    uint32_t Version() const { return version_; }
+    size_t MemoryBytes() const;
+
+private:
+    friend class VoxelGrid;
+    VoxelBrick& MutableBrick(int bx, int by, int bz);
+    void Collapse(); // все кирпичи однородны и одинаковы — в однородный чанк
+
+    VoxelMaterial uniform_ = 0;
+    std::vector<VoxelBrick> bricks_; // 64 или пусто
+    uint32_t version_ = 0;
+};
+
+struct VoxelHit {
+    int32_t x = 0, y = 0, z = 0;        // попавшая ячейка
+    int32_t nx = 0, ny = 0, nz = 0;     // нормаль грани входа (-1/0/1)
+    float distance = 0;
+    VoxelMaterial material = 0;
+};
+
+struct VoxelGridStats {
+    size_t chunks = 0;
+    size_t uniformChunks = 0;
+    size_t detailedBricks = 0;
+    size_t bytes = 0;
+};
+
+class VoxelGrid {
+public:
+    VoxelMaterial Get(int32_t x, int32_t y, int32_t z) const;
+    void Set(int32_t x, int32_t y, int32_t z, VoxelMaterial m);
+    // [min, max] включительно; целые кирпичи и чанки внутри заполняются без обхода ячеек
+    void FillBox(const int32_t min[3], const int32_t max[3], VoxelMaterial m);
+    void FillSphere(const float center[3], float radius, VoxelMaterial m);
+
+    // Первая твёрдая ячейка по лучу (DDA); dir не обязан быть нормирован
+    bool Raycast(const float origin[3], const float dir[3], float maxDistance, VoxelHit& hit) const;
+
+    std::shared_ptr<const VoxelChunk> Chunk(VoxelChunkKey key) const;
+    size_t ChunkCount() const { return chunks_.size(); }
+    template <class F> void ForEachChunk(F&& fn) const
+    {
+        for (const auto& [key, chunk] : chunks_) fn(key, *chunk);
+    }
+    VoxelGridStats Stats() const; // обход всех чанков
+
+    // Чанки, которым нужен новый меш (правка внутри или на общей грани), с прошлого вызова
+    void TakeDirty(std::vector<VoxelChunkKey>& out);
+
+private:
+    VoxelChunk* MutableChunk(VoxelChunkKey key);   // создаёт пустой; копирует, если держат задачи
+    // Чанк в dirty_ вместе с соседями по граням из faces (биты -x +x -y +y -z +z)
+    void Touch(int32_t cx, int32_t cy, int32_t cz, unsigned faces);
+    void Release(VoxelChunkKey key);               // убрать, если стал пустым воздухом
+    template <class Shape> void Fill(const Shape& shape, VoxelMaterial m);
+
+    std::unordered_map<VoxelChunkKey, std::shared_ptr<VoxelChunk>> chunks_;
+    std::unordered_set<VoxelChunkKey> dirty_;
+};
+
+} // namespace dancore::physics
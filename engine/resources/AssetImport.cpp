@@ -0,0 +1,447 @@
+#include "AssetImport.hpp"
+#include "BlockCompress.hpp"
+#include "Gltf.hpp"
+#include "core/Hash.hpp"
+#include "core/Log.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace dancore::resources {
+
+namespace fs = std::filesystem;
+namespace jobs = dancore::core::jobs;
+namespace prof = dancore::core::profiler;
+
+namespace {
+
+constexpr uint32_t kModelMagic = 0x4C444D44;   // 'DMDL'
+constexpr uint32_t kTextureMagic = 0x58455444; // 'DTEX'
+constexpr uint64_t kWakeInterval = 50'000'000; // нс: прогресс в простаивающем редакторе — не чаще 20 раз в секунду
+
+std::string Extension(const fs::path& file)
+{
+    std::string ext = file.extension().string();
+    for (char& c : ext) c = char(std::tolower((unsigned char)c));
+    return ext;
+}
+
+std::vector<uint8_t> ReadFile(const fs::path& file)
+{
+    std::ifstream in(file, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("cannot open " + file.string());
+    std::vector<uint8_t> data(size_t(in.tellg()));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size()))) throw std::runtime_error("cannot read " + file.string());
+    return data;
+}
+
+struct Writer {
+    std::vector<uint8_t> out;
+
+    template <class T> void Put(const T& v) { Bytes(&v, sizeof(T)); }
+    void Bytes(const void* p, size_t n)
+    {
+        out.insert(out.end(), static_cast<const uint8_t*>(p), static_cast<const uint8_t*>(p) + n);
+    }
+    void Align(size_t a) { out.resize((out.size() + a - 1) / a * a, 0); }
+};
+
+struct Reader {
+    const uint8_t* p;
+    size_t size, pos = 0;
+    const char* who;
+
+    void Bytes(void* dst, size_t n)
+    {
+        if (n > size - pos) throw std::runtime_error(std::string(who) + ": truncated data");
+        std::memcpy(dst, p + pos, n);
+        pos += n;
+    }
+    template <class T> T Get()
+    {
+        T v;
+        Bytes(&v, sizeof(T));
+        return v;
+    }
+    void Align(size_t a) { pos = std::min(size, (pos + a - 1) / a * a); }
+};
+
+std::vector<uint8_t> ImportModel(const std::vector<uint8_t>& data, const fs::path& file, const ImportSettings& settings)
+{
+    std::vector<MeshPrimitive> primitives = LoadGltf(data.data(), data.size(), file);
+    ModelAsset model;
+    model.quantized = settings.quantizeVertices;
+    model.submeshes.resize(primitives.size());
+    // примитивы независимы: сварка, нормали, порядок и квантование — параллельно
+    jobs::ParallelFor(0, primitives.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            DC_PROFILE_ZONE("ImportModel::Primitive");
+            MeshPrimitive& p = primitives[i];
+            WeldVertices(p);
+            if (!p.hasNormals) GenerateNormals(p);
+            if (settings.optimizeMeshes) {
+                OptimizeVertexCache(p.indices, p.vertices.size());
+                OptimizeOverdraw(p.indices, p.vertices);
+                OptimizeVertexFetch(p);
+            }
+            ModelAsset::Submesh& s = model.submeshes[i];
+            s.name = std::move(p.name);
+            s.material = p.material;
+            if (settings.quantizeVertices) s.quantized = Quantize(p);
+            else s.vertices = std::move(p.vertices);
+            s.indices = std::move(p.indices);
+        }
+    });
+    return WriteModelAsset(model);
+}
+
+std::vector<uint8_t> ImportTexture(const std::vector<uint8_t>& data, const fs::path& file, const ImportSettings& settings)
+{
+    const bool png = Extension(file) == ".png";
+    Image image = png ? DecodePng(data.data(), data.size()) : ReadKtx2(data.data(), data.size());
+    if (png) image.srgb = settings.srgb;
+    if (image.format == PixelFormat::RGBA8) {
+        if (settings.generateMips && image.levels.size() == 1) GenerateMips(image);
+        if (settings.compressTextures) image = CompressBC(image, image.HasAlpha() ? PixelFormat::BC3 : PixelFormat::BC1);
+    }
+    return WriteTextureAsset(image);
+}
+
+} // namespace
+
+uint64_t ImportSettings::Hash(AssetKind kind) const
+{
+    const uint8_t bits[3] = {uint8_t(kind),
+                             uint8_t(kind == AssetKind::Model ? optimizeMeshes | quantizeVertices << 1
+                                                              : generateMips | compressTextures << 1 | srgb << 2),
+                             0};
+    return core::Hash64(bits, sizeof(bits));
+}
+
+bool ImportKindOf(const fs::path& file, AssetKind& kind)
+{
+    const std::string ext = Extension(file);
+    if (ext == ".gltf" || ext == ".glb") kind = AssetKind::Model;
+    else if (ext == ".png" || ext == ".ktx2") kind = AssetKind::Texture;
+    else return false;
+    return true;
+}
+
+std::vector<uint8_t> WriteModelAsset(const ModelAsset& model)
+{
+    Writer w;
+    w.Put(kModelMagic);
+    w.Put(kModelImporterVersion);
+    w.Put(uint32_t(model.submeshes.size()));
+    w.Put(uint32_t(model.quantized));
+    for (const ModelAsset::Submesh& s : model.submeshes) {
+        const size_t vertexCount = model.quantized ? s.quantized.vertices.size() : s.vertices.size();
+        const uint32_t indexBytes = vertexCount <= 65536 ? 2 : 4;
+        w.Put(uint32_t(s.name.size()));
+        w.Bytes(s.name.data(), s.name.size());
+        w.Align(4);
+        w.Put(s.material);
+        w.Put(uint32_t(vertexCount));
+        w.Put(uint32_t(s.indices.size()));
+        w.Put(indexBytes);
+        if (model.quantized) {
+            w.Bytes(s.quantized.boundsMin, sizeof(float) * 3);
+            w.Bytes(s.quantized.boundsMax, sizeof(float) * 3);
+            w.Bytes(s.quantized.uvMin, sizeof(float) * 2);
+            w.Bytes(s.quantized.uvMax, sizeof(float) * 2);
+            w.Bytes(s.quantized.vertices.data(), vertexCount * sizeof(QuantizedVertex));
+        } else {
+            w.Bytes(s.vertices.data(), vertexCount * sizeof(MeshVertex));
+        }
+        if (indexBytes == 2) {
+            for (uint32_t i : s.indices) w.Put(uint16_t(i));
+        } else {
+            w.Bytes(s.indices.data(), s.indices.size() * 4);
+        }
+        w.Align(4);
+    }
+    return std::move(w.out);
+}
+
+ModelAsset ReadModelAsset(const uint8_t* data, size_t size)
+{
+    Reader r{data, size, 0, "ReadModelAsset"};
+    if (r.Get<uint32_t>() != kModelMagic || r.Get<uint32_t>() != kModelImporterVersion)
+        throw std::runtime_error("ReadModelAsset: not a model of this version");
+    ModelAsset model;
+    const uint32_t count = r.Get<uint32_t>();
+    model.quantized = r.Get<uint32_t>() != 0;
+    if (count > size / 20) throw std::runtime_error("ReadModelAsset: bad submesh count");
+    model.submeshes.resize(count);
+    for (ModelAsset::Submesh& s : model.submeshes) {
+        const uint32_t nameSize = r.Get<uint32_t>();
+        if (nameSize > size - r.pos) throw std::runtime_error("ReadModelAsset: truncated data");
+        s.name.resize(nameSize);
+        r.Bytes(s.name.data(), nameSize);
+        r.Align(4);
+        s.material = r.Get<uint32_t>();
+        const uint32_t vertexCount = r.Get<uint32_t>(), indexCount = r.Get<uint32_t>(), indexBytes = r.Get<uint32_t>();
+        const size_t vertexSize = model.quantized ? sizeof(QuantizedVertex) : sizeof(MeshVertex);
+        if ((indexBytes != 2 && indexBytes != 4) || uint64_t(vertexCount) * vertexSize + uint64_t(indexCount) * indexBytes > size - r.pos)
+            throw std::runtime_error("ReadModelAsset: truncated data");
+        if (model.quantized) {
+            r.Bytes(s.quantized.boundsMin, sizeof(float) * 3);
+            r.Bytes(s.quantized.boundsMax, sizeof(float) * 3);
+            r.Bytes(s.quantized.uvMin, sizeof(float) * 2);
+            r.Bytes(s.quantized.uvMax, sizeof(float) * 2);
+            s.quantized.vertices.resize(vertexCount);
+            r.Bytes(s.quantized.vertices.data(), vertexCount * sizeof(QuantizedVertex));
+        } else {
+            s.vertices.resize(vertexCount);
+            r.Bytes(s.vertices.data(), vertexCount * sizeof(MeshVertex));
+        }
+        s.indices.resize(indexCount);
+        for (uint32_t& i : s.indices) {
+            i = indexBytes == 2 ? r.Get<uint16_t>() : r.Get<uint32_t>();
+            if (i >= vertexCount) throw std::runtime_error("ReadModelAsset: index out of range");
+        }
+        r.Align(4);
+    }
+    return model;
+}
+
+std::vector<uint8_t> WriteTextureAsset(const Image& image)
+{
+    Writer w;
+    w.Put(kTextureMagic);
+    w.Put(kTextureImporterVersion);
+    w.Put(uint32_t(image.format));
+    w.Put(uint32_t(image.srgb));
+    w.Put(uint32_t(image.levels.size()));
+    for (const ImageLevel& l : image.levels) {
+        w.Put(l.width);
+        w.Put(l.height);
+        w.Put(uint64_t(l.data.size()));
+    }
+    // уровни выровнены на 16: загрузчик может копировать их в staging-буфер как есть
+    for (const ImageLevel& l : image.levels) {
+        w.Align(16);
+        w.Bytes(l.data.data(), l.data.size());
+    }
+    return std::move(w.out);
+}
+
+Image ReadTextureAsset(const uint8_t* data, size_t size)
+{
+    Reader r{data, size, 0, "ReadTextureAsset"};
+    if (r.Get<uint32_t>() != kTextureMagic || r.Get<uint32_t>() != kTextureImporterVersion)
+        throw std::runtime_error("ReadTextureAsset: not a texture of this version");
+    Image image;
+    const uint32_t format = r.Get<uint32_t>();
+    if (format > uint32_t(PixelFormat::BC7)) throw std::runtime_error("ReadTextureAsset: bad format");
+    image.format = PixelFormat(format);
+    image.srgb = r.Get<uint32_t>() != 0;
+    const uint32_t levels = r.Get<uint32_t>();
+    if (levels > 32) throw std::runtime_error("ReadTextureAsset: bad level count");
+    image.levels.resize(levels);
+    std::vector<uint64_t> sizes(levels);
+    for (uint32_t i = 0; i < levels; ++i) {
+        image.levels[i].width = r.Get<uint32_t>();
+        image.levels[i].height = r.Get<uint32_t>();
+        sizes[i] = r.Get<uint64_t>();
+        if (sizes[i] != LevelBytes(image.format, image.levels[i].width, image.levels[i].height))
+            throw std::runtime_error("ReadTextureAsset: bad level size");
+    }
+    for (uint32_t i = 0; i < levels; ++i) {
+        r.Align(16);
+        image.levels[i].data.resize(size_t(sizes[i]));
+        r.Bytes(image.levels[i].data.data(), size_t(sizes[i]));
+    }
+    return image;
+}
+
+ImportResult ImportAsset(DerivedDataCache& cache, const fs::path& file, AssetKind kind, const ImportSettings& settings)
+{
+    DC_PROFILE_ZONE("ImportAsset");
+    const prof::Clock start = prof::Now();
+    ImportResult result;
+    result.path = file.generic_string();
+    result.kind = kind;
+    try {
+        std::vector<uint8_t> data;
+        uint64_t hash = cache.SourceHash(file, data);
+        result.sourceBytes = data.size();
+        // .gltf без своих буферов ничего не значит: их содержимое — тоже часть ключа
+        if (Extension(file) == ".gltf") {
+            if (data.empty()) {
+                data = ReadFile(file);
+                result.sourceBytes += data.size();
+            }
+            std::vector<uint8_t> scratch;
+            for (const fs::path& dep : GltfExternalFiles(data.data(), data.size(), file)) {
+                hash = core::HashCombine(hash, cache.SourceHash(dep, scratch));
+                result.sourceBytes += scratch.size();
+            }
+        }
+        const uint32_t version = kind == AssetKind::Model ? kModelImporterVersion : kTextureImporterVersion;
+        result.key = DerivedDataCache::Key(hash, version, settings.Hash(kind));
+        if (cache.Contains(result.key)) {
+            result.cached = true;
+        } else {
+            if (data.empty()) {
+                data = ReadFile(file);
+                result.sourceBytes += data.size();
+            }
+            const std::vector<uint8_t> blob = kind == AssetKind::Model ? ImportModel(data, file, settings) : ImportTexture(data, file, settings);
+            cache.Store(result.key, blob.data(), blob.size());
+            result.derivedBytes = blob.size();
+        }
+    } catch (const std::exception& e) {
+        result.error = e.what();
+        result.key = 0;
+    }
+    result.seconds = double(prof::Now() - start) / 1e9;
+    return result;
+}
+
+// ---------------- пакет в фоне ----------------
+
+struct AssetImporter::Batch {
+    struct File {
+        fs::path path;
+        std::string rel;
+        AssetKind kind;
+        uint64_t size;
+    };
+    std::vector<File> files;
+    ImportSettings settings;
+    std::atomic<size_t> next{0};
+    prof::Clock start = 0;
+};
+
+AssetImporter::AssetImporter(DerivedDataCache& cache) : cache_(cache) {}
+
+AssetImporter::~AssetImporter()
+{
+    Cancel();
+    Wait();
+}
+
+bool AssetImporter::Import(const fs::path& root, uint32_t kinds, const ImportSettings& settings)
+{
+    if (Busy()) return false;
+    cancel_ = false;
+    total_ = done_ = cached_ = failed_ = 0;
+    bytes_ = 0;
+    scanning_ = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        failures_.clear();
+    }
+    auto batch = std::make_shared<Batch>();
+    batch->settings = settings;
+    batch->start = prof::Now();
+    jobs::Run([this, batch, root, kinds] {
+        DC_PROFILE_ZONE("AssetImporter::Scan");
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+             !ec && it != end && !cancel_; it.increment(ec)) {
+            const std::string name = it->path().filename().generic_string();
+            std::error_code ec2;
+            if (name.empty() || name[0] == '.') {
+                if (it->is_directory(ec2)) it.disable_recursion_pending();
+                continue;
+            }
+            AssetKind kind;
+            if (!ImportKindOf(it->path(), kind) || !(kinds & (kind == AssetKind::Model ? kImportModels : kImportTextures))) continue;
+            if (!it->is_regular_file(ec2)) continue;
+            batch->files.push_back({it->path(), fs::relative(it->path(), root, ec2).generic_string(), kind, it->file_size(ec2)});
+            total_.fetch_add(1, std::memory_order_relaxed);
+        }
+        // крупные первыми: самый долгий файл не остаётся на хвосте пакета
+        std::stable_sort(batch->files.begin(), batch->files.end(), [](const Batch::File& a, const Batch::File& b) { return a.size > b.size; });
+        scanning_ = false;
+        if (batch->files.empty()) {
+            DC_LOG_INFO(Assets, "import: nothing to import under {}", root.string());
+            jobs::WakeMainThread();
+            return;
+        }
+        // по задаче на файл, в полёте — не больше, чем потоков: память — несколько исходников сразу
+        const size_t pumps = std::min<size_t>(batch->files.size(), jobs::WorkerCount() + 1);
+        for (size_t i = 0; i < pumps; ++i) jobs::Run([this, batch] { Pump(batch); }, &jobs_);
+    }, &jobs_);
+    return true;
+}
+
+void AssetImporter::Pump(const std::shared_ptr<Batch>& batch)
+{
+    const size_t i = batch->next.fetch_add(1, std::memory_order_relaxed);
+    if (i >= batch->files.size() || cancel_) return;
+    const Batch::File& file = batch->files[i];
+    const ImportResult r = ImportAsset(cache_, file.path, file.kind, batch->settings);
+    bytes_.fetch_add(r.sourceBytes, std::memory_order_relaxed);
+    if (!r.error.empty()) {
+        failed_.fetch_add(1, std::memory_order_relaxed);
+        DC_LOG_ERROR(Assets, "import {}: {}", file.rel, r.error);
+        std::lock_guard<std::mutex> lock(mutex_);
+        failures_.push_back(file.rel + ": " + r.error);
+    } else {
+        if (r.cached) cached_.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        products_[file.rel] = r.key;
+    }
+    if (done_.fetch_add(1, std::memory_order_acq_rel) + 1 == batch->files.size()) {
+        Finish(*batch);
+        return;
+    }
+    const int64_t now = int64_t(prof::Now());
+    int64_t last = lastWake_.load(std::memory_order_relaxed);
+    if (now - last >= int64_t(kWakeInterval) && lastWake_.compare_exchange_strong(last, now)) jobs::WakeMainThread();
+    // следующий файл — новой задачей: украденная в чужом Wait задача держит поток на одном файле
+    jobs::Run([this, batch] { Pump(batch); }, &jobs_);
+}
+
+void AssetImporter::Finish(const Batch& batch)
+{
+    DC_LOG_INFO(Assets, "import: {} files ({} from cache, {} failed), {} MB read in {} s", (uint64_t)batch.files.size(),
+                cached_.load(), failed_.load(), bytes_.load() / 1048576.0, double(prof::Now() - batch.start) / 1e9);
+    cache_.Save();
+    jobs::WakeMainThread();
+}
+
+void AssetImporter::Cancel()
+{
+    cancel_ = true;
+}
+
+void AssetImporter::Wait()
+{
+    jobs::Wait(jobs_);
+}
+
+ImportProgress AssetImporter::Progress() const
+{
+    ImportProgress p;
+    p.total = total_.load(std::memory_order_relaxed);
+    p.done = done_.load(std::memory_order_relaxed);
+    p.cached = cached_.load(std::memory_order_relaxed);
+    p.failed = failed_.load(std::memory_order_relaxed);
+    p.bytes = bytes_.load(std::memory_order_relaxed);
+    p.scanning = scanning_.load(std::memory_order_relaxed);
+    return p;
+}
+
+uint64_t AssetImporter::Find(const std::string& relPath) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = products_.find(relPath);
+    return it == products_.end() ? 0 : it->second;
+}
+
+std::vector<std::string> AssetImporter::Failures() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failures_;
+}
+
+} // namespace dancore::resources
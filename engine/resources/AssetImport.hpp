@@ -0,0 +1,133 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DerivedDataCache.hpp"
+#include "Image.hpp"
+#include "MeshOptimizer.hpp"
+#include "core/JobSystem.hpp"
+
+// Импорт исходных ассетов (glTF/GLB, PNG/KTX2) в производные данные для рантайма.
+//
+// Файл — задача job system, внутри неё стадии тоже параллельны: примитивы меша
+// оптимизируются и квантуются в jobs::ParallelFor, mip-уровни и блоки BCn — по строкам.
+// Результат ложится в DerivedDataCache по ключу (хэш исходника, версия импортёра, хэш
+// настроек); если ключ уже есть, файл не разбирается вовсе, а для неизменённого файла
+// (размер и mtime те же) он даже не читается — повторный импорт проекта стоит stat'ов.
+//
+// AssetImporter ведёт пакет импорта в фоне: обход каталога — тоже в задаче, файлы
+// выдаются по одному (сначала крупные), прогресс — атомарные счётчики. Главный поток
+// только запускает импорт и читает Progress(); ничего не ждёт.
+
+namespace dancore::resources {
+
+enum class AssetKind : uint8_t { Model, Texture };
+
+enum ImportKinds : uint32_t { kImportModels = 1, kImportTextures = 2 };
+
+// Меняется вместе с форматом производных данных или алгоритмами: старые ключи перестают совпадать
+inline constexpr uint32_t kModelImporterVersion = 1;
+inline constexpr uint32_t kTextureImporterVersion = 1;
+
+struct ImportSettings {
+    // модели
+    bool optimizeMeshes = true;      // порядок под кэш вершин, против перерисовки, выборка подряд
+    bool quantizeVertices = true;    // 12 байт на вершину вместо 32
+    // текстуры
+    bool generateMips = true;        // если в исходнике один уровень
+    bool compressTextures = true;    // RGBA8 -> BC1 (непрозрачные) или BC3; готовые BCn — как есть
+    bool srgb = true;                // PNG — цвет в sRGB (у KTX2 это задаёт формат)
+
+    uint64_t Hash(AssetKind kind) const; // только поля, влияющие на данный тип
+};
+
+// .gltf/.glb — модель, .png/.ktx2 — текстура
+bool ImportKindOf(const std::filesystem::path& file, AssetKind& kind);
+
+// --- производные данные ---
+
+struct ModelAsset {
+    struct Submesh {
+        std::string name;
+        uint32_t material = ~0u;
+        QuantizedMesh quantized;             // при quantizeVertices
+        std::vector<MeshVertex> vertices;    // без квантования
+        std::vector<uint32_t> indices;
+    };
+    std::vector<Submesh> submeshes;
+    bool quantized = false;
+};
+
+std::vector<uint8_t> WriteModelAsset(const ModelAsset& model);
+ModelAsset ReadModelAsset(const uint8_t* data, size_t size);       // бросает std::runtime_error
+std::vector<uint8_t> WriteTextureAsset(const Image& image);
+Image ReadTextureAsset(const uint8_t* data, size_t size);
+
+struct ImportResult {
+    std::string path;            // как передан
+    AssetKind kind = AssetKind::Model;
+    uint64_t key = 0;            // ключ в кэше, 0 — ошибка
+    bool cached = false;         // готовый результат уже лежал в кэше
+    std::string error;
+    uint64_t sourceBytes = 0;    // прочитано исходных данных (0 — хэш был запомнен)
+    uint64_t derivedBytes = 0;   // записано в кэш
+    double seconds = 0;
+};
+
+// Один файл в вызывающем потоке (стадии внутри — в job system). Ошибки — в result.error
+ImportResult ImportAsset(DerivedDataCache& cache, const std::filesystem::path& file, AssetKind kind,
+                         const ImportSettings& settings = {});
+
+struct ImportProgress {
+    uint32_t total = 0;          // файлов в пакете (растёт, пока идёт обход)
+    uint32_t done = 0;
+    uint32_t cached = 0;         // из них взяты из кэша
+    uint32_t failed = 0;
+    uint64_t bytes = 0;          // исходных данных прочитано
+    bool scanning = false;
+};
+
+class AssetImporter {
+public:
+    explicit AssetImporter(DerivedDataCache& cache);
+    ~AssetImporter(); // отменяет и ждёт
+    AssetImporter(const AssetImporter&) = delete;
+    AssetImporter& operator=(const AssetImporter&) = delete;
+
+    // Все файлы kinds (ImportKinds) под root рекурсивно, скрытые (".*") пропускаются.
+    // Возвращает сразу; false — предыдущий пакет ещё идёт
+    bool Import(const std::filesystem::path& root, uint32_t kinds, const ImportSettings& settings = {});
+    void Cancel();               // оставшиеся файлы пакета не начинаются
+    void Wait();
+
+    bool Busy() const { return !jobs_.Done(); }
+    ImportProgress Progress() const;
+    // Ключ последнего удачного импорта файла (путь относительно root, через '/'); 0 — нет
+    uint64_t Find(const std::string& relPath) const;
+    // Ошибки текущего (последнего) пакета: "путь: сообщение"; они же — в журнале
+    std::vector<std::string> Failures() const;
+
+private:
+    struct Batch;
+    void Pump(const std::shared_ptr<Batch>& batch);
+    void Finish(const Batch& batch);
+
+    DerivedDataCache& cache_;
+    core::jobs::JobCounter jobs_;
+    std::atomic<bool> cancel_{false};
+    std::atomic<uint32_t> total_{0}, done_{0}, cached_{0}, failed_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<bool> scanning_{false};
+    std::atomic<int64_t> lastWake_{0};
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, uint64_t> products_;
+    std::vector<std::string> failures_;
+};
+
+} // namespace dancore::resources
@@ -0,0 +1,157 @@
+#include "BlockCompress.hpp"
+#include "core/JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace dancore::resources {
+
+namespace jobs = dancore::core::jobs;
+
+namespace {
+
+uint16_t To565(const float c[3])
+{
+    const int r = std::clamp(int(c[0] * (31.0f / 255.0f) + 0.5f), 0, 31);
+    const int g = std::clamp(int(c[1] * (63.0f / 255.0f) + 0.5f), 0, 63);
+    const int b = std::clamp(int(c[2] * (31.0f / 255.0f) + 0.5f), 0, 31);
+    return uint16_t(r << 11 | g << 5 | b);
+}
+
+void From565(uint16_t v, int c[3])
+{
+    const int r = v >> 11, g = (v >> 5) & 63, b = v & 31;
+    c[0] = r << 3 | r >> 2, c[1] = g << 2 | g >> 4, c[2] = b << 3 | b >> 2;
+}
+
+// Цветовой блок BC1 в режиме 4 цветов (c0 > c1); в BC3 он же
+void ColorBlock(const uint8_t* rgba, uint8_t out[8])
+{
+    float mean[3] = {};
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 3; ++c) mean[c] += rgba[i * 4 + c];
+    for (float& m : mean) m /= 16.0f;
+    float cov[6] = {}; // rr rg rb gg gb bb
+    float lo[3] = {255, 255, 255}, hi[3] = {};
+    for (int i = 0; i < 16; ++i) {
+        const float r = rgba[i * 4] - mean[0], g = rgba[i * 4 + 1] - mean[1], b = rgba[i * 4 + 2] - mean[2];
+        cov[0] += r * r, cov[1] += r * g, cov[2] += r * b, cov[3] += g * g, cov[4] += g * b, cov[5] += b * b;
+        for (int c = 0; c < 3; ++c) lo[c] = std::min(lo[c], float(rgba[i * 4 + c])), hi[c] = std::max(hi[c], float(rgba[i * 4 + c]));
+    }
+    // главная ось: степенной метод от диагонали охватывающего box'а
+    float axis[3] = {hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]};
+    for (int it = 0; it < 8; ++it) {
+        const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        const float m = std::max({std::abs(x), std::abs(y), std::abs(z)});
+        if (m <= 0) break;
+        axis[0] = x / m, axis[1] = y / m, axis[2] = z / m;
+    }
+    const float len2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    float tMin = 0, tMax = 0;
+    if (len2 > 0) {
+        tMin = 1e30f, tMax = -1e30f;
+        for (int i = 0; i < 16; ++i) {
+            const float t = ((rgba[i * 4] - mean[0]) * axis[0] + (rgba[i * 4 + 1] - mean[1]) * axis[1] + (rgba[i * 4 + 2] - mean[2]) * axis[2]) / len2;
+            tMin = std::min(tMin, t), tMax = std::max(tMax, t);
+        }
+    }
+    float e0[3], e1[3];
+    for (int c = 0; c < 3; ++c) e0[c] = mean[c] + axis[c] * tMax, e1[c] = mean[c] + axis[c] * tMin;
+    uint16_t c0 = To565(e0), c1 = To565(e1);
+    if (c0 < c1) std::swap(c0, c1);
+
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        int p[4][3];
+        From565(c0, p[0]);
+        From565(c1, p[1]);
+        for (int c = 0; c < 3; ++c) p[2][c] = (2 * p[0][c] + p[1][c]) / 3, p[3][c] = (p[0][c] + 2 * p[1][c]) / 3;
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestError = 1 << 30;
+            for (int k = 0; k < 4; ++k) {
+                const int dr = rgba[i * 4] - p[k][0], dg = rgba[i * 4 + 1] - p[k][1], db = rgba[i * 4 + 2] - p[k][2];
+                const int error = dr * dr + dg * dg + db * db;
+                if (error < bestError) best = k, bestError = error;
+            }
+            indices |= uint32_t(best) << (2 * i);
+        }
+    }
+    out[0] = uint8_t(c0), out[1] = uint8_t(c0 >> 8), out[2] = uint8_t(c1), out[3] = uint8_t(c1 >> 8);
+    std::memcpy(out + 4, &indices, 4);
+}
+
+// Альфа-блок BC3 в режиме 8 значений (a0 > a1)
+void AlphaBlock(const uint8_t* rgba, uint8_t out[8])
+{
+    int a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; ++i) a0 = std::max<int>(a0, rgba[i * 4 + 3]), a1 = std::min<int>(a1, rgba[i * 4 + 3]);
+    uint64_t bits = 0;
+    if (a0 != a1) {
+        int p[8] = {a0, a1};
+        for (int k = 2; k < 8; ++k) p[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestError = 1 << 30;
+            for (int k = 0; k < 8; ++k) {
+                const int error = std::abs(rgba[i * 4 + 3] - p[k]);
+                if (error < bestError) best = k, bestError = error;
+            }
+            bits |= uint64_t(best) << (3 * i);
+        }
+    }
+    out[0] = uint8_t(a0), out[1] = uint8_t(a1);
+    for (int b = 0; b < 6; ++b) out[2 + b] = uint8_t(bits >> (8 * b));
+}
+
+} // namespace
+
+void CompressBC1Block(const uint8_t rgba[64], uint8_t out[8])
+{
+    ColorBlock(rgba, out);
+}
+
+void CompressBC3Block(const uint8_t rgba[64], uint8_t out[16])
+{
+    AlphaBlock(rgba, out);
+    ColorBlock(rgba, out + 8);
+}
+
+Image CompressBC(const Image& rgba, PixelFormat target)
+{
+    if (rgba.format != PixelFormat::RGBA8) throw std::runtime_error("CompressBC: source is not RGBA8");
+    if (target != PixelFormat::BC1 && target != PixelFormat::BC3)
+        throw std::runtime_error(std::string("CompressBC: no encoder for ") + PixelFormatName(target));
+    const size_t blockBytes = target == PixelFormat::BC1 ? 8 : 16;
+    Image out;
+    out.format = target;
+    out.srgb = rgba.srgb;
+    out.levels.resize(rgba.levels.size());
+    for (size_t l = 0; l < rgba.levels.size(); ++l) {
+        const ImageLevel& src = rgba.levels[l];
+        ImageLevel& dst = out.levels[l];
+        dst.width = src.width, dst.height = src.height;
+        dst.data.resize(LevelBytes(target, src.width, src.height));
+        const uint32_t bw = (src.width + 3) / 4, bh = (src.height + 3) / 4;
+        jobs::ParallelFor(0, bh, std::max<size_t>(1, 256 / bw), [&](size_t begin, size_t end) {
+            uint8_t block[64];
+            for (size_t by = begin; by < end; ++by)
+                for (uint32_t bx = 0; bx < bw; ++bx) {
+                    // край текстуры меньше 4 пикселей: повторяем последние
+                    for (uint32_t y = 0; y < 4; ++y)
+                        for (uint32_t x = 0; x < 4; ++x) {
+                            const size_t sx = std::min(bx * 4 + x, src.width - 1), sy = std::min<size_t>(by * 4 + y, src.height - 1);
+                            std::memcpy(block + (y * 4 + x) * 4, &src.data[(sy * src.width + sx) * 4], 4);
+                        }
+                    uint8_t* o = &dst.data[(by * bw + bx) * blockBytes];
+                    if (target == PixelFormat::BC1) CompressBC1Block(block, o);
+                    else CompressBC3Block(block, o);
+                }
+        });
+    }
+    return out;
+}
+
+} // namespace dancore::resources
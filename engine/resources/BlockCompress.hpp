@@ -0,0 +1,17 @@
+#pragma once
+#include "Image.hpp"
+
+// Сжатие RGBA8 в BC1 (без альфы) и BC3 для импорта текстур. Подбор концов — range fit по
+// главной оси цветов блока (ковариация, степенной метод), индексы — ближайший цвет палитры.
+// Качество ниже оффлайн-компрессоров с перебором кластеров, зато блок 4x4 стоит единицы
+// микросекунд, а строки блоков всех уровней идут в jobs::ParallelFor.
+
+namespace dancore::resources {
+
+// target — BC1 или BC3; все уровни, srgb сохраняется
+Image CompressBC(const Image& rgba, PixelFormat target);
+
+void CompressBC1Block(const uint8_t rgba[64], uint8_t out[8]);
+void CompressBC3Block(const uint8_t rgba[64], uint8_t out[16]);
+
+} // namespace dancore::resources
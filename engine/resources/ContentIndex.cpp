@@ -0,0 +1,638 @@
+#include "ContentIndex.hpp"
+#include "core/Log.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace dancore::resources {
+
+namespace fs = std::filesystem;
+namespace jobs = dancore::core::jobs;
+namespace prof = dancore::core::profiler;
+
+namespace {
+
+constexpr uint32_t kFileMagic = 0x49434344; // 'DCCI'
+constexpr uint32_t kFileVersion = 1;
+constexpr double kRescanPeriod = 60.0;     // без inotify
+
+double Seconds() { return double(prof::Now()) / 1e9; }
+
+char Lower(char c) { return (char)std::tolower((unsigned char)c); }
+
+uint32_t Trigram(const char* p) { return uint32_t((uint8_t)p[0]) | uint32_t((uint8_t)p[1]) << 8 | uint32_t((uint8_t)p[2]) << 16; }
+
+std::string_view ParentOf(std::string_view path)
+{
+    size_t slash = path.rfind('/');
+    return slash == std::string_view::npos ? std::string_view() : path.substr(0, slash);
+}
+
+int64_t Stamp(fs::file_time_type t) { return (int64_t)t.time_since_epoch().count(); }
+
+} // namespace
+
+struct ContentIndex::DirCache {
+    int64_t mtime = 0;
+    std::vector<Item> files;
+    std::vector<std::string> subdirs;
+};
+
+struct ContentIndex::Snapshot {
+    std::vector<ContentEntry> entries;
+    std::string paths, lower;                               // арены: как есть и в нижнем регистре
+    std::unordered_map<std::string, uint32_t> byPath;
+    std::vector<std::vector<uint32_t>> children;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigrams; // по возрастанию id
+    std::vector<uint32_t> byName;                           // по имени в нижнем регистре
+    uint32_t dead = 0;
+    bool final = true;                                      // false — загружен с диска, сверка ещё идёт
+
+    std::string_view Path(uint32_t id) const { return {paths.data() + entries[id].path, entries[id].pathLen}; }
+    std::string_view LowerPath(uint32_t id) const { return {lower.data() + entries[id].path, entries[id].pathLen}; }
+    std::string_view LowerName(uint32_t id) const
+    {
+        const ContentEntry& e = entries[id];
+        return {lower.data() + e.path + e.nameOffset, e.pathLen - e.nameOffset};
+    }
+
+    bool ChildLess(uint32_t a, uint32_t b) const
+    {
+        if (entries[a].directory != entries[b].directory) return entries[a].directory;
+        return LowerName(a) < LowerName(b);
+    }
+
+    uint32_t Add(const Item& item, bool bulk)
+    {
+        uint32_t parent = kNone;
+        if (!item.path.empty()) {
+            auto it = byPath.find(std::string(ParentOf(item.path)));
+            if (it == byPath.end() || !entries[it->second].directory) return kNone; // родитель ещё не известен
+            parent = it->second;
+        }
+        uint32_t id = (uint32_t)entries.size();
+        ContentEntry& e = entries.emplace_back();
+        e.path = (uint32_t)paths.size();
+        e.pathLen = (uint32_t)item.path.size();
+        size_t slash = item.path.rfind('/');
+        e.nameOffset = slash == std::string::npos ? 0 : uint32_t(slash + 1);
+        e.parent = parent;
+        e.size = item.size;
+        e.mtime = item.mtime;
+        e.directory = item.directory;
+        paths += item.path;
+        for (char c : item.path) lower += Lower(c);
+        byPath.emplace(item.path, id);
+        children.emplace_back();
+
+        std::string_view lp = LowerPath(id);
+        for (size_t i = 0; i + 3 <= lp.size(); ++i) {
+            auto& list = trigrams[Trigram(lp.data() + i)];
+            if (list.empty() || list.back() != id) list.push_back(id);
+        }
+        if (bulk) {
+            if (parent != kNone) children[parent].push_back(id);
+            byName.push_back(id);
+        } else {
+            if (parent != kNone) {
+                auto& list = children[parent];
+                list.insert(std::lower_bound(list.begin(), list.end(), id, [&](uint32_t a, uint32_t b) { return ChildLess(a, b); }), id);
+            }
+            byName.insert(std::lower_bound(byName.begin(), byName.end(), id,
+                                           [&](uint32_t a, uint32_t b) { return LowerName(a) < LowerName(b); }),
+                          id);
+        }
+        return id;
+    }
+
+    // Мёртвые записи остаются в массивах (id стабильны) и пропускаются; их доля
+    // ограничена полной пересборкой
+    void Remove(uint32_t id)
+    {
+        ContentEntry& e = entries[id];
+        if (!e.alive) return;
+        e.alive = false;
+        ++dead;
+        byPath.erase(std::string(Path(id)));
+        if (e.parent != kNone) {
+            auto& list = children[e.parent];
+            list.erase(std::remove(list.begin(), list.end(), id), list.end());
+        }
+        std::vector<uint32_t> sub = std::move(children[id]);
+        children[id].clear();
+        for (uint32_t c : sub) Remove(c);
+    }
+
+    void Upsert(const Item& item)
+    {
+        auto it = byPath.find(item.path);
+        if (it != byPath.end()) {
+            ContentEntry& e = entries[it->second];
+            if (e.directory == item.directory) {
+                e.size = item.size;
+                e.mtime = item.mtime;
+                return;
+            }
+            Remove(it->second); // файл стал каталогом или наоборот
+        }
+        Add(item, false);
+    }
+
+    // items — по пути, тогда родитель всегда раньше детей
+    void Build(std::vector<Item>& items)
+    {
+        DC_PROFILE_ZONE("ContentIndex::Build");
+        std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.path < b.path; });
+        entries.reserve(items.size());
+        children.reserve(items.size());
+        byPath.reserve(items.size());
+        byName.reserve(items.size());
+        for (const Item& item : items) Add(item, true);
+        for (auto& list : children)
+            std::sort(list.begin(), list.end(), [&](uint32_t a, uint32_t b) { return ChildLess(a, b); });
+        std::sort(byName.begin(), byName.end(), [&](uint32_t a, uint32_t b) { return LowerName(a) < LowerName(b); });
+    }
+};
+
+ContentIndex::ContentIndex() = default;
+
+ContentIndex::~ContentIndex() { Close(); }
+
+// ---------------- файл индекса ----------------
+
+namespace {
+
+template <class T>
+void Put(std::ofstream& out, const T& v) { out.write(reinterpret_cast<const char*>(&v), sizeof(T)); }
+
+template <class T>
+bool Get(std::ifstream& in, T& v) { return bool(in.read(reinterpret_cast<char*>(&v), sizeof(T))); }
+
+void PutString(std::ofstream& out, std::string_view s)
+{
+    Put(out, (uint32_t)s.size());
+    out.write(s.data(), (std::streamsize)s.size());
+}
+
+bool GetString(std::ifstream& in, std::string& s)
+{
+    uint32_t n = 0;
+    if (!Get(in, n) || n > (1u << 16)) return false;
+    s.resize(n);
+    return bool(in.read(s.data(), n));
+}
+
+} // namespace
+
+void ContentIndex::Save() const
+{
+    if (!live_ || indexFile_.empty()) return;
+    DC_PROFILE_ZONE("ContentIndex::Save");
+    std::error_code ec;
+    fs::create_directories(indexFile_.parent_path(), ec);
+    fs::path tmp = indexFile_;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return;
+        Put(out, kFileMagic);
+        Put(out, kFileVersion);
+        PutString(out, root_.generic_string());
+        Put(out, Count());
+        // id растут от родителя к детям, так что порядок "родитель раньше" сохраняется
+        for (uint32_t id = 0; id < live_->entries.size(); ++id) {
+            const ContentEntry& e = live_->entries[id];
+            if (!e.alive) continue;
+            Put(out, uint8_t(e.directory));
+            Put(out, e.size);
+            Put(out, e.mtime);
+            PutString(out, live_->Path(id));
+        }
+        if (!out) {
+            out.close();
+            fs::remove(tmp, ec);
+            return;
+        }
+    }
+    fs::rename(tmp, indexFile_, ec); // атомарно: недописанный файл не подменит прежний
+    if (ec) DC_LOG_WARN(Assets, "cannot write content index {}: {}", indexFile_.string(), ec.message());
+}
+
+namespace {
+
+// Снимок с прошлого запуска и mtime каталогов для сверки
+std::unique_ptr<ContentIndex::Snapshot> Load(const fs::path& file, const fs::path& root,
+                                             std::unordered_map<std::string, ContentIndex::DirCache>& reuse)
+{
+    DC_PROFILE_ZONE("ContentIndex::Load");
+    std::ifstream in(file, std::ios::binary);
+    if (!in) return nullptr;
+    uint32_t magic = 0, version = 0, count = 0;
+    std::string rootPath;
+    if (!Get(in, magic) || magic != kFileMagic || !Get(in, version) || version != kFileVersion) return nullptr;
+    if (!GetString(in, rootPath) || rootPath != root.generic_string() || !Get(in, count)) return nullptr;
+
+    std::vector<ContentIndex::Item> items(count);
+    for (auto& item : items) {
+        uint8_t dir = 0;
+        if (!Get(in, dir) || !Get(in, item.size) || !Get(in, item.mtime) || !GetString(in, item.path)) return nullptr;
+        item.directory = dir != 0;
+    }
+    for (const auto& item : items) {
+        if (item.directory) reuse[item.path].mtime = item.mtime;
+        if (item.path.empty()) continue;
+        auto& dir = reuse[std::string(ParentOf(item.path))];
+        if (item.directory) dir.subdirs.push_back(item.path);
+        else dir.files.push_back(item);
+    }
+    auto snap = std::make_unique<ContentIndex::Snapshot>();
+    snap->Build(items);
+    snap->final = false;
+    return snap;
+}
+
+} // namespace
+
+// ---------------- обход ----------------
+
+struct ContentIndex::ScanState {
+    ContentIndex* index;
+    fs::path root;
+    Reuse reuse;
+    std::mutex mutex;
+    std::vector<Item> items;
+    uint32_t reused = 0;
+    jobs::JobCounter counter;
+};
+
+void ContentIndex::Open(const fs::path& root, const fs::path& indexFile)
+{
+    Close();
+    closing_ = false;
+    root_ = root;
+    indexFile_ = indexFile;
+    watchFailed_ = false;
+    rescanNow_ = false;
+    nextRescan_ = 0;
+#ifdef __linux__
+    inotify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_ < 0) DC_LOG_WARN(Assets, "inotify unavailable ({}), content changes are picked up by rescans", std::strerror(errno));
+#endif
+    std::error_code ec;
+    if (!fs::is_directory(root_, ec)) {
+        DC_LOG_WARN(Assets, "content root {} not found", root_.string());
+        live_ = std::make_unique<Snapshot>();
+        live_->Add(Item{"", true}, false);
+        return;
+    }
+
+    building_ = true;
+    jobs::Run([this] {
+        auto reuse = std::make_shared<std::unordered_map<std::string, DirCache>>();
+        if (auto loaded = Load(indexFile_, root_, *reuse)) {
+            DC_LOG_INFO(Assets, "content index: {} entries from the previous run", (uint64_t)loaded->entries.size());
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ready_ = std::move(loaded);
+            }
+            jobs::WakeMainThread();
+        }
+        Scan(reuse->empty() ? nullptr : std::move(reuse));
+    }, &jobs_);
+}
+
+void ContentIndex::StartRebuild()
+{
+    building_ = true;
+    Scan(nullptr);
+}
+
+void ContentIndex::Scan(Reuse reuse)
+{
+    auto st = std::make_shared<ScanState>();
+    st->index = this;
+    st->root = root_;
+    st->reuse = std::move(reuse);
+    prof::Clock start = prof::Now();
+
+    // Задача на каталог; подкаталоги ставятся до завершения родителя, так что счётчик
+    // обхода обнуляется только после последнего каталога
+    jobs::Run([st] { ScanDirectory(st, std::string()); }, &st->counter);
+    jobs::RunAfter(st->counter, [this, st, start] {
+        if (closing_) return;
+        auto snap = std::make_unique<Snapshot>();
+        snap->Build(st->items);
+        DC_LOG_INFO(Assets, "content index: {} entries in {} ms ({} directories unchanged)",
+                    (uint64_t)snap->entries.size(), double(prof::Now() - start) / 1e6, st->reused);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_ = std::move(snap);
+        }
+        jobs::WakeMainThread(); // Update() подменит снимок, даже если редактор простаивает
+    }, &jobs_);
+}
+
+void ContentIndex::ScanDirectory(const std::shared_ptr<ScanState>& st, const std::string& rel)
+{
+    if (st->index->closing_) return;
+    fs::path abs = rel.empty() ? st->root : st->root / rel;
+    st->index->WatchDirectory(rel);
+
+    std::error_code ec;
+    Item self{rel, true};
+    self.mtime = Stamp(fs::last_write_time(abs, ec));
+
+    std::vector<Item> local;
+    std::vector<std::string> subdirs;
+    const DirCache* cached = nullptr;
+    if (st->reuse) {
+        auto it = st->reuse->find(rel);
+        if (it != st->reuse->end() && it->second.mtime == self.mtime) cached = &it->second;
+    }
+    if (cached) {
+        // mtime каталога не изменился — состав тот же; размеры файлов берём из индекса
+        local = cached->files;
+        subdirs = cached->subdirs;
+    } else {
+        for (fs::directory_iterator it(abs, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+            std::error_code ec2;
+            std::string name = it->path().filename().generic_string();
+            if (name.empty() || name[0] == '.') continue;
+            std::string child = rel.empty() ? name : rel + "/" + name;
+            // по ссылкам не ходим: циклы и выход за пределы Content/
+            fs::file_status status = it->symlink_status(ec2);
+            if (ec2) continue;
+            if (fs::is_directory(status)) {
+                subdirs.push_back(std::move(child));
+            } else if (fs::is_regular_file(status)) {
+                Item item{std::move(child)};
+                item.size = it->file_size(ec2);
+                item.mtime = Stamp(it->last_write_time(ec2));
+                local.push_back(std::move(item));
+            }
+        }
+    }
+
+    for (const std::string& sub : subdirs)
+        jobs::Run([st, sub] { ScanDirectory(st, sub); }, &st->counter);
+
+    std::lock_guard<std::mutex> lock(st->mutex);
+    if (cached) ++st->reused;
+    st->items.push_back(std::move(self));
+    for (auto& item : local) st->items.push_back(std::move(item));
+}
+
+void ContentIndex::Restat(std::vector<std::string> paths)
+{
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+    jobs::Run([this, paths = std::move(paths)] {
+        DC_PROFILE_ZONE("ContentIndex::Restat");
+        std::vector<Item> batch;
+        for (const std::string& rel : paths) {
+            if (closing_) return;
+            std::error_code ec;
+            fs::path abs = rel.empty() ? root_ : root_ / rel;
+            fs::file_status status = fs::symlink_status(abs, ec);
+            Item item{rel};
+            if (ec || !fs::exists(status)) {
+                item.exists = false;
+                batch.push_back(std::move(item));
+            } else if (fs::is_regular_file(status)) {
+                item.size = fs::file_size(abs, ec);
+                item.mtime = Stamp(fs::last_write_time(abs, ec));
+                batch.push_back(std::move(item));
+            } else if (fs::is_directory(status)) {
+                // новый или перемещённый каталог: весь подкаталог, родители раньше детей
+                item.directory = true;
+                item.mtime = Stamp(fs::last_write_time(abs, ec));
+                batch.push_back(std::move(item));
+                WatchDirectory(rel);
+                auto opts = fs::directory_options::skip_permission_denied;
+                for (fs::recursive_directory_iterator it(abs, opts, ec), end; !ec && it != end; it.increment(ec)) {
+                    std::error_code ec2;
+                    std::string name = it->path().filename().generic_string();
+                    fs::file_status s = it->symlink_status(ec2);
+                    if (ec2 || name.empty() || name[0] == '.') {
+                        if (fs::is_directory(s)) it.disable_recursion_pending();
+                        continue;
+                    }
+                    Item sub{fs::relative(it->path(), root_, ec2).generic_string()};
+                    if (fs::is_directory(s)) {
+                        sub.directory = true;
+                        sub.mtime = Stamp(it->last_write_time(ec2));
+                        WatchDirectory(sub.path);
+                    } else if (fs::is_regular_file(s)) {
+                        sub.size = it->file_size(ec2);
+                        sub.mtime = Stamp(it->last_write_time(ec2));
+                    } else {
+                        continue;
+                    }
+                    batch.push_back(std::move(sub));
+                }
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batches_.push_back(std::move(batch));
+        }
+        jobs::WakeMainThread();
+    }, &jobs_);
+}
+
+// ---------------- inotify ----------------
+
+void ContentIndex::WatchDirectory(const std::string& rel)
+{
+#ifdef __linux__
+    if (inotify_ < 0) return;
+    fs::path abs = rel.empty() ? root_ : root_ / rel;
+    uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB | IN_ONLYDIR;
+    int wd = inotify_add_watch(inotify_, abs.c_str(), mask);
+    if (wd < 0) {
+        // обычно ENOSPC: упёрлись в fs.inotify.max_user_watches
+        if (!watchFailed_.exchange(true))
+            DC_LOG_WARN(Assets, "cannot watch {} ({}), falling back to periodic rescans", rel, std::strerror(errno));
+        return;
+    }
+    std::lock_guard<std::mutex> lock(watchMutex_);
+    watches_[wd] = rel;
+#else
+    (void)rel;
+#endif
+}
+
+void ContentIndex::ReadEvents(std::vector<std::string>& changed)
+{
+#ifdef __linux__
+    if (inotify_ < 0) return;
+    alignas(inotify_event) char buf[16384];
+    for (;;) {
+        ssize_t n = read(inotify_, buf, sizeof(buf));
+        if (n <= 0) break; // EAGAIN — событий больше нет
+        std::lock_guard<std::mutex> lock(watchMutex_);
+        for (char* p = buf; p < buf + n;) {
+            const auto* ev = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW) {
+                rescanNow_ = true;
+                continue;
+            }
+            if (ev->mask & IN_IGNORED) {
+                watches_.erase(ev->wd);
+                continue;
+            }
+            auto it = watches_.find(ev->wd);
+            if (it == watches_.end()) continue;
+            if (ev->len == 0 || ev->name[0] == '.') continue;
+            changed.push_back(it->second.empty() ? std::string(ev->name) : it->second + "/" + ev->name);
+        }
+    }
+#else
+    (void)changed;
+#endif
+}
+
+// ---------------- главный поток ----------------
+
+void ContentIndex::Update()
+{
+    DC_PROFILE_ZONE("ContentIndex::Update");
+    std::unique_ptr<Snapshot> fresh;
+    std::vector<std::vector<Item>> batches;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fresh = std::move(ready_);
+        batches.swap(batches_);
+    }
+    if (fresh) {
+        live_ = std::move(fresh);
+        ++version_;
+        if (live_->final) {
+            building_ = false;
+            rescanNow_ = false;
+            bool polling = inotify_ < 0 || watchFailed_;
+            nextRescan_ = polling ? Seconds() + kRescanPeriod : 0;
+            if (!deferred_.empty()) Restat(std::move(deferred_));
+            deferred_.clear();
+        }
+    }
+    if (live_) {
+        if (!batches.empty()) ++version_;
+        for (const auto& batch : batches) {
+            for (const Item& item : batch) {
+                if (item.exists) {
+                    live_->Upsert(item);
+                } else if (uint32_t id = Find(item.path); id != kNone) {
+                    live_->Remove(id);
+                }
+            }
+        }
+    }
+
+    std::vector<std::string> changed;
+    ReadEvents(changed);
+    if (!changed.empty()) {
+        if (building_) deferred_.insert(deferred_.end(), changed.begin(), changed.end());
+        else Restat(std::move(changed));
+    }
+
+    if (building_ || !live_ || !live_->final) return;
+    bool compact = live_->dead > 1024 && live_->dead > live_->entries.size() / 4;
+    bool periodic = nextRescan_ != 0 && Seconds() >= nextRescan_;
+    if (rescanNow_ || compact || periodic) StartRebuild();
+}
+
+void ContentIndex::Close()
+{
+    closing_ = true;
+    jobs::Wait(jobs_);
+    Save();
+#ifdef __linux__
+    if (inotify_ >= 0) close(inotify_);
+#endif
+    inotify_ = -1;
+    {
+        std::lock_guard<std::mutex> lock(watchMutex_);
+        watches_.clear();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_.reset();
+    batches_.clear();
+    live_.reset();
+    deferred_.clear();
+    building_ = false;
+}
+
+// ---------------- запросы ----------------
+
+uint32_t ContentIndex::Count() const { return live_ ? uint32_t(live_->entries.size() - live_->dead) : 0; }
+
+uint32_t ContentIndex::Root() const { return live_ && !live_->entries.empty() ? 0 : kNone; }
+
+const ContentEntry& ContentIndex::Get(uint32_t id) const { return live_->entries[id]; }
+
+std::string_view ContentIndex::Path(uint32_t id) const { return live_->Path(id); }
+
+std::string_view ContentIndex::Name(uint32_t id) const { return Path(id).substr(live_->entries[id].nameOffset); }
+
+const std::vector<uint32_t>& ContentIndex::Children(uint32_t dir) const { return live_->children[dir]; }
+
+uint32_t ContentIndex::Find(std::string_view relPath) const
+{
+    if (!live_) return kNone;
+    auto it = live_->byPath.find(std::string(relPath));
+    return it == live_->byPath.end() ? kNone : it->second;
+}
+
+void ContentIndex::Search(std::string_view query, size_t maxResults, std::vector<uint32_t>& out) const
+{
+    DC_PROFILE_ZONE("ContentIndex::Search");
+    out.clear();
+    if (!live_ || maxResults == 0) return;
+    std::string q;
+    for (char c : query)
+        if (c != ' ' && c != '\t') q += Lower(c == '\\' ? '/' : c);
+    if (q.empty()) return;
+    const Snapshot& s = *live_;
+
+    if (q.size() < 3) {
+        // коротко — только начало имени, по отсортированному списку
+        auto it = std::lower_bound(s.byName.begin(), s.byName.end(), q,
+                                   [&](uint32_t id, const std::string& v) { return s.LowerName(id) < v; });
+        for (; it != s.byName.end() && out.size() < maxResults; ++it) {
+            if (s.LowerName(*it).substr(0, q.size()) != q) break;
+            if (s.entries[*it].alive) out.push_back(*it);
+        }
+        return;
+    }
+
+    // самый короткий список триграмм запроса, кандидаты проверяются подстрокой
+    const std::vector<uint32_t>* candidates = nullptr;
+    for (size_t i = 0; i + 3 <= q.size(); ++i) {
+        auto it = s.trigrams.find(Trigram(q.data() + i));
+        if (it == s.trigrams.end()) return;
+        if (!candidates || it->second.size() < candidates->size()) candidates = &it->second;
+    }
+    std::vector<uint32_t> tiers[3];
+    for (uint32_t id : *candidates) {
+        if (!s.entries[id].alive || s.LowerPath(id).find(q) == std::string_view::npos) continue;
+        std::string_view name = s.LowerName(id);
+        int tier = name.substr(0, q.size()) == q ? 0 : name.find(q) != std::string_view::npos ? 1 : 2;
+        tiers[tier].push_back(id);
+        if (tiers[0].size() >= maxResults) break;
+    }
+    for (auto& tier : tiers)
+        for (size_t i = 0; i < tier.size() && out.size() < maxResults; ++i) out.push_back(tier[i]);
+}
+
+} // namespace dancore::resources
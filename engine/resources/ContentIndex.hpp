@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/JobSystem.hpp"
+
+// Индекс содержимого проекта (Content/) для проводника и поиска в тулбаре.
+//
+// Файловая система трогается только в задачах job system: первичный обход — задача на
+// каталог, параллельно; снимок индекса собирается там же и подменяется на главном потоке
+// в Update(). Тёплый старт: индекс с прошлого запуска читается с диска и показывается сразу,
+// затем фоновая сверка перечитывает только каталоги, чей mtime изменился.
+// Дальше — инкрементально: inotify (Linux) сообщает изменённые пути, задача их stat'ит,
+// главный поток применяет пачку. Без inotify (или при переполнении очереди) — полная
+// фоновая пересборка раз в минуту.
+//
+// Поиск — триграммы полного пути (подстрока от 3 символов) и отсортированные имена
+// (префикс для 1–2 символов). Всё, кроме Open/Close, — только главный поток.
+
+namespace dancore::resources {
+
+struct ContentEntry {
+    uint32_t path = 0, pathLen = 0; // относительный путь через '/' в арене снимка
+    uint32_t nameOffset = 0;        // начало имени файла внутри пути
+    uint32_t parent = ~0u;
+    uint64_t size = 0;
+    int64_t mtime = 0;              // file_time_type::rep
+    bool directory = false;
+    bool alive = true;
+};
+
+class ContentIndex {
+public:
+    static constexpr uint32_t kNone = ~0u;
+
+    ContentIndex();
+    ~ContentIndex();
+    ContentIndex(const ContentIndex&) = delete;
+    ContentIndex& operator=(const ContentIndex&) = delete;
+
+    // indexFile — куда сохранять индекс между запусками (каталог создаётся)
+    void Open(const std::filesystem::path& root, const std::filesystem::path& indexFile);
+    void Close(); // ждёт фоновые задачи и сохраняет индекс
+
+    // Раз в кадр: подменяет готовый снимок, применяет изменения, запускает пересборку
+    void Update();
+
+    bool Ready() const { return live_ != nullptr; }
+    bool Scanning() const { return building_; }
+    uint32_t Count() const;
+    // Растёт при любом изменении; id действительны, пока версия та же
+    uint64_t Version() const { return version_; }
+    const std::filesystem::path& RootPath() const { return root_; }
+
+    uint32_t Root() const;
+    const ContentEntry& Get(uint32_t id) const;
+    std::string_view Path(uint32_t id) const;
+    std::string_view Name(uint32_t id) const;
+    const std::vector<uint32_t>& Children(uint32_t dir) const; // подкаталоги, затем файлы, по имени
+    uint32_t Find(std::string_view relPath) const;
+
+    // Совпадения без учёта регистра: сначала по началу имени, затем в имени, затем в пути
+    void Search(std::string_view query, size_t maxResults, std::vector<uint32_t>& out) const;
+
+    struct Snapshot;
+    struct Item {
+        std::string path;   // относительный, через '/'
+        bool directory = false;
+        bool exists = true; // false — путь исчез
+        uint64_t size = 0;
+        int64_t mtime = 0;
+    };
+    struct DirCache;
+
+private:
+    using Reuse = std::shared_ptr<const std::unordered_map<std::string, DirCache>>;
+    void StartRebuild();     // главный поток
+    void Scan(Reuse reuse);  // из любого потока: обход в задачах, снимок -> ready_
+    struct ScanState;
+    static void ScanDirectory(const std::shared_ptr<ScanState>& st, const std::string& rel);
+    void Restat(std::vector<std::string> paths);
+    void WatchDirectory(const std::string& rel);
+    void ReadEvents(std::vector<std::string>& changed);
+    void Save() const;
+
+    std::filesystem::path root_, indexFile_;
+    std::unique_ptr<Snapshot> live_;
+    uint64_t version_ = 0;
+
+    // между задачами и главным потоком
+    std::mutex mutex_;
+    std::unique_ptr<Snapshot> ready_;                 // готовый снимок на подмену
+    std::vector<std::vector<Item>> batches_;          // результаты Restat
+    core::jobs::JobCounter jobs_;
+    std::atomic<bool> closing_{false};
+
+    bool building_ = false;
+    std::vector<std::string> deferred_;               // изменения во время пересборки
+    double nextRescan_ = 0;                           // секунды profiler::Now, 0 — не нужна
+    bool rescanNow_ = false;                          // очередь inotify переполнилась
+
+    int inotify_ = -1;
+    std::mutex watchMutex_;
+    std::unordered_map<int, std::string> watches_;    // wd -> относительный путь каталога
+    std::atomic<bool> watchFailed_{false};
+};
+
+} // namespace dancore::resources
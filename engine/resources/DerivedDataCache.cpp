@@ -0,0 +1,239 @@
+#include "DerivedDataCache.hpp"
+#include "core/Hash.hpp"
+#include "core/Log.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace dancore::resources {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint32_t kEntryMagic = 0x31434444;   // 'DDC1'
+constexpr uint32_t kSourcesMagic = 0x53434444; // 'DDCS'
+constexpr uint32_t kSourcesVersion = 1;
+
+struct EntryHeader {
+    uint32_t magic = kEntryMagic;
+    uint32_t reserved = 0;
+    uint64_t key = 0;
+    uint64_t size = 0;
+    uint64_t hash = 0;          // Hash64 данных
+};
+static_assert(sizeof(EntryHeader) == 32);
+
+template <class T>
+void Put(std::ofstream& out, const T& v) { out.write(reinterpret_cast<const char*>(&v), sizeof(T)); }
+
+template <class T>
+bool Get(std::ifstream& in, T& v) { return bool(in.read(reinterpret_cast<char*>(&v), sizeof(T))); }
+
+int64_t Stamp(fs::file_time_type t) { return (int64_t)t.time_since_epoch().count(); }
+
+bool Stat(const fs::path& file, uint64_t& size, int64_t& mtime)
+{
+    std::error_code ec;
+    size = fs::file_size(file, ec);
+    if (ec) return false;
+    mtime = Stamp(fs::last_write_time(file, ec));
+    return !ec;
+}
+
+// Заголовок записи совпадает с ключом и длиной файла: обрыв записи (сбой, чужой писатель) виден без чтения данных
+bool ReadHeader(std::ifstream& in, const fs::path& path, uint64_t key, EntryHeader& h)
+{
+    std::error_code ec;
+    const uint64_t length = fs::file_size(path, ec);
+    return !ec && in && Get(in, h) && h.magic == kEntryMagic && h.key == key && length == sizeof(EntryHeader) + h.size;
+}
+
+} // namespace
+
+DerivedDataCache::DerivedDataCache(fs::path root) : root_(std::move(root))
+{
+    // кэш общий для всех процессов на машине: у временных файлов — свой префикс у каждого экземпляра
+    std::random_device rd;
+    tmpTag_ = (uint64_t(rd()) << 32 | rd()) ^ uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::error_code ec;
+    fs::create_directories(root_, ec);
+    LoadSources();
+}
+
+DerivedDataCache::~DerivedDataCache()
+{
+    Save();
+}
+
+uint64_t DerivedDataCache::Key(uint64_t sourceHash, uint32_t importerVersion, uint64_t settingsHash)
+{
+    return core::HashCombine(core::HashCombine(sourceHash, importerVersion), settingsHash);
+}
+
+fs::path DerivedDataCache::PathOf(uint64_t key) const
+{
+    char name[20];
+    std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+    return root_ / std::string(name, 2) / name;
+}
+
+uint64_t DerivedDataCache::SourceHash(const fs::path& file, std::vector<uint8_t>& contents)
+{
+    contents.clear();
+    // отметка — до чтения: файл, изменённый во время чтения, в следующий раз перечитается
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    const bool stamped = Stat(file, size, mtime);
+    const std::string key = fs::absolute(file).generic_string();
+    if (stamped) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = sources_.find(key);
+        if (it != sources_.end() && it->second.size == size && it->second.mtime == mtime) return it->second.hash;
+    }
+    std::ifstream in(file, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("DerivedDataCache: cannot open " + file.string());
+    contents.resize(size_t(in.tellg()));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(contents.data()), std::streamsize(contents.size())))
+        throw std::runtime_error("DerivedDataCache: cannot read " + file.string());
+    const uint64_t hash = core::Hash64(contents.data(), contents.size());
+    if (stamped) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sources_[key] = {size, mtime, hash};
+        dirty_ = true;
+    }
+    return hash;
+}
+
+bool DerivedDataCache::Contains(uint64_t key) const
+{
+    const fs::path path = PathOf(key);
+    bool found = false;
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        EntryHeader h;
+        found = ReadHeader(in, path, key, h);
+    }
+    if (!found) Discard(path);
+    (found ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    return found;
+}
+
+bool DerivedDataCache::Load(uint64_t key, std::vector<uint8_t>& out) const
+{
+    const fs::path path = PathOf(key);
+    bool ok = false, exists = false;
+    {
+        std::ifstream in(path, std::ios::binary);
+        exists = bool(in);
+        EntryHeader h;
+        if (exists && ReadHeader(in, path, key, h) && h.size < (1ull << 40)) {
+            out.resize(size_t(h.size));
+            ok = bool(in.read(reinterpret_cast<char*>(out.data()), std::streamsize(out.size()))) &&
+                 core::Hash64(out.data(), out.size()) == h.hash;
+        }
+    }
+    if (exists && !ok) Discard(path);
+    (ok ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    return ok;
+}
+
+void DerivedDataCache::Discard(const fs::path& path) const
+{
+    // следующий импорт не найдёт запись и соберёт её заново
+    DC_LOG_WARN(Assets, "derived data {} is corrupt, removed", path.string());
+    std::error_code ec;
+    fs::remove(path, ec);
+}
+
+void DerivedDataCache::Store(uint64_t key, const void* data, size_t size)
+{
+    const fs::path path = PathOf(key);
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    // один и тот же ключ могут писать два потока (одинаковые файлы в разных местах)
+    fs::path tmp = path;
+    char suffix[40];
+    std::snprintf(suffix, sizeof(suffix), ".tmp%016llx-%u", (unsigned long long)tmpTag_,
+                  tmpSerial_.fetch_add(1, std::memory_order_relaxed));
+    tmp += suffix;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("DerivedDataCache: cannot create " + tmp.string());
+        EntryHeader h;
+        h.key = key;
+        h.size = size;
+        h.hash = core::Hash64(data, size);
+        Put(out, h);
+        out.write(static_cast<const char*>(data), std::streamsize(size));
+        if (!out) {
+            out.close();
+            fs::remove(tmp, ec);
+            throw std::runtime_error("DerivedDataCache: write failed " + tmp.string());
+        }
+    }
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        throw std::runtime_error("DerivedDataCache: cannot replace " + path.string());
+    }
+}
+
+void DerivedDataCache::LoadSources()
+{
+    std::ifstream in(root_ / "sources.idx", std::ios::binary);
+    uint32_t magic = 0, version = 0, count = 0;
+    if (!in || !Get(in, magic) || magic != kSourcesMagic || !Get(in, version) || version != kSourcesVersion || !Get(in, count)) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (uint32_t i = 0; i < count; ++i) {
+        SourceStamp s;
+        uint32_t length = 0;
+        if (!Get(in, s.size) || !Get(in, s.mtime) || !Get(in, s.hash) || !Get(in, length) || length > 4096) break;
+        std::string path(length, '\0');
+        if (!in.read(path.data(), length)) break;
+        sources_[std::move(path)] = s;
+    }
+}
+
+void DerivedDataCache::Save() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!dirty_) return;
+    const fs::path file = root_ / "sources.idx";
+    fs::path tmp = file;
+    tmp += ".tmp";
+    std::error_code ec;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return;
+        Put(out, kSourcesMagic);
+        Put(out, kSourcesVersion);
+        Put(out, uint32_t(sources_.size()));
+        for (const auto& [path, s] : sources_) {
+            Put(out, s.size);
+            Put(out, s.mtime);
+            Put(out, s.hash);
+            Put(out, uint32_t(path.size()));
+            out.write(path.data(), std::streamsize(path.size()));
+        }
+        if (!out) {
+            out.close();
+            fs::remove(tmp, ec);
+            return;
+        }
+    }
+    fs::rename(tmp, file, ec); // атомарно: недописанный файл не подменит прежний
+    if (ec) DC_LOG_WARN(Assets, "cannot write {}: {}", file.string(), ec.message());
+    else dirty_ = false;
+}
+
+} // namespace dancore::resources
@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Кэш производных данных импорта, адресуемый содержимым.
+//
+// Ключ — HashCombine(хэш исходника, версия импортёра, хэш настроек): тот же файл с теми же
+// настройками той же версией импортёра даёт тот же ключ на любой машине и в любом каталоге,
+// переименование или откат файла попадает в уже готовый результат. Запись — файл
+// <root>/<2 hex>/<16 hex>, пишется во временный и подменяется целиком. Contains сверяет
+// заголовок с ключом и длиной файла, Load — ещё и хэш содержимого; битая запись — промах,
+// и она удаляется, чтобы импорт собрал её заново.
+//
+// Чтобы неизменённые исходники не перечитывать ради хэша, хэши запоминаются по
+// (путь, размер, mtime) и сохраняются в <root>/sources.idx. Все методы — из любого потока.
+
+namespace dancore::resources {
+
+class DerivedDataCache {
+public:
+    explicit DerivedDataCache(std::filesystem::path root);
+    ~DerivedDataCache(); // сохраняет запомненные хэши
+    DerivedDataCache(const DerivedDataCache&) = delete;
+    DerivedDataCache& operator=(const DerivedDataCache&) = delete;
+
+    static uint64_t Key(uint64_t sourceHash, uint32_t importerVersion, uint64_t settingsHash);
+
+    // Хэш содержимого файла: запомненный, если размер и mtime те же, иначе файл читается
+    // (прочитанное остаётся в contents, чтобы импорт не читал его второй раз).
+    // Бросает std::runtime_error, если файл не читается
+    uint64_t SourceHash(const std::filesystem::path& file, std::vector<uint8_t>& contents);
+
+    bool Contains(uint64_t key) const; // по заголовку, без чтения данных
+    bool Load(uint64_t key, std::vector<uint8_t>& out) const;
+    // Бросает std::runtime_error, если запись не удалась
+    void Store(uint64_t key, const void* data, size_t size);
+
+    void Save() const; // запомненные хэши на диск
+    const std::filesystem::path& Root() const { return root_; }
+
+    uint64_t Hits() const { return hits_; }
+    uint64_t Misses() const { return misses_; }
+
+private:
+    struct SourceStamp {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        uint64_t hash = 0;
+    };
+    std::filesystem::path PathOf(uint64_t key) const;
+    void LoadSources();
+    void Discard(const std::filesystem::path& path) const;
+
+    std::filesystem::path root_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, SourceStamp> sources_; // абсолютный путь -> отметка
+    mutable bool dirty_ = false;
+    mutable std::atomic<uint64_t> hits_{0}, misses_{0};
+    uint64_t tmpTag_ = 0;                      // случайный: временные файлы разных процессов не совпадают
+    std::atomic<uint32_t> tmpSerial_{0};
+};
+
+} // namespace dancore::resources
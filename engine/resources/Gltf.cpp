@@ -0,0 +1,439 @@
+#include "Gltf.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace dancore::resources {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// --- JSON: ровно столько, сколько нужно glTF ---
+
+struct Json {
+    enum class Type : uint8_t { Null, Bool, Number, String, Array, Object };
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<Json> items;          // элементы массива или значения объекта
+    std::vector<std::string> keys;    // у объекта: ключ items[i]
+
+    const Json* Find(std::string_view key) const
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+            if (keys[i] == key) return &items[i];
+        return nullptr;
+    }
+    const Json& operator[](std::string_view key) const
+    {
+        static const Json null;
+        const Json* j = Find(key);
+        return j ? *j : null;
+    }
+    const Json& operator[](size_t i) const
+    {
+        static const Json null;
+        return type == Type::Array && i < items.size() ? items[i] : null;
+    }
+    size_t Size() const { return type == Type::Array ? items.size() : 0; }
+    bool Has(std::string_view key) const { return Find(key) != nullptr; }
+    double Number(double def = 0) const { return type == Type::Number ? number : def; }
+    uint64_t Index(uint64_t def = ~0ull) const { return type == Type::Number && number >= 0 ? uint64_t(number) : def; }
+};
+
+class JsonParser {
+public:
+    JsonParser(const char* p, const char* end) : p_(p), end_(end) {}
+
+    Json Parse()
+    {
+        Json root = Value(0);
+        Space();
+        if (p_ != end_) Fail("trailing data");
+        return root;
+    }
+
+private:
+    [[noreturn]] void Fail(const char* what)
+    {
+        throw std::runtime_error(std::string("LoadGltf: JSON: ") + what);
+    }
+    void Space()
+    {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) ++p_;
+    }
+    bool Eat(char c)
+    {
+        Space();
+        if (p_ < end_ && *p_ == c) {
+            ++p_;
+            return true;
+        }
+        return false;
+    }
+    void Expect(char c)
+    {
+        if (!Eat(c)) Fail("unexpected character");
+    }
+    bool Word(const char* w)
+    {
+        const size_t n = std::strlen(w);
+        if (size_t(end_ - p_) < n || std::memcmp(p_, w, n)) return false;
+        p_ += n;
+        return true;
+    }
+
+    Json Value(int depth)
+    {
+        if (depth > 128) Fail("nested too deep");
+        Space();
+        if (p_ >= end_) Fail("unexpected end");
+        Json j;
+        const char c = *p_;
+        if (c == '{') {
+            ++p_;
+            j.type = Json::Type::Object;
+            if (Eat('}')) return j;
+            do {
+                Space();
+                j.keys.push_back(String());
+                Expect(':');
+                j.items.push_back(Value(depth + 1));
+            } while (Eat(','));
+            Expect('}');
+        } else if (c == '[') {
+            ++p_;
+            j.type = Json::Type::Array;
+            if (Eat(']')) return j;
+            do j.items.push_back(Value(depth + 1));
+            while (Eat(','));
+            Expect(']');
+        } else if (c == '"') {
+            j.type = Json::Type::String;
+            j.string = String();
+        } else if (Word("true")) {
+            j.type = Json::Type::Bool;
+            j.boolean = true;
+        } else if (Word("false")) {
+            j.type = Json::Type::Bool;
+        } else if (Word("null")) {
+        } else {
+            // strtod читает до первого не-числового символа; буфер заканчивается не-цифрой (см. LoadGltf)
+            char* after = nullptr;
+            j.number = std::strtod(p_, &after);
+            if (after == p_ || after > end_) Fail("bad value");
+            j.type = Json::Type::Number;
+            p_ = after;
+        }
+        return j;
+    }
+
+    std::string String()
+    {
+        if (p_ >= end_ || *p_ != '"') Fail("expected string");
+        ++p_;
+        std::string s;
+        while (p_ < end_ && *p_ != '"') {
+            char c = *p_++;
+            if (c != '\\') {
+                s += c;
+                continue;
+            }
+            if (p_ >= end_) break;
+            c = *p_++;
+            switch (c) {
+            case 'b': s += '\b'; break;
+            case 'f': s += '\f'; break;
+            case 'n': s += '\n'; break;
+            case 'r': s += '\r'; break;
+            case 't': s += '\t'; break;
+            case 'u': {
+                if (end_ - p_ < 4) Fail("bad escape");
+                const uint32_t u = uint32_t(std::strtoul(std::string(p_, 4).c_str(), nullptr, 16));
+                p_ += 4;
+                // в UTF-8; суррогатные пары в именах glTF не встречаются — заменяются '?'
+                if (u < 0x80) s += char(u);
+                else if (u < 0x800) s += char(0xC0 | u >> 6), s += char(0x80 | (u & 63));
+                else if (u >= 0xD800 && u < 0xE000) s += '?';
+                else s += char(0xE0 | u >> 12), s += char(0x80 | ((u >> 6) & 63)), s += char(0x80 | (u & 63));
+                break;
+            }
+            default: s += c; break;
+            }
+        }
+        if (p_ >= end_) Fail("unterminated string");
+        ++p_;
+        return s;
+    }
+
+    const char* p_;
+    const char* end_;
+};
+
+// --- буферы ---
+
+std::vector<uint8_t> DecodeBase64(std::string_view s)
+{
+    static const auto table = [] {
+        std::array<int8_t, 256> t{};
+        t.fill(-1);
+        const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int i = 0; i < 64; ++i) t[uint8_t(alphabet[i])] = int8_t(i);
+        return t;
+    }();
+    std::vector<uint8_t> out;
+    out.reserve(s.size() * 3 / 4);
+    uint32_t acc = 0;
+    int bits = 0;
+    for (char c : s) {
+        const int v = table[uint8_t(c)];
+        if (v < 0) continue; // '=' и переводы строк
+        acc = acc << 6 | uint32_t(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(uint8_t(acc >> bits));
+        }
+    }
+    return out;
+}
+
+std::string DecodeUri(std::string_view uri)
+{
+    std::string s;
+    for (size_t i = 0; i < uri.size(); ++i) {
+        if (uri[i] == '%' && i + 2 < uri.size()) {
+            s += char(std::strtoul(std::string(uri.substr(i + 1, 2)).c_str(), nullptr, 16));
+            i += 2;
+        } else {
+            s += uri[i];
+        }
+    }
+    return s;
+}
+
+std::vector<uint8_t> ReadWhole(const fs::path& file)
+{
+    std::ifstream in(file, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("LoadGltf: cannot open buffer " + file.string());
+    std::vector<uint8_t> data(size_t(in.tellg()));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size())))
+        throw std::runtime_error("LoadGltf: cannot read buffer " + file.string());
+    return data;
+}
+
+struct Document {
+    Json json;
+    std::vector<std::vector<uint8_t>> buffers;
+};
+
+uint32_t ComponentSize(uint64_t type)
+{
+    switch (type) {
+    case 5120: case 5121: return 1;
+    case 5122: case 5123: return 2;
+    case 5125: case 5126: return 4;
+    }
+    throw std::runtime_error("LoadGltf: bad componentType " + std::to_string(type));
+}
+
+uint32_t ComponentCount(const std::string& type)
+{
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    throw std::runtime_error("LoadGltf: unexpected accessor type " + type);
+}
+
+double Component(const uint8_t* p, uint64_t type, bool normalized)
+{
+    switch (type) {
+    case 5120: { int8_t v; std::memcpy(&v, p, 1); return normalized ? std::max(v / 127.0, -1.0) : v; }
+    case 5121: return normalized ? *p / 255.0 : *p;
+    case 5122: { int16_t v; std::memcpy(&v, p, 2); return normalized ? std::max(v / 32767.0, -1.0) : v; }
+    case 5123: { uint16_t v; std::memcpy(&v, p, 2); return normalized ? v / 65535.0 : v; }
+    case 5125: { uint32_t v; std::memcpy(&v, p, 4); return v; }
+    default: { float v; std::memcpy(&v, p, 4); return v; }
+    }
+}
+
+// Элементы аксессора по components значений (лишние отбрасываются, недостающие — 0) в out
+template <class T>
+void ReadAccessor(const Document& doc, uint64_t index, uint32_t components, std::vector<T>& out)
+{
+    const Json& acc = doc.json["accessors"][index];
+    if (acc.type != Json::Type::Object) throw std::runtime_error("LoadGltf: bad accessor " + std::to_string(index));
+    if (acc.Has("sparse")) throw std::runtime_error("LoadGltf: sparse accessors are not supported");
+    const uint64_t count = acc["count"].Index(0);
+    const uint64_t type = acc["componentType"].Index(0);
+    const bool normalized = acc["normalized"].boolean;
+    const uint32_t have = ComponentCount(acc["type"].string);
+    const uint32_t elementSize = ComponentSize(type) * have;
+    if (count > (1ull << 28)) throw std::runtime_error("LoadGltf: accessor too large");
+    out.assign(size_t(count) * components, T(0));
+    if (!acc.Has("bufferView")) return; // по спецификации — нули
+
+    const Json& view = doc.json["bufferViews"][acc["bufferView"].Index()];
+    const uint64_t buffer = view["buffer"].Index();
+    if (buffer >= doc.buffers.size()) throw std::runtime_error("LoadGltf: bad buffer view");
+    const std::vector<uint8_t>& bytes = doc.buffers[size_t(buffer)];
+    const uint64_t viewOffset = view["byteOffset"].Index(0), viewLength = view["byteLength"].Index(0);
+    const uint64_t stride = view["byteStride"].Index(elementSize);
+    const uint64_t offset = acc["byteOffset"].Index(0);
+    if (viewOffset + viewLength > bytes.size() || stride < elementSize ||
+        (count && offset + stride * (count - 1) + elementSize > viewLength))
+        throw std::runtime_error("LoadGltf: accessor " + std::to_string(index) + " is out of its buffer");
+    const uint8_t* base = bytes.data() + viewOffset + offset;
+    const uint32_t cs = ComponentSize(type), n = std::min(have, components);
+    for (uint64_t i = 0; i < count; ++i)
+        for (uint32_t k = 0; k < n; ++k) out[size_t(i) * components + k] = T(Component(base + i * stride + k * cs, type, normalized));
+}
+
+// JSON документа; у .glb ещё и BIN-чанк в bin
+Json ParseDocument(const uint8_t* data, size_t size, std::vector<uint8_t>* bin, bool& glb)
+{
+    std::string json;
+    glb = false;
+    if (size >= 12 && !std::memcmp(data, "glTF", 4)) {
+        uint32_t version, length;
+        std::memcpy(&version, data + 4, 4);
+        std::memcpy(&length, data + 8, 4);
+        if (version != 2 || length > size) throw std::runtime_error("LoadGltf: bad GLB header");
+        for (size_t pos = 12; pos + 8 <= length;) {
+            uint32_t chunkLength, chunkType;
+            std::memcpy(&chunkLength, data + pos, 4);
+            std::memcpy(&chunkType, data + pos + 4, 4);
+            if (chunkLength > length - pos - 8) throw std::runtime_error("LoadGltf: truncated GLB chunk");
+            const uint8_t* body = data + pos + 8;
+            if (chunkType == 0x4E4F534A) json.assign(reinterpret_cast<const char*>(body), chunkLength);
+            else if (chunkType == 0x004E4942 && bin && bin->empty()) bin->assign(body, body + chunkLength);
+            pos += 8 + ((size_t(chunkLength) + 3) & ~size_t(3));
+        }
+        glb = true;
+    } else {
+        json.assign(reinterpret_cast<const char*>(data), size);
+    }
+    json += '\0'; // strtod не выйдет за конец
+    return JsonParser(json.data(), json.data() + json.size() - 1).Parse();
+}
+
+} // namespace
+
+std::vector<std::filesystem::path> GltfExternalFiles(const uint8_t* data, size_t size, const fs::path& file)
+{
+    bool glb;
+    const Json json = ParseDocument(data, size, nullptr, glb);
+    std::vector<fs::path> files;
+    const Json& buffers = json["buffers"];
+    for (size_t i = 0; i < buffers.Size(); ++i) {
+        const Json* uri = buffers[i].Find("uri");
+        if (uri && uri->string.rfind("data:", 0) != 0) files.push_back(file.parent_path() / fs::u8path(DecodeUri(uri->string)));
+    }
+    return files;
+}
+
+std::vector<MeshPrimitive> LoadGltf(const uint8_t* data, size_t size, const fs::path& file)
+{
+    Document doc;
+    std::vector<uint8_t> bin;
+    bool glb;
+    doc.json = ParseDocument(data, size, &bin, glb);
+
+    const Json& asset = doc.json["asset"];
+    if (asset["version"].string.rfind("2.", 0) != 0) throw std::runtime_error("LoadGltf: not a glTF 2.0 file");
+    const Json& required = doc.json["extensionsRequired"];
+    for (size_t i = 0; i < required.Size(); ++i) {
+        const std::string& ext = required[i].string;
+        if (ext == "KHR_draco_mesh_compression" || ext == "EXT_meshopt_compression" || ext == "KHR_meshopt_compression")
+            throw std::runtime_error("LoadGltf: compressed geometry (" + ext + ") is not supported");
+    }
+
+    const Json& buffers = doc.json["buffers"];
+    for (size_t i = 0; i < buffers.Size(); ++i) {
+        const Json& b = buffers[i];
+        const Json* uri = b.Find("uri");
+        if (!uri) {
+            if (!glb || i) throw std::runtime_error("LoadGltf: buffer " + std::to_string(i) + " has no uri");
+            doc.buffers.push_back(std::move(bin));
+        } else if (uri->string.rfind("data:", 0) == 0) {
+            const size_t comma = uri->string.find(";base64,");
+            if (comma == std::string::npos) throw std::runtime_error("LoadGltf: only base64 data URIs are supported");
+            doc.buffers.push_back(DecodeBase64(std::string_view(uri->string).substr(comma + 8)));
+        } else {
+            doc.buffers.push_back(ReadWhole(file.parent_path() / fs::u8path(DecodeUri(uri->string))));
+        }
+        if (doc.buffers.back().size() < b["byteLength"].Index(0))
+            throw std::runtime_error("LoadGltf: buffer " + std::to_string(i) + " is shorter than its byteLength");
+    }
+
+    std::vector<MeshPrimitive> out;
+    const Json& meshes = doc.json["meshes"];
+    std::vector<float> values;
+    std::vector<uint32_t> indices;
+    for (size_t m = 0; m < meshes.Size(); ++m) {
+        const Json& mesh = meshes[m];
+        const std::string meshName = mesh["name"].string.empty() ? "mesh" + std::to_string(m) : mesh["name"].string;
+        const Json& primitives = mesh["primitives"];
+        for (size_t p = 0; p < primitives.Size(); ++p) {
+            const Json& prim = primitives[p];
+            const uint64_t mode = prim["mode"].Index(4);
+            const Json& attributes = prim["attributes"];
+            if (mode < 4 || mode > 6 || !attributes.Has("POSITION")) continue; // точки и линии
+            MeshPrimitive& dst = out.emplace_back();
+            dst.name = meshName + "/" + std::to_string(p);
+            dst.material = uint32_t(prim["material"].Index(~0u));
+
+            ReadAccessor(doc, attributes["POSITION"].Index(), 3, values);
+            dst.vertices.resize(values.size() / 3);
+            for (size_t v = 0; v < dst.vertices.size(); ++v) std::memcpy(dst.vertices[v].position, &values[v * 3], 12);
+            if (attributes.Has("NORMAL")) {
+                ReadAccessor(doc, attributes["NORMAL"].Index(), 3, values);
+                if (values.size() / 3 != dst.vertices.size()) throw std::runtime_error("LoadGltf: NORMAL count mismatch in " + dst.name);
+                for (size_t v = 0; v < dst.vertices.size(); ++v) std::memcpy(dst.vertices[v].normal, &values[v * 3], 12);
+                dst.hasNormals = true;
+            }
+            if (attributes.Has("TEXCOORD_0")) {
+                ReadAccessor(doc, attributes["TEXCOORD_0"].Index(), 2, values);
+                if (values.size() / 2 != dst.vertices.size()) throw std::runtime_error("LoadGltf: TEXCOORD_0 count mismatch in " + dst.name);
+                for (size_t v = 0; v < dst.vertices.size(); ++v) std::memcpy(dst.vertices[v].uv, &values[v * 2], 8);
+                dst.hasUVs = true;
+            }
+
+            if (prim.Has("indices")) {
+                ReadAccessor(doc, prim["indices"].Index(), 1, indices);
+            } else {
+                indices.resize(dst.vertices.size());
+                for (uint32_t i = 0; i < indices.size(); ++i) indices[i] = i;
+            }
+            for (uint32_t i : indices)
+                if (i >= dst.vertices.size()) throw std::runtime_error("LoadGltf: index out of range in " + dst.name);
+            // полосы и веера -> списки, вырожденные треугольники отбрасываются
+            std::vector<uint32_t>& tri = dst.indices;
+            const size_t n = indices.size();
+            if (mode == 4) {
+                tri.assign(indices.begin(), indices.begin() + n / 3 * 3);
+            } else {
+                for (size_t i = 0; i + 2 < n; ++i) {
+                    uint32_t a = mode == 5 ? indices[i] : indices[0], b = indices[i + 1], c = indices[i + 2];
+                    if (mode == 5 && (i & 1)) std::swap(a, b);
+                    if (a == b || b == c || a == c) continue;
+                    tri.insert(tri.end(), {a, b, c});
+                }
+            }
+            if (tri.empty()) out.pop_back();
+        }
+    }
+    return out;
+}
+
+} // namespace dancore::resources
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Геометрия из glTF 2.0 (.gltf с внешними буферами или data: URI, .glb) для импорта моделей.
+//
+// Берутся треугольники (списки, полосы и веера приводятся к спискам) с POSITION, NORMAL и
+// TEXCOORD_0, по примитиву на каждый меш. Иерархия узлов, материалы, анимация и скины не
+// читаются: меш остаётся в своих координатах, у примитива — только номер материала.
+// Файлы, требующие расширений сжатия (Draco, meshopt), отклоняются. Ошибки — std::runtime_error.
+
+namespace dancore::resources {
+
+struct MeshVertex {
+    float position[3] = {};
+    float normal[3] = {};
+    float uv[2] = {};
+};
+
+struct MeshPrimitive {
+    std::string name;                  // "меш/номер примитива"
+    uint32_t material = ~0u;           // индекс материала glTF, ~0u — нет
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;     // тройками
+    bool hasNormals = false, hasUVs = false;
+};
+
+// data — содержимое файла file; внешние буферы ищутся рядом с file
+std::vector<MeshPrimitive> LoadGltf(const uint8_t* data, size_t size, const std::filesystem::path& file);
+
+// Внешние буферы (не data: URI), от которых зависит геометрия: их хэши входят в ключ импорта
+std::vector<std::filesystem::path> GltfExternalFiles(const uint8_t* data, size_t size, const std::filesystem::path& file);
+
+} // namespace dancore::resources
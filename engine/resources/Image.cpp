@@ -0,0 +1,387 @@
+#include "Image.hpp"
+#include "Inflate.hpp"
+#include "core/JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef DANCORE_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace dancore::resources {
+
+namespace jobs = dancore::core::jobs;
+
+namespace {
+
+constexpr uint64_t kMaxPixels = 1ull << 28; // 16384 x 16384
+
+uint32_t ReadBE32(const uint8_t* p) { return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3]; }
+
+template <class T>
+T ReadLE(const uint8_t* p)
+{
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+// --- PNG ---
+
+struct PngInfo {
+    uint32_t width = 0, height = 0;
+    uint8_t depth = 0, colorType = 0, interlace = 0;
+    uint32_t channels = 0;
+    uint8_t palette[256][4] = {};
+    uint32_t paletteSize = 0;
+    bool colorKey = false;
+    uint16_t key[3] = {};           // tRNS серого/RGB: этот цвет прозрачен
+
+    uint32_t Bits() const { return channels * depth; }
+    size_t Stride(uint32_t w) const { return (size_t(w) * Bits() + 7) / 8; }
+};
+
+uint8_t Paeth(int a, int b, int c)
+{
+    const int p = a + b - c, pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    return uint8_t(pa <= pb && pa <= pc ? a : pb <= pc ? b : c);
+}
+
+// Фильтры строк на месте; rows — (1 + stride) байт на строку
+void Unfilter(uint8_t* rows, uint32_t height, size_t stride, size_t bpp)
+{
+    const uint8_t* prev = nullptr;
+    for (uint32_t y = 0; y < height; ++y) {
+        uint8_t* row = rows + y * (stride + 1);
+        const uint8_t filter = row[0];
+        uint8_t* cur = row + 1;
+        switch (filter) {
+        case 0: break;
+        case 1: for (size_t i = bpp; i < stride; ++i) cur[i] += cur[i - bpp]; break;
+        case 2: if (prev) for (size_t i = 0; i < stride; ++i) cur[i] += prev[i]; break;
+        case 3:
+            for (size_t i = 0; i < stride; ++i)
+                cur[i] += uint8_t(((i >= bpp ? cur[i - bpp] : 0) + (prev ? prev[i] : 0)) >> 1);
+            break;
+        case 4:
+            for (size_t i = 0; i < stride; ++i)
+                cur[i] += Paeth(i >= bpp ? cur[i - bpp] : 0, prev ? prev[i] : 0, i >= bpp && prev ? prev[i - bpp] : 0);
+            break;
+        default: throw std::runtime_error("DecodePng: bad filter type " + std::to_string(filter));
+        }
+        prev = cur;
+    }
+}
+
+uint32_t Sample(const uint8_t* row, size_t i, uint32_t depth)
+{
+    if (depth == 8) return row[i];
+    if (depth == 16) return uint32_t(row[2 * i]) << 8 | row[2 * i + 1];
+    const size_t bit = i * depth;
+    return (row[bit >> 3] >> (8 - depth - (bit & 7))) & ((1u << depth) - 1);
+}
+
+// Строка подизображения -> пиксели RGBA8 с шагом step начиная с x0
+void Expand(const PngInfo& png, const uint8_t* row, uint32_t count, uint8_t* dst, uint32_t step)
+{
+    const uint32_t d = png.depth, c = png.channels;
+    const uint32_t maxValue = (1u << d) - 1;
+    auto scale = [&](uint32_t v) { return uint8_t(d == 16 ? v >> 8 : d == 8 ? v : v * 255 / maxValue); };
+    for (uint32_t x = 0; x < count; ++x, dst += 4 * step) {
+        uint32_t s[4];
+        for (uint32_t k = 0; k < c; ++k) s[k] = Sample(row, size_t(x) * c + k, d);
+        switch (png.colorType) {
+        case 0:
+            dst[0] = dst[1] = dst[2] = scale(s[0]);
+            dst[3] = png.colorKey && s[0] == png.key[0] ? 0 : 255;
+            break;
+        case 2:
+            dst[0] = scale(s[0]), dst[1] = scale(s[1]), dst[2] = scale(s[2]);
+            dst[3] = png.colorKey && s[0] == png.key[0] && s[1] == png.key[1] && s[2] == png.key[2] ? 0 : 255;
+            break;
+        case 3:
+            if (s[0] >= png.paletteSize) throw std::runtime_error("DecodePng: palette index out of range");
+            std::memcpy(dst, png.palette[s[0]], 4);
+            break;
+        case 4: dst[0] = dst[1] = dst[2] = scale(s[0]), dst[3] = scale(s[1]); break;
+        default: dst[0] = scale(s[0]), dst[1] = scale(s[1]), dst[2] = scale(s[2]), dst[3] = scale(s[3]); break;
+        }
+    }
+}
+
+// --- KTX2 ---
+
+constexpr uint8_t kKtx2Magic[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+struct VkFormatInfo {
+    uint32_t vk;
+    PixelFormat format;
+    bool srgb;
+    uint32_t rgbBytes;  // 3 — RGB8, расширяется до RGBA8
+};
+
+constexpr VkFormatInfo kVkFormats[] = {
+    {23, PixelFormat::RGBA8, false, 3}, {29, PixelFormat::RGBA8, true, 3},
+    {37, PixelFormat::RGBA8, false, 0}, {43, PixelFormat::RGBA8, true, 0},
+    {131, PixelFormat::BC1, false, 0}, {132, PixelFormat::BC1, true, 0},
+    {133, PixelFormat::BC1, false, 0}, {134, PixelFormat::BC1, true, 0},
+    {137, PixelFormat::BC3, false, 0}, {138, PixelFormat::BC3, true, 0},
+    {139, PixelFormat::BC4, false, 0}, {141, PixelFormat::BC5, false, 0},
+    {145, PixelFormat::BC7, false, 0}, {146, PixelFormat::BC7, true, 0},
+};
+
+// --- mip ---
+
+struct SrgbTables {
+    float toLinear[256];
+    uint8_t fromLinear[1 << 14];
+
+    SrgbTables()
+    {
+        for (int i = 0; i < 256; ++i) {
+            const float c = i / 255.0f;
+            toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (int i = 0; i < (1 << 14); ++i) {
+            const float l = i / float((1 << 14) - 1);
+            const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            fromLinear[i] = uint8_t(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+        }
+    }
+};
+
+const SrgbTables& Srgb()
+{
+    static const SrgbTables tables;
+    return tables;
+}
+
+} // namespace
+
+const char* PixelFormatName(PixelFormat f)
+{
+    switch (f) {
+    case PixelFormat::RGBA8: return "RGBA8";
+    case PixelFormat::BC1: return "BC1";
+    case PixelFormat::BC3: return "BC3";
+    case PixelFormat::BC4: return "BC4";
+    case PixelFormat::BC5: return "BC5";
+    case PixelFormat::BC7: return "BC7";
+    }
+    return "?";
+}
+
+bool IsBlockCompressed(PixelFormat f) { return f != PixelFormat::RGBA8; }
+
+size_t LevelBytes(PixelFormat f, uint32_t width, uint32_t height)
+{
+    if (f == PixelFormat::RGBA8) return size_t(width) * height * 4;
+    const size_t blocks = size_t((width + 3) / 4) * ((height + 3) / 4);
+    return blocks * (f == PixelFormat::BC1 || f == PixelFormat::BC4 ? 8 : 16);
+}
+
+bool Image::HasAlpha() const
+{
+    if (format == PixelFormat::BC3 || format == PixelFormat::BC7) return true;
+    if (format != PixelFormat::RGBA8 || levels.empty()) return false;
+    const std::vector<uint8_t>& d = levels[0].data;
+    for (size_t i = 3; i < d.size(); i += 4)
+        if (d[i] != 255) return true;
+    return false;
+}
+
+Image DecodePng(const uint8_t* data, size_t size)
+{
+    static constexpr uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (size < 8 || std::memcmp(data, kSignature, 8)) throw std::runtime_error("DecodePng: not a PNG file");
+    PngInfo png;
+    std::vector<uint8_t> idat;
+    bool header = false, end = false;
+    for (size_t pos = 8; pos + 12 <= size && !end;) {
+        const uint32_t length = ReadBE32(data + pos);
+        const uint8_t* type = data + pos + 4;
+        const uint8_t* body = data + pos + 8;
+        if (length > size - pos - 12) throw std::runtime_error("DecodePng: truncated chunk");
+        if (!std::memcmp(type, "IHDR", 4)) {
+            if (length < 13) throw std::runtime_error("DecodePng: bad IHDR");
+            png.width = ReadBE32(body), png.height = ReadBE32(body + 4);
+            png.depth = body[8], png.colorType = body[9], png.interlace = body[12];
+            static constexpr uint32_t kChannels[7] = {1, 0, 3, 1, 2, 0, 4};
+            png.channels = png.colorType < 7 ? kChannels[png.colorType] : 0;
+            const uint32_t d = png.depth;
+            const bool depthOk = png.colorType == 0 ? (d == 1 || d == 2 || d == 4 || d == 8 || d == 16)
+                               : png.colorType == 3 ? (d == 1 || d == 2 || d == 4 || d == 8)
+                               : (d == 8 || d == 16);
+            if (!png.channels || !depthOk || body[10] || body[11] || png.interlace > 1)
+                throw std::runtime_error("DecodePng: unsupported format");
+            if (!png.width || !png.height || uint64_t(png.width) * png.height > kMaxPixels)
+                throw std::runtime_error("DecodePng: bad size " + std::to_string(png.width) + "x" + std::to_string(png.height));
+            header = true;
+        } else if (!std::memcmp(type, "PLTE", 4)) {
+            png.paletteSize = std::min(length / 3, 256u);
+            for (uint32_t i = 0; i < png.paletteSize; ++i)
+                png.palette[i][0] = body[3 * i], png.palette[i][1] = body[3 * i + 1], png.palette[i][2] = body[3 * i + 2],
+                png.palette[i][3] = 255;
+        } else if (!std::memcmp(type, "tRNS", 4)) {
+            if (png.colorType == 3) {
+                for (uint32_t i = 0; i < std::min(length, 256u); ++i) png.palette[i][3] = body[i];
+            } else if (png.colorType == 0 && length >= 2) {
+                png.colorKey = true, png.key[0] = uint16_t(body[0] << 8 | body[1]);
+            } else if (png.colorType == 2 && length >= 6) {
+                png.colorKey = true;
+                for (int k = 0; k < 3; ++k) png.key[k] = uint16_t(body[2 * k] << 8 | body[2 * k + 1]);
+            }
+        } else if (!std::memcmp(type, "IDAT", 4)) {
+            idat.insert(idat.end(), body, body + length);
+        } else if (!std::memcmp(type, "IEND", 4)) {
+            end = true;
+        } else if (!(type[0] & 0x20)) {
+            throw std::runtime_error("DecodePng: unknown critical chunk");
+        }
+        pos += size_t(length) + 12;
+    }
+    if (!header || idat.empty()) throw std::runtime_error("DecodePng: missing IHDR or IDAT");
+    if (png.colorType == 3 && !png.paletteSize) throw std::runtime_error("DecodePng: missing palette");
+
+    // подизображения Adam7: x0, y0, шаг по x, шаг по y; без чересстрочности — одно
+    struct Pass { uint32_t x0, y0, dx, dy; };
+    static constexpr Pass kAdam7[7] = {{0, 0, 8, 8}, {4, 0, 8, 8}, {0, 4, 4, 8}, {2, 0, 4, 4}, {0, 2, 2, 4}, {1, 0, 2, 2}, {0, 1, 1, 2}};
+    static constexpr Pass kFull[1] = {{0, 0, 1, 1}};
+    const Pass* passes = png.interlace ? kAdam7 : kFull;
+    const int passCount = png.interlace ? 7 : 1;
+    size_t raw = 0;
+    for (int p = 0; p < passCount; ++p) {
+        const uint32_t w = (png.width - passes[p].x0 + passes[p].dx - 1) / passes[p].dx;
+        const uint32_t h = (png.height - passes[p].y0 + passes[p].dy - 1) / passes[p].dy;
+        if (png.width > passes[p].x0 && png.height > passes[p].y0) raw += (png.Stride(w) + 1) * h;
+    }
+    std::vector<uint8_t> rows;
+    if (!InflateZlib(idat.data(), idat.size(), rows, raw) || rows.size() < raw) throw std::runtime_error("DecodePng: corrupt image data");
+
+    Image image;
+    ImageLevel& level = image.levels.emplace_back();
+    level.width = png.width, level.height = png.height;
+    level.data.resize(size_t(png.width) * png.height * 4);
+    const size_t bpp = std::max<size_t>(1, png.Bits() / 8);
+    uint8_t* cursor = rows.data();
+    for (int p = 0; p < passCount; ++p) {
+        const Pass& pass = passes[p];
+        if (png.width <= pass.x0 || png.height <= pass.y0) continue;
+        const uint32_t w = (png.width - pass.x0 + pass.dx - 1) / pass.dx;
+        const uint32_t h = (png.height - pass.y0 + pass.dy - 1) / pass.dy;
+        const size_t stride = png.Stride(w);
+        Unfilter(cursor, h, stride, bpp);
+        for (uint32_t y = 0; y < h; ++y) {
+            uint8_t* dst = level.data.data() + (size_t(pass.y0 + y * pass.dy) * png.width + pass.x0) * 4;
+            Expand(png, cursor + y * (stride + 1) + 1, w, dst, pass.dx);
+        }
+        cursor += (stride + 1) * h;
+    }
+    return image;
+}
+
+Image ReadKtx2(const uint8_t* data, size_t size)
+{
+    if (size < 80 || std::memcmp(data, kKtx2Magic, 12)) throw std::runtime_error("ReadKtx2: not a KTX2 file");
+    const uint32_t vkFormat = ReadLE<uint32_t>(data + 12);
+    const uint32_t width = ReadLE<uint32_t>(data + 20), height = ReadLE<uint32_t>(data + 24);
+    const uint32_t depth = ReadLE<uint32_t>(data + 28), layers = ReadLE<uint32_t>(data + 32);
+    const uint32_t faces = ReadLE<uint32_t>(data + 36);
+    const uint32_t levelCount = std::max(ReadLE<uint32_t>(data + 40), 1u);
+    const uint32_t scheme = ReadLE<uint32_t>(data + 44);
+
+    if (scheme == 1 || vkFormat == 0)
+        throw std::runtime_error("ReadKtx2: Basis Universal (BasisLZ/UASTC) textures need a transcoder this build does not have");
+    const VkFormatInfo* info = nullptr;
+    for (const VkFormatInfo& f : kVkFormats)
+        if (f.vk == vkFormat) info = &f;
+    if (!info) throw std::runtime_error("ReadKtx2: unsupported VkFormat " + std::to_string(vkFormat));
+    if (depth > 1 || layers > 1 || faces != 1) throw std::runtime_error("ReadKtx2: only 2D textures are supported");
+    if (!width || !height || uint64_t(width) * height > kMaxPixels || levelCount > 32 || 80 + size_t(levelCount) * 24 > size)
+        throw std::runtime_error("ReadKtx2: bad header");
+#ifndef DANCORE_HAS_ZSTD
+    if (scheme == 2) throw std::runtime_error("ReadKtx2: Zstd supercompression needs a build with zstd");
+#endif
+    if (scheme > 3) throw std::runtime_error("ReadKtx2: unknown supercompression " + std::to_string(scheme));
+
+    Image image;
+    image.format = info->format;
+    image.srgb = info->srgb;
+    image.levels.resize(levelCount);
+    for (uint32_t l = 0; l < levelCount; ++l) {
+        const uint8_t* entry = data + 80 + size_t(l) * 24;
+        const uint64_t offset = ReadLE<uint64_t>(entry), length = ReadLE<uint64_t>(entry + 8);
+        ImageLevel& level = image.levels[l];
+        level.width = std::max(width >> l, 1u), level.height = std::max(height >> l, 1u);
+        const size_t expected = info->rgbBytes ? size_t(level.width) * level.height * 3 : LevelBytes(info->format, level.width, level.height);
+        if (offset > size || length > size - offset) throw std::runtime_error("ReadKtx2: level " + std::to_string(l) + " out of file");
+        std::vector<uint8_t> bytes;
+        if (scheme == 0) {
+            bytes.assign(data + offset, data + offset + length);
+        } else if (scheme == 3) {
+            if (!InflateZlib(data + offset, size_t(length), bytes, expected)) throw std::runtime_error("ReadKtx2: corrupt zlib level");
+        } else {
+#ifdef DANCORE_HAS_ZSTD
+            bytes.resize(expected);
+            const size_t n = ZSTD_decompress(bytes.data(), bytes.size(), data + offset, size_t(length));
+            if (ZSTD_isError(n)) throw std::runtime_error(std::string("ReadKtx2: ") + ZSTD_getErrorName(n));
+            bytes.resize(n);
+#endif
+        }
+        if (bytes.size() != expected) throw std::runtime_error("ReadKtx2: level " + std::to_string(l) + " has a wrong size");
+        if (info->rgbBytes) {
+            level.data.resize(size_t(level.width) * level.height * 4);
+            for (size_t i = 0, n = size_t(level.width) * level.height; i < n; ++i) {
+                std::memcpy(&level.data[i * 4], &bytes[i * 3], 3);
+                level.data[i * 4 + 3] = 255;
+            }
+        } else {
+            level.data = std::move(bytes);
+        }
+    }
+    return image;
+}
+
+void GenerateMips(Image& image)
+{
+    if (image.format != PixelFormat::RGBA8 || image.levels.empty()) return;
+    image.levels.resize(1);
+    const SrgbTables& srgb = Srgb();
+    const bool linearize = image.srgb;
+    while (image.levels.back().width > 1 || image.levels.back().height > 1) {
+        const ImageLevel& src = image.levels.back();
+        ImageLevel dst;
+        dst.width = std::max(src.width / 2, 1u), dst.height = std::max(src.height / 2, 1u);
+        dst.data.resize(size_t(dst.width) * dst.height * 4);
+        const uint32_t sw = src.width, sh = src.height;
+        const uint8_t* s = src.data.data();
+        uint8_t* d = dst.data.data();
+        const uint32_t dw = dst.width;
+        jobs::ParallelFor(0, dst.height, std::max<size_t>(1, 16384 / dw), [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; ++y) {
+                const size_t y0 = std::min<size_t>(2 * y, sh - 1), y1 = std::min<size_t>(2 * y + 1, sh - 1);
+                for (uint32_t x = 0; x < dw; ++x) {
+                    const size_t x0 = std::min<size_t>(2 * x, sw - 1), x1 = std::min<size_t>(2 * x + 1, sw - 1);
+                    const uint8_t* p[4] = {s + (y0 * sw + x0) * 4, s + (y0 * sw + x1) * 4, s + (y1 * sw + x0) * 4, s + (y1 * sw + x1) * 4};
+                    uint8_t* out = d + (y * dw + x) * 4;
+                    for (int c = 0; c < 3; ++c) {
+                        if (linearize) {
+                            const float l = (srgb.toLinear[p[0][c]] + srgb.toLinear[p[1][c]] + srgb.toLinear[p[2][c]] + srgb.toLinear[p[3][c]]) * 0.25f;
+                            out[c] = srgb.fromLinear[int(l * float((1 << 14) - 1) + 0.5f)];
+                        } else {
+                            out[c] = uint8_t((p[0][c] + p[1][c] + p[2][c] + p[3][c] + 2) >> 2);
+                        }
+                    }
+                    out[3] = uint8_t((p[0][3] + p[1][3] + p[2][3] + p[3][3] + 2) >> 2);
+                }
+            }
+        });
+        image.levels.push_back(std::move(dst));
+    }
+}
+
+} // namespace dancore::resources
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Картинки для импорта текстур: разбор PNG и KTX2 в уровни в памяти, mip-цепочка.
+//
+// PNG — все типы цвета и глубины, включая чересстрочные; приводится к RGBA8 (16 бит — старший
+// байт). KTX2 — 2D-текстуры в RGBA8/RGB8 и BCn, без суперсжатия, с zlib или Zstd (Zstd — при
+// сборке с DANCORE_HAS_ZSTD). BasisLZ/UASTC требуют транскодера Basis Universal, которого в
+// движке нет: такие файлы отклоняются с понятной ошибкой. Ошибки — std::runtime_error.
+
+namespace dancore::resources {
+
+enum class PixelFormat : uint32_t { RGBA8, BC1, BC3, BC4, BC5, BC7 };
+
+const char* PixelFormatName(PixelFormat f);
+bool IsBlockCompressed(PixelFormat f);
+size_t LevelBytes(PixelFormat f, uint32_t width, uint32_t height);
+
+struct ImageLevel {
+    uint32_t width = 0, height = 0;
+    std::vector<uint8_t> data;
+};
+
+struct Image {
+    PixelFormat format = PixelFormat::RGBA8;
+    bool srgb = false;                // цветовые каналы в sRGB (mip-уровни усредняются в линейном)
+    std::vector<ImageLevel> levels;   // 0 — полный размер
+
+    uint32_t Width() const { return levels.empty() ? 0 : levels[0].width; }
+    uint32_t Height() const { return levels.empty() ? 0 : levels[0].height; }
+    bool HasAlpha() const;            // RGBA8: есть альфа меньше 255; BC3/BC7 — всегда
+};
+
+Image DecodePng(const uint8_t* data, size_t size);
+Image ReadKtx2(const uint8_t* data, size_t size);
+
+// RGBA8: уровни до 1x1 фильтром 2x2 (нечётная сторона прижимается к краю); строки — в jobs::ParallelFor
+void GenerateMips(Image& image);
+
+} // namespace dancore::resources
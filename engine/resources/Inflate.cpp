@@ -0,0 +1,264 @@
+#include "Inflate.hpp"
+
+#include <cstring>
+
+namespace dancore::resources {
+
+namespace {
+
+constexpr int kMaxBits = 15;
+constexpr int kFastBits = 10;
+
+constexpr uint16_t kLengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                      35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t kDistBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+                                    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+struct Bits {
+    const uint8_t* src;
+    size_t size, pos = 0;
+    uint64_t buffer = 0;
+    int count = 0;
+
+    void Refill()
+    {
+        while (count <= 56 && pos < size) {
+            buffer |= uint64_t(src[pos++]) << count;
+            count += 8;
+        }
+    }
+    bool Need(int n)
+    {
+        if (count < n) Refill();
+        return count >= n;
+    }
+    uint32_t Peek(int n) const { return uint32_t(buffer & ((uint64_t(1) << n) - 1)); }
+    void Drop(int n)
+    {
+        buffer >>= n;
+        count -= n;
+    }
+    bool Take(int n, uint32_t& v)
+    {
+        if (!Need(n)) return false;
+        v = Peek(n);
+        Drop(n);
+        return true;
+    }
+};
+
+// Канонический код: быстрая таблица по перевёрнутым первым kFastBits битам + счётчики для длинных
+struct Huffman {
+    uint16_t fast[1 << kFastBits]; // symbol << 4 | length, 0 — код длиннее kFastBits
+    uint16_t counts[kMaxBits + 1];
+    uint16_t symbols[288];
+
+    bool Build(const uint8_t* lengths, int n)
+    {
+        std::memset(counts, 0, sizeof(counts));
+        for (int i = 0; i < n; ++i) counts[lengths[i]]++;
+        counts[0] = 0;
+        int left = 1;
+        for (int len = 1; len <= kMaxBits; ++len) {
+            left = (left << 1) - counts[len];
+            if (left < 0) return false; // переподписанный код
+        }
+        uint16_t offsets[kMaxBits + 2];
+        offsets[1] = 0;
+        for (int len = 1; len <= kMaxBits; ++len) offsets[len + 1] = uint16_t(offsets[len] + counts[len]);
+        for (int i = 0; i < n; ++i)
+            if (lengths[i]) symbols[offsets[lengths[i]]++] = uint16_t(i);
+
+        std::memset(fast, 0, sizeof(fast));
+        uint32_t code = 0;
+        int index = 0;
+        for (int len = 1; len <= kFastBits; ++len) {
+            for (int k = 0; k < counts[len]; ++k, ++code, ++index) {
+                uint32_t rev = 0;
+                for (int b = 0; b < len; ++b) rev |= ((code >> b) & 1) << (len - 1 - b);
+                for (uint32_t i = rev; i < (1u << kFastBits); i += 1u << len) fast[i] = uint16_t(symbols[index] << 4 | len);
+            }
+            code <<= 1;
+        }
+        return true;
+    }
+
+    // -1 — нет такого кода или поток кончился
+    int Decode(Bits& bits) const
+    {
+        bits.Need(kMaxBits);
+        const uint16_t e = fast[bits.Peek(kFastBits)];
+        if (e && (e & 15) <= bits.count) {
+            bits.Drop(e & 15);
+            return e >> 4;
+        }
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len <= kMaxBits && len <= bits.count; ++len) {
+            code |= int((bits.buffer >> (len - 1)) & 1);
+            const int count = counts[len];
+            if (code - first < count) {
+                bits.Drop(len);
+                return symbols[index + code - first];
+            }
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+};
+
+struct Output {
+    std::vector<uint8_t>& data;
+    size_t begin, pos;
+
+    void Reserve(size_t n)
+    {
+        if (pos + n > data.size()) data.resize(std::max(pos + n, data.size() * 2));
+    }
+};
+
+bool Codes(Bits& bits, const Huffman& lit, const Huffman& dist, Output& out)
+{
+    for (;;) {
+        const int sym = lit.Decode(bits);
+        if (sym < 0) return false;
+        if (sym < 256) {
+            out.Reserve(1);
+            out.data[out.pos++] = uint8_t(sym);
+            continue;
+        }
+        if (sym == 256) return true;
+        const int li = sym - 257;
+        if (li >= 29) return false;
+        uint32_t extra = 0;
+        if (!bits.Take(kLengthExtra[li], extra)) return false;
+        const size_t length = kLengthBase[li] + extra;
+        const int di = dist.Decode(bits);
+        if (di < 0 || di >= 30) return false;
+        if (!bits.Take(kDistExtra[di], extra)) return false;
+        const size_t distance = kDistBase[di] + extra;
+        if (distance > out.pos - out.begin) return false;
+        out.Reserve(length);
+        uint8_t* dst = out.data.data() + out.pos;
+        const uint8_t* from = dst - distance;
+        if (distance >= length) std::memcpy(dst, from, length);
+        else for (size_t i = 0; i < length; ++i) dst[i] = from[i]; // перекрытие: повтор последних байт
+        out.pos += length;
+    }
+}
+
+bool Dynamic(Bits& bits, Huffman& lit, Huffman& dist)
+{
+    static constexpr uint8_t kOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    uint32_t hlit, hdist, hclen;
+    if (!bits.Take(5, hlit) || !bits.Take(5, hdist) || !bits.Take(4, hclen)) return false;
+    hlit += 257, hdist += 1, hclen += 4;
+    if (hlit > 286 || hdist > 30) return false;
+    uint8_t lengths[320] = {};
+    for (uint32_t i = 0; i < hclen; ++i) {
+        uint32_t v;
+        if (!bits.Take(3, v)) return false;
+        lengths[kOrder[i]] = uint8_t(v);
+    }
+    Huffman lenCode;
+    if (!lenCode.Build(lengths, 19)) return false;
+    std::memset(lengths, 0, sizeof(lengths));
+    for (uint32_t i = 0; i < hlit + hdist;) {
+        const int sym = lenCode.Decode(bits);
+        if (sym < 0) return false;
+        if (sym < 16) {
+            lengths[i++] = uint8_t(sym);
+            continue;
+        }
+        uint32_t repeat, value = 0;
+        if (sym == 16) {
+            if (i == 0 || !bits.Take(2, repeat)) return false;
+            value = lengths[i - 1], repeat += 3;
+        } else if (sym == 17) {
+            if (!bits.Take(3, repeat)) return false;
+            repeat += 3;
+        } else {
+            if (!bits.Take(7, repeat)) return false;
+            repeat += 11;
+        }
+        if (i + repeat > hlit + hdist) return false;
+        while (repeat--) lengths[i++] = uint8_t(value);
+    }
+    if (!lengths[256]) return false; // без конца блока
+    return lit.Build(lengths, int(hlit)) && dist.Build(lengths + hlit, int(hdist));
+}
+
+} // namespace
+
+bool Inflate(const uint8_t* src, size_t size, std::vector<uint8_t>& out, size_t sizeHint)
+{
+    Bits bits{src, size};
+    Output o{out, out.size(), out.size()};
+    out.resize(o.pos + (sizeHint ? sizeHint : size * 4 + 1024));
+    static const struct Fixed {
+        Huffman lit, dist;
+        Fixed()
+        {
+            uint8_t lengths[320];
+            std::memset(lengths, 8, 144);
+            std::memset(lengths + 144, 9, 112);
+            std::memset(lengths + 256, 7, 24);
+            std::memset(lengths + 280, 8, 8);
+            lit.Build(lengths, 288);
+            std::memset(lengths, 5, 30);
+            dist.Build(lengths, 30);
+        }
+    } fixed;
+    Huffman lit, dist; // динамические, на каждый блок
+    uint32_t last = 0;
+    while (!last) {
+        uint32_t type;
+        if (!bits.Take(1, last) || !bits.Take(2, type)) return false;
+        bool ok = false;
+        if (type == 0) {
+            bits.Drop(bits.count & 7); // до границы байта
+            uint32_t len, nlen;
+            if (!bits.Take(16, len) || !bits.Take(16, nlen) || (len ^ 0xffff) != nlen) return false;
+            o.Reserve(len);
+            // остаток буфера бит — уже прочитанные байты блока
+            for (; len && bits.count >= 8; --len) {
+                out[o.pos++] = uint8_t(bits.Peek(8));
+                bits.Drop(8);
+            }
+            if (len > bits.size - bits.pos) return false;
+            std::memcpy(out.data() + o.pos, bits.src + bits.pos, len);
+            o.pos += len, bits.pos += len;
+            ok = true;
+        } else if (type == 1) {
+            ok = Codes(bits, fixed.lit, fixed.dist, o);
+        } else if (type == 2) {
+            ok = Dynamic(bits, lit, dist) && Codes(bits, lit, dist, o);
+        }
+        if (!ok) return false;
+    }
+    out.resize(o.pos);
+    return true;
+}
+
+bool InflateZlib(const uint8_t* src, size_t size, std::vector<uint8_t>& out, size_t sizeHint)
+{
+    if (size < 6) return false;
+    const uint32_t cmf = src[0], flg = src[1];
+    if ((cmf & 15) != 8 || (cmf << 8 | flg) % 31 || (flg & 0x20)) return false; // deflate, без словаря
+    const size_t begin = out.size();
+    if (!Inflate(src + 2, size - 6, out, sizeHint)) return false;
+    // Adler-32 по кускам, пока суммы не переполнят 32 бита
+    uint32_t a = 1, b = 0;
+    for (size_t i = begin; i < out.size();) {
+        const size_t end = std::min(out.size(), i + 5552);
+        for (; i < end; ++i) a += out[i], b += a;
+        a %= 65521, b %= 65521;
+    }
+    const uint8_t* t = src + size - 4;
+    return (b << 16 | a) == (uint32_t(t[0]) << 24 | uint32_t(t[1]) << 16 | uint32_t(t[2]) << 8 | t[3]);
+}
+
+} // namespace dancore::resources
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Распаковка deflate (RFC 1951) без внешней зависимости: IDAT у PNG, zlib-суперсжатие KTX2.
+// Коды Хаффмана — таблица на первые 10 бит, длинные коды дочитываются по каноническим счётчикам.
+
+namespace dancore::resources {
+
+// Сырой поток deflate; результат дописывается в out. sizeHint — ожидаемый размер (0 — неизвестен).
+// Проверяет границы на каждом шаге; false — поток повреждён или обрывается
+bool Inflate(const uint8_t* src, size_t size, std::vector<uint8_t>& out, size_t sizeHint = 0);
+
+// То же в обёртке zlib (заголовок и Adler-32 проверяются)
+bool InflateZlib(const uint8_t* src, size_t size, std::vector<uint8_t>& out, size_t sizeHint = 0);
+
+} // namespace dancore::resources
@@ -0,0 +1,128 @@
+#include "Lz4.hpp"
+
+#include <cstring>
+#include <memory>
+
+namespace dancore::resources {
+
+namespace {
+
+constexpr uint32_t kHashLog = 14;
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5; // последние байты блока — всегда литералы
+constexpr size_t kMatchFind = 12;   // совпадение не начинается ближе к концу
+constexpr size_t kMaxOffset = 65535;
+
+uint32_t Read32(const uint8_t* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+uint32_t Hash(uint32_t v) { return (v * 2654435761u) >> (32 - kHashLog); }
+
+uint8_t* PutLength(uint8_t* op, size_t len)
+{
+    for (; len >= 255; len -= 255) *op++ = 255;
+    *op++ = uint8_t(len);
+    return op;
+}
+
+uint8_t* Emit(uint8_t* op, const uint8_t* literals, size_t litLen, size_t offset, size_t matchLen)
+{
+    uint8_t* token = op++;
+    *token = uint8_t((litLen < 15 ? litLen : 15) << 4);
+    if (litLen >= 15) op = PutLength(op, litLen - 15);
+    if (litLen) std::memcpy(op, literals, litLen);
+    op += litLen;
+    if (matchLen == 0) return op; // хвост из одних литералов
+    *op++ = uint8_t(offset);
+    *op++ = uint8_t(offset >> 8);
+    size_t m = matchLen - kMinMatch;
+    *token |= uint8_t(m < 15 ? m : 15);
+    if (m >= 15) op = PutLength(op, m - 15);
+    return op;
+}
+
+bool GetLength(const uint8_t*& ip, const uint8_t* end, size_t& len)
+{
+    uint8_t b;
+    do {
+        if (ip >= end) return false;
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+} // namespace
+
+size_t Lz4Compress(const uint8_t* src, size_t size, uint8_t* dst)
+{
+    const uint8_t* ip = src;
+    const uint8_t* anchor = src;
+    const uint8_t* end = src + size;
+    uint8_t* op = dst;
+
+    if (size > kMatchFind) {
+        const uint8_t* matchFind = end - kMatchFind;
+        const uint8_t* matchLimit = end - kLastLiterals;
+        auto table = std::make_unique<uint32_t[]>(size_t(1) << kHashLog); // позиции от src, нули
+        uint32_t misses = 0;
+        ++ip;
+        while (ip < matchFind) {
+            uint32_t seq = Read32(ip);
+            uint32_t h = Hash(seq);
+            const uint8_t* ref = src + table[h];
+            table[h] = uint32_t(ip - src);
+            if (size_t(ip - ref) > kMaxOffset || Read32(ref) != seq) {
+                ip += 1 + (misses++ >> 6); // несжимаемые участки проходим всё крупнее
+                continue;
+            }
+            misses = 0;
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) { --ip; --ref; }
+            const uint8_t* p = ip + kMinMatch;
+            const uint8_t* q = ref + kMinMatch;
+            while (p < matchLimit && *p == *q) { ++p; ++q; }
+            op = Emit(op, anchor, size_t(ip - anchor), size_t(ip - ref), size_t(p - ip));
+            ip = anchor = p;
+        }
+    }
+    return size_t(Emit(op, anchor, size_t(end - anchor), 0, 0) - dst);
+}
+
+bool Lz4Decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t rawSize)
+{
+    const uint8_t* ip = src;
+    const uint8_t* iend = src + size;
+    uint8_t* op = dst;
+    uint8_t* oend = dst + rawSize;
+    while (ip < iend) {
+        uint8_t token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15 && !GetLength(ip, iend, lit)) return false;
+        if (lit > size_t(iend - ip) || lit > size_t(oend - op)) return false;
+        if (lit) std::memcpy(op, ip, lit);
+        op += lit;
+        ip += lit;
+        if (ip == iend) break; // последняя последовательность без совпадения
+        if (iend - ip < 2) return false;
+        size_t offset = size_t(ip[0]) | size_t(ip[1]) << 8;
+        ip += 2;
+        size_t len = token & 15;
+        if (len == 15 && !GetLength(ip, iend, len)) return false;
+        len += kMinMatch;
+        if (offset == 0 || offset > size_t(op - dst) || len > size_t(oend - op)) return false;
+        const uint8_t* m = op - offset;
+        if (offset >= len) {
+            std::memcpy(op, m, len);
+            op += len;
+        } else {
+            for (size_t i = 0; i < len; ++i) *op++ = m[i]; // перекрытие: повтор короткого шаблона
+        }
+    }
+    return op == oend;
+}
+
+} // namespace dancore::resources
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Блочный формат LZ4 (совместим с LZ4_compress_default/LZ4_decompress_safe):
+// быстрая распаковка без внешней зависимости. Сжатие — жадное, по хэшу 4 байт,
+// детерминированное (одинаковый вход — побайтно одинаковый выход).
+
+namespace dancore::resources {
+
+// Сколько нужно места под сжатый блок в худшем случае
+constexpr size_t Lz4Bound(size_t size) { return size + size / 255 + 16; }
+
+// dst — не меньше Lz4Bound(size); возвращает размер сжатых данных
+size_t Lz4Compress(const uint8_t* src, size_t size, uint8_t* dst);
+
+// Проверяет границы на каждом шаге; true, только если получилось ровно rawSize байт
+bool Lz4Decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t rawSize);
+
+} // namespace dancore::resources
@@ -0,0 +1,309 @@
+#include "MeshOptimizer.hpp"
+#include "core/Hash.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+namespace dancore::resources {
+
+namespace {
+
+constexpr int kCacheSize = 32;
+constexpr int kMaxValence = 64; // выше — одна и та же добавка к весу
+
+struct ScoreTables {
+    float cache[kCacheSize];
+    float valence[kMaxValence + 1];
+
+    ScoreTables()
+    {
+        // последний треугольник — 0.75: его вершины и так в кэше, чуть ниже следующих за ними
+        for (int i = 0; i < kCacheSize; ++i)
+            cache[i] = i < 3 ? 0.75f : std::pow(1.0f - float(i - 3) / float(kCacheSize - 3), 1.5f);
+        valence[0] = 0;
+        for (int i = 1; i <= kMaxValence; ++i) valence[i] = 2.0f / std::sqrt(float(i));
+    }
+};
+
+const ScoreTables& Scores()
+{
+    static const ScoreTables tables;
+    return tables;
+}
+
+float VertexScore(int cachePos, uint32_t active)
+{
+    if (!active) return -1.0f;
+    const ScoreTables& t = Scores();
+    return (cachePos < 0 ? 0.0f : t.cache[cachePos]) + t.valence[std::min<uint32_t>(active, kMaxValence)];
+}
+
+void Cross(const float* a, const float* b, const float* c, float* n)
+{
+    const float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    const float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+uint16_t Unorm16(float v, float min, float max)
+{
+    const float extent = max - min;
+    return extent > 0 ? uint16_t(std::clamp((v - min) / extent * 65535.0f + 0.5f, 0.0f, 65535.0f)) : 0;
+}
+
+int8_t Snorm8(float v) { return int8_t(std::clamp(std::lround(v * 127.0f), -127l, 127l)); }
+
+} // namespace
+
+void WeldVertices(MeshPrimitive& mesh)
+{
+    std::vector<MeshVertex>& v = mesh.vertices;
+    std::unordered_map<uint64_t, uint32_t> seen;
+    seen.reserve(v.size());
+    std::vector<uint32_t> remap(v.size());
+    std::vector<MeshVertex> unique;
+    unique.reserve(v.size());
+    for (size_t i = 0; i < v.size(); ++i) {
+        const uint64_t h = core::Hash64(&v[i], sizeof(MeshVertex));
+        auto [it, added] = seen.try_emplace(h, uint32_t(unique.size()));
+        // совпал хэш, но не вершина — оставляем отдельной
+        if (!added && std::memcmp(&unique[it->second], &v[i], sizeof(MeshVertex))) {
+            remap[i] = uint32_t(unique.size());
+            unique.push_back(v[i]);
+            continue;
+        }
+        if (added) unique.push_back(v[i]);
+        remap[i] = it->second;
+    }
+    for (uint32_t& i : mesh.indices) i = remap[i];
+    v = std::move(unique);
+}
+
+void GenerateNormals(MeshPrimitive& mesh)
+{
+    std::vector<MeshVertex>& v = mesh.vertices;
+    for (MeshVertex& x : v) x.normal[0] = x.normal[1] = x.normal[2] = 0;
+    for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3) {
+        float n[3];
+        const uint32_t a = mesh.indices[t], b = mesh.indices[t + 1], c = mesh.indices[t + 2];
+        Cross(v[a].position, v[b].position, v[c].position, n); // длина — удвоенная площадь
+        for (uint32_t k : {a, b, c})
+            for (int i = 0; i < 3; ++i) v[k].normal[i] += n[i];
+    }
+    for (MeshVertex& x : v) {
+        const float len = std::sqrt(x.normal[0] * x.normal[0] + x.normal[1] * x.normal[1] + x.normal[2] * x.normal[2]);
+        if (len > 0) for (float& c : x.normal) c /= len;
+        else x.normal[0] = x.normal[1] = 0, x.normal[2] = 1;
+    }
+    mesh.hasNormals = true;
+}
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+    const size_t triCount = indices.size() / 3;
+    if (triCount < 2) return;
+    // треугольники каждой вершины (CSR); активные — в начале её отрезка
+    std::vector<uint32_t> offsets(vertexCount + 1, 0), active(vertexCount, 0);
+    for (uint32_t i : indices) active[i]++;
+    for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] = offsets[v] + active[v];
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triCount; ++t)
+            for (int k = 0; k < 3; ++k) adjacency[fill[indices[t * 3 + k]]++] = uint32_t(t);
+    }
+    std::vector<int> cachePos(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    std::vector<uint8_t> emitted(triCount, 0);
+    for (size_t v = 0; v < vertexCount; ++v) vertexScore[v] = VertexScore(-1, active[v]);
+
+    std::vector<uint32_t> out;
+    out.reserve(indices.size());
+    uint32_t cache[kCacheSize + 3], next[kCacheSize + 3];
+    int cacheCount = 0;
+    size_t scan = 0; // тупик: следующий невыданный треугольник по порядку
+    int64_t best = 0;
+    float bestScore = -1e30f;
+    for (size_t t = 0; t < triCount; ++t) {
+        const float s = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+        if (s > bestScore) bestScore = s, best = int64_t(t);
+    }
+    while (out.size() < indices.size()) {
+        if (best < 0) {
+            while (emitted[scan]) ++scan;
+            best = int64_t(scan);
+        }
+        const uint32_t* tri = &indices[size_t(best) * 3];
+        emitted[size_t(best)] = 1;
+        out.insert(out.end(), tri, tri + 3);
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t v = tri[k];
+            uint32_t* list = &adjacency[offsets[v]];
+            for (uint32_t i = 0; i < active[v]; ++i)
+                if (list[i] == uint32_t(best)) {
+                    std::swap(list[i], list[active[v] - 1]);
+                    break;
+                }
+            active[v]--;
+        }
+        // вершины треугольника — в голову LRU, остальные сдвигаются
+        int n = 0;
+        for (int k = 0; k < 3; ++k) next[n++] = tri[k];
+        for (int i = 0; i < cacheCount; ++i)
+            if (cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2]) next[n++] = cache[i];
+        for (int i = kCacheSize; i < n; ++i) cachePos[next[i]] = -1; // вытесненные
+        cacheCount = std::min(n, kCacheSize);
+        std::memcpy(cache, next, sizeof(uint32_t) * cacheCount);
+        for (int i = 0; i < cacheCount; ++i) {
+            cachePos[cache[i]] = i;
+            vertexScore[cache[i]] = VertexScore(i, active[cache[i]]);
+        }
+        for (int i = kCacheSize; i < n; ++i) vertexScore[next[i]] = VertexScore(-1, active[next[i]]);
+
+        // кандидаты — треугольники вершин кэша
+        best = -1;
+        bestScore = -1e30f;
+        for (int i = 0; i < cacheCount; ++i) {
+            const uint32_t v = cache[i];
+            for (uint32_t j = 0; j < active[v]; ++j) {
+                const uint32_t t = adjacency[offsets[v] + j];
+                const float s = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                if (s > bestScore) bestScore = s, best = int64_t(t);
+            }
+        }
+    }
+    indices = std::move(out);
+}
+
+void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices)
+{
+    const size_t triCount = indices.size() / 3;
+    if (triCount < 2) return;
+    // границы кластеров: треугольник, у которого все три вершины — промахи FIFO-кэша
+    constexpr uint32_t kFifo = 16;
+    std::vector<uint32_t> stamp(vertices.size(), 0);
+    uint32_t time = kFifo + 1;
+    std::vector<uint32_t> starts;
+    for (size_t t = 0; t < triCount; ++t) {
+        int misses = 0;
+        for (int k = 0; k < 3; ++k) {
+            uint32_t& s = stamp[indices[t * 3 + k]];
+            if (time - s > kFifo) s = time++, ++misses;
+        }
+        if (misses == 3 || t == 0) starts.push_back(uint32_t(t));
+    }
+    if (starts.size() < 2) return;
+    starts.push_back(uint32_t(triCount));
+
+    float center[3] = {};
+    for (const MeshVertex& v : vertices)
+        for (int i = 0; i < 3; ++i) center[i] += v.position[i];
+    for (float& c : center) c /= float(std::max<size_t>(vertices.size(), 1));
+
+    // ключ: насколько кластер смотрит наружу от центра меша; внешние рисуются первыми
+    const size_t clusters = starts.size() - 1;
+    std::vector<float> key(clusters);
+    for (size_t c = 0; c < clusters; ++c) {
+        float centroid[3] = {}, normal[3] = {}, area = 0;
+        for (uint32_t t = starts[c]; t < starts[c + 1]; ++t) {
+            const float* a = vertices[indices[t * 3]].position;
+            const float* b = vertices[indices[t * 3 + 1]].position;
+            const float* d = vertices[indices[t * 3 + 2]].position;
+            float n[3];
+            Cross(a, b, d, n);
+            const float w = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int i = 0; i < 3; ++i) normal[i] += n[i], centroid[i] += (a[i] + b[i] + d[i]) * w / 3.0f;
+            area += w;
+        }
+        const float len = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (area <= 0 || len <= 0) continue;
+        for (int i = 0; i < 3; ++i) key[c] += (centroid[i] / area - center[i]) * normal[i] / len;
+    }
+    std::vector<uint32_t> order(clusters);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return key[a] > key[b]; });
+
+    std::vector<uint32_t> out;
+    out.reserve(indices.size());
+    for (uint32_t c : order) out.insert(out.end(), indices.begin() + starts[c] * 3, indices.begin() + starts[c + 1] * 3);
+    indices = std::move(out);
+}
+
+void OptimizeVertexFetch(MeshPrimitive& mesh)
+{
+    std::vector<uint32_t> remap(mesh.vertices.size(), ~0u);
+    std::vector<MeshVertex> out;
+    out.reserve(mesh.vertices.size());
+    for (uint32_t& i : mesh.indices) {
+        if (remap[i] == ~0u) {
+            remap[i] = uint32_t(out.size());
+            out.push_back(mesh.vertices[i]);
+        }
+        i = remap[i];
+    }
+    mesh.vertices = std::move(out); // неиспользуемые вершины отброшены
+}
+
+double AverageCacheMissRatio(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+{
+    if (indices.size() < 3) return 0;
+    std::vector<uint32_t> stamp(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    size_t misses = 0;
+    for (uint32_t i : indices)
+        if (time - stamp[i] > cacheSize) stamp[i] = time++, ++misses;
+    return double(misses) / double(indices.size() / 3);
+}
+
+QuantizedMesh Quantize(const MeshPrimitive& mesh)
+{
+    QuantizedMesh q;
+    if (!mesh.vertices.empty()) {
+        for (int i = 0; i < 3; ++i) q.boundsMin[i] = q.boundsMax[i] = mesh.vertices[0].position[i];
+        for (int i = 0; i < 2; ++i) q.uvMin[i] = q.uvMax[i] = mesh.vertices[0].uv[i];
+    }
+    for (const MeshVertex& v : mesh.vertices) {
+        for (int i = 0; i < 3; ++i) q.boundsMin[i] = std::min(q.boundsMin[i], v.position[i]), q.boundsMax[i] = std::max(q.boundsMax[i], v.position[i]);
+        for (int i = 0; i < 2; ++i) q.uvMin[i] = std::min(q.uvMin[i], v.uv[i]), q.uvMax[i] = std::max(q.uvMax[i], v.uv[i]);
+    }
+    q.vertices.resize(mesh.vertices.size());
+    for (size_t k = 0; k < mesh.vertices.size(); ++k) {
+        const MeshVertex& v = mesh.vertices[k];
+        QuantizedVertex& o = q.vertices[k];
+        for (int i = 0; i < 3; ++i) o.position[i] = Unorm16(v.position[i], q.boundsMin[i], q.boundsMax[i]);
+        for (int i = 0; i < 2; ++i) o.uv[i] = Unorm16(v.uv[i], q.uvMin[i], q.uvMax[i]);
+        const float l1 = std::abs(v.normal[0]) + std::abs(v.normal[1]) + std::abs(v.normal[2]);
+        float x = l1 > 0 ? v.normal[0] / l1 : 0, y = l1 > 0 ? v.normal[1] / l1 : 0;
+        if (v.normal[2] < 0) {
+            const float ox = x;
+            x = (1.0f - std::abs(y)) * (ox >= 0 ? 1.0f : -1.0f);
+            y = (1.0f - std::abs(ox)) * (y >= 0 ? 1.0f : -1.0f);
+        }
+        o.normal[0] = Snorm8(x), o.normal[1] = Snorm8(y);
+    }
+    return q;
+}
+
+MeshVertex Dequantize(const QuantizedMesh& mesh, const QuantizedVertex& v)
+{
+    MeshVertex out;
+    for (int i = 0; i < 3; ++i) out.position[i] = mesh.boundsMin[i] + v.position[i] / 65535.0f * (mesh.boundsMax[i] - mesh.boundsMin[i]);
+    for (int i = 0; i < 2; ++i) out.uv[i] = mesh.uvMin[i] + v.uv[i] / 65535.0f * (mesh.uvMax[i] - mesh.uvMin[i]);
+    float x = v.normal[0] / 127.0f, y = v.normal[1] / 127.0f;
+    const float z = 1.0f - std::abs(x) - std::abs(y);
+    if (z < 0) {
+        const float ox = x;
+        x = (1.0f - std::abs(y)) * (ox >= 0 ? 1.0f : -1.0f);
+        y = (1.0f - std::abs(ox)) * (y >= 0 ? 1.0f : -1.0f);
+    }
+    const float len = std::sqrt(x * x + y * y + z * z);
+    out.normal[0] = x / len, out.normal[1] = y / len, out.normal[2] = z / len;
+    return out;
+}
+
+} // namespace dancore::resources
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Gltf.hpp"
+
+// Подготовка геометрии к GPU при импорте моделей:
+//  - порядок треугольников под кэш вершин (алгоритм Форсайта, LRU на 32 вершины);
+//  - затем против перерисовки: треугольники режутся на кластеры там, где кэш начинается
+//    заново, и кластеры сортируются "снаружи внутрь" (как в Tipsify) — пересортировка
+//    почти не портит попадания в кэш;
+//  - вершины в порядке первого использования (выборка из памяти подряд);
+//  - квантование: позиция — 3 x unorm16 в AABB меша, нормаль — октаэдр в 2 x snorm8,
+//    UV — 2 x unorm16 в пределах UV меша: 12 байт на вершину вместо 32.
+
+namespace dancore::resources {
+
+struct QuantizedVertex {
+    uint16_t position[3];   // min + q / 65535 * (max - min)
+    int8_t normal[2];       // октаэдрическая развёртка
+    uint16_t uv[2];         // uvMin + q / 65535 * (uvMax - uvMin)
+};
+static_assert(sizeof(QuantizedVertex) == 12);
+
+struct QuantizedMesh {
+    float boundsMin[3] = {}, boundsMax[3] = {};
+    float uvMin[2] = {}, uvMax[2] = {};
+    std::vector<QuantizedVertex> vertices;
+};
+
+// Сливает одинаковые вершины (побитово) и перенумеровывает индексы
+void WeldVertices(MeshPrimitive& mesh);
+// Нормали по треугольникам, взвешенные площадью (если в исходнике их нет)
+void GenerateNormals(MeshPrimitive& mesh);
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices);
+void OptimizeVertexFetch(MeshPrimitive& mesh);
+
+// Среднее число промахов на треугольник для FIFO-кэша cacheSize (ACMR, 0.5 — идеал, 3 — худшее)
+double AverageCacheMissRatio(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+QuantizedMesh Quantize(const MeshPrimitive& mesh);
+MeshVertex Dequantize(const QuantizedMesh& mesh, const QuantizedVertex& v);
+
+} // namespace dancore::resources
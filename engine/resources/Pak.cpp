@@ -0,0 +1,282 @@
+#include "Pak.hpp"
+#include "Lz4.hpp"
+#include "core/Hash.hpp"
+#include "core/JobSystem.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef DANCORE_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace dancore::resources {
+
+namespace jobs = dancore::core::jobs;
+
+namespace {
+
+void Corrupt(const std::string& path, const char* what)
+{
+    throw std::runtime_error("PakFile: " + path + ": " + what);
+}
+
+constexpr uint32_t kParallelBlocks = 4; // с какого числа блоков полное чтение идёт в задачах
+
+} // namespace
+
+const char* PakCodecName(PakCodec c)
+{
+    switch (c) {
+    case PakCodec::None: return "none";
+    case PakCodec::LZ4:  return "lz4";
+    case PakCodec::Zstd: return "zstd";
+    }
+    return "?";
+}
+
+bool PakCodecAvailable(PakCodec c)
+{
+#ifdef DANCORE_HAS_ZSTD
+    return c <= PakCodec::Zstd;
+#else
+    return c <= PakCodec::LZ4;
+#endif
+}
+
+PakFile::~PakFile() { Close(); }
+
+void PakFile::Open(const std::filesystem::path& file)
+{
+    DC_PROFILE_ZONE("PakFile::Open");
+    Close();
+    path_ = file.string();
+#ifdef _WIN32
+    HANDLE f = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) Corrupt(path_, "cannot open");
+    LARGE_INTEGER size{};
+    GetFileSizeEx(f, &size);
+    HANDLE mapping = size.QuadPart ? CreateFileMappingW(f, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(f);
+        Corrupt(path_, "cannot map");
+    }
+    file_ = f;
+    mapping_ = mapping;
+    size_ = size_t(size.QuadPart);
+#else
+    int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) Corrupt(path_, "cannot open");
+    struct stat st {};
+    void* view = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        view = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // отображение держит файл само
+    if (view == MAP_FAILED) Corrupt(path_, "cannot map");
+    size_ = size_t(st.st_size);
+#endif
+    base_ = static_cast<const uint8_t*>(view);
+
+    try {
+        if (size_ < sizeof(PakHeader)) Corrupt(path_, "truncated header");
+        header_ = reinterpret_cast<const PakHeader*>(base_);
+        const PakHeader& h = *header_;
+        if (h.magic != kPakMagic) Corrupt(path_, "not a pak file");
+        if (h.version != kPakVersion) Corrupt(path_, "unsupported version");
+        if (h.fileSize != size_) Corrupt(path_, "size mismatch");
+        if (h.bucketCount == 0 || (h.bucketCount & (h.bucketCount - 1)) || h.bucketCount <= h.entryCount)
+            Corrupt(path_, "bad hash index");
+        auto inside = [&](uint64_t offset, uint64_t bytes) { return offset <= size_ && bytes <= size_ - offset; };
+        if (!inside(h.tocOffset, uint64_t(h.entryCount) * sizeof(PakEntry)) || h.tocOffset % kPakAlign ||
+            !inside(h.hashOffset, uint64_t(h.bucketCount) * 4) || h.hashOffset % 4 || !inside(h.namesOffset, h.namesSize))
+            Corrupt(path_, "bad table offsets");
+        toc_ = reinterpret_cast<const PakEntry*>(base_ + h.tocOffset);
+        buckets_ = reinterpret_cast<const uint32_t*>(base_ + h.hashOffset);
+        names_ = reinterpret_cast<const char*>(base_ + h.namesOffset);
+        // TOC проверяется один раз здесь, чтение дальше доверяет смещениям
+        for (uint32_t i = 0; i < h.entryCount; ++i) {
+            const PakEntry& e = toc_[i];
+            if (!inside(e.offset, e.storedSize) || uint64_t(e.nameOffset) + e.nameSize > h.namesSize)
+                Corrupt(path_, "entry out of bounds");
+            if (!PakCodecAvailable(e.codec)) Corrupt(path_, "entry codec is not supported by this build");
+            bool stored = e.codec == PakCodec::None;
+            uint64_t blocks = stored ? 0 : (e.rawSize + kPakBlockSize - 1) / kPakBlockSize;
+            if (e.blockCount != blocks || (stored && e.storedSize != e.rawSize) || e.storedSize < uint64_t(e.blockCount) * 4)
+                Corrupt(path_, "bad entry layout");
+        }
+    } catch (...) {
+        Close();
+        throw;
+    }
+}
+
+void PakFile::Close()
+{
+    if (!base_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(base_);
+    CloseHandle(mapping_);
+    CloseHandle(file_);
+    file_ = mapping_ = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(base_), size_);
+#endif
+    base_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+    toc_ = nullptr;
+    buckets_ = nullptr;
+    names_ = nullptr;
+}
+
+uint32_t PakFile::Find(std::string_view name) const
+{
+    if (!header_ || header_->entryCount == 0) return kNone;
+    uint64_t hash = core::Hash64(name);
+    uint32_t mask = header_->bucketCount - 1;
+    // пустая корзина есть всегда (bucketCount > entryCount), если таблицу писал PakWriter;
+    // в испорченном файле слоты могут повторяться — не больше одного круга
+    uint32_t b = uint32_t(hash) & mask;
+    for (uint32_t probe = 0; probe < header_->bucketCount; ++probe, b = (b + 1) & mask) {
+        uint32_t slot = buckets_[b];
+        if (slot == 0 || slot > header_->entryCount) return kNone;
+        if (toc_[slot - 1].nameHash == hash && Name(slot - 1) == name) return slot - 1;
+    }
+    return kNone;
+}
+
+std::span<const uint8_t> PakFile::View(uint32_t i) const
+{
+    const PakEntry& e = toc_[i];
+    if (e.codec != PakCodec::None) return {};
+    return {base_ + e.offset, size_t(e.rawSize)};
+}
+
+const uint32_t* PakFile::Blocks(const PakEntry& e) const
+{
+    return reinterpret_cast<const uint32_t*>(base_ + e.offset);
+}
+
+void PakFile::DecodeBlock(const PakEntry& e, const uint8_t* src, uint32_t size, uint8_t* dst, size_t rawSize) const
+{
+    bool ok = false;
+    switch (e.codec) {
+    case PakCodec::LZ4:
+        ok = Lz4Decompress(src, size, dst, rawSize);
+        break;
+    case PakCodec::Zstd:
+#ifdef DANCORE_HAS_ZSTD
+        ok = ZSTD_decompress(dst, rawSize, src, size) == rawSize;
+#endif
+        break;
+    case PakCodec::None:
+        break;
+    }
+    if (!ok) Corrupt(path_, "corrupt compressed block");
+}
+
+void PakFile::Read(uint32_t i, std::vector<uint8_t>& out) const
+{
+    DC_PROFILE_ZONE("PakFile::Read");
+    const PakEntry& e = toc_[i];
+    out.resize(size_t(e.rawSize));
+    if (e.codec == PakCodec::None) {
+        if (e.rawSize) std::memcpy(out.data(), base_ + e.offset, size_t(e.rawSize));
+        return;
+    }
+    // начала блоков: префиксные суммы размеров
+    const uint32_t* sizes = Blocks(e);
+    std::vector<uint64_t> starts(e.blockCount + 1);
+    starts[0] = uint64_t(e.blockCount) * 4;
+    for (uint32_t b = 0; b < e.blockCount; ++b) starts[b + 1] = starts[b] + sizes[b];
+    if (starts[e.blockCount] > e.storedSize) Corrupt(path_, "block table out of bounds");
+
+    auto decode = [&](size_t b) {
+        size_t raw = std::min<uint64_t>(kPakBlockSize, e.rawSize - uint64_t(b) * kPakBlockSize);
+        DecodeBlock(e, base_ + e.offset + starts[b], sizes[b], out.data() + b * kPakBlockSize, raw);
+    };
+    if (e.blockCount < kParallelBlocks) {
+        for (uint32_t b = 0; b < e.blockCount; ++b) decode(b);
+        return;
+    }
+    // исключение из задачи не пробросить: помечаем и бросаем уже здесь
+    std::atomic<bool> failed{false};
+    jobs::ParallelFor(0, e.blockCount, 1, [&](size_t begin, size_t end) {
+        try {
+            for (size_t b = begin; b < end; ++b) decode(b);
+        } catch (const std::runtime_error&) {
+            failed = true;
+        }
+    });
+    if (failed) Corrupt(path_, "corrupt compressed block");
+}
+
+size_t PakFile::Read(uint32_t i, uint64_t offset, std::span<uint8_t> dst) const
+{
+    const PakEntry& e = toc_[i];
+    if (offset >= e.rawSize || dst.empty()) return 0;
+    size_t n = size_t(std::min<uint64_t>(dst.size(), e.rawSize - offset));
+    if (e.codec == PakCodec::None) {
+        std::memcpy(dst.data(), base_ + e.offset + offset, n);
+        return n;
+    }
+    const uint32_t* sizes = Blocks(e);
+    uint32_t first = uint32_t(offset / kPakBlockSize);
+    uint32_t last = uint32_t((offset + n - 1) / kPakBlockSize);
+    uint64_t pos = uint64_t(e.blockCount) * 4;
+    for (uint32_t b = 0; b < first; ++b) pos += sizes[b];
+
+    std::vector<uint8_t> scratch;
+    uint8_t* out = dst.data();
+    for (uint32_t b = first; b <= last; ++b) {
+        uint64_t blockStart = uint64_t(b) * kPakBlockSize;
+        size_t raw = size_t(std::min<uint64_t>(kPakBlockSize, e.rawSize - blockStart));
+        if (pos + sizes[b] > e.storedSize) Corrupt(path_, "block table out of bounds");
+        uint64_t from = std::max(offset, blockStart);
+        uint64_t to = std::min(offset + n, blockStart + raw);
+        const uint8_t* src = base_ + e.offset + pos;
+        if (from == blockStart && to == blockStart + raw) {
+            DecodeBlock(e, src, sizes[b], out, raw); // блок целиком — сразу в dst
+        } else {
+            scratch.resize(raw);
+            DecodeBlock(e, src, sizes[b], scratch.data(), raw);
+            std::memcpy(out, scratch.data() + (from - blockStart), size_t(to - from));
+        }
+        out += to - from;
+        pos += sizes[b];
+    }
+    return n;
+}
+
+void PakFile::Prefetch(uint32_t i) const
+{
+#ifndef _WIN32
+    const PakEntry& e = toc_[i];
+    static const uintptr_t page = uintptr_t(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = uintptr_t(base_ + e.offset) & ~(page - 1);
+    uintptr_t end = uintptr_t(base_ + e.offset + e.storedSize);
+    if (end > begin) madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+#else
+    const PakEntry& e = toc_[i];
+    WIN32_MEMORY_RANGE_ENTRY range{const_cast<uint8_t*>(base_ + e.offset), size_t(e.storedSize)};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+}
+
+} // namespace dancore::resources
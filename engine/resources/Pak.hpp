@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Пакет ресурсов (.pak) для загрузки в рантайме.
+//
+// Файл отображается в память целиком; несжатые записи отдаются span'ом прямо в
+// отображение, без копий и без чтения наперёд. Сжатые записи разбиты на независимые
+// блоки по kPakBlockSize: частичное чтение распаковывает только нужные блоки, полное —
+// параллельно в job system. Поиск по имени — открытая адресация по Hash64 имени.
+//
+// Формат (little-endian, всё, кроме имён, выровнено на kPakAlign):
+//   PakHeader
+//   данные записей в порядке TOC; у сжатой — сначала uint32[blockCount] размеров блоков
+//   PakEntry[entryCount], по возрастанию имени
+//   uint32[bucketCount] хэш-индекс: номер записи + 1, 0 — пусто
+//   имена через '/', без терминаторов
+// Сборка (PakWriter.hpp) детерминирована: те же файлы дают побайтно тот же пакет.
+
+namespace dancore::resources {
+
+inline constexpr uint32_t kPakMagic = 0x4B415044; // 'DPAK'
+inline constexpr uint32_t kPakVersion = 1;
+inline constexpr uint32_t kPakAlign = 64;
+inline constexpr uint32_t kPakBlockSize = 256 * 1024;
+
+enum class PakCodec : uint32_t { None, LZ4, Zstd };
+
+const char* PakCodecName(PakCodec c);
+bool PakCodecAvailable(PakCodec c); // Zstd — только при сборке с DANCORE_HAS_ZSTD
+
+struct PakHeader {
+    uint32_t magic = kPakMagic;
+    uint32_t version = kPakVersion;
+    uint32_t entryCount = 0;
+    uint32_t bucketCount = 0;   // степень двойки
+    uint64_t tocOffset = 0;
+    uint64_t hashOffset = 0;
+    uint64_t namesOffset = 0;
+    uint64_t namesSize = 0;
+    uint64_t fileSize = 0;
+    uint64_t reserved = 0;
+};
+static_assert(sizeof(PakHeader) == 64);
+
+struct PakEntry {
+    uint64_t nameHash = 0;      // Hash64 имени
+    uint64_t contentHash = 0;   // Hash64 несжатых данных
+    uint64_t offset = 0;        // от начала файла, кратно kPakAlign
+    uint64_t storedSize = 0;    // в файле, вместе с таблицей блоков
+    uint64_t rawSize = 0;
+    uint32_t nameOffset = 0, nameSize = 0;
+    PakCodec codec = PakCodec::None;
+    uint32_t blockCount = 0;    // 0 у несжатых
+    uint64_t reserved = 0;
+};
+static_assert(sizeof(PakEntry) == 64);
+
+// Только чтение; методы const безопасно вызывать из нескольких потоков сразу
+class PakFile {
+public:
+    static constexpr uint32_t kNone = ~0u;
+
+    PakFile() = default;
+    ~PakFile();
+    PakFile(const PakFile&) = delete;
+    PakFile& operator=(const PakFile&) = delete;
+
+    // Бросает std::runtime_error, если файл не открылся или заголовок/TOC повреждены
+    void Open(const std::filesystem::path& file);
+    void Close();
+    bool IsOpen() const { return base_ != nullptr; }
+
+    uint32_t Count() const { return header_ ? header_->entryCount : 0; }
+    const PakEntry& Entry(uint32_t i) const { return toc_[i]; }
+    std::string_view Name(uint32_t i) const { return {names_ + toc_[i].nameOffset, toc_[i].nameSize}; }
+    uint32_t Find(std::string_view name) const;
+
+    // Данные несжатой записи прямо в отображении; у сжатых — пусто
+    std::span<const uint8_t> View(uint32_t i) const;
+    // Вся запись; сжатые большие записи распаковываются блоками параллельно
+    void Read(uint32_t i, std::vector<uint8_t>& out) const;
+    // [offset, offset + dst.size()) записи: распаковываются только задетые блоки.
+    // Возвращает число прочитанных байт (меньше dst.size() у конца записи)
+    size_t Read(uint32_t i, uint64_t offset, std::span<uint8_t> dst) const;
+    // Подсказка ОС подтянуть страницы записи заранее (асинхронно)
+    void Prefetch(uint32_t i) const;
+
+private:
+    const uint32_t* Blocks(const PakEntry& e) const;
+    void DecodeBlock(const PakEntry& e, const uint8_t* src, uint32_t size, uint8_t* dst, size_t rawSize) const;
+
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    const PakHeader* header_ = nullptr;
+    const PakEntry* toc_ = nullptr;
+    const uint32_t* buckets_ = nullptr;
+    const char* names_ = nullptr;
+    std::string path_;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+} // namespace dancore::resources
@@ -0,0 +1,233 @@
+#include "PakWriter.hpp"
+#include "Lz4.hpp"
+#include "core/Hash.hpp"
+#include "core/JobSystem.hpp"
+#include "core/Profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef DANCORE_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace dancore::resources {
+
+namespace fs = std::filesystem;
+namespace jobs = dancore::core::jobs;
+namespace prof = dancore::core::profiler;
+
+namespace {
+
+struct Packed {
+    std::vector<uint8_t> data; // как ляжет в файл
+    PakEntry entry;
+    std::string error;
+};
+
+std::vector<uint8_t> ReadFile(const fs::path& file)
+{
+    std::ifstream in(file, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("cannot open");
+    std::vector<uint8_t> data(size_t(in.tellg()));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size()))) throw std::runtime_error("read failed");
+    return data;
+}
+
+std::vector<uint8_t> CompressBlock(PakCodec codec, int level, const uint8_t* src, size_t size)
+{
+    std::vector<uint8_t> out;
+    if (codec == PakCodec::LZ4) {
+        out.resize(Lz4Bound(size));
+        out.resize(Lz4Compress(src, size, out.data()));
+    }
+#ifdef DANCORE_HAS_ZSTD
+    if (codec == PakCodec::Zstd) {
+        out.resize(ZSTD_compressBound(size));
+        size_t n = ZSTD_compress(out.data(), out.size(), src, size, level ? level : ZSTD_CLEVEL_DEFAULT);
+        if (ZSTD_isError(n)) throw std::runtime_error(ZSTD_getErrorName(n));
+        out.resize(n);
+    }
+#else
+    (void)level;
+#endif
+    return out;
+}
+
+void Pack(const PakSource& src, const PakBuildOptions& o, Packed& out)
+{
+    std::vector<uint8_t> raw = ReadFile(src.file);
+    PakEntry& e = out.entry;
+    e.rawSize = raw.size();
+    e.contentHash = core::Hash64(raw.data(), raw.size());
+
+    if (o.codec != PakCodec::None && !raw.empty()) {
+        size_t blocks = (raw.size() + kPakBlockSize - 1) / kPakBlockSize;
+        std::vector<std::vector<uint8_t>> packed(blocks);
+        auto compress = [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                size_t from = b * kPakBlockSize;
+                packed[b] = CompressBlock(o.codec, o.level, raw.data() + from, std::min<size_t>(kPakBlockSize, raw.size() - from));
+            }
+        };
+        // большой файл — по блокам в задачах, иначе целиком в этой
+        jobs::ParallelFor(0, blocks, 1, compress);
+
+        size_t total = blocks * 4;
+        for (const auto& p : packed) total += p.size();
+        if (double(total) <= double(raw.size()) * (1.0 - o.minSaving)) {
+            out.data.resize(blocks * 4);
+            for (size_t b = 0; b < blocks; ++b) {
+                uint32_t size = uint32_t(packed[b].size());
+                std::memcpy(out.data.data() + b * 4, &size, 4);
+            }
+            for (const auto& p : packed) out.data.insert(out.data.end(), p.begin(), p.end());
+            e.codec = o.codec;
+            e.blockCount = uint32_t(blocks);
+            e.storedSize = out.data.size();
+            return;
+        }
+    }
+    e.codec = PakCodec::None;
+    e.blockCount = 0;
+    e.storedSize = raw.size();
+    out.data = std::move(raw);
+}
+
+} // namespace
+
+PakBuildStats BuildPak(std::vector<PakSource> sources, const fs::path& out, const PakBuildOptions& options)
+{
+    DC_PROFILE_ZONE("BuildPak");
+    prof::Clock start = prof::Now();
+    if (!PakCodecAvailable(options.codec))
+        throw std::runtime_error(std::string("BuildPak: codec ") + PakCodecName(options.codec) + " is not available in this build");
+
+    std::sort(sources.begin(), sources.end(), [](const PakSource& a, const PakSource& b) { return a.name < b.name; });
+    std::vector<PakEntry> toc(sources.size());
+    std::string names;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        if (i && sources[i].name == sources[i - 1].name) throw std::runtime_error("BuildPak: duplicate entry " + sources[i].name);
+        toc[i].nameHash = core::Hash64(sources[i].name);
+        toc[i].nameOffset = uint32_t(names.size());
+        toc[i].nameSize = uint32_t(sources[i].name.size());
+        names += sources[i].name;
+    }
+
+    std::error_code ec;
+    if (out.has_parent_path()) fs::create_directories(out.parent_path(), ec);
+    fs::path tmp = out;
+    tmp += ".tmp";
+    std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+    if (!f) throw std::runtime_error("BuildPak: cannot create " + tmp.string());
+
+    PakBuildStats stats;
+    uint64_t pos = 0;
+    auto write = [&](const void* data, size_t size) {
+        f.write(static_cast<const char*>(data), std::streamsize(size));
+        pos += size;
+    };
+    auto pad = [&] {
+        static const char zeros[kPakAlign] = {};
+        write(zeros, size_t((kPakAlign - pos % kPakAlign) % kPakAlign));
+    };
+    PakHeader header;
+    write(&header, sizeof(header)); // настоящий — в конце
+
+    // порциями по batchBytes: задачи сжимают, этот поток пишет по порядку
+    for (size_t i = 0; i < sources.size();) {
+        size_t j = i;
+        uint64_t bytes = 0;
+        while (j < sources.size() && (j == i || bytes < options.batchBytes)) bytes += fs::file_size(sources[j++].file, ec);
+        std::vector<Packed> batch(j - i);
+        jobs::ParallelFor(i, j, 1, [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                // исключение из задачи не пробросить: запоминаем, бросаем при записи
+                try {
+                    Pack(sources[k], options, batch[k - i]);
+                } catch (const std::exception& ex) {
+                    batch[k - i].error = ex.what();
+                }
+            }
+        });
+        for (size_t k = i; k < j; ++k) {
+            Packed& p = batch[k - i];
+            if (!p.error.empty()) {
+                f.close();
+                fs::remove(tmp, ec);
+                throw std::runtime_error("BuildPak: " + sources[k].file.string() + ": " + p.error);
+            }
+            pad();
+            PakEntry& e = toc[k];
+            e.offset = pos;
+            e.storedSize = p.entry.storedSize;
+            e.rawSize = p.entry.rawSize;
+            e.contentHash = p.entry.contentHash;
+            e.codec = p.entry.codec;
+            e.blockCount = p.entry.blockCount;
+            write(p.data.data(), p.data.size());
+            stats.rawBytes += e.rawSize;
+            stats.stored += e.codec == PakCodec::None;
+        }
+        i = j;
+    }
+
+    pad();
+    header.entryCount = uint32_t(toc.size());
+    header.tocOffset = pos;
+    write(toc.data(), toc.size() * sizeof(PakEntry));
+
+    // не больше половины заполнения: короткие цепочки проб
+    uint32_t buckets = 1;
+    while (buckets < toc.size() * 2 || buckets <= toc.size()) buckets <<= 1;
+    std::vector<uint32_t> index(buckets, 0);
+    for (uint32_t k = 0; k < toc.size(); ++k) {
+        uint32_t b = uint32_t(toc[k].nameHash) & (buckets - 1);
+        while (index[b]) b = (b + 1) & (buckets - 1);
+        index[b] = k + 1;
+    }
+    header.bucketCount = buckets;
+    header.hashOffset = pos;
+    write(index.data(), index.size() * 4);
+
+    header.namesOffset = pos;
+    header.namesSize = names.size();
+    write(names.data(), names.size());
+    header.fileSize = pos;
+    f.seekp(0);
+    f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    f.close();
+    if (!f) {
+        fs::remove(tmp, ec);
+        throw std::runtime_error("BuildPak: write failed " + tmp.string());
+    }
+    fs::rename(tmp, out, ec);
+    if (ec) throw std::runtime_error("BuildPak: cannot replace " + out.string() + ": " + ec.message());
+
+    stats.entries = header.entryCount;
+    stats.fileBytes = pos;
+    stats.seconds = double(prof::Now() - start) / 1e9;
+    return stats;
+}
+
+std::vector<PakSource> CollectPakSources(const fs::path& dir)
+{
+    std::vector<PakSource> sources;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+        std::string name = it->path().filename().generic_string();
+        std::error_code ec2;
+        if (name.empty() || name[0] == '.') {
+            if (it->is_directory(ec2)) it.disable_recursion_pending();
+            continue;
+        }
+        if (!it->is_regular_file(ec2)) continue;
+        sources.push_back({fs::relative(it->path(), dir, ec2).generic_string(), it->path()});
+    }
+    return sources;
+}
+
+} // namespace dancore::resources
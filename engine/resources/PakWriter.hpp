@@ -0,0 +1,39 @@
+#pragma once
+#include "Pak.hpp"
+
+// Сборка .pak. Файлы читаются и сжимаются параллельно (задача на файл, большие файлы —
+// ещё и по блокам), а пишутся последовательно в порядке имён. Ни времени, ни путей на
+// диске в пакет не попадает, так что результат не зависит ни от числа потоков, ни от
+// порядка входа. Вызывать при запущенной job system; можно из задачи.
+
+namespace dancore::resources {
+
+struct PakSource {
+    std::string name;            // имя в пакете, через '/'
+    std::filesystem::path file;
+};
+
+struct PakBuildOptions {
+    PakCodec codec = PakCodec::LZ4;
+    int level = 0;                         // Zstd; 0 — уровень по умолчанию
+    double minSaving = 0.05;               // экономия меньше — запись хранится как есть (View без копии)
+    uint64_t batchBytes = 256ull << 20;    // сколько несжатых данных держать в памяти за раз
+};
+
+struct PakBuildStats {
+    uint32_t entries = 0;
+    uint32_t stored = 0;         // записей без сжатия
+    uint64_t rawBytes = 0;
+    uint64_t fileBytes = 0;
+    double seconds = 0;
+};
+
+// Пишет во временный файл и подменяет out целиком. Бросает std::runtime_error
+// (повтор имени, файл не читается, кодек не собран)
+PakBuildStats BuildPak(std::vector<PakSource> sources, const std::filesystem::path& out,
+                       const PakBuildOptions& options = {});
+
+// Обычные файлы каталога рекурсивно; скрытые (".*") пропускаются
+std::vector<PakSource> CollectPakSources(const std::filesystem::path& dir);
+
+} // namespace dancore::resources
@@ -0,0 +1,580 @@
+#include "SceneFile.hpp"
+#include "core/Hash.hpp"
+#include "core/JobSystem.hpp"
+#include "core/Log.hpp"
+#include "core/Profiler.hpp"
+#include "core/SceneComponents.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+namespace dancore::resources {
+
+namespace fs = std::filesystem;
+namespace ecs = dancore::core::ecs;
+namespace jobs = dancore::core::jobs;
+namespace prof = dancore::core::profiler;
+
+namespace {
+
+constexpr double kMaxGarbage = 0.5; // доля мусора в файле, после которой сохранение полное
+
+struct Registered {
+    ecs::ComponentId id;
+    std::string name;
+    SceneTextFn toText;
+    bool transient;
+};
+
+std::mutex gRegistryMutex;
+std::vector<Registered> gRegistry;
+
+void Fail(const fs::path& file, const char* what)
+{
+    throw std::runtime_error("SceneFile: " + file.string() + ": " + what);
+}
+
+uint64_t AlignUp(uint64_t v) { return (v + kSceneAlign - 1) & ~uint64_t(kSceneAlign - 1); }
+
+void Vec3Text(const void* value, std::string& out)
+{
+    const float* v = static_cast<const float*>(value);
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.9g %.9g %.9g", v[0], v[1], v[2]);
+    out += buf;
+}
+
+void NameText(const void* value, std::string& out)
+{
+    const auto& n = *static_cast<const core::scene::Name*>(value);
+    out += '"';
+    for (size_t i = 0; i < sizeof(n.value) && n.value[i]; ++i) {
+        char c = n.value[i];
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    out += '"';
+}
+
+void PhysicsBodyText(const void* value, std::string& out)
+{
+    out += static_cast<const core::scene::PhysicsBody*>(value)->mode == core::scene::PhysicsBody::Voxel ? "Voxel" : "Rigid";
+}
+
+void RegisterLocked(ecs::ComponentId id, const char* name, SceneTextFn toText, bool transient)
+{
+    if (std::strlen(name) >= sizeof(SceneComponentEntry::name))
+        throw std::runtime_error(std::string("SceneFile: component name is too long: ") + name);
+    for (Registered& r : gRegistry)
+        if (r.id == id || r.name == name) {
+            if (r.id != id || r.name != name)
+                throw std::runtime_error(std::string("SceneFile: component registered twice: ") + name);
+            r.toText = toText;
+            r.transient = transient;
+            return;
+        }
+    gRegistry.push_back({id, name, toText, transient});
+}
+
+// Базовые компоненты: при первом обращении к реестру, под его замком
+void RegisterBuiltinsLocked()
+{
+    static bool done = false;
+    if (done) return;
+    done = true;
+    namespace scene = core::scene;
+    RegisterLocked(ecs::ComponentIdOf<scene::Name>(), "Name", NameText, false);
+    RegisterLocked(ecs::ComponentIdOf<scene::Position>(), "Position", Vec3Text, false);
+    RegisterLocked(ecs::ComponentIdOf<scene::Rotation>(), "Rotation", Vec3Text, false);
+    RegisterLocked(ecs::ComponentIdOf<scene::Scale>(), "Scale", Vec3Text, false);
+    RegisterLocked(ecs::ComponentIdOf<scene::PhysicsBody>(), "PhysicsBody", PhysicsBodyText, false);
+    RegisterLocked(ecs::ComponentIdOf<scene::LocalToWorld>(), "LocalToWorld", nullptr, true);
+}
+
+} // namespace
+
+void RegisterSceneComponent(ecs::ComponentId id, const char* name, SceneTextFn toText)
+{
+    std::lock_guard lock(gRegistryMutex);
+    RegisterBuiltinsLocked();
+    RegisterLocked(id, name, toText, false);
+}
+
+void RegisterTransientComponent(ecs::ComponentId id, const char* name)
+{
+    std::lock_guard lock(gRegistryMutex);
+    RegisterBuiltinsLocked();
+    RegisterLocked(id, name, nullptr, true);
+}
+
+// Снимок реестра: компоненты по имени, номер в этом порядке — номер в файле
+struct SceneFile::Schema {
+    std::vector<Registered> comps;
+    std::array<int, ecs::kMaxComponents> fileIndex; // -1 — не сохраняется
+    uint64_t hash = 0;
+
+    Schema()
+    {
+        {
+            std::lock_guard lock(gRegistryMutex);
+            RegisterBuiltinsLocked();
+            comps = gRegistry;
+        }
+        std::sort(comps.begin(), comps.end(), [](const Registered& a, const Registered& b) { return a.name < b.name; });
+        fileIndex.fill(-1);
+        std::string key;
+        for (size_t i = 0; i < comps.size(); ++i) {
+            fileIndex[comps[i].id] = int(i);
+            key += comps[i].name;
+            key += comps[i].transient ? '-' : '+';
+            key += std::to_string(ecs::GetComponentInfo(comps[i].id).size) + ';';
+        }
+        hash = core::Hash64(key);
+    }
+
+    uint64_t FileMask(const ecs::Archetype& a) const
+    {
+        uint64_t m = 0;
+        for (ecs::ComponentId id : a.components)
+            if (fileIndex[id] >= 0) m |= uint64_t(1) << fileIndex[id];
+        return m;
+    }
+
+    // Компоненты с данными в порядке записи (по номеру в файле)
+    std::vector<ecs::ComponentId> Columns(uint64_t fileMask) const
+    {
+        std::vector<ecs::ComponentId> out;
+        for (size_t i = 0; i < comps.size(); ++i)
+            if ((fileMask >> i) & 1 && !comps[i].transient) out.push_back(comps[i].id);
+        return out;
+    }
+};
+
+bool SceneFile::ChunkDirty(const ecs::Archetype& a, uint32_t chunk, const Schema& schema) const
+{
+    const uint32_t* v = a.Versions(chunk);
+    if (v[0] > savedVersion_) return true;
+    for (size_t k = 0; k < a.components.size(); ++k) {
+        int fi = schema.fileIndex[a.components[k]];
+        if (fi >= 0 && !schema.comps[fi].transient && v[1 + k] > savedVersion_) return true;
+    }
+    return false;
+}
+
+bool SceneFile::Dirty(const ecs::World& world) const
+{
+    if (!valid_) return true;
+    Schema schema;
+    if (schema.hash != schemaHash_) return true;
+    size_t archetypes = 0;
+    for (const ecs::Archetype* a : world.Archetypes()) {
+        if (a->chunks.empty() || !schema.FileMask(*a)) continue;
+        auto it = stored_.find(a->mask);
+        if (it == stored_.end() || it->second.size() != a->chunks.size()) return true;
+        for (uint32_t i = 0; i < a->chunks.size(); ++i)
+            if (it->second[i].count != a->chunks[i].count || ChunkDirty(*a, i, schema)) return true;
+        ++archetypes;
+    }
+    return archetypes != stored_.size(); // архетип опустел целиком
+}
+
+void SceneFile::Reset()
+{
+    path_.clear();
+    valid_ = false;
+    stored_.clear();
+    fileBytes_ = 0;
+    saveCount_ = 0;
+}
+
+SceneSaveStats SceneFile::Save(ecs::World& world, const fs::path& file)
+{
+    DC_PROFILE_ZONE("SceneFile::Save");
+    prof::Clock start = prof::Now();
+    Schema schema;
+    std::error_code ec;
+    uint64_t onDisk = fs::file_size(file, ec);
+    bool full = !valid_ || file != path_ || schema.hash != schemaHash_ || ec || onDisk != fileBytes_;
+
+    struct Item {
+        const ecs::Archetype* a;
+        uint32_t chunk;
+        bool write;
+        SceneChunkEntry entry;
+        std::vector<uint8_t> data;
+    };
+    std::vector<Item> items;
+    std::vector<uint64_t> masks;
+    uint64_t live = 0, appended = 0; // оставшиеся на месте записи и дописываемые
+    auto collect = [&] {
+        items.clear();
+        masks.clear();
+        live = appended = 0;
+        for (const ecs::Archetype* a : world.Archetypes()) {
+            uint64_t fileMask = schema.FileMask(*a);
+            if (a->chunks.empty() || !fileMask) continue;
+            uint32_t archetype = uint32_t(masks.size());
+            masks.push_back(fileMask);
+            uint64_t rowBytes = 0;
+            for (ecs::ComponentId id : schema.Columns(fileMask)) rowBytes += ecs::GetComponentInfo(id).size;
+            auto it = full ? stored_.end() : stored_.find(a->mask);
+            for (uint32_t i = 0; i < a->chunks.size(); ++i) {
+                Item item{a, i, true, {}, {}};
+                const SceneChunkEntry* old = it != stored_.end() && i < it->second.size() ? &it->second[i] : nullptr;
+                if (old && old->count == a->chunks[i].count && !ChunkDirty(*a, i, schema)) {
+                    item.write = false;
+                    item.entry = *old;
+                    live += old->size;
+                } else {
+                    item.entry.count = a->chunks[i].count;
+                    item.entry.size = rowBytes * item.entry.count;
+                    appended += AlignUp(item.entry.size);
+                }
+                item.entry.archetype = archetype;
+                items.push_back(std::move(item));
+            }
+        }
+    };
+    collect();
+    uint64_t grown = fileBytes_ + appended;
+    if (!full && double(grown - std::min(grown, sizeof(SceneHeader) + live + appended)) > kMaxGarbage * double(grown)) {
+        full = true;
+        collect();
+    }
+
+    // данные изменившихся чанков: массивы компонентов подряд, параллельно по чанкам
+    std::vector<uint32_t> dirty;
+    for (uint32_t k = 0; k < items.size(); ++k)
+        if (items[k].write) dirty.push_back(k);
+    jobs::ParallelFor(0, dirty.size(), 4, [&](size_t begin, size_t end) {
+        for (size_t d = begin; d < end; ++d) {
+            Item& item = items[dirty[d]];
+            const ecs::Chunk& c = item.a->chunks[item.chunk];
+            item.data.resize(size_t(item.entry.size));
+            uint8_t* out = item.data.data();
+            for (ecs::ComponentId id : schema.Columns(masks[item.entry.archetype])) {
+                size_t bytes = size_t(ecs::GetComponentInfo(id).size) * c.count;
+                std::memcpy(out, item.a->Column(c, id), bytes);
+                out += bytes;
+            }
+            item.entry.hash = core::Hash64(item.data.data(), item.data.size());
+        }
+    });
+
+    // футер целиком в памяти: его хэш идёт в трейлер
+    std::vector<uint8_t> footer;
+    auto put = [&](const void* p, size_t n) {
+        footer.insert(footer.end(), static_cast<const uint8_t*>(p), static_cast<const uint8_t*>(p) + n);
+    };
+
+    SceneSaveStats stats;
+    stats.full = full;
+    stats.chunksTotal = uint32_t(items.size());
+    fs::path tmp = file;
+    tmp += ".tmp";
+    try {
+        std::fstream f;
+        uint64_t pos = 0;
+        if (full) {
+            if (file.has_parent_path()) fs::create_directories(file.parent_path(), ec);
+            f.open(tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!f) Fail(tmp, "cannot create");
+        } else {
+            f.open(file, std::ios::in | std::ios::out | std::ios::binary);
+            if (!f) Fail(file, "cannot open for append");
+            f.seekp(std::streamoff(fileBytes_));
+            pos = fileBytes_;
+        }
+        auto write = [&](const void* data, size_t size) {
+            f.write(static_cast<const char*>(data), std::streamsize(size));
+            pos += size;
+        };
+        auto pad = [&] {
+            static const char zeros[kSceneAlign] = {};
+            write(zeros, size_t(AlignUp(pos) - pos));
+        };
+        if (full) {
+            SceneHeader header;
+            write(&header, sizeof(header));
+        }
+        for (Item& item : items) {
+            if (!item.write) continue;
+            pad();
+            item.entry.offset = pos;
+            write(item.data.data(), item.data.size());
+            stats.bytesWritten += item.data.size();
+            ++stats.chunksWritten;
+            live += item.entry.size;
+            std::vector<uint8_t>().swap(item.data);
+        }
+
+        SceneFooter header;
+        header.componentCount = uint32_t(schema.comps.size());
+        header.archetypeCount = uint32_t(masks.size());
+        header.chunkCount = uint32_t(items.size());
+        header.saveCount = full ? 1 : saveCount_ + 1;
+        put(&header, sizeof(header));
+        for (const Registered& r : schema.comps) {
+            SceneComponentEntry e;
+            std::memcpy(e.name, r.name.data(), r.name.size());
+            e.size = ecs::GetComponentInfo(r.id).size;
+            e.flags = r.transient ? uint32_t(SceneComponentEntry::Transient) : 0;
+            put(&e, sizeof(e));
+        }
+        put(masks.data(), masks.size() * sizeof(uint64_t));
+        for (const Item& item : items) put(&item.entry, sizeof(item.entry));
+
+        pad();
+        SceneTrailer trailer;
+        trailer.footerOffset = pos;
+        trailer.footerSize = footer.size();
+        trailer.footerHash = core::Hash64(footer.data(), footer.size());
+        write(footer.data(), footer.size());
+        write(&trailer, sizeof(trailer));
+        f.close();
+        if (!f) Fail(full ? tmp : file, "write failed");
+        if (full) {
+            fs::rename(tmp, file, ec);
+            if (ec) throw std::runtime_error("SceneFile: cannot replace " + file.string() + ": " + ec.message());
+        }
+        stats.fileBytes = pos;
+        saveCount_ = header.saveCount;
+    } catch (...) {
+        if (full) fs::remove(tmp, ec);
+        Reset();
+        throw;
+    }
+
+    stored_.clear();
+    for (const Item& item : items) stored_[item.a->mask].push_back(item.entry);
+    path_ = file;
+    valid_ = true;
+    schemaHash_ = schema.hash;
+    fileBytes_ = stats.fileBytes;
+    savedVersion_ = world.Version();
+    world.AdvanceVersion();
+    stats.seconds = double(prof::Now() - start) / 1e9;
+    return stats;
+}
+
+void SceneFile::Load(ecs::World& world, const fs::path& file)
+{
+    DC_PROFILE_ZONE("SceneFile::Load");
+    Reset();
+    if (world.Count()) throw std::runtime_error("SceneFile: Load expects an empty world");
+    std::ifstream f(file, std::ios::binary | std::ios::ate);
+    if (!f) Fail(file, "cannot open");
+    const uint64_t size = uint64_t(f.tellg());
+    auto read = [&](uint64_t offset, void* dst, size_t n) {
+        f.clear();
+        f.seekg(std::streamoff(offset));
+        return bool(f.read(static_cast<char*>(dst), std::streamsize(n)));
+    };
+
+    SceneHeader header;
+    if (size < sizeof(header) || !read(0, &header, sizeof(header)) || header.magic != kSceneMagic) Fail(file, "not a scene file");
+    if (header.version != kSceneVersion) Fail(file, "unsupported version");
+
+    // последний целый футер; после оборванного дописывания хвост пропускается
+    SceneTrailer trailer;
+    std::vector<uint8_t> footer;
+    uint64_t end = size & ~uint64_t(7);
+    for (;; end -= 8) {
+        if (end < sizeof(SceneHeader) + sizeof(SceneFooter) + sizeof(SceneTrailer)) Fail(file, "no valid footer");
+        uint64_t at = end - sizeof(trailer);
+        if (!read(at, &trailer, sizeof(trailer)) || trailer.magic != SceneTrailer{}.magic || trailer.version != kSceneVersion ||
+            trailer.footerOffset < sizeof(SceneHeader) || trailer.footerOffset > at ||
+            trailer.footerSize != at - trailer.footerOffset || trailer.footerSize < sizeof(SceneFooter))
+            continue;
+        footer.resize(size_t(trailer.footerSize));
+        if (read(trailer.footerOffset, footer.data(), footer.size()) &&
+            core::Hash64(footer.data(), footer.size()) == trailer.footerHash)
+            break;
+    }
+    if (end != size) DC_LOG_WARN(Assets, "Scene {}: torn tail after the last save, loading the previous one", file.string());
+
+    SceneFooter fh;
+    std::memcpy(&fh, footer.data(), sizeof(fh));
+    if (fh.componentCount > ecs::kMaxComponents ||
+        footer.size() != sizeof(fh) + uint64_t(fh.componentCount) * sizeof(SceneComponentEntry) +
+                             uint64_t(fh.archetypeCount) * 8 + uint64_t(fh.chunkCount) * sizeof(SceneChunkEntry))
+        Fail(file, "bad footer layout");
+    std::vector<SceneComponentEntry> comps(fh.componentCount);
+    std::vector<uint64_t> masks(fh.archetypeCount);
+    std::vector<SceneChunkEntry> chunks(fh.chunkCount);
+    const uint8_t* p = footer.data() + sizeof(fh);
+    auto take = [&](void* dst, size_t n) {
+        if (n) std::memcpy(dst, p, n);
+        p += n;
+    };
+    take(comps.data(), comps.size() * sizeof(SceneComponentEntry));
+    take(masks.data(), masks.size() * 8);
+    take(chunks.data(), chunks.size() * sizeof(SceneChunkEntry));
+
+    // компоненты файла -> компоненты мира по имени
+    Schema schema;
+    struct FileComp {
+        int id = -1;               // -1 — в мире такого нет
+        uint32_t size = 0;
+        bool data = false;         // есть байты в записи
+        bool copy = false;         // и их можно скопировать
+    };
+    std::vector<FileComp> map(comps.size());
+    bool exact = comps.size() == schema.comps.size();
+    for (size_t i = 0; i < comps.size(); ++i) {
+        const SceneComponentEntry& e = comps[i];
+        std::string name(e.name, std::find(e.name, e.name + sizeof(e.name), '\0'));
+        FileComp& m = map[i];
+        m.size = e.size;
+        m.data = !(e.flags & SceneComponentEntry::Transient);
+        auto it = std::find_if(schema.comps.begin(), schema.comps.end(), [&](const Registered& r) { return r.name == name; });
+        if (it == schema.comps.end()) {
+            DC_LOG_WARN(Assets, "Scene {}: unknown component '{}' skipped", file.string(), name);
+            exact = false;
+            continue;
+        }
+        m.id = it->id;
+        uint32_t have = ecs::GetComponentInfo(it->id).size;
+        m.copy = m.data && !it->transient && have == e.size;
+        if (m.data && !it->transient && have != e.size)
+            DC_LOG_WARN(Assets, "Scene {}: component '{}' is {} bytes, file has {}; using defaults", file.string(), name, have, e.size);
+        exact = exact && it - schema.comps.begin() == std::ptrdiff_t(i) && m.data == !it->transient && have == e.size;
+    }
+
+    struct Arch {
+        ecs::ComponentMask mask = 0;
+        uint64_t rowBytes = 0;
+    };
+    std::vector<Arch> archs(masks.size());
+    for (size_t a = 0; a < masks.size(); ++a) {
+        if (comps.size() < 64 && masks[a] >> comps.size()) Fail(file, "archetype references an unknown component");
+        for (size_t i = 0; i < comps.size(); ++i) {
+            if (!((masks[a] >> i) & 1)) continue;
+            if (map[i].id >= 0) archs[a].mask |= ecs::ComponentMask(1) << map[i].id;
+            if (map[i].data) archs[a].rowBytes += map[i].size;
+        }
+    }
+
+    // строки создаются здесь по порядку; запись чанка попадает в строки
+    // [first, first + count) своего архетипа, в чанке мира или на стыке двух
+    struct Dest {
+        ecs::Archetype* a;
+        uint32_t first;
+        const SceneChunkEntry* entry;
+    };
+    std::vector<Dest> loads;
+    loads.reserve(chunks.size());
+    std::unordered_map<ecs::ComponentMask, uint32_t> owner; // маска мира -> архетип файла
+    for (const SceneChunkEntry& e : chunks) {
+        if (e.archetype >= archs.size() || e.offset < sizeof(SceneHeader) || e.size > trailer.footerOffset ||
+            e.offset > trailer.footerOffset - e.size || e.size != archs[e.archetype].rowBytes * e.count)
+            Fail(file, "chunk entry out of bounds");
+        const Arch& arch = archs[e.archetype];
+        ecs::Archetype& a = world.GetArchetype(arch.mask);
+        uint32_t first = a.Count();
+        if (!owner.try_emplace(arch.mask, e.archetype).second && owner[arch.mask] != e.archetype) exact = false;
+        if (first % a.capacity || e.count > a.capacity) exact = false;
+        world.CreateBatch(arch.mask, e.count);
+        loads.push_back({&a, first, &e});
+    }
+
+    std::atomic<bool> failed{false};
+    jobs::ParallelFor(0, loads.size(), 4, [&](size_t begin, size_t end) {
+        std::ifstream in(file, std::ios::binary);
+        std::vector<uint8_t> data;
+        for (size_t k = begin; k < end && in; ++k) {
+            const Dest& l = loads[k];
+            const SceneChunkEntry& e = *l.entry;
+            data.resize(size_t(e.size));
+            in.seekg(std::streamoff(e.offset));
+            if (!in.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size())) ||
+                core::Hash64(data.data(), data.size()) != e.hash) {
+                failed = true;
+                return;
+            }
+            const uint8_t* src = data.data();
+            for (size_t i = 0; i < map.size(); ++i) {
+                if (!((masks[e.archetype] >> i) & 1) || !map[i].data) continue;
+                if (map[i].copy) {
+                    ecs::ComponentId id = ecs::ComponentId(map[i].id);
+                    // строки могут перейти через границу чанка мира
+                    for (uint32_t row = 0; row < e.count;) {
+                        uint32_t at = l.first + row;
+                        const ecs::Chunk& c = l.a->chunks[at / l.a->capacity];
+                        uint32_t n = std::min(e.count - row, l.a->capacity - at % l.a->capacity);
+                        std::memcpy(static_cast<uint8_t*>(l.a->Column(c, id)) + size_t(at % l.a->capacity) * map[i].size,
+                                    src + size_t(row) * map[i].size, size_t(n) * map[i].size);
+                        row += n;
+                    }
+                }
+                src += size_t(map[i].size) * e.count;
+            }
+        }
+        if (!in) failed = true;
+    });
+    if (failed) Fail(file, "corrupt chunk data");
+
+    // файл совпал с раскладкой мира один в один — следующее сохранение дописывает
+    if (exact) {
+        for (const Dest& l : loads) stored_[l.a->mask].push_back(*l.entry);
+        path_ = file;
+        valid_ = true;
+        schemaHash_ = schema.hash;
+        saveCount_ = fh.saveCount;
+        fileBytes_ = end;
+    }
+    savedVersion_ = world.Version();
+    world.AdvanceVersion();
+}
+
+void ExportSceneText(const ecs::World& world, const fs::path& file)
+{
+    DC_PROFILE_ZONE("ExportSceneText");
+    std::vector<Registered> comps;
+    {
+        std::lock_guard lock(gRegistryMutex);
+        RegisterBuiltinsLocked();
+        for (const Registered& r : gRegistry)
+            if (!r.transient) comps.push_back(r);
+    }
+    std::sort(comps.begin(), comps.end(), [](const Registered& a, const Registered& b) { return a.name < b.name; });
+
+    std::string out = "# dancore scene\n";
+    uint32_t n = 0;
+    for (const ecs::Archetype* a : world.Archetypes())
+        for (const ecs::Chunk& c : a->chunks)
+            for (uint32_t row = 0; row < c.count; ++row) {
+                out += "\nentity " + std::to_string(n++) + '\n';
+                for (const Registered& r : comps) {
+                    if (a->offset[r.id] == ~0u) continue;
+                    uint32_t size = ecs::GetComponentInfo(r.id).size;
+                    const uint8_t* value = static_cast<const uint8_t*>(a->Column(c, r.id)) + size_t(size) * row;
+                    out += "  " + r.name + ' ';
+                    if (r.toText) {
+                        r.toText(value, out);
+                    } else {
+                        char hex[3];
+                        for (uint32_t b = 0; b < size; ++b) {
+                            std::snprintf(hex, sizeof(hex), "%02x", value[b]);
+                            out += hex;
+                        }
+                    }
+                    out += '\n';
+                }
+            }
+
+    std::error_code ec;
+    if (file.has_parent_path()) fs::create_directories(file.parent_path(), ec);
+    std::ofstream f(file, std::ios::binary | std::ios::trunc);
+    f.write(out.data(), std::streamsize(out.size()));
+    f.close();
+    if (!f) throw std::runtime_error("ExportSceneText: cannot write " + file.string());
+}
+
+} // namespace dancore::resources
@@ -0,0 +1,134 @@
+#pragma once
+#include "core/Ecs.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Бинарный файл сцены (.dscene).
+//
+// Запись повторяет раскладку ECS: чанк мира — одна запись, внутри массивы компонентов
+// подряд, так что загрузка — memcpy массива в чанк, а чанки разбираются параллельно в
+// job system. Файл только дописывается: сохранение пишет заново лишь изменившиеся с
+// прошлого раза чанки (по версиям World) и новый оглавление-футер, старые копии
+// остаются мусором до полной перезаписи. Читается всегда последний целый футер.
+//
+// Формат (little-endian, записи и футер выровнены на kSceneAlign):
+//   SceneHeader
+//   записи чанков: для каждого компонента архетипа с данными count * size байт
+//   футер: SceneFooter, SceneComponentEntry[componentCount], uint64 маска[archetypeCount],
+//          SceneChunkEntry[chunkCount]
+//   SceneTrailer — последние 32 байта файла
+// Компоненты в файле — по стабильным именам (RegisterSceneComponent): ComponentId
+// зависят от порядка регистрации и между запусками не совпадают.
+
+namespace dancore::resources {
+
+inline constexpr uint32_t kSceneMagic = 0x4E435344;   // 'DSCN'
+inline constexpr uint32_t kSceneVersion = 1;
+inline constexpr uint32_t kSceneAlign = 64;
+
+struct SceneHeader {
+    uint32_t magic = kSceneMagic;
+    uint32_t version = kSceneVersion;
+    uint32_t reserved[14] = {};
+};
+static_assert(sizeof(SceneHeader) == 64);
+
+struct SceneFooter {
+    uint32_t magic = 0x52544653;    // 'SFTR'
+    uint32_t componentCount = 0;
+    uint32_t archetypeCount = 0;
+    uint32_t chunkCount = 0;
+    uint64_t saveCount = 0;         // сохранений в этот файл с последней полной записи
+    uint64_t reserved = 0;
+};
+static_assert(sizeof(SceneFooter) == 32);
+
+struct SceneComponentEntry {
+    enum : uint32_t { Transient = 1 }; // в маске архетипа, но без данных
+    char name[56] = {};
+    uint32_t size = 0;
+    uint32_t flags = 0;
+};
+static_assert(sizeof(SceneComponentEntry) == 64);
+
+struct SceneChunkEntry {
+    uint32_t archetype = 0;         // номер маски в футере
+    uint32_t count = 0;             // сущностей
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint64_t hash = 0;              // Hash64 записи
+};
+static_assert(sizeof(SceneChunkEntry) == 32);
+
+struct SceneTrailer {
+    uint64_t footerOffset = 0;
+    uint64_t footerSize = 0;
+    uint64_t footerHash = 0;
+    uint32_t magic = 0x45435344;    // 'DSCE'
+    uint32_t version = kSceneVersion;
+};
+static_assert(sizeof(SceneTrailer) == 32);
+
+// Текст компонента для ExportSceneText; nullptr — байты в hex
+using SceneTextFn = void (*)(const void* value, std::string& out);
+
+// Компонент попадает в файл только зарегистрированным. Базовые из core/SceneComponents
+// (Name, Position, Rotation, Scale, PhysicsBody, LocalToWorld) регистрируются сами.
+// Transient: сохраняется только наличие, данные после загрузки по умолчанию
+// (LocalToWorld пересчитывает UpdateLocalToWorld).
+void RegisterSceneComponent(core::ecs::ComponentId id, const char* name, SceneTextFn toText = nullptr);
+void RegisterTransientComponent(core::ecs::ComponentId id, const char* name);
+
+struct SceneSaveStats {
+    bool full = false;              // файл переписан целиком
+    uint32_t chunksWritten = 0;
+    uint32_t chunksTotal = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t fileBytes = 0;
+    double seconds = 0;
+};
+
+// Состояние файла между сохранениями: где лежит каждый чанк и какая версия мира
+// была сохранена. Один SceneFile — одна сцена одного World. Вызывать с главного
+// потока при запущенной job system, пока мир не меняют.
+class SceneFile {
+public:
+    // Первое сохранение, смена пути или набора компонентов, мусора больше половины
+    // файла — полная запись во временный файл с подменой; иначе дописывание.
+    // Бросает std::runtime_error; после ошибки следующее сохранение будет полным.
+    SceneSaveStats Save(core::ecs::World& world, const std::filesystem::path& file);
+
+    // В пустой мир. Неизвестные компоненты и компоненты другого размера пропускаются
+    // с предупреждением в лог. Бросает std::runtime_error на повреждённом файле;
+    // мир при этом может остаться загруженным частично — его стоит выбросить.
+    void Load(core::ecs::World& world, const std::filesystem::path& file);
+
+    // Есть ли в мире изменения после последнего Save/Load
+    bool Dirty(const core::ecs::World& world) const;
+    const std::filesystem::path& Path() const { return path_; }
+    void Reset();                   // забыть файл: следующее сохранение полное
+
+private:
+    struct Schema;
+
+    bool ChunkDirty(const core::ecs::Archetype& a, uint32_t chunk, const Schema& schema) const;
+
+    std::filesystem::path path_;
+    bool valid_ = false;            // stored_ соответствует файлу на диске
+    uint64_t schemaHash_ = 0;
+    uint32_t savedVersion_ = 0;
+    uint64_t saveCount_ = 0;
+    uint64_t fileBytes_ = 0;
+    // маска архетипа в мире -> записи его чанков по номеру чанка
+    std::unordered_map<core::ecs::ComponentMask, std::vector<SceneChunkEntry>> stored_;
+};
+
+// Текстовая выгрузка для diff'ов: по сущности на блок, компоненты по имени. Порядок —
+// порядок хранения в мире; только запись, обратно не читается.
+void ExportSceneText(const core::ecs::World& world, const std::filesystem::path& file);
+
+} // namespace dancore::resources
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+// Описание компонентов для скриптов на этапе компиляции: имя типа и поля как указатели
+// на члены. Привязки к языку (lua/LuaBind.hpp) разворачивают эти кортежи шаблонами, так
+// что доступ к полю — прямое обращение к члену, без таблиц имён во время выполнения.
+// Поля: числа (float/double/целые), bool и char[N] (строки).
+
+namespace dancore::scripting {
+
+template <class C, class M>
+struct Field {
+    using Type = M;
+    const char* name;
+    M C::*member;
+};
+
+template <class C, class M>
+Field(const char*, M C::*) -> Field<C, M>;
+
+// Специализация на компонент: static constexpr const char* name; static constexpr auto fields
+template <class T>
+struct Reflect;
+
+template <class T>
+concept Reflected = requires {
+    { Reflect<T>::name } -> std::convertible_to<const char*>;
+    std::tuple_size<std::remove_cv_t<decltype(Reflect<T>::fields)>>::value;
+};
+
+template <class T>
+inline constexpr size_t kFieldCount = std::tuple_size_v<std::remove_cv_t<decltype(Reflect<T>::fields)>>;
+
+template <class M>
+inline constexpr bool kNumericField = std::is_arithmetic_v<M> && !std::is_same_v<M, bool>;
+
+// Все поля — числа: с такими компонентами работают пакетные операции над столбцами
+template <class T>
+inline constexpr bool kNumericComponent = std::apply(
+    [](const auto&... f) { return (kNumericField<typename std::remove_cvref_t<decltype(f)>::Type> && ...); }, Reflect<T>::fields);
+
+// fn(field, index) по всем полям T; index — std::integral_constant
+template <class T, class F>
+constexpr void ForEachField(F&& fn)
+{
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        (fn(std::get<I>(Reflect<T>::fields), std::integral_constant<size_t, I>{}), ...);
+    }(std::make_index_sequence<kFieldCount<T>>{});
+}
+
+template <class... Ts>
+struct TypeList {
+    static constexpr size_t size = sizeof...(Ts);
+};
+
+} // namespace dancore::scripting
@@ -0,0 +1,46 @@
+#pragma once
+#include "Reflect.hpp"
+#include "core/SceneComponents.hpp"
+
+// Компоненты сцены, видимые скриптам. Новый компонент: специализация Reflect и строчка в
+// ScriptComponents — привязки для всех языков генерируются из этого списка.
+
+namespace dancore::scripting {
+
+template <>
+struct Reflect<core::scene::Name> {
+    static constexpr const char* name = "Name";
+    static constexpr auto fields = std::tuple{Field{"value", &core::scene::Name::value}};
+};
+
+template <>
+struct Reflect<core::scene::Position> {
+    static constexpr const char* name = "Position";
+    static constexpr auto fields = std::tuple{Field{"x", &core::scene::Position::x}, Field{"y", &core::scene::Position::y},
+                                              Field{"z", &core::scene::Position::z}};
+};
+
+template <>
+struct Reflect<core::scene::Rotation> {
+    static constexpr const char* name = "Rotation";
+    static constexpr auto fields = std::tuple{Field{"x", &core::scene::Rotation::x}, Field{"y", &core::scene::Rotation::y},
+                                              Field{"z", &core::scene::Rotation::z}};
+};
+
+template <>
+struct Reflect<core::scene::Scale> {
+    static constexpr const char* name = "Scale";
+    static constexpr auto fields = std::tuple{Field{"x", &core::scene::Scale::x}, Field{"y", &core::scene::Scale::y},
+                                              Field{"z", &core::scene::Scale::z}};
+};
+
+template <>
+struct Reflect<core::scene::PhysicsBody> {
+    static constexpr const char* name = "PhysicsBody";
+    static constexpr auto fields = std::tuple{Field{"mode", &core::scene::PhysicsBody::mode}};
+};
+
+using ScriptComponents = TypeList<core::scene::Name, core::scene::Position, core::scene::Rotation, core::scene::Scale,
+                                  core::scene::PhysicsBody>;
+
+} // namespace dancore::scripting
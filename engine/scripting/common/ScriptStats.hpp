@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Профиль скриптов для панели редактора (без типов языка). Время — всё, что скрипт
+// провёл в своих вызовах за кадр; выделения — через аллокатор его виртуальной машины.
+
+namespace dancore::scripting {
+
+struct ScriptStats {
+    std::string name;              // путь относительно каталога скриптов
+    bool failed = false;           // ошибка: скрипт выключен до следующего Play
+    uint32_t chunks = 0;           // пакетных вызовов за кадр
+    uint32_t entities = 0;         // сущностей в них
+    double frameMs = 0, avgMs = 0, peakMs = 0;
+    uint64_t frameAllocs = 0;      // выделений за кадр
+    uint64_t frameAllocBytes = 0;
+    uint64_t liveBytes = 0;        // память виртуальной машины сейчас
+    uint64_t frames = 0;
+};
+
+} // namespace dancore::scripting
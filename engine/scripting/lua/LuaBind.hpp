@@ -0,0 +1,343 @@
+#pragma once
+#include <lua.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "core/Ecs.hpp"
+#include "scripting/common/Reflect.hpp"
+
+// Привязки компонентов к Lua, развёрнутые шаблонами из Reflect<T> (только для LuaHost.cpp).
+//
+// Ссылка на компонент (scene.get) и столбец чанка (аргументы system.update) — userdata с
+// указателем прямо в массив компонента, без копий. Тип userdata проверяется по метатаблице,
+// которая лежит в реестре под адресом (lua_rawgetp), а не под строкой. Поля ref.x ищутся
+// сравнением ключа с интернированными именами полей в upvalue (lua_rawequal — сравнение
+// указателей), так что на вызов нет ни хэширования строк, ни таблиц имён.
+//
+// Указатели в чанк живут один вызов скрипта: Context::epoch растёт после каждого вызова.
+// Ссылка компонента (scene.get) создаётся на вызов, и сохранённая на потом даёт ошибку.
+// Столбцы же — одни userdata на скрипт, их перепривязывают к каждому чанку (update без
+// аллокаций): столбец, сохранённый скриптом, в следующем update молча указывает на текущий
+// чанк, ошибку он даёт только вне update (в frame). Чужой памяти не читает ни то, ни другое.
+
+namespace dancore::scripting::lua {
+
+// Хэндл сущности в Lua — целое: индекс | поколение << 32
+inline lua_Integer ToLua(core::ecs::Entity e) { return lua_Integer(uint64_t(e.generation) << 32 | e.index); }
+inline core::ecs::Entity EntityFromLua(lua_Integer v) { return {uint32_t(uint64_t(v)), uint32_t(uint64_t(v) >> 32)}; }
+
+// Состояние привязок одной виртуальной машины; указатель на него — в lua_getextraspace
+struct Context {
+    using PushRefFn = void (*)(lua_State*, void* value);
+    using NewColumnFn = void (*)(lua_State*);
+
+    core::ecs::World* world = nullptr;
+    uint32_t epoch = 1;
+    const char* script = "";
+    std::array<PushRefFn, core::ecs::kMaxComponents> pushRef{};     // по ComponentId, nullptr — не виден
+    std::array<NewColumnFn, core::ecs::kMaxComponents> newColumn{};
+};
+
+inline Context& GetContext(lua_State* L) { return **static_cast<Context**>(lua_getextraspace(L)); }
+
+struct Ref {
+    void* value;
+    uint32_t epoch;
+};
+
+struct Column {
+    void* data;
+    uint32_t count;
+    uint32_t epoch;
+};
+
+// Ключи метатаблиц в реестре
+template <class T> inline const char kRefKey = 0;
+template <class T> inline const char kColumnKey = 0;
+inline const char kEntitiesKey = 0;
+
+template <class Ud>
+Ud* TestUserdata(lua_State* L, int index, const void* key)
+{
+    void* p = lua_touserdata(L, index);
+    if (!p || !lua_getmetatable(L, index)) return nullptr;
+    lua_rawgetp(L, LUA_REGISTRYINDEX, key);
+    const bool same = lua_rawequal(L, -1, -2);
+    lua_pop(L, 2);
+    return same ? static_cast<Ud*>(p) : nullptr;
+}
+
+template <class Ud>
+Ud& CheckUserdata(lua_State* L, int index, const void* key, const char* what)
+{
+    Ud* ud = TestUserdata<Ud>(L, index, key);
+    if (!ud) luaL_typeerror(L, index, what);
+    if (ud->epoch != GetContext(L).epoch) luaL_error(L, "stale %s reference: it is valid only during the call that got it", what);
+    return *ud;
+}
+
+template <class M>
+void PushValue(lua_State* L, const M& v)
+{
+    if constexpr (std::is_same_v<M, bool>) lua_pushboolean(L, v);
+    else if constexpr (std::is_integral_v<M>) lua_pushinteger(L, lua_Integer(v));
+    else if constexpr (std::is_floating_point_v<M>) lua_pushnumber(L, lua_Number(v));
+    else lua_pushlstring(L, v, strnlen(v, std::extent_v<M>)); // char[N]
+}
+
+template <class M>
+void ReadValue(lua_State* L, int index, M& v)
+{
+    if constexpr (std::is_same_v<M, bool>) {
+        v = lua_toboolean(L, index);
+    } else if constexpr (std::is_integral_v<M>) {
+        v = M(luaL_checkinteger(L, index));
+    } else if constexpr (std::is_floating_point_v<M>) {
+        v = M(luaL_checknumber(L, index));
+    } else {
+        size_t n = 0;
+        const char* s = luaL_checklstring(L, index, &n);
+        n = n < std::extent_v<M> ? n : std::extent_v<M> - 1;
+        std::memset(v, 0, sizeof(v)); // хвост нулями: сохранение сцены побайтовое
+        std::memcpy(v, s, n);
+    }
+}
+
+template <class T>
+using FieldType = typename std::remove_cvref_t<T>::Type;
+
+// ---- ссылка на один компонент ----
+
+template <class T>
+void PushRef(lua_State* L, void* value)
+{
+    auto* ref = static_cast<Ref*>(lua_newuserdatauv(L, sizeof(Ref), 0));
+    *ref = {value, GetContext(L).epoch};
+    lua_rawgetp(L, LUA_REGISTRYINDEX, &kRefKey<T>);
+    lua_setmetatable(L, -2);
+}
+
+// upvalue i + 1 — имя поля i
+template <class T>
+int RefIndex(lua_State* L)
+{
+    T& value = *static_cast<T*>(CheckUserdata<Ref>(L, 1, &kRefKey<T>, Reflect<T>::name).value);
+    bool found = false;
+    ForEachField<T>([&](const auto& field, auto i) {
+        if (!found && lua_rawequal(L, 2, lua_upvalueindex(int(i) + 1))) PushValue(L, value.*field.member), found = true;
+    });
+    if (!found) return luaL_error(L, "%s has no field '%s'", Reflect<T>::name, luaL_tolstring(L, 2, nullptr));
+    return 1;
+}
+
+template <class T>
+int RefNewIndex(lua_State* L)
+{
+    T& value = *static_cast<T*>(CheckUserdata<Ref>(L, 1, &kRefKey<T>, Reflect<T>::name).value);
+    bool found = false;
+    ForEachField<T>([&](const auto& field, auto i) {
+        if (!found && lua_rawequal(L, 2, lua_upvalueindex(int(i) + 1))) ReadValue(L, 3, value.*field.member), found = true;
+    });
+    if (!found) return luaL_error(L, "%s has no field '%s'", Reflect<T>::name, luaL_tolstring(L, 2, nullptr));
+    return 0;
+}
+
+// ---- столбец чанка: пакетный доступ ----
+
+template <class T>
+Column& CheckColumn(lua_State* L, int index)
+{
+    return CheckUserdata<Column>(L, index, &kColumnKey<T>, Reflect<T>::name);
+}
+
+inline uint32_t CheckRow(lua_State* L, const Column& c, int index)
+{
+    const lua_Integer row = luaL_checkinteger(L, index);
+    if (row < 1 || row > lua_Integer(c.count)) luaL_error(L, "row %d is out of range 1..%d", int(row), int(c.count));
+    return uint32_t(row - 1);
+}
+
+// col:get(i) -> все поля строки i
+template <class T>
+int ColumnGet(lua_State* L)
+{
+    const Column& c = CheckColumn<T>(L, 1);
+    const T& value = static_cast<const T*>(c.data)[CheckRow(L, c, 2)];
+    ForEachField<T>([&](const auto& field, auto) { PushValue(L, value.*field.member); });
+    return int(kFieldCount<T>);
+}
+
+// col:set(i, ...) — по аргументу на поле, nil оставляет поле как есть
+template <class T>
+int ColumnSet(lua_State* L)
+{
+    const Column& c = CheckColumn<T>(L, 1);
+    T& value = static_cast<T*>(c.data)[CheckRow(L, c, 2)];
+    ForEachField<T>([&](const auto& field, auto i) {
+        if (!lua_isnoneornil(L, 3 + int(i))) ReadValue(L, 3 + int(i), value.*field.member);
+    });
+    return 0;
+}
+
+template <class T>
+int ColumnLen(lua_State* L)
+{
+    lua_pushinteger(L, CheckColumn<T>(L, 1).count);
+    return 1;
+}
+
+// col:fill/add/mul(...) — одно значение на поле для всех строк; цикл по строкам без вызовов
+template <class T, class Op>
+int ColumnApply(lua_State* L, Op op)
+{
+    const Column& c = CheckColumn<T>(L, 1);
+    T* data = static_cast<T*>(c.data);
+    ForEachField<T>([&](const auto& field, auto i) {
+        if (lua_isnoneornil(L, 2 + int(i))) return;
+        using M = FieldType<decltype(field)>;
+        const M v = M(luaL_checknumber(L, 2 + int(i)));
+        const auto member = field.member;
+        for (uint32_t r = 0; r < c.count; ++r) data[r].*member = M(op(data[r].*member, v));
+    });
+    return 0;
+}
+
+template <class T> int ColumnFill(lua_State* L) { return ColumnApply<T>(L, [](auto, auto v) { return v; }); }
+template <class T> int ColumnAdd(lua_State* L) { return ColumnApply<T>(L, [](auto a, auto v) { return a + v; }); }
+template <class T> int ColumnMul(lua_State* L) { return ColumnApply<T>(L, [](auto a, auto v) { return a * v; }); }
+
+template <class T, class MT, class U, class MU>
+void AddScaledField(T* dst, MT T::*to, const U* src, MU U::*from, uint32_t count, double k)
+{
+    using Scale = std::conditional_t<std::is_floating_point_v<MT>, MT, double>;
+    const Scale scale = Scale(k);
+    for (uint32_t r = 0; r < count; ++r) dst[r].*to = MT(dst[r].*to + scale * src[r].*from);
+}
+
+template <class T, class U>
+bool TryAddScaled(lua_State* L, const Column& c)
+{
+    if constexpr (!kNumericComponent<U> || kFieldCount<U> != kFieldCount<T>) {
+        return false;
+    } else {
+        const Column* other = TestUserdata<Column>(L, 2, &kColumnKey<U>);
+        if (!other) return false;
+        if (other->epoch != GetContext(L).epoch) luaL_error(L, "stale %s reference", Reflect<U>::name);
+        if (other->count != c.count) luaL_error(L, "add_scaled: columns come from different chunks");
+        const double k = luaL_checknumber(L, 3);
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (AddScaledField(static_cast<T*>(c.data), std::get<I>(Reflect<T>::fields).member,
+                            static_cast<const U*>(other->data), std::get<I>(Reflect<U>::fields).member, c.count, k),
+             ...);
+        }(std::make_index_sequence<kFieldCount<T>>{});
+        return true;
+    }
+}
+
+// col:add_scaled(other, k): col += other * k по полям, other — столбец того же чанка с тем же
+// числом числовых полей (позиция += скорость * dt)
+template <class T, class... Us>
+int ColumnAddScaled(lua_State* L)
+{
+    const Column& c = CheckColumn<T>(L, 1);
+    if (!(TryAddScaled<T, Us>(L, c) || ...)) luaL_typeerror(L, 2, "numeric column with the same number of fields");
+    return 0;
+}
+
+template <class T>
+void NewColumn(lua_State* L)
+{
+    auto* c = static_cast<Column*>(lua_newuserdatauv(L, sizeof(Column), 0));
+    *c = {nullptr, 0, 0};
+    lua_rawgetp(L, LUA_REGISTRYINDEX, &kColumnKey<T>);
+    lua_setmetatable(L, -2);
+}
+
+// entities:get(i) -> хэндл сущности строки i
+inline int EntitiesGet(lua_State* L)
+{
+    const Column& c = CheckUserdata<Column>(L, 1, &kEntitiesKey, "entities");
+    lua_pushinteger(L, ToLua(static_cast<const core::ecs::Entity*>(c.data)[CheckRow(L, c, 2)]));
+    return 1;
+}
+
+inline int EntitiesLen(lua_State* L)
+{
+    lua_pushinteger(L, CheckUserdata<Column>(L, 1, &kEntitiesKey, "entities").count);
+    return 1;
+}
+
+inline void NewEntities(lua_State* L)
+{
+    auto* c = static_cast<Column*>(lua_newuserdatauv(L, sizeof(Column), 0));
+    *c = {nullptr, 0, 0};
+    lua_rawgetp(L, LUA_REGISTRYINDEX, &kEntitiesKey);
+    lua_setmetatable(L, -2);
+}
+
+// ---- регистрация ----
+
+inline void SetFunction(lua_State* L, const char* name, lua_CFunction fn)
+{
+    lua_pushcfunction(L, fn);
+    lua_setfield(L, -2, name);
+}
+
+template <class T, class... All>
+void RegisterComponent(lua_State* L, Context& context)
+{
+    static_assert(Reflected<T>);
+    auto pushNames = [&] { ForEachField<T>([&](const auto& field, auto) { lua_pushstring(L, field.name); }); };
+
+    lua_createtable(L, 0, 3);
+    pushNames();
+    lua_pushcclosure(L, &RefIndex<T>, int(kFieldCount<T>));
+    lua_setfield(L, -2, "__index");
+    pushNames();
+    lua_pushcclosure(L, &RefNewIndex<T>, int(kFieldCount<T>));
+    lua_setfield(L, -2, "__newindex");
+    lua_pushstring(L, Reflect<T>::name);
+    lua_setfield(L, -2, "__name");
+    lua_rawsetp(L, LUA_REGISTRYINDEX, &kRefKey<T>);
+
+    lua_createtable(L, 0, 3);
+    lua_createtable(L, 0, 6);
+    SetFunction(L, "get", &ColumnGet<T>);
+    SetFunction(L, "set", &ColumnSet<T>);
+    if constexpr (kNumericComponent<T>) {
+        SetFunction(L, "fill", &ColumnFill<T>);
+        SetFunction(L, "add", &ColumnAdd<T>);
+        SetFunction(L, "mul", &ColumnMul<T>);
+        SetFunction(L, "add_scaled", &ColumnAddScaled<T, All...>);
+    }
+    lua_setfield(L, -2, "__index");
+    SetFunction(L, "__len", &ColumnLen<T>);
+    lua_pushstring(L, Reflect<T>::name);
+    lua_setfield(L, -2, "__name");
+    lua_rawsetp(L, LUA_REGISTRYINDEX, &kColumnKey<T>);
+
+    // глобальное Position = ComponentId: им скрипт называет тип в scene.get и components
+    const core::ecs::ComponentId id = core::ecs::ComponentIdOf<T>();
+    context.pushRef[id] = &PushRef<T>;
+    context.newColumn[id] = &NewColumn<T>;
+    lua_pushinteger(L, id);
+    lua_setglobal(L, Reflect<T>::name);
+}
+
+template <class... Ts>
+void RegisterComponents(lua_State* L, Context& context, TypeList<Ts...>)
+{
+    (RegisterComponent<Ts, Ts...>(L, context), ...);
+
+    lua_createtable(L, 0, 2);
+    lua_createtable(L, 0, 1);
+    SetFunction(L, "get", &EntitiesGet);
+    lua_setfield(L, -2, "__index");
+    SetFunction(L, "__len", &EntitiesLen);
+    lua_rawsetp(L, LUA_REGISTRYINDEX, &kEntitiesKey);
+}
+
+} // namespace dancore::scripting::lua
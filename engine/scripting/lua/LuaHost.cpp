@@ -0,0 +1,380 @@
+#include "LuaHost.hpp"
+#include "core/Log.hpp"
+#include "core/Profiler.hpp"
+#include "scripting/common/SceneReflect.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#ifdef DANCORE_HAS_LUA
+#include "LuaBind.hpp"
+#endif
+
+namespace dancore::scripting {
+
+namespace fs = std::filesystem;
+namespace ecs = dancore::core::ecs;
+namespace prof = dancore::core::profiler;
+
+namespace {
+
+// Значения видимых скриптам компонентов на момент Begin
+template <class List>
+struct Values;
+
+template <class... Ts>
+struct Values<TypeList<Ts...>> {
+    template <class T>
+    struct Column {
+        std::vector<ecs::Entity> entities;
+        std::vector<T> values;
+    };
+    std::tuple<Column<Ts>...> columns;
+
+    void Capture(ecs::World& world)
+    {
+        (CaptureOne<Ts>(world), ...);
+    }
+
+    // Пишем только изменённое: неконстантный Get помечает чанк для сохранения сцены
+    void Restore(ecs::World& world) const
+    {
+        (RestoreOne<Ts>(world), ...);
+    }
+
+    template <class T>
+    void CaptureOne(ecs::World& world)
+    {
+        Column<T>& c = std::get<Column<T>>(columns);
+        world.Each<const T>([&](uint32_t count, const ecs::Entity* entities, const T* values) {
+            c.entities.insert(c.entities.end(), entities, entities + count);
+            c.values.insert(c.values.end(), values, values + count);
+        });
+    }
+
+    template <class T>
+    void RestoreOne(ecs::World& world) const
+    {
+        const Column<T>& c = std::get<Column<T>>(columns);
+        for (size_t i = 0; i < c.entities.size(); ++i) {
+            const T* current = std::as_const(world).Get<T>(c.entities[i]);
+            if (current && std::memcmp(current, &c.values[i], sizeof(T))) *world.Get<T>(c.entities[i]) = c.values[i];
+        }
+    }
+};
+
+} // namespace
+
+struct LuaHost::Snapshot : Values<ScriptComponents> {};
+
+#ifdef DANCORE_HAS_LUA
+
+namespace {
+
+// Виртуальная машина скрипта и счётчики её аллокатора
+struct Machine {
+    lua_State* L = nullptr;
+    lua::Context context;
+    std::string name;
+    uint64_t allocs = 0, allocBytes = 0, liveBytes = 0;
+
+    ~Machine()
+    {
+        if (L) lua_close(L);
+    }
+};
+
+void* Allocate(void* user, void* ptr, size_t oldSize, size_t newSize)
+{
+    auto& s = *static_cast<Machine*>(user);
+    if (!newSize) {
+        if (ptr) s.liveBytes -= oldSize;
+        std::free(ptr);
+        return nullptr;
+    }
+    void* p = std::realloc(ptr, newSize);
+    if (!p) return nullptr;
+    s.liveBytes += newSize - (ptr ? oldSize : 0);
+    ++s.allocs;
+    s.allocBytes += newSize;
+    return p;
+}
+
+lua::Context& CheckWorld(lua_State* L)
+{
+    lua::Context& context = lua::GetContext(L);
+    if (!context.world) luaL_error(L, "scene is only available while the script runs");
+    return context;
+}
+
+// scene.get(entity, Position) -> ссылка на компонент или nil
+int SceneGet(lua_State* L)
+{
+    lua::Context& context = CheckWorld(L);
+    const ecs::Entity e = lua::EntityFromLua(luaL_checkinteger(L, 1));
+    const lua_Integer id = luaL_checkinteger(L, 2);
+    if (id < 0 || id >= lua_Integer(ecs::kMaxComponents) || !context.pushRef[size_t(id)])
+        return luaL_argerror(L, 2, "not a component visible to scripts");
+    void* value = context.world->Alive(e) ? context.world->GetRaw(e, ecs::ComponentId(id)) : nullptr;
+    if (!value) lua_pushnil(L);
+    else context.pushRef[size_t(id)](L, value);
+    return 1;
+}
+
+// scene.find(name) -> первая сущность с таким Name или nil (перебор: не для каждого кадра)
+int SceneFind(lua_State* L)
+{
+    lua::Context& context = CheckWorld(L);
+    size_t length = 0;
+    const char* name = luaL_checklstring(L, 1, &length);
+    ecs::Entity found{};
+    if (length < sizeof(core::scene::Name::value))
+        context.world->Each<const core::scene::Name>(
+            [&](uint32_t count, const ecs::Entity* entities, const core::scene::Name* names) {
+                for (uint32_t i = 0; i < count && !found; ++i)
+                    if (!std::strncmp(names[i].value, name, sizeof(names[i].value)) && !names[i].value[length]) found = entities[i];
+            });
+    if (found) lua_pushinteger(L, lua::ToLua(found));
+    else lua_pushnil(L);
+    return 1;
+}
+
+int SceneAlive(lua_State* L)
+{
+    lua_pushboolean(L, CheckWorld(L).world->Alive(lua::EntityFromLua(luaL_checkinteger(L, 1))));
+    return 1;
+}
+
+// print -> лог редактора
+int Print(lua_State* L)
+{
+    const int n = lua_gettop(L);
+    for (int i = 1; i <= n; ++i) {
+        if (i > 1) lua_pushliteral(L, "\t");
+        luaL_tolstring(L, i, nullptr);
+    }
+    lua_concat(L, n ? 2 * n - 1 : 0);
+    DC_LOG_INFO(Script, "{}: {}", lua::GetContext(L).script, lua_tostring(L, -1));
+    return 0;
+}
+
+// Без io/os/package/debug: скрипты правят сцену, а не машину
+void OpenLibraries(lua_State* L)
+{
+    const luaL_Reg libraries[] = {{"_G", luaopen_base},           {"coroutine", luaopen_coroutine},
+                                  {"table", luaopen_table},       {"string", luaopen_string},
+                                  {"math", luaopen_math},         {"utf8", luaopen_utf8}};
+    for (const luaL_Reg& lib : libraries) {
+        luaL_requiref(L, lib.name, lib.func, 1);
+        lua_pop(L, 1);
+    }
+    lua_pushcfunction(L, &Print);
+    lua_setglobal(L, "print");
+    const luaL_Reg scene[] = {{"get", &SceneGet}, {"find", &SceneFind}, {"alive", &SceneAlive}};
+    lua_createtable(L, 0, 3);
+    for (const luaL_Reg& f : scene) {
+        lua_pushcfunction(L, f.func);
+        lua_setfield(L, -2, f.name);
+    }
+    lua_setglobal(L, "scene");
+}
+
+int Reference(lua_State* L, int index, const char* field)
+{
+    lua_getfield(L, index, field);
+    if (lua_isfunction(L, -1)) return luaL_ref(L, LUA_REGISTRYINDEX);
+    lua_pop(L, 1);
+    return LUA_NOREF;
+}
+
+// Вызов с аргументами на стеке; после него ссылки этого вызова устаревают
+bool Call(Machine& s, int args)
+{
+    const int status = lua_pcall(s.L, args, 0, 0);
+    ++s.context.epoch;
+    if (status == LUA_OK) return true;
+    DC_LOG_ERROR(Script, "{}: {}", s.name, lua_tostring(s.L, -1));
+    lua_pop(s.L, 1);
+    return false;
+}
+
+void BindColumn(lua_State* L, int ref, void* data, uint32_t count, uint32_t epoch)
+{
+    lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+    *static_cast<lua::Column*>(lua_touserdata(L, -1)) = {data, count, epoch};
+}
+
+} // namespace
+
+struct LuaHost::Script : Machine {
+    int frame = LUA_NOREF, update = LUA_NOREF, entities = LUA_NOREF;
+    std::vector<ecs::ComponentId> components; // аргументы update после entities
+    std::vector<int> columns;                 // userdata столбцов, одни и те же каждый чанк (см. LuaBind.hpp)
+    ecs::ComponentMask need = 0;
+    double totalMs = 0;
+};
+
+#else
+
+struct LuaHost::Script {};
+
+#endif
+
+LuaHost::LuaHost() = default;
+LuaHost::~LuaHost() = default;
+
+void LuaHost::Begin(ecs::World& world)
+{
+    if (running_) End(world);
+    scripts_.clear();
+    stats_.clear();
+    snapshot_ = std::make_unique<Snapshot>();
+    snapshot_->Capture(world);
+    running_ = true;
+}
+
+void LuaHost::LoadDirectory(const fs::path& directory)
+{
+    std::error_code ec;
+    if (!fs::is_directory(directory, ec)) return;
+    std::vector<fs::path> files;
+    for (fs::recursive_directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec))
+        if (it->is_regular_file(ec) && it->path().extension() == ".lua") files.push_back(it->path());
+    std::sort(files.begin(), files.end());
+    for (const fs::path& file : files) {
+        std::ifstream in(file, std::ios::binary);
+        std::ostringstream source;
+        source << in.rdbuf();
+        Load(fs::relative(file, directory, ec).generic_string(), source.str());
+    }
+}
+
+bool LuaHost::Load(std::string_view name, std::string_view source)
+{
+    DC_PROFILE_ZONE("LuaHost::Load");
+    stats_.push_back({});
+    stats_.back().name = name;
+#ifndef DANCORE_HAS_LUA
+    (void)source;
+    scripts_.push_back(std::make_unique<Script>());
+    stats_.back().failed = true;
+    DC_LOG_ERROR(Script, "{}: this build has no Lua support", name);
+    return false;
+#else
+    scripts_.push_back(std::make_unique<Script>());
+    Script& s = *scripts_.back();
+    s.name = name;
+    auto fail = [&](const char* what) {
+        DC_LOG_ERROR(Script, "{}: {}", s.name, what);
+        stats_.back().failed = true;
+        return false;
+    };
+    s.L = lua_newstate(&Allocate, static_cast<Machine*>(&s));
+    if (!s.L) return fail("cannot create a Lua state");
+    lua_State* L = s.L;
+    *static_cast<lua::Context**>(lua_getextraspace(L)) = &s.context;
+    s.context.script = s.name.c_str();
+    OpenLibraries(L);
+    lua::RegisterComponents(L, s.context, ScriptComponents{});
+
+    const std::string chunk = "@" + s.name;
+    if (luaL_loadbufferx(L, source.data(), source.size(), chunk.c_str(), "t") != LUA_OK ||
+        lua_pcall(L, 0, 1, 0) != LUA_OK)
+        return fail(lua_tostring(L, -1));
+    if (!lua_istable(L, -1)) return fail("the script must return a system table");
+    s.frame = Reference(L, -1, "frame");
+    s.update = Reference(L, -1, "update");
+    if (s.frame == LUA_NOREF && s.update == LUA_NOREF) return fail("the system has neither update nor frame");
+
+    lua_getfield(L, -1, "components");
+    const lua_Integer count = lua_istable(L, -1) ? luaL_len(L, -1) : 0;
+    for (lua_Integer i = 1; i <= count; ++i) {
+        lua_geti(L, -1, i);
+        int isNumber = 0;
+        const lua_Integer id = lua_tointegerx(L, -1, &isNumber);
+        lua_pop(L, 1);
+        if (!isNumber || id < 0 || id >= lua_Integer(ecs::kMaxComponents) || !s.context.newColumn[size_t(id)])
+            return fail("components lists something that is not a component visible to scripts");
+        s.components.push_back(ecs::ComponentId(id));
+        s.need |= ecs::ComponentMask(1) << id;
+        s.context.newColumn[size_t(id)](L);
+        s.columns.push_back(luaL_ref(L, LUA_REGISTRYINDEX));
+    }
+    lua_pop(L, 2);
+    if (s.update != LUA_NOREF && s.components.empty()) return fail("update needs a non-empty components list");
+    lua::NewEntities(L);
+    s.entities = luaL_ref(L, LUA_REGISTRYINDEX);
+    DC_LOG_INFO(Script, "{}: loaded, {} components", s.name, s.components.size());
+    return true;
+#endif
+}
+
+void LuaHost::Update(ecs::World& world, double frameSeconds)
+{
+    DC_PROFILE_ZONE("LuaHost::Update");
+    if (!running_) return;
+#ifdef DANCORE_HAS_LUA
+    for (size_t i = 0; i < scripts_.size(); ++i) {
+        Script& s = *scripts_[i];
+        ScriptStats& stats = stats_[i];
+        if (stats.failed) continue;
+        const prof::Clock start = prof::Now();
+        const uint64_t allocs = s.allocs, allocBytes = s.allocBytes;
+        lua_State* L = s.L;
+        s.context.world = &world;
+        stats.chunks = stats.entities = 0;
+
+        bool ok = true;
+        if (s.frame != LUA_NOREF) {
+            lua_rawgeti(L, LUA_REGISTRYINDEX, s.frame);
+            lua_pushnumber(L, frameSeconds);
+            ok = Call(s, 1);
+        }
+        if (ok && s.update != LUA_NOREF)
+            world.EachChunk(s.need, s.need, [&](const ecs::Archetype& a, const ecs::Chunk& c) {
+                if (!ok) return;
+                lua_rawgeti(L, LUA_REGISTRYINDEX, s.update);
+                lua_pushnumber(L, frameSeconds);
+                lua_pushinteger(L, c.count);
+                BindColumn(L, s.entities, a.Entities(c), c.count, s.context.epoch);
+                for (size_t k = 0; k < s.components.size(); ++k)
+                    BindColumn(L, s.columns[k], a.Column(c, s.components[k]), c.count, s.context.epoch);
+                ok = Call(s, 3 + int(s.components.size()));
+                ++stats.chunks;
+                stats.entities += c.count;
+            });
+        s.context.world = nullptr;
+
+        const double ms = double(prof::Now() - start) / 1e6;
+        s.totalMs += ms;
+        ++stats.frames;
+        stats.frameMs = ms;
+        stats.avgMs = s.totalMs / double(stats.frames);
+        stats.peakMs = std::max(stats.peakMs, ms);
+        stats.frameAllocs = s.allocs - allocs;
+        stats.frameAllocBytes = s.allocBytes - allocBytes;
+        stats.liveBytes = s.liveBytes;
+        stats.failed = !ok;
+    }
+#else
+    (void)world, (void)frameSeconds;
+#endif
+}
+
+void LuaHost::End(ecs::World& world)
+{
+    if (!running_) return;
+    scripts_.clear(); // статистику оставляем панели до следующего Play
+    if (snapshot_) snapshot_->Restore(world);
+    snapshot_.reset();
+    running_ = false;
+}
+
+} // namespace dancore::scripting
@@ -0,0 +1,57 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "core/Ecs.hpp"
+#include "scripting/common/ScriptStats.hpp"
+
+// Скрипты Lua в режиме Play. Скрипт — система: файл возвращает таблицу
+//
+//   local spin = { components = { Rotation } }
+//   function spin.update(dt, n, entities, rotation)  -- раз на чанк, n сущностей
+//       rotation:add(nil, 90 * dt, nil)               -- пакетно, без цикла в Lua
+//   end
+//   function spin.frame(dt) end                        -- раз в кадр, по желанию
+//   return spin
+//
+// update получает столбцы чанка (col:get(i) / col:set(i, ...) / #col и для числовых
+// компонентов fill/add/mul/add_scaled на все строки сразу); scene.get(entity, Position)
+// даёт ссылку на один компонент с полями p.x. Структуру мира скрипты не меняют.
+//
+// У каждого скрипта своя виртуальная машина: его время и выделения памяти считаются
+// отдельно (Stats() -> панель Scripts). Ошибка выключает скрипт до следующего Play.
+// Без Lua в сборке (DANCORE_HAS_LUA) скрипты не загружаются, об этом пишется в лог.
+
+namespace dancore::scripting {
+
+class LuaHost {
+public:
+    LuaHost();
+    ~LuaHost();
+    LuaHost(const LuaHost&) = delete;
+    LuaHost& operator=(const LuaHost&) = delete;
+
+    // Play: запомнить видимые скриптам компоненты, End вернёт их
+    void Begin(core::ecs::World& world);
+    // Все *.lua каталога (рекурсивно, по имени); ошибки — в лог и в Stats()
+    void LoadDirectory(const std::filesystem::path& directory);
+    bool Load(std::string_view name, std::string_view source);
+    void Update(core::ecs::World& world, double frameSeconds);
+    void End(core::ecs::World& world);
+
+    bool Running() const { return running_; }
+    const std::vector<ScriptStats>& Stats() const { return stats_; }
+
+private:
+    struct Script;
+    struct Snapshot;
+
+    std::vector<std::unique_ptr<Script>> scripts_;
+    std::vector<ScriptStats> stats_;
+    std::unique_ptr<Snapshot> snapshot_;
+    bool running_ = false;
+};
+
+} // namespace dancore::scripting
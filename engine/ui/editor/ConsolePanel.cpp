@@ -0,0 +1,206 @@
+#include "ConsolePanel.hpp"
+#include "core/Log.hpp"
+#include "core/Profiler.hpp"
+
+#include <imgui.h>
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace dancore::ui {
+
+namespace log = dancore::core::log;
+namespace prof = dancore::core::profiler;
+
+namespace {
+
+constexpr prof::Clock kScanBudgetNs = 500'000; // на фильтрацию за кадр
+
+struct Filter {
+    uint32_t levels = ~0u & ~(1u << uint32_t(log::Level::Trace));
+    uint32_t categories = ~0u;
+    std::string search; // в нижнем регистре
+
+    // this отбирает подмножество строк old: достаточно перепроверить старые совпадения
+    bool Narrows(const Filter& old) const
+    {
+        return (levels & ~old.levels) == 0 && (categories & ~old.categories) == 0 &&
+               search.find(old.search) != std::string::npos;
+    }
+    bool operator==(const Filter&) const = default;
+};
+
+struct ConsoleState {
+    Filter filter, applied;
+    char searchBuf[256] = "";
+    std::vector<uint64_t> rows;     // прошедшие фильтр, по возрастанию
+    std::vector<uint64_t> recheck;  // сужение фильтра: старые строки на перепроверку
+    size_t recheckPos = 0;
+    uint64_t next = 0;              // следующая непросмотренная запись журнала
+    bool autoScroll = true;
+    std::string text;               // буфер форматирования
+};
+
+ConsoleState s;
+
+bool ContainsLower(const std::string& hay, const std::string& needle)
+{
+    if (needle.empty()) return true;
+    auto it = std::search(hay.begin(), hay.end(), needle.begin(), needle.end(),
+                          [](char a, char b) { return std::tolower((unsigned char)a) == b; });
+    return it != hay.end();
+}
+
+// Уровень и категория — по компактной записи, текст форматируется только для поиска
+bool Matches(uint64_t index)
+{
+    const log::Record& r = log::At(index);
+    if (!(s.applied.levels >> uint32_t(r.site->level) & 1) || !(s.applied.categories >> uint32_t(r.site->category) & 1))
+        return false;
+    if (s.applied.search.empty()) return true;
+    log::Format(index, s.text);
+    return ContainsLower(s.text, s.applied.search);
+}
+
+// Возвращает true, когда всё просмотрено
+bool Scan()
+{
+    DC_PROFILE_ZONE("Console::Scan");
+    uint64_t first = log::First(), end = log::End();
+    // вытесненные и очищенные записи
+    if (!s.rows.empty() && s.rows.front() < first)
+        s.rows.erase(s.rows.begin(), std::lower_bound(s.rows.begin(), s.rows.end(), first));
+    s.next = std::max(s.next, first);
+
+    prof::Clock deadline = prof::Now() + kScanBudgetNs;
+    uint32_t n = 0;
+    auto outOfTime = [&] { return (++n & 255) == 0 && prof::Now() > deadline; };
+    for (; s.recheckPos < s.recheck.size(); ++s.recheckPos) {
+        if (outOfTime()) return false;
+        uint64_t i = s.recheck[s.recheckPos];
+        if (i >= first && Matches(i)) s.rows.push_back(i);
+    }
+    s.recheck.clear();
+    s.recheckPos = 0;
+    for (; s.next < end; ++s.next) {
+        if (outOfTime()) return false;
+        if (Matches(s.next)) s.rows.push_back(s.next);
+    }
+    return true;
+}
+
+void Apply()
+{
+    if (s.filter == s.applied) return;
+    if (s.filter.Narrows(s.applied)) {
+        // "tex" -> "text": перепроверяем только уже найденное, новое дочитается как обычно.
+        // Недоперепроверенный хвост прошлого сужения тоже остаётся: его индексы больше
+        // всех в rows, так что список по-прежнему по возрастанию
+        std::vector<uint64_t> pending = std::move(s.rows);
+        pending.insert(pending.end(), s.recheck.begin() + std::ptrdiff_t(s.recheckPos), s.recheck.end());
+        s.recheck = std::move(pending);
+        s.recheckPos = 0;
+    } else {
+        s.recheck.clear();
+        s.recheckPos = 0;
+        s.next = log::First();
+    }
+    s.rows.clear();
+    s.applied = s.filter;
+}
+
+ImVec4 LevelColor(log::Level l)
+{
+    switch (l) {
+    case log::Level::Trace: return ImVec4(0.55f, 0.55f, 0.55f, 1);
+    case log::Level::Warn:  return ImVec4(1.0f, 0.8f, 0.3f, 1);
+    case log::Level::Error: return ImVec4(1.0f, 0.3f, 0.3f, 1);
+    default:                return ImVec4(0.85f, 0.85f, 0.85f, 1);
+    }
+}
+
+void LevelToggle(log::Level l)
+{
+    uint32_t bit = 1u << uint32_t(l);
+    bool on = s.filter.levels & bit;
+    char label[48];
+    std::snprintf(label, sizeof(label), "%s (%llu)", log::LevelName(l), (unsigned long long)log::Count(l));
+    ImGui::PushStyleColor(ImGuiCol_Text, LevelColor(l));
+    if (ImGui::Checkbox(label, &on)) s.filter.levels = on ? s.filter.levels | bit : s.filter.levels & ~bit;
+    ImGui::PopStyleColor();
+    ImGui::SameLine();
+}
+
+} // namespace
+
+unsigned DrawConsole(bool& open)
+{
+    if (!open) return 0;
+    ImGui::Begin("Console", &open, ImGuiWindowFlags_NoCollapse);
+    unsigned dock = ImGui::GetWindowDockID();
+
+    // --- Панель фильтров ---
+    if (ImGui::Button("Clear")) log::Clear();
+    ImGui::SameLine();
+    for (uint32_t l = 0; l < uint32_t(log::Level::Count); ++l) LevelToggle(log::Level(l));
+    ImGui::SetNextItemWidth(110.0f);
+    if (ImGui::BeginCombo("##categories", "Categories")) {
+        for (uint32_t c = 0; c < uint32_t(log::Category::Count); ++c) {
+            bool on = s.filter.categories >> c & 1;
+            if (ImGui::Checkbox(log::CategoryName(log::Category(c)), &on))
+                s.filter.categories = on ? s.filter.categories | (1u << c) : s.filter.categories & ~(1u << c);
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(std::max(120.0f, ImGui::GetContentRegionAvail().x - 110.0f));
+    if (ImGui::InputTextWithHint("##search", "Search", s.searchBuf, sizeof(s.searchBuf))) {
+        s.filter.search = s.searchBuf;
+        for (char& c : s.filter.search) c = (char)std::tolower((unsigned char)c);
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("Follow", &s.autoScroll);
+
+    Apply();
+    bool complete = Scan();
+    if (!complete || log::Dropped()) {
+        uint64_t total = log::End() - log::First();
+        if (!complete)
+            ImGui::TextDisabled("Filtering... %.0f%%", total ? 100.0 * double(s.next - log::First()) / double(total) : 100.0);
+        if (log::Dropped()) {
+            if (!complete) ImGui::SameLine();
+            ImGui::TextDisabled("%llu messages dropped (ring overflow)", (unsigned long long)log::Dropped());
+        }
+    }
+    ImGui::Separator();
+
+    // --- Строки: только видимые ---
+    ImGui::BeginChild("##log", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+    ImGuiListClipper clipper;
+    clipper.Begin((int)s.rows.size());
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            uint64_t i = s.rows[(size_t)row];
+            const log::Record& r = log::At(i);
+            log::Format(i, s.text);
+            ImGui::PushStyleColor(ImGuiCol_Text, LevelColor(r.site->level));
+            ImGui::Text("%9.3f [%s] [%s] %s", double(r.time) / 1e9, log::LevelName(r.site->level),
+                        log::CategoryName(r.site->category), s.text.c_str());
+            ImGui::PopStyleColor();
+            if (ImGui::IsItemHovered())
+                ImGui::SetTooltip("%s:%u\nthread %u", r.site->file, r.site->line, (unsigned)r.thread);
+        }
+    }
+    clipper.End();
+    if (s.autoScroll && ImGui::GetScrollY() >= ImGui::GetScrollMaxY() - 1.0f) ImGui::SetScrollHereY(1.0f);
+    ImGui::EndChild();
+
+    ImGui::End();
+    return dock;
+}
+
+} // namespace dancore::ui
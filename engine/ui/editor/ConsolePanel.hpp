@@ -0,0 +1,11 @@
+#pragma once
+
+// Окно "Console": записи core::log с фильтрами по уровню и категории и поиском по тексту.
+// Рисуются только видимые строки; фильтрация идёт порциями по времени, кадр не ждёт её конца.
+
+namespace dancore::ui {
+
+// Возвращает dock id окна (0 — окно закрыто)
+unsigned DrawConsole(bool& open);
+
+} // namespace dancore::ui
@@ -1,5 +1,18 @@
 #include "EditorUI.hpp"
+#include "ConsolePanel.hpp"
+#include "MemoryPanel.hpp"
+#include "ProfilerPanel.hpp"
+#include "ScriptsPanel.hpp"
+#include "core/Profiler.hpp"
+#include "core/SceneComponents.hpp"
+#include "core/UndoJournal.hpp"
+#include "resources/ContentIndex.hpp"
 #include <imgui.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace dancore::ui {
 
@@ -35,6 +48,54 @@ static void EndDockspace()
     ImGui::End(); // ##DockSpaceHost
 }
 
+// Поиск по индексу Content/: запрос заново только при смене текста или индекса
+static void DrawSearch(EditorState& state)
+{
+    static char search[128] = {};
+    static std::vector<uint32_t> results;
+    static uint64_t version = 0;
+    bool changed = ImGui::InputTextWithHint("##Search", "Search assets/objects...", search, IM_ARRAYSIZE(search));
+    bool active = ImGui::IsItemActive();
+    ImVec2 below(ImGui::GetItemRectMin().x, ImGui::GetItemRectMax().y);
+    resources::ContentIndex* index = state.content;
+    if (!index || !index->Ready()) return;
+    if (changed || version != index->Version()) {
+        index->Search(search, 50, results);
+        version = index->Version();
+    }
+    // обычное окно, а не popup: popup забрал бы фокус у поля ввода
+    static bool shown = false;
+    shown = search[0] && (active || shown);
+    if (!shown) return;
+    ImGui::SetNextWindowPos(below);
+    ImGui::SetNextWindowSizeConstraints(ImVec2(320, 0), ImVec2(640, 400));
+    ImGui::Begin("##SearchResults", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoMove |
+                 ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoDocking |
+                 ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_AlwaysAutoResize);
+    if (results.empty()) ImGui::TextDisabled("No matches");
+    bool picked = false;
+    for (uint32_t id : results) {
+        std::string path(index->Path(id));
+        ImGui::PushID((int)id);
+        if (ImGui::Selectable(path.c_str(), state.selected_asset == path)) {
+            state.selected_asset = path;
+            state.show_file_explorer = true;
+            picked = true;
+        }
+        ImGui::PopID();
+    }
+    bool keep = ImGui::IsWindowHovered() || ImGui::IsWindowFocused();
+    ImGui::End();
+    shown = !picked && (active || keep);
+}
+
+// Журнал правок вне Play. Отмена — XOR-дельта и верна, только пока значение равно записанному;
+// в Play позы пишут физика и скрипты, а Stop возвращает прежние — правки Play не журналируются
+static core::UndoJournal* Journal(const EditorState& state) { return state.play_mode ? nullptr : state.journal; }
+
+static bool CanUndo(const EditorState& state) { return state.world && Journal(state) && state.journal->CanUndo(); }
+static bool CanRedo(const EditorState& state) { return state.world && Journal(state) && state.journal->CanRedo(); }
+
 // Верхнее меню + тулбар (Undo/Redo, Play/Pause/Stop, EditMode, Поиск, Лого)
 static void DrawMainMenuAndToolbar(EditorState& state)
 {
@@ -46,18 +107,19 @@ static void DrawMainMenuAndToolbar(EditorState& state)
             ImGui::MenuItem("Open Project...");
             ImGui::Separator();
             ImGui::MenuItem("New Scene");
-            ImGui::MenuItem("Save Scene", "Ctrl+S");
-            ImGui::MenuItem("Save All", "Ctrl+Alt+S");
+            if (ImGui::MenuItem("Save Scene", "Ctrl+S", false, state.world != nullptr)) state.save_scene = true;
+            if (ImGui::MenuItem("Save All", "Ctrl+Alt+S", false, state.world != nullptr)) state.save_scene = true;
             ImGui::Separator();
             if (ImGui::BeginMenu("Import")) {
-                ImGui::MenuItem("Model (.gltf/.glb)");
-                ImGui::MenuItem("Texture (.png/.ktx2)");
+                if (ImGui::MenuItem("Model (.gltf/.glb)", nullptr, false, !state.importing)) state.import_models = true;
+                if (ImGui::MenuItem("Texture (.png/.ktx2)", nullptr, false, !state.importing)) state.import_textures = true;
                 ImGui::MenuItem("Audio (.ogg/.opus)");
                 ImGui::MenuItem("Shader (HLSL)");
                 ImGui::EndMenu();
             }
             if (ImGui::BeginMenu("Export")) {
-                ImGui::MenuItem("Package (.pak)...");
+                if (ImGui::MenuItem("Package (.pak)...", nullptr, false, !state.exporting_pak)) state.export_pak = true;
+                if (ImGui::MenuItem("Scene as Text (.txt)", nullptr, false, state.world != nullptr)) state.export_scene_text = true;
                 ImGui::MenuItem("Scene as Template...");
                 ImGui::EndMenu();
             }
@@ -69,8 +131,11 @@ static void DrawMainMenuAndToolbar(EditorState& state)
         }
         if (ImGui::BeginMenu("Edit"))
         {
-            ImGui::MenuItem("Undo", "Ctrl+Z");
-            ImGui::MenuItem("Redo", "Ctrl+Y");
+            // "###" — id пункта не зависит от подписи правки
+            std::string undo = std::string("Undo ") + (CanUndo(state) ? state.journal->UndoLabel() : "") + "###Undo";
+            std::string redo = std::string("Redo ") + (CanRedo(state) ? state.journal->RedoLabel() : "") + "###Redo";
+            if (ImGui::MenuItem(undo.c_str(), "Ctrl+Z", false, CanUndo(state))) state.journal->Undo(*state.world);
+            if (ImGui::MenuItem(redo.c_str(), "Ctrl+Y", false, CanRedo(state))) state.journal->Redo(*state.world);
             ImGui::Separator();
             ImGui::MenuItem("Duplicate", "Ctrl+D");
             ImGui::MenuItem("Delete", "Del");
@@ -103,6 +168,9 @@ static void DrawMainMenuAndToolbar(EditorState& state)
             ImGui::MenuItem("Console", nullptr, &state.show_console);
             ImGui::MenuItem("File Explorer", nullptr, &state.show_file_explorer);
             ImGui::MenuItem("Inspector", nullptr, &state.show_inspector);
+            ImGui::MenuItem("Profiler", nullptr, &state.show_profiler);
+            ImGui::MenuItem("GPU Memory", nullptr, &state.show_memory);
+            ImGui::MenuItem("Scripts", nullptr, &state.show_scripts);
             ImGui::EndMenu();
         }
         if (ImGui::BeginMenu("Help"))
@@ -114,9 +182,9 @@ static void DrawMainMenuAndToolbar(EditorState& state)
 
         // --- Тулбар справа: Undo/Redo, Play/Pause/Stop, Edit Mode, Search, Лого ---
         ImGui::Separator();
-        if (ImGui::SmallButton("↶")) { /* Undo */ }
+        if (ImGui::SmallButton("↶") && CanUndo(state)) state.journal->Undo(*state.world);
         ImGui::SameLine();
-        if (ImGui::SmallButton("↷")) { /* Redo */ }
+        if (ImGui::SmallButton("↷") && CanRedo(state)) state.journal->Redo(*state.world);
         ImGui::SameLine();
         ImGui::Separator();
 
@@ -124,9 +192,9 @@ static void DrawMainMenuAndToolbar(EditorState& state)
         if (!state.play_mode) {
             if (ImGui::SmallButton("▶ Play")) state.play_mode = true;
         } else {
-            if (ImGui::SmallButton("⏹ Stop")) state.play_mode = false;
+            if (ImGui::SmallButton("⏹ Stop")) state.play_mode = state.play_paused = false;
             ImGui::SameLine();
-            if (ImGui::SmallButton("⏸ Pause")) { /* pause */ }
+            if (ImGui::SmallButton(state.play_paused ? "▶ Resume" : "⏸ Pause")) state.play_paused = !state.play_paused;
         }
 
         ImGui::SameLine();
@@ -135,9 +203,18 @@ static void DrawMainMenuAndToolbar(EditorState& state)
         ImGui::Combo("##EditMode", &state.edit_mode, modes, IM_ARRAYSIZE(modes));
 
         ImGui::SameLine();
-        static char search[128] = {};
         ImGui::SetNextItemWidth(200);
-        ImGui::InputTextWithHint("##Search", "Search assets/objects...", search, IM_ARRAYSIZE(search));
+        DrawSearch(state);
+
+        if (state.importing) {
+            ImGui::SameLine();
+            char label[64];
+            std::snprintf(label, sizeof(label), "Import %u/%u", state.import_done, state.import_total);
+            float fraction = state.import_total ? float(state.import_done) / float(state.import_total) : 0.0f;
+            ImGui::ProgressBar(fraction, ImVec2(160, 0), label);
+            if (ImGui::IsItemHovered())
+                ImGui::SetTooltip("%u from the derived-data cache, %u failed (see Console)", state.import_cached, state.import_failed);
+        }
 
         ImGui::SameLine();
         if (ImGui::BeginMenu("Dancore ▾")) {
@@ -150,17 +227,37 @@ static void DrawMainMenuAndToolbar(EditorState& state)
 
         ImGui::EndMenuBar();
     }
+    // Ctrl+S и Ctrl+Alt+S из подписей меню (Save All пока сохраняет только сцену)
+    const ImGuiIO& io = ImGui::GetIO();
+    if (state.world && io.KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_S, false)) state.save_scene = true;
+    // в поле ввода Ctrl+Z — его собственная отмена
+    if (io.KeyCtrl && !io.WantTextInput) {
+        if (ImGui::IsKeyPressed(ImGuiKey_Z) && !io.KeyShift && CanUndo(state)) state.journal->Undo(*state.world);
+        if ((ImGui::IsKeyPressed(ImGuiKey_Y) || (io.KeyShift && ImGui::IsKeyPressed(ImGuiKey_Z))) && CanRedo(state))
+            state.journal->Redo(*state.world);
+    }
+}
+
+namespace scene = dancore::core::scene;
+
+// Кнопка инструмента: активный подсвечен
+static void ToolButton(EditorState& state, const char* label, Tool tool)
+{
+    bool active = state.tool == tool;
+    if (active) ImGui::PushStyleColor(ImGuiCol_Button, ImGui::GetStyleColorVec4(ImGuiCol_ButtonActive));
+    if (ImGui::Button(label)) state.tool = tool;
+    if (active) ImGui::PopStyleColor();
 }
 
 // Левая колонка: инструменты (Select/Move/Rotate/Scale/…)
-static void DrawToolbox()
+static void DrawToolbox(EditorState& state)
 {
     ImGui::Begin("Toolbox", nullptr, ImGuiWindowFlags_NoCollapse);
     ImGui::TextUnformatted("Tools");
-    if (ImGui::Button("Select")) {}
-    if (ImGui::Button("Move  ⭢")) {}     // стрелки во все стороны — иконки добавим позже
-    if (ImGui::Button("Rotate ⟳")) {}
-    if (ImGui::Button("Scale  ⤢")) {}
+    ToolButton(state, "Select", Tool::Select);
+    ToolButton(state, "Move  ⭢", Tool::Move);     // стрелки во все стороны — иконки добавим позже
+    ToolButton(state, "Rotate ⟳", Tool::Rotate);
+    ToolButton(state, "Scale  ⤢", Tool::Scale);
     ImGui::Separator();
     if (ImGui::Button("Camera")) {}
     if (ImGui::Button("Voxel")) {}
@@ -168,51 +265,249 @@ static void DrawToolbox()
     ImGui::End();
 }
 
-// Центр: Viewport (пока просто окно-плейсхолдер)
-static void DrawViewport()
+// Запись компонента с отметкой в журнале правок; mergeKey != 0 — продолжение той же правки
+template <class T>
+static void SetComponent(EditorState& state, core::ecs::Entity e, const T& value, const char* label, uint64_t mergeKey)
+{
+    T* dst = state.world->Get<T>(e);
+    if (core::UndoJournal* journal = Journal(state)) journal->Change(e, *dst, value, label, mergeKey);
+    *dst = value;
+}
+
+// Перетаскивание мышью во вьюпорте применяет активный инструмент к выделенной сущности
+static void ApplyTool(EditorState& state, ImVec2 delta)
 {
-    ImGui::Begin("Viewport", nullptr, ImGuiWindowFlags_NoCollapse);
-    ImGui::TextDisabled("Viewport: здесь будет отрисовка Vulkan.");
-    ImGui::Dummy(ImVec2(0, 400)); // заглушка высоты
+    const core::ecs::World& w = *state.world;
+    core::ecs::Entity e = state.selected;
+    // один жест — одна запись журнала, её закрывает отпускание кнопки
+    uint64_t key = uint64_t(uint32_t(state.tool) + 1) << 32 | e.index;
+    switch (state.tool) {
+    case Tool::Select:
+        break;
+    case Tool::Move:
+        if (const auto* cur = w.Get<scene::Position>(e)) {
+            scene::Position p = *cur;
+            p.x += delta.x * 0.01f;
+            p.y -= delta.y * 0.01f;
+            SetComponent(state, e, p, "Move", key);
+        }
+        break;
+    case Tool::Rotate:
+        if (const auto* cur = w.Get<scene::Rotation>(e)) {
+            scene::Rotation r = *cur;
+            r.y += delta.x * 0.5f;
+            r.x += delta.y * 0.5f;
+            SetComponent(state, e, r, "Rotate", key);
+        }
+        break;
+    case Tool::Scale:
+        if (const auto* cur = w.Get<scene::Scale>(e)) {
+            scene::Scale s = *cur;
+            float k = 1.0f + delta.x * 0.005f;
+            s.x = std::clamp(s.x * k, 0.01f, 100.0f);
+            s.y = std::clamp(s.y * k, 0.01f, 100.0f);
+            s.z = std::clamp(s.z * k, 0.01f, 100.0f);
+            SetComponent(state, e, s, "Scale", key);
+        }
+        break;
+    }
+}
+
+// Центр: Viewport — список сущностей слева, картинка сцены от бэкенда справа.
+// ПКМ — вращение камеры, колесо — приближение, ЛКМ — выбор и текущий инструмент
+static void DrawViewport(EditorState& state)
+{
+    state.viewport_width = state.viewport_height = 0;
+    state.viewport_markers.clear();
+    state.viewport_hash = 0;
+    bool visible = ImGui::Begin("Viewport", nullptr, ImGuiWindowFlags_NoCollapse);
+    if (!state.world) {
+        ImGui::TextDisabled("Viewport: сцена не загружена.");
+        ImGui::Dummy(ImVec2(0, 400)); // заглушка высоты
+        ImGui::End();
+        return;
+    }
+    if (!visible) { ImGui::End(); return; }
+    core::ecs::World& w = *state.world;
+    if (!w.Alive(state.selected)) state.selected = {};
+    ImGui::Text("Entities: %u", w.Count());
+
+    ImGui::BeginChild("##entities", ImVec2(220, 0), true);
+    // сотни тысяч объектов: рисуем только видимые строки
+    ImGuiListClipper clipper;
+    clipper.Begin((int)w.Count());
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+            core::ecs::Entity e = w.At((uint32_t)i);
+            const scene::Name* name = std::as_const(w).Get<scene::Name>(e); // чтение не помечает чанк для сохранения
+            ImGui::PushID((int)e.index);
+            if (ImGui::Selectable(name && name->value[0] ? name->value : "<unnamed>", e == state.selected))
+                state.selected = e;
+            ImGui::PopID();
+        }
+    }
+    ImGui::EndChild();
+
+    ImGui::SameLine();
+    ImGui::BeginChild("##scene", ImVec2(0, 0), false, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 size = ImGui::GetContentRegionAvail();
+    size.x = std::max(size.x, 1.0f);
+    size.y = std::max(size.y, 1.0f);
+    ImGui::InvisibleButton("##view", size, ImGuiButtonFlags_MouseButtonLeft | ImGuiButtonFlags_MouseButtonRight);
+    const ImGuiIO& io = ImGui::GetIO();
+    // инструмент — только жест, начатый на картинке: не список сущностей, не его полоса прокрутки, не другая панель
+    const bool viewActive = ImGui::IsItemActive();
+    if (viewActive && ImGui::IsMouseDragging(ImGuiMouseButton_Right))
+        state.camera.Orbit(-io.MouseDelta.x * 0.3f, io.MouseDelta.y * 0.3f);
+    if (ImGui::IsItemHovered() && io.MouseWheel != 0.0f) state.camera.Zoom(io.MouseWheel);
+
+    state.viewport_width = (uint32_t)size.x;
+    state.viewport_height = (uint32_t)size.y;
+    state.viewport_hash = graphics::BuildViewportMarkers(w, state.camera, state.viewport_width, state.viewport_height,
+                                                         state.selected, state.viewport_markers);
+    if (ImGui::IsItemClicked(ImGuiMouseButton_Left))
+        state.selected = graphics::PickViewportMarker(state.viewport_markers, io.MousePos.x - origin.x, io.MousePos.y - origin.y);
+
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+    ImVec2 end(origin.x + size.x, origin.y + size.y);
+    // первый кадр и кадр после смены размера: картинки этого размера ещё нет, растягиваем прошлую
+    if (state.viewport_texture) dl->AddImage((ImTextureID)state.viewport_texture, origin, end);
+    else dl->AddRectFilled(origin, end, IM_COL32(20, 22, 25, 255));
+    ImGui::EndChild();
+
+    if (state.selected && viewActive && ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+        ApplyTool(state, io.MouseDelta);
+    }
+    if (state.journal && ImGui::IsMouseReleased(ImGuiMouseButton_Left)) state.journal->Seal();
     ImGui::End();
 }
 
-// Нижний проводник (File Explorer)
-static void DrawFileExplorer(bool& open)
+// Каталог проводника: узлы раскрываются лениво, файлы — только видимые строки
+static void DrawContentDir(EditorState& state, const resources::ContentIndex& index, uint32_t dir)
 {
-    if (!open) return;
-    ImGui::Begin("File Explorer", &open, ImGuiWindowFlags_NoCollapse);
-    ImGui::TextUnformatted("Content/");
-    ImGui::BulletText("Scenes/");
-    ImGui::BulletText("Scripts/  (Lua, Python)");
-    ImGui::BulletText("UI/      (HTML/CSS/JS)");
-    ImGui::BulletText("Assets/  (Models, Textures, Audio)");
-    ImGui::BulletText("Shaders/");
+    const std::vector<uint32_t>& children = index.Children(dir);
+    // сначала подкаталоги, затем файлы
+    size_t files = std::partition_point(children.begin(), children.end(),
+                                        [&](uint32_t id) { return index.Get(id).directory; }) - children.begin();
+    for (size_t i = 0; i < files; ++i) {
+        uint32_t id = children[i];
+        std::string name(index.Name(id));
+        ImGui::PushID((int)id);
+        if (ImGui::TreeNodeEx(name.c_str(), ImGuiTreeNodeFlags_OpenOnArrow)) {
+            DrawContentDir(state, index, id);
+            ImGui::TreePop();
+        }
+        ImGui::PopID();
+    }
+    ImGuiListClipper clipper;
+    clipper.Begin((int)(children.size() - files));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            uint32_t id = children[files + (size_t)row];
+            std::string name(index.Name(id));
+            ImGui::PushID((int)id);
+            ImGui::Indent();
+            if (ImGui::Selectable(name.c_str(), state.selected_asset == index.Path(id))) state.selected_asset = index.Path(id);
+            if (ImGui::IsItemHovered())
+                ImGui::SetTooltip("%.*s\n%llu bytes", (int)index.Path(id).size(), index.Path(id).data(),
+                                  (unsigned long long)index.Get(id).size);
+            ImGui::Unindent();
+            ImGui::PopID();
+        }
+    }
+    clipper.End();
+}
+
+// Нижний проводник (File Explorer) по фоновому индексу: файловую систему здесь не трогаем
+static void DrawFileExplorer(EditorState& state)
+{
+    if (!state.show_file_explorer) return;
+    ImGui::Begin("File Explorer", &state.show_file_explorer, ImGuiWindowFlags_NoCollapse);
     if (ImGui::Button("New Scene")) {}
     ImGui::SameLine();
-    if (ImGui::Button("New Script (Lua)")) {}
+    if (ImGui::Button("New Script (Lua)")) state.new_script = true;
     ImGui::SameLine();
     if (ImGui::Button("Import...")) {}
+
+    resources::ContentIndex* index = state.content;
+    if (!index || !index->Ready()) {
+        ImGui::TextDisabled("Content/  (indexing...)");
+        ImGui::End();
+        return;
+    }
+    ImGui::SameLine();
+    ImGui::TextDisabled("%u items%s", index->Count(), index->Scanning() ? ", scanning..." : "");
+    if (!state.selected_asset.empty()) {
+        ImGui::SameLine();
+        ImGui::Text("| %s", state.selected_asset.c_str());
+    }
+    ImGui::Separator();
+
+    ImGui::BeginChild("##content", ImVec2(0, 0), false);
+    if (uint32_t root = index->Root(); root != resources::ContentIndex::kNone &&
+        ImGui::TreeNodeEx("Content/", ImGuiTreeNodeFlags_DefaultOpen)) {
+        DrawContentDir(state, *index, root);
+        ImGui::TreePop();
+    }
+    ImGui::EndChild();
     ImGui::End();
 }
 
+// Неконстантный Get помечает чанк изменённым (инкрементальное сохранение сцены),
+// поэтому виджет правит копию, а в чанк и журнал она идёт, только если виджет её изменил.
+// Пока виджет активен (тянут, печатают), правки сливаются в одну запись журнала
+template <class T, class F>
+static void EditComponent(EditorState& state, core::ecs::Entity e, const char* label, F&& edit)
+{
+    const T* current = std::as_const(*state.world).Get<T>(e);
+    if (!current) return;
+    T copy = *current;
+    if (edit(copy))
+        SetComponent(state, e, copy, label, ImGui::IsItemActive() ? uint64_t(ImGui::GetItemID()) << 32 | e.index : 0);
+    if (state.journal && ImGui::IsItemDeactivated()) state.journal->Seal();
+}
+
 // Правая нижняя: Inspector
-static void DrawInspector(bool& open)
+static void DrawInspector(EditorState& state)
 {
-    if (!open) return;
-    ImGui::Begin("Inspector", &open, ImGuiWindowFlags_NoCollapse);
+    if (!state.show_inspector) return;
+    ImGui::Begin("Inspector", &state.show_inspector, ImGuiWindowFlags_NoCollapse);
+    core::ecs::World* w = state.world;
+    if (!w || !w->Alive(state.selected)) {
+        ImGui::TextDisabled("Nothing selected.");
+        ImGui::End();
+        return;
+    }
+    // компоненты правим копией и пишем в чанк только при изменении
+    core::ecs::Entity e = state.selected;
+    EditComponent<scene::Name>(state, e, "Rename", [](scene::Name& n) { return ImGui::InputText("Name", n.value, sizeof(n.value)); });
+
     ImGui::TextUnformatted("Transform");
     ImGui::Separator();
-    static float pos[3] = {0,0,0}, rot[3] = {0,0,0}, scl[3] = {1,1,1};
-    ImGui::DragFloat3("Position", pos, 0.1f);
-    ImGui::DragFloat3("Rotation", rot, 0.5f);
-    ImGui::DragFloat3("Scale", scl, 0.01f, 0.01f, 100.0f);
+    EditComponent<scene::Position>(state, e, "Edit Position", [](scene::Position& p) { return ImGui::DragFloat3("Position", &p.x, 0.1f); });
+    EditComponent<scene::Rotation>(state, e, "Edit Rotation", [](scene::Rotation& r) { return ImGui::DragFloat3("Rotation", &r.x, 0.5f); });
+    EditComponent<scene::Scale>(state, e, "Edit Scale", [](scene::Scale& s) { return ImGui::DragFloat3("Scale", &s.x, 0.01f, 0.01f, 100.0f); });
 
     ImGui::Separator();
     ImGui::TextUnformatted("Physics");
-    static int mode = 0; // 0 Rigid, 1 Voxel
-    ImGui::RadioButton("Rigid", &mode, 0); ImGui::SameLine();
-    ImGui::RadioButton("Voxel", &mode, 1);
+    if (w->Has<scene::PhysicsBody>(e)) {
+        EditComponent<scene::PhysicsBody>(state, e, "Edit Physics", [](scene::PhysicsBody& body) {
+            int mode = body.mode;
+            bool changed = ImGui::RadioButton("Rigid", &mode, scene::PhysicsBody::Rigid); ImGui::SameLine();
+            changed |= ImGui::RadioButton("Voxel", &mode, scene::PhysicsBody::Voxel);
+            body.mode = (uint8_t)mode;
+            return changed;
+        });
+        if (ImGui::SmallButton("Remove Physics")) {
+            if (core::UndoJournal* journal = Journal(state))
+                journal->Removed(e, core::ecs::ComponentIdOf<scene::PhysicsBody>(), w->Get<scene::PhysicsBody>(e), "Remove Physics");
+            w->Remove<scene::PhysicsBody>(e);
+        }
+    } else if (ImGui::SmallButton("Add Physics")) {
+        scene::PhysicsBody& body = w->Add<scene::PhysicsBody>(e);
+        if (core::UndoJournal* journal = Journal(state)) journal->Added(e, core::ecs::ComponentIdOf<scene::PhysicsBody>(), &body, "Add Physics");
+    }
 
     ImGui::Separator();
     ImGui::TextUnformatted("Scripts");
@@ -220,29 +515,25 @@ static void DrawInspector(bool& open)
     ImGui::End();
 }
 
-// Консоль
-static void DrawConsole(bool& open)
-{
-    if (!open) return;
-    ImGui::Begin("Console", &open, ImGuiWindowFlags_NoCollapse);
-    ImGui::TextDisabled("[Info] Editor started.");
-    ImGui::TextDisabled("[Warn] Example warning.");
-    ImGui::TextColored(ImVec4(1,0.3f,0.3f,1), "[Error] Example error.");
-    if (ImGui::Button("Clear")) {}
-    ImGui::End();
-} 
+static ImGuiID s_console_dock = 0; // сюда по умолчанию пристыковывается Profiler
 
 void DrawEditorUI(EditorState& state)
 {
+    DC_PROFILE_ZONE("DrawEditorUI");
     BeginDockspace();
     DrawMainMenuAndToolbar(state);
 
     // Окна (их расположение и докинг пользователь сохранит/сбросит)
-    DrawToolbox();               // слева
-    DrawViewport();              // центр
-    DrawFileExplorer(state.show_file_explorer); // низ
-    DrawInspector(state.show_inspector);        // право-низ
-    DrawConsole(state.show_console);            // низ
+    DrawToolbox(state);          // слева
+    DrawViewport(state);         // центр
+    DrawFileExplorer(state);                    // низ
+    DrawInspector(state);                       // право-низ
+    if (ImGuiID dock = DrawConsole(state.show_console)) s_console_dock = dock; // низ
+    if (state.show_profiler && s_console_dock)
+        ImGui::SetNextWindowDockID(s_console_dock, ImGuiCond_FirstUseEver);
+    DrawProfiler(state.show_profiler, state.frames_rendered, state.frames_skipped); // вкладкой рядом с консолью
+    DrawMemory(state.show_memory, state.memory); // плавающее
+    DrawScripts(state.show_scripts, state.scripts); // плавающее
 
     EndDockspace();
 }
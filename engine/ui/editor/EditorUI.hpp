@@ -3,14 +3,76 @@
 // Чистый интерфейс отрисовки редактора (только ImGui-вызовы).
 // Вызывается после Begin/End кадра ImGui в твоём бэкенде (Vulkan/и т.д.)
 
+#include "core/Ecs.hpp"
+#include "graphics/MemoryStats.hpp"
+#include "graphics/ViewportScene.hpp"
+#include "scripting/common/ScriptStats.hpp"
+#include <string>
+#include <vector>
+
+namespace dancore::core { class UndoJournal; }
+namespace dancore::resources { class ContentIndex; }
+
 namespace dancore::ui {
 
+enum class Tool { Select, Move, Rotate, Scale };
+
 struct EditorState {
     bool show_console = true;
     bool show_file_explorer = true;
     bool show_inspector = true;
+    bool show_profiler = false;
+    bool show_memory = false;
+    bool show_scripts = false;
     bool play_mode = false;
+    bool play_paused = false; // в Play: симуляция стоит, сцена остаётся в состоянии Play
     int  edit_mode = 0; // 0=Scene,1=UI,2=Animation
+
+    // Сцена, которую правят Inspector и Toolbox (владеет приложение)
+    core::ecs::World* world = nullptr;
+    core::ecs::Entity selected{};
+    Tool tool = Tool::Select;
+    core::UndoJournal* journal = nullptr; // правки Inspector и инструментов (может отсутствовать)
+
+    // Viewport: камеру и метки сцены ведёт UI, бэкенд рисует их графом кадра в текстуру.
+    // Размер 0 — Viewport в этом кадре не виден, проходы сцены не выполняются
+    graphics::ViewportCamera camera;
+    std::vector<graphics::ViewportMarker> viewport_markers;
+    uint64_t viewport_hash = 0;
+    uint32_t viewport_width = 0, viewport_height = 0;
+    void* viewport_texture = nullptr; // ImTextureID картинки прошлого кадра (заполняет бэкенд)
+
+    // Снимок аллокатора видеопамяти, бэкенд обновляет его, пока открыто окно GPU Memory
+    graphics::MemoryStats memory;
+
+    // Время и память скриптов Play, приложение копирует их, пока открыто окно Scripts
+    std::vector<scripting::ScriptStats> scripts;
+
+    // Кадры, отправленные на GPU и пропущенные из-за неизменного UI (заполняет бэкенд)
+    uint64_t frames_rendered = 0;
+    uint64_t frames_skipped = 0;
+
+    // Индекс Content/ для проводника и поиска (владеет приложение, может отсутствовать)
+    resources::ContentIndex* content = nullptr;
+    std::string selected_asset; // относительный путь: id меняются при пересборке индекса
+
+    // File > Export > Package: запрос приложению и признак идущей сборки
+    bool export_pak = false;
+    bool exporting_pak = false;
+
+    // File > Import > Model/Texture: запросы приложению (всё Content/ через кэш производных
+    // данных) и прогресс идущего пакета, который приложение копирует каждый кадр
+    bool import_models = false;
+    bool import_textures = false;
+    bool importing = false;
+    uint32_t import_done = 0, import_total = 0, import_cached = 0, import_failed = 0;
+
+    // File > Save Scene / Save All / Export > Scene as Text: запросы приложению
+    bool save_scene = false;
+    bool export_scene_text = false;
+
+    // File Explorer > New Script (Lua): запрос приложению создать Content/Scripts/*.lua
+    bool new_script = false;
 };
 
 void DrawEditorUI(EditorState& state);
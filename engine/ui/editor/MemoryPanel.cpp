@@ -0,0 +1,71 @@
+#include "MemoryPanel.hpp"
+
+#include <imgui.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+namespace dancore::ui {
+
+static float Mb(uint64_t bytes) { return float(bytes / (1024.0 * 1024.0)); }
+
+// Полоса на кучу: наше выделенное поверх всего занятого процессом, метка — бюджет
+static void DrawHeap(uint32_t index, const graphics::MemoryStats::Heap& h)
+{
+    ImGui::Text("Heap %u%s  %.0f MB", index, h.deviceLocal ? " (device local)" : "", Mb(h.size));
+    const float barH = 14.0f;
+    ImVec2 p0 = ImGui::GetCursorScreenPos();
+    float w = ImGui::GetContentRegionAvail().x;
+    ImGui::InvisibleButton("##heap", ImVec2(w, barH));
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+    dl->AddRectFilled(p0, ImVec2(p0.x + w, p0.y + barH), IM_COL32(25, 25, 28, 255));
+    if (!h.size) return;
+    auto X = [&](uint64_t v) { return p0.x + w * std::min(1.0f, float(double(v) / double(h.size))); };
+    bool over = h.usage > h.budget;
+    dl->AddRectFilled(p0, ImVec2(X(h.usage), p0.y + barH), over ? IM_COL32(200, 70, 60, 255) : IM_COL32(80, 110, 160, 255));
+    dl->AddRectFilled(p0, ImVec2(X(h.allocated), p0.y + barH), IM_COL32(90, 180, 110, 255));
+    float bx = X(h.budget);
+    dl->AddLine(ImVec2(bx, p0.y - 2), ImVec2(bx, p0.y + barH + 2), IM_COL32(255, 255, 255, 160), 2.0f);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Ours %.1f MB\nProcess %.1f MB\nBudget %.1f MB", Mb(h.allocated), Mb(h.usage), Mb(h.budget));
+}
+
+void DrawMemory(bool& open, const graphics::MemoryStats& s)
+{
+    if (!open) return;
+    if (!ImGui::Begin("GPU Memory", &open)) { ImGui::End(); return; }
+
+    ImGui::TextDisabled(s.budgetExtension ? "Budget: VK_EXT_memory_budget" : "Budget: estimated (80%% of heap)");
+    for (uint32_t i = 0; i < s.heaps.size(); ++i) {
+        ImGui::PushID((int)i);
+        DrawHeap(i, s.heaps[i]);
+        ImGui::PopID();
+    }
+
+    ImGui::Separator();
+    ImGui::TextUnformatted("Allocator");
+    ImGui::Text("vkAllocateMemory live: %u", s.vkAllocations);
+    ImGui::Text("Blocks: %u, %.1f / %.1f MB used, %u allocations", s.blocks, Mb(s.usedBytes), Mb(s.blockBytes), s.allocations);
+    ImGui::Text("Largest free range: %.1f MB", Mb(s.largestFree));
+    float frag = s.Fragmentation();
+    char label[32];
+    std::snprintf(label, sizeof(label), "Fragmentation %.0f%%", frag * 100.0f);
+    ImGui::ProgressBar(frag, ImVec2(-1, 0), label);
+    ImGui::Text("Dedicated: %u, %.1f MB", s.dedicated, Mb(s.dedicatedBytes));
+    ImGui::Text("Defrag moved: %.1f MB", Mb(s.defragMovedBytes));
+
+    ImGui::Separator();
+    ImGui::TextUnformatted("Render graph");
+    ImGui::Text("Transient images: %u, %.1f MB aliased into %.1f MB", s.transientImages, Mb(s.transientBytes),
+                Mb(s.transientHeapBytes));
+
+    ImGui::Separator();
+    ImGui::TextUnformatted("Frame arena");
+    ImGui::Text("Peak %.2f / %.2f MB per frame", Mb(s.arenaPeak), Mb(s.arenaBytes));
+    if (s.arenaOverflows)
+        ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "Overflows: %u", s.arenaOverflows);
+
+    ImGui::End();
+}
+
+} // namespace dancore::ui
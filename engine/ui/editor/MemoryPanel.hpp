@@ -0,0 +1,11 @@
+#pragma once
+
+// Окно "GPU Memory": бюджет куч, блоки аллокатора, фрагментация, арены кадра и дефрагментация.
+
+#include "graphics/MemoryStats.hpp"
+
+namespace dancore::ui {
+
+void DrawMemory(bool& open, const graphics::MemoryStats& stats);
+
+} // namespace dancore::ui
@@ -0,0 +1,127 @@
+#include "ProfilerPanel.hpp"
+#include "core/Profiler.hpp"
+
+#include <imgui.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace dancore::ui {
+
+namespace prof = dancore::core::profiler;
+
+// Стабильный цвет зоны по имени (указатель на литерал уникален)
+static ImU32 ZoneColor(const char* name)
+{
+    uint32_t h = (uint32_t)(uintptr_t)name * 2654435761u;
+    return IM_COL32(90 + (h & 0x7F), 90 + ((h >> 8) & 0x7F), 110 + ((h >> 16) & 0x5F), 255);
+}
+
+static double Ms(prof::Clock ns) { return ns / 1e6; }
+
+// История: столбик на кадр; клик выбирает кадр и ставит профайлер на паузу
+static void DrawHistory(const std::vector<prof::FrameCapture>& frames, int& selected)
+{
+    const float h = 70.0f, budget = 1000.0f / 60.0f;
+    ImVec2 p0 = ImGui::GetCursorScreenPos();
+    float w = ImGui::GetContentRegionAvail().x;
+    ImGui::InvisibleButton("##history", ImVec2(w, h));
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+    dl->AddRectFilled(p0, ImVec2(p0.x + w, p0.y + h), IM_COL32(25, 25, 28, 255));
+
+    float maxMs = budget * 2;
+    for (const auto& f : frames) maxMs = std::max(maxMs, (float)Ms(f.end - f.begin));
+    float barW = w / 240.0f;
+    float budgetY = p0.y + h - h * budget / maxMs;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        float ms = (float)Ms(frames[i].end - frames[i].begin);
+        float x = p0.x + i * barW;
+        ImU32 col = (int)i == selected ? IM_COL32(240, 240, 120, 255)
+                  : ms > budget ? IM_COL32(220, 80, 70, 255) : IM_COL32(90, 180, 110, 255);
+        dl->AddRectFilled(ImVec2(x, p0.y + h - h * ms / maxMs), ImVec2(x + std::max(barW - 1.0f, 1.0f), p0.y + h), col);
+    }
+    dl->AddLine(ImVec2(p0.x, budgetY), ImVec2(p0.x + w, budgetY), IM_COL32(255, 255, 255, 60));
+
+    if (ImGui::IsItemHovered() && !frames.empty()) {
+        int i = std::clamp((int)((ImGui::GetIO().MousePos.x - p0.x) / barW), 0, (int)frames.size() - 1);
+        const auto& f = frames[i];
+        ImGui::SetTooltip("Frame %llu\nCPU %.2f ms\nGPU %.2f ms", (unsigned long long)f.index, Ms(f.end - f.begin), f.gpu_ms);
+        if (ImGui::IsMouseClicked(ImGuiMouseButton_Left)) { selected = i; prof::SetPaused(true); }
+    }
+}
+
+// Flame graph: строка на поток, внутри — уровни вложенности зон
+static void DrawFlameGraph(const prof::FrameCapture& f)
+{
+    prof::Clock t0 = f.begin, t1 = f.end;
+    for (const auto& z : f.zones) { t0 = std::min(t0, z.begin); t1 = std::max(t1, z.end); }
+    if (t1 <= t0) return;
+
+    auto names = prof::ThreadNames();
+    const float rowH = ImGui::GetTextLineHeight() + 4.0f, labelW = 80.0f;
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+    float w = ImGui::GetContentRegionAvail().x - labelW;
+    double scale = w / double(t1 - t0);
+
+    auto drawThread = [&](uint32_t thread, const char* label) {
+        uint32_t depth = 0; bool any = false;
+        for (const auto& z : f.zones) if (z.thread == thread) { depth = std::max(depth, z.depth + 1); any = true; }
+        if (!any) return;
+        ImVec2 p0 = ImGui::GetCursorScreenPos();
+        ImGui::TextDisabled("%s", label);
+        ImGui::SetCursorScreenPos(p0);
+        ImGui::InvisibleButton(label, ImVec2(labelW + w, rowH * depth));
+        bool hovered = ImGui::IsItemHovered();
+        ImVec2 mouse = ImGui::GetIO().MousePos;
+        for (const auto& z : f.zones) {
+            if (z.thread != thread) continue;
+            ImVec2 a(p0.x + labelW + float((z.begin - t0) * scale), p0.y + z.depth * rowH);
+            ImVec2 b(std::max(a.x + 1.0f, p0.x + labelW + float((z.end - t0) * scale)), a.y + rowH - 1.0f);
+            dl->AddRectFilled(a, b, ZoneColor(z.name));
+            if (b.x - a.x > ImGui::CalcTextSize(z.name).x + 4.0f)
+                dl->AddText(ImVec2(a.x + 2.0f, a.y + 2.0f), IM_COL32(15, 15, 15, 255), z.name);
+            if (hovered && mouse.x >= a.x && mouse.x < b.x && mouse.y >= a.y && mouse.y < b.y)
+                ImGui::SetTooltip("%s\n%.3f ms", z.name, Ms(z.end - z.begin));
+        }
+    };
+    for (uint32_t t = 0; t < names.size(); ++t) drawThread(t, names[t].c_str());
+    drawThread(prof::kGpuThread, "GPU");
+}
+
+void DrawProfiler(bool& open, uint64_t framesRendered, uint64_t framesSkipped)
+{
+    if (!open) return;
+    ImGui::Begin("Profiler", &open, ImGuiWindowFlags_NoCollapse);
+
+    static int selected = -1;
+    static std::string status;
+    const auto& frames = prof::History();
+
+    bool paused = prof::IsPaused();
+    if (ImGui::Checkbox("Pause", &paused)) { prof::SetPaused(paused); if (!paused) selected = -1; }
+    ImGui::SameLine();
+    if (ImGui::Button("Export Chrome Trace")) {
+        const char* path = "dancore_trace.json";
+        status = prof::ExportChromeTrace(path) ? std::string("Saved ") + path : std::string("Failed to write ") + path;
+    }
+    if (!status.empty()) { ImGui::SameLine(); ImGui::TextDisabled("%s", status.c_str()); }
+    const uint64_t built = framesRendered + framesSkipped;
+    ImGui::TextDisabled("Frames: %llu rendered, %llu skipped (UI unchanged, %.0f%%)", (unsigned long long)framesRendered,
+                        (unsigned long long)framesSkipped, built ? 100.0 * double(framesSkipped) / double(built) : 0.0);
+
+    if (frames.empty()) { ImGui::TextDisabled("No frames captured yet."); ImGui::End(); return; }
+    if (selected < 0 || selected >= (int)frames.size() || !paused) selected = (int)frames.size() - 1;
+
+    const auto& f = frames[selected];
+    ImGui::Text("Frame %llu   CPU %.2f ms   GPU %.2f ms", (unsigned long long)f.index, Ms(f.end - f.begin), f.gpu_ms);
+    if (uint64_t dropped = prof::DroppedZones()) { ImGui::SameLine(); ImGui::TextColored(ImVec4(1,0.6f,0.2f,1), "(%llu zones dropped)", (unsigned long long)dropped); }
+
+    DrawHistory(frames, selected);
+    ImGui::Separator();
+    ImGui::BeginChild("##flame", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+    DrawFlameGraph(frames[selected]);
+    ImGui::EndChild();
+    ImGui::End();
+}
+
+} // namespace dancore::ui
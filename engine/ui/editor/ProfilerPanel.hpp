@@ -0,0 +1,13 @@
+#pragma once
+
+// Окно "Profiler": история времени кадра + flame graph выбранного кадра по потокам и GPU.
+// Пока окно открыто, UI меняется каждый кадр, так что простоя редактора с ним не бывает.
+
+#include <cstdint>
+
+namespace dancore::ui {
+
+// framesRendered/framesSkipped — кадры на GPU и пропущенные из-за неизменного UI
+void DrawProfiler(bool& open, uint64_t framesRendered, uint64_t framesSkipped);
+
+} // namespace dancore::ui
@@ -0,0 +1,58 @@
+#include "ScriptsPanel.hpp"
+
+#include <imgui.h>
+#include <cstdint>
+
+namespace dancore::ui {
+
+static float Kb(uint64_t bytes) { return float(bytes / 1024.0); }
+
+void DrawScripts(bool& open, const std::vector<scripting::ScriptStats>& stats)
+{
+    if (!open) return;
+    if (!ImGui::Begin("Scripts", &open)) { ImGui::End(); return; }
+
+    if (stats.empty()) {
+        ImGui::TextDisabled("No scripts (Play runs Content/Scripts/*.lua)");
+        ImGui::End();
+        return;
+    }
+
+    double total = 0;
+    for (const scripting::ScriptStats& s : stats) total += s.frameMs;
+    ImGui::Text("%zu scripts, %.3f ms this frame", stats.size(), total);
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable |
+                                  ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingStretchProp;
+    if (ImGui::BeginTable("##scripts", 7, flags)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Script", ImGuiTableColumnFlags_WidthStretch, 3.0f);
+        ImGui::TableSetupColumn("ms");
+        ImGui::TableSetupColumn("avg");
+        ImGui::TableSetupColumn("peak");
+        ImGui::TableSetupColumn("Calls / entities");
+        ImGui::TableSetupColumn("Allocs / frame");
+        ImGui::TableSetupColumn("Live KB");
+        ImGui::TableHeadersRow();
+        for (const scripting::ScriptStats& s : stats) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            if (s.failed) ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "%s (error)", s.name.c_str());
+            else ImGui::TextUnformatted(s.name.c_str());
+            if (s.failed && ImGui::IsItemHovered()) ImGui::SetTooltip("Stopped until next Play, see Console");
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", s.frameMs);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", s.avgMs);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", s.peakMs);
+            ImGui::TableNextColumn(); ImGui::Text("%u / %u", s.chunks, s.entities);
+            ImGui::TableNextColumn();
+            if (s.frameAllocs) ImGui::TextColored(ImVec4(1, 0.8f, 0.3f, 1), "%llu (%.1f KB)",
+                                                  (unsigned long long)s.frameAllocs, Kb(s.frameAllocBytes));
+            else ImGui::TextUnformatted("0");
+            ImGui::TableNextColumn(); ImGui::Text("%.1f", Kb(s.liveBytes));
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+} // namespace dancore::ui
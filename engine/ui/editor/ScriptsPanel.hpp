@@ -0,0 +1,12 @@
+#pragma once
+
+// Окно "Scripts": время и выделения памяти каждого скрипта Lua в режиме Play.
+
+#include "scripting/common/ScriptStats.hpp"
+#include <vector>
+
+namespace dancore::ui {
+
+void DrawScripts(bool& open, const std::vector<scripting::ScriptStats>& stats);
+
+} // namespace dancore::ui
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "audio/AudioMixer.hpp"
+#include "audio/NullAudioDevice.hpp"
+#include "core/JobSystem.hpp"
+#include "core/Profiler.hpp"
+
+// dancore_audiobench: mixes many looping voices (synthetic clips at 22.05/32/44.1/48 kHz,
+// mono and stereo, random pitch/pan so every voice resamples) into the null device and
+// reports how much faster than real time the mixer runs. --stream adds looping streamed
+// voices decoded by job system workers; --realtime drives a device thread at 48 kHz
+// instead of rendering offline; --out writes the mix to a float WAV.
+//
+//   dancore_audiobench [--voices=N] [--seconds=N] [--workers=N] [--stream=file] [--streams=N]
+//                      [--realtime] [--out=file.wav]
+
+using namespace dancore;
+namespace prof = core::profiler;
+
+static double Ms(prof::Clock begin){ return double(prof::Now()-begin)/1e6; }
+
+static int Usage(){
+    std::cerr<<"usage: dancore_audiobench [--voices=N] [--seconds=N] [--workers=N] [--stream=file] [--streams=N]"
+               " [--realtime] [--out=file.wav]\n";
+    return 2;
+}
+
+// Секунда аккорда из трёх синусов
+static std::shared_ptr<const audio::AudioClip> Tone(uint32_t rate, uint32_t channels, float base){
+    auto clip=std::make_shared<audio::AudioClip>();
+    clip->format={rate,channels};
+    clip->samples.resize(size_t(rate)*channels);
+    for(uint32_t f=0;f<rate;f++){
+        double t=double(f)/rate;
+        for(uint32_t c=0;c<channels;c++){
+            double k=base*(1.0+0.01*c);
+            clip->samples[size_t(f)*channels+c]=float(0.2*(std::sin(6.2831853*k*t)+std::sin(6.2831853*k*1.25*t)+
+                                                            std::sin(6.2831853*k*1.5*t)));
+        }
+    }
+    return clip;
+}
+
+int main(int argc, char** argv){
+    int voices=256, streams=4;
+    double seconds=20;
+    uint32_t workers=0;
+    bool realtime=false;
+    const char* stream=nullptr;
+    const char* out=nullptr;
+    for(int i=1;i<argc;i++){
+        const char* a=argv[i];
+        if(!std::strncmp(a,"--voices=",9)) voices=std::max(std::atoi(a+9),1);
+        else if(!std::strncmp(a,"--seconds=",10)) seconds=std::max(std::atof(a+10),0.1);
+        else if(!std::strncmp(a,"--workers=",10)) workers=(uint32_t)std::max(std::atoi(a+10),1);
+        else if(!std::strncmp(a,"--stream=",9)) stream=a+9;
+        else if(!std::strncmp(a,"--streams=",10)) streams=std::max(std::atoi(a+10),1);
+        else if(!std::strncmp(a,"--out=",6)) out=a+6;
+        else if(!std::strcmp(a,"--realtime")) realtime=true;
+        else return Usage();
+    }
+    core::jobs::Init(workers);
+
+    audio::AudioMixerSettings settings;
+    settings.maxVoices=uint32_t(voices+(stream?streams:0));
+    settings.maxStreams=uint32_t(streams);
+    audio::AudioMixer mixer(settings);
+    audio::NullAudioDeviceSettings deviceSettings;
+    deviceSettings.realtime=realtime;
+    if(out) deviceSettings.wavPath=out;
+    audio::NullAudioDevice device(mixer,deviceSettings);
+
+    const std::shared_ptr<const audio::AudioClip> clips[]={
+        Tone(22050,1,220.0f),Tone(32000,2,277.2f),Tone(44100,1,329.6f),Tone(48000,2,392.0f)};
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pan(-1.0f,1.0f), pitch(0.5f,2.0f);
+    const float volume=1.0f/std::sqrt(float(voices));
+    std::vector<audio::VoiceId> ids;
+    for(int i=0;i<voices;i++)
+        ids.push_back(mixer.Play(clips[i%4],{volume,pan(rng),pitch(rng),true}));
+    if(stream) for(int i=0;i<streams;i++) mixer.PlayStream(stream,{0.5f,pan(rng),1.0f,true});
+    std::printf("%d voices%s, %u workers, %.0f s at %u Hz, %s\n",voices,
+                stream?" + streams":"",core::jobs::WorkerCount(),seconds,settings.sampleRate,
+                realtime?"real time":"offline");
+
+    // кадр игры — 10 мс: Update и немного движения голосов
+    const uint64_t total=uint64_t(seconds*settings.sampleRate), frame=settings.sampleRate/100;
+    size_t moved=0;
+    auto gameFrame=[&]{
+        mixer.Update();
+        for(int k=0;k<8;k++,moved++) mixer.SetPan(ids[moved%ids.size()],pan(rng));
+    };
+    prof::Clock t=prof::Now();
+    if(realtime){
+        device.Start();
+        while(device.Frames()<total){
+            gameFrame();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        device.Stop();
+    }else{
+        for(uint64_t done=0;done<total;done+=frame){
+            gameFrame();
+            device.RenderFrames(std::min(frame,total-done));
+        }
+    }
+    const double wall=Ms(t);
+    mixer.Update();
+
+    const audio::AudioStats st=mixer.Stats();
+    const double audioMs=double(st.framesRendered)*1000.0/settings.sampleRate;
+    std::printf("%.0f ms of audio in %.0f ms: %.1fx real time, mixer load %.3f\n",audioMs,wall,audioMs/wall,st.load);
+    std::printf("render %.3f ms avg (%.3f peak), %.2f ns per voice-frame\n",st.renderMsAvg,st.renderMsPeak,
+                st.load*1e9/settings.sampleRate/std::max(st.peakVoices,1u));
+    std::printf("voices %u (peak %u), streams %u, underruns %llu (%llu frames), dropped %llu commands, %llu voices\n",
+                st.voices,st.peakVoices,st.streams,(unsigned long long)st.underruns,
+                (unsigned long long)st.underrunFrames,(unsigned long long)st.droppedCommands,
+                (unsigned long long)st.droppedVoices);
+    core::jobs::Shutdown();
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "core/JobSystem.hpp"
+#include "core/Profiler.hpp"
+#include "core/SceneComponents.hpp"
+#include "net/Replication.hpp"
+
+// dancore_netbench: a play session on loopback. One server world and N client worlds, each
+// client on its own UDP socket on 127.0.0.1. Part of the entities wander and spin, a few are
+// destroyed and respawned every tick, and datagrams are dropped at random in both directions.
+// Reports what caps player counts: payload bytes per entity per tick and server CPU per tick
+// (snapshot, per-client encoding, socket calls). After the lossy ticks the world stops, the
+// link gets clean, and every client world is compared with the server's quantized state.
+//
+//   dancore_netbench [--clients=N] [--entities=N] [--ticks=N] [--loss=PERCENT] [--moving=PERCENT]
+//                    [--churn=N] [--budget=KB/s] [--workers=N]
+
+using namespace dancore;
+namespace ecs = core::ecs;
+namespace scene = core::scene;
+namespace prof = core::profiler;
+
+static double Ms(prof::Clock begin){ return double(prof::Now()-begin)/1e6; }
+
+static int Usage(){
+    std::cerr<<"usage: dancore_netbench [--clients=N] [--entities=N] [--ticks=N] [--loss=PERCENT] [--moving=PERCENT]\n"
+               "                        [--churn=N] [--budget=KB/s] [--workers=N]\n";
+    return 2;
+}
+
+struct Velocity { float x=0, z=0, spin=0; };
+
+struct Peer {
+    net::UdpSocket socket;
+    std::unique_ptr<net::ReplicationClient> client;
+    ecs::World world;
+};
+
+// Drops each datagram with probability loss; kept ones are packed to the front
+static size_t Lose(net::Datagram* d, size_t n, double loss, std::mt19937& rng){
+    if(loss<=0) return n;
+    std::uniform_real_distribution<double> u(0.0,1.0);
+    size_t kept=0;
+    for(size_t i=0;i<n;i++){
+        if(u(rng)<loss) continue;
+        if(kept!=i){ d[kept].address=d[i].address; d[kept].size=d[i].size; std::memcpy(d[kept].data,d[i].data,d[i].size); }
+        kept++;
+    }
+    return kept;
+}
+
+static ecs::Entity Spawn(ecs::World& world, std::mt19937& rng, bool moving, uint32_t serial){
+    std::uniform_real_distribution<float> pos(-500.0f,500.0f), angle(0.0f,360.0f), speed(-4.0f,4.0f);
+    char name[32];
+    std::snprintf(name,sizeof(name),"Crate %u",serial);
+    ecs::Entity e=scene::CreateObject(world,name);
+    *world.Get<scene::Position>(e)={pos(rng),0.5f,pos(rng)};
+    *world.Get<scene::Rotation>(e)={0,angle(rng),0};
+    if(moving) world.Add<Velocity>(e,{speed(rng),speed(rng),speed(rng)*20});
+    return e;
+}
+
+int main(int argc, char** argv){
+    int clients=16, entities=10000, ticks=600, churn=10;
+    double loss=0.05, moving=0.2;
+    uint32_t workers=0, budget=128;
+    for(int i=1;i<argc;i++){
+        const char* a=argv[i];
+        if(!std::strncmp(a,"--clients=",10)) clients=std::clamp(std::atoi(a+10),1,1000);
+        else if(!std::strncmp(a,"--entities=",11)) entities=std::max(std::atoi(a+11),1);
+        else if(!std::strncmp(a,"--ticks=",8)) ticks=std::max(std::atoi(a+8),1);
+        else if(!std::strncmp(a,"--loss=",7)) loss=std::clamp(std::atof(a+7),0.0,90.0)/100.0;
+        else if(!std::strncmp(a,"--moving=",9)) moving=std::clamp(std::atof(a+9),0.0,100.0)/100.0;
+        else if(!std::strncmp(a,"--churn=",8)) churn=std::max(std::atoi(a+8),0);
+        else if(!std::strncmp(a,"--budget=",9)) budget=(uint32_t)std::max(std::atoi(a+9),1);
+        else if(!std::strncmp(a,"--workers=",10)) workers=(uint32_t)std::max(std::atoi(a+10),1);
+        else return Usage();
+    }
+    core::jobs::Init(workers);
+    try {
+        net::ReplicationSettings settings;
+        settings.bytesPerSecond=budget*1024;
+        settings.maxClients=uint32_t(clients);
+        settings.timeoutTicks=uint32_t(ticks)+1000; // no client may time out during the run
+        net::ReplicationServer server(net::SceneReplicationSchema(),settings);
+        net::UdpSocket serverSocket;
+        serverSocket.Open(0,true);
+        const net::NetAddress serverAddress{0x7f000001u,serverSocket.Port()};
+
+        std::mt19937 rng(5);
+        ecs::World world;
+        std::vector<ecs::Entity> live;
+        uint32_t serial=0;
+        const int movers=int(entities*moving);
+        for(int i=0;i<entities;i++) live.push_back(Spawn(world,rng,i<movers,serial++));
+
+        std::vector<std::unique_ptr<Peer>> peers;
+        for(int i=0;i<clients;i++){
+            auto p=std::make_unique<Peer>();
+            p->socket.Open(0,true);
+            p->client=std::make_unique<net::ReplicationClient>(net::SceneReplicationSchema(),settings);
+            p->client->Connect(serverAddress);
+            peers.push_back(std::move(p));
+        }
+        std::printf("%d clients, %d entities (%d moving, %d respawned per tick), %.0f%% loss, %u KB/s per client, %u workers\n",
+                    clients,entities,movers,churn,loss*100,budget,core::jobs::WorkerCount());
+
+        std::vector<net::Datagram> inbox(1024);
+        std::vector<net::Datagram> out;
+        const float dt=1.0f/float(settings.tickRate);
+        const int maxSettle=int(settings.tickRate)*120; // clean ticks at the end: the budget drains the backlog
+        double serverTotal=0, serverWorst=0, snapshot=0, encode=0, transport=0, clientTotal=0;
+        uint64_t windowBytes=0, windowSent=0;
+        double windowMs=0;
+        prof::Clock wall=prof::Now();
+        int tick=0;
+        bool settled=false;
+        for(;tick<ticks+maxSettle && !settled;tick++){
+            const bool lossy=tick<ticks;
+            if(lossy){
+                world.Each<scene::Position,scene::Rotation,const Velocity>([&](uint32_t n,const ecs::Entity*,scene::Position* p,scene::Rotation* r,const Velocity* v){
+                    for(uint32_t i=0;i<n;i++){
+                        p[i].x+=v[i].x*dt, p[i].z+=v[i].z*dt;
+                        r[i].y+=v[i].spin*dt;
+                    }
+                });
+                std::uniform_int_distribution<size_t> pick(0,live.size()-1);
+                for(int c=0;c<churn && !live.empty();c++){
+                    size_t i=pick(rng);
+                    bool wasMoving=world.Has<Velocity>(live[i]);
+                    world.Destroy(live[i]);
+                    live[i]=Spawn(world,rng,wasMoving,serial++);
+                }
+            }
+
+            prof::Clock t=prof::Now();
+            size_t n;
+            while((n=serverSocket.Receive(inbox.data(),inbox.size()))>0) server.Receive(inbox.data(),n);
+            server.Tick(world);
+            serverSocket.Send(server.Outgoing().data(),server.Outgoing().size());
+            const double ms=Ms(t);
+            const auto& s=server.Stats();
+            serverTotal+=ms, serverWorst=std::max(serverWorst,ms);
+            snapshot+=s.snapshotMs, encode+=s.encodeMs, transport+=ms-s.snapshotMs-s.encodeMs;
+            windowBytes+=s.bytes, windowSent+=s.sent, windowMs+=ms;
+            settled=!lossy && s.clients==uint32_t(clients) && !s.pending;
+
+            prof::Clock ct=prof::Now();
+            for(auto& p:peers){
+                while((n=p->socket.Receive(inbox.data(),inbox.size()))>0){
+                    n=lossy?Lose(inbox.data(),n,loss,rng):n;
+                    p->client->Receive(inbox.data(),n,p->world);
+                }
+                out.clear();
+                p->client->Flush(out);
+                n=lossy?Lose(out.data(),out.size(),loss,rng):out.size();
+                p->socket.Send(out.data(),n);
+            }
+            clientTotal+=Ms(ct);
+
+            if(tick%100==99 || settled){
+                const int span=tick%100+1;
+                std::printf("tick %4d: %5u changed, %7u pending, %6u records, %4u packets | %.3f B/entity/tick, %.1f B/record | server %.3f ms/tick\n",
+                            tick+1,s.changed,s.pending,s.sent,s.packets,
+                            double(windowBytes)/(double(clients)*entities*span),windowSent?double(windowBytes)/windowSent:0.0,windowMs/span);
+                windowBytes=windowSent=0;
+                windowMs=0;
+            }
+        }
+        const int total=tick;
+        if(settled) std::printf("settled %d clean ticks after the lossy ones\n",total-ticks);
+        else std::printf("not settled after %d clean ticks: the budget is too small for the world\n",maxSettle);
+        const auto& s=server.Stats();
+        std::printf("%d ticks in %.0f ms; server %.3f ms/tick avg (%.3f worst): snapshot %.3f, encode %.3f, sockets %.3f; clients %.3f ms/tick\n",
+                    total,Ms(wall),serverTotal/total,serverWorst,snapshot/total,encode/total,transport/total,clientTotal/total);
+        std::printf("sent %.1f MB in %llu packets (%llu dropped by the socket), %.3f B/entity/tick, %.1f B/record, %.1f KB/s per client at %u Hz\n",
+                    s.totalBytes/1048576.0,(unsigned long long)s.totalPackets,(unsigned long long)serverSocket.Dropped(),
+                    double(s.totalBytes)/(double(clients)*entities*total),s.totalSent?double(s.totalBytes)/s.totalSent:0.0,
+                    double(s.totalBytes)/clients/total*settings.tickRate/1024,settings.tickRate);
+
+        // every client should now hold the server's quantized state
+        const auto& schema=server.Schema();
+        uint32_t positionIndex=0;
+        for(uint32_t c=0;c<schema.Components().size();c++)
+            if(schema.Components()[c].id==ecs::ComponentIdOf<scene::Position>()) positionIndex=c;
+        uint64_t missing=0, wrong=0, extra=0, rejected=0, stale=0;
+        for(auto& p:peers){
+            uint32_t found=0;
+            for(ecs::Entity e:live){
+                ecs::Entity l=p->client->Find(e.index);
+                const scene::Position* mine=l?p->world.Get<scene::Position>(l):nullptr;
+                if(!mine){ missing++; continue; }
+                found++;
+                uint32_t words[3];
+                scene::Position expected;
+                schema.Quantize(positionIndex,world.Get<scene::Position>(e),words);
+                schema.Dequantize(positionIndex,words,&expected);
+                if(std::memcmp(&expected,mine,sizeof(expected))) wrong++;
+            }
+            extra+=p->world.Count()-found;
+            rejected+=p->client->Stats().rejected, stale+=p->client->Stats().stale;
+        }
+        std::printf("clients: %llu missing, %llu wrong, %llu extra entities; %llu packets rejected, %llu stale records\n",
+                    (unsigned long long)missing,(unsigned long long)wrong,(unsigned long long)extra,
+                    (unsigned long long)rejected,(unsigned long long)stale);
+        core::jobs::Shutdown();
+        return missing||wrong||extra ? 1 : 0;
+    } catch(const std::exception& e){
+        std::cerr<<e.what()<<"\n";
+        core::jobs::Shutdown();
+        return 1;
+    }
+}
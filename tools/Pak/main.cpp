@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/Hash.hpp"
+#include "core/JobSystem.hpp"
+#include "resources/Pak.hpp"
+#include "resources/PakWriter.hpp"
+
+// dancore_pak: packs a content directory into a .pak and inspects existing packages.
+// Output depends only on the input files, so the same tree gives a byte-identical pack.
+//
+//   dancore_pak build <dir> <out.pak> [--codec=lz4|zstd|none] [--level=N] [--workers=N]
+//   dancore_pak list <file.pak>
+//   dancore_pak verify <file.pak> [--workers=N]
+
+using namespace dancore;
+
+static int Usage(){
+    std::cerr<<"usage: dancore_pak build <dir> <out.pak> [--codec=lz4|zstd|none] [--level=N] [--workers=N]\n"
+               "       dancore_pak list <file.pak>\n"
+               "       dancore_pak verify <file.pak> [--workers=N]\n";
+    return 2;
+}
+
+static bool ParseCodec(const char* s, resources::PakCodec& c){
+    for(auto v: {resources::PakCodec::None,resources::PakCodec::LZ4,resources::PakCodec::Zstd})
+        if(!std::strcmp(s,resources::PakCodecName(v))){ c=v; return true; }
+    return false;
+}
+
+static int Build(const std::vector<std::string>& args, const resources::PakBuildOptions& opt){
+    if(args.size()!=2) return Usage();
+    auto sources=resources::CollectPakSources(args[0]);
+    auto s=resources::BuildPak(std::move(sources),args[1],opt);
+    std::printf("%s: %u entries (%u stored), %.1f MB -> %.1f MB in %.2f s\n",args[1].c_str(),s.entries,s.stored,
+                s.rawBytes/1048576.0,s.fileBytes/1048576.0,s.seconds);
+    return 0;
+}
+
+static int List(const std::vector<std::string>& args){
+    if(args.size()!=1) return Usage();
+    resources::PakFile pak;
+    pak.Open(args[0]);
+    for(uint32_t i=0;i<pak.Count();i++){
+        const auto& e=pak.Entry(i);
+        std::string_view name=pak.Name(i);
+        std::printf("%12llu %12llu %-5s %.*s\n",(unsigned long long)e.rawSize,(unsigned long long)e.storedSize,
+                    resources::PakCodecName(e.codec),(int)name.size(),name.data());
+    }
+    return 0;
+}
+
+// Unpacks every entry in parallel and checks it against the stored content hash
+static int Verify(const std::vector<std::string>& args){
+    if(args.size()!=1) return Usage();
+    resources::PakFile pak;
+    pak.Open(args[0]);
+    std::vector<uint8_t> bad(pak.Count(),0);
+    core::jobs::ParallelFor(0,pak.Count(),16,[&](size_t begin,size_t end){
+        std::vector<uint8_t> data;
+        for(size_t i=begin;i<end;i++){
+            try {
+                pak.Read((uint32_t)i,data);
+                bad[i]=core::Hash64(data.data(),data.size())!=pak.Entry((uint32_t)i).contentHash;
+            } catch(const std::exception&){
+                bad[i]=1;
+            }
+        }
+    });
+    uint32_t failed=0;
+    for(uint32_t i=0;i<pak.Count();i++) if(bad[i]){
+        std::string_view name=pak.Name(i);
+        std::fprintf(stderr,"corrupt: %.*s\n",(int)name.size(),name.data());
+        failed++;
+    }
+    std::printf("%s: %u entries, %u corrupt\n",args[0].c_str(),pak.Count(),failed);
+    return failed?1:0;
+}
+
+int main(int argc, char** argv){
+    if(argc<2) return Usage();
+    std::string cmd=argv[1];
+    std::vector<std::string> args;
+    resources::PakBuildOptions opt;
+    uint32_t workers=0;
+    for(int i=2;i<argc;i++){
+        const char* a=argv[i];
+        if(!std::strncmp(a,"--codec=",8)){
+            if(!ParseCodec(a+8,opt.codec)){ std::cerr<<"Unknown codec '"<<a+8<<"'\n"; return 2; }
+        }
+        else if(!std::strncmp(a,"--level=",8)) opt.level=std::atoi(a+8);
+        else if(!std::strncmp(a,"--workers=",10)) workers=(uint32_t)std::max(std::atoi(a+10),1);
+        else if(a[0]=='-' && a[1]=='-'){ std::cerr<<"Unknown option "<<a<<"\n"; return 2; }
+        else args.push_back(a);
+    }
+
+    core::jobs::Init(workers);
+    int rc=0;
+    try {
+        if(cmd=="build") rc=Build(args,opt);
+        else if(cmd=="list") rc=List(args);
+        else if(cmd=="verify") rc=Verify(args);
+        else rc=Usage();
+    } catch(const std::exception& e){
+        std::cerr<<e.what()<<"\n";
+        rc=1;
+    }
+    core::jobs::Shutdown();
+    return rc;
+}
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#include "core/JobSystem.hpp"
+#include "core/Profiler.hpp"
+#include "physics/RigidWorld.hpp"
+
+// dancore_physicsbench: drops a field of box and sphere columns onto the ground plane and
+// times fixed steps while it falls, collides and settles. The final state hash is the same
+// for any worker count: compare runs with --workers=1 to check determinism.
+//
+//   dancore_physicsbench [--bodies=N] [--steps=N] [--workers=N] [--iterations=N]
+
+using namespace dancore;
+namespace prof = core::profiler;
+
+static double Ms(prof::Clock begin){ return double(prof::Now()-begin)/1e6; }
+
+static int Usage(){
+    std::cerr<<"usage: dancore_physicsbench [--bodies=N] [--steps=N] [--workers=N] [--iterations=N]\n";
+    return 2;
+}
+
+int main(int argc, char** argv){
+    int bodies=100000, steps=600, iterations=0;
+    uint32_t workers=0;
+    for(int i=1;i<argc;i++){
+        const char* a=argv[i];
+        if(!std::strncmp(a,"--bodies=",9)) bodies=std::max(std::atoi(a+9),1);
+        else if(!std::strncmp(a,"--steps=",8)) steps=std::max(std::atoi(a+8),1);
+        else if(!std::strncmp(a,"--workers=",10)) workers=(uint32_t)std::max(std::atoi(a+10),1);
+        else if(!std::strncmp(a,"--iterations=",13)) iterations=std::max(std::atoi(a+13),1);
+        else return Usage();
+    }
+    core::jobs::Init(workers);
+    physics::RigidSettings settings;
+    if(iterations) settings.iterations=iterations;
+    physics::RigidWorld world(settings);
+
+    // столбики по 4 тела на квадратной сетке, каждое пятое — сфера, повороты вокруг y
+    const int kColumn=4, columns=(bodies+kColumn-1)/kColumn, side=int(std::ceil(std::sqrt(double(columns))));
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> jitter(-0.15f,0.15f), angle(0.0f,3.14159265f);
+    prof::Clock t=prof::Now();
+    for(int i=0;i<bodies;i++){
+        int c=i/kColumn, level=i%kColumn;
+        physics::RigidBodyDesc d;
+        d.shape=i%5==4?physics::RigidShape::Sphere:physics::RigidShape::Box;
+        d.halfExtents[0]=d.halfExtents[1]=d.halfExtents[2]=0.5f;
+        d.position[0]=float(c%side)*2.5f+jitter(rng);
+        d.position[1]=0.6f+float(level)*1.3f;
+        d.position[2]=float(c/side)*2.5f+jitter(rng);
+        float a=0.5f*angle(rng);
+        d.orientation[1]=std::sin(a), d.orientation[3]=std::cos(a);
+        world.Add(d);
+    }
+    std::printf("%d bodies in %d columns: built in %.1f ms, %u workers, %d iterations, dt %.4f s\n",
+                bodies,columns,Ms(t),core::jobs::WorkerCount(),settings.iterations,settings.fixedDt);
+
+    double total=0, broad=0, narrow=0, solve=0, worst=0;
+    t=prof::Now();
+    for(int s=0;s<steps;s++){
+        prof::Clock st=prof::Now();
+        world.Step();
+        double ms=Ms(st);
+        total+=ms;
+        worst=std::max(worst,ms);
+        const auto& stats=world.Stats();
+        broad+=stats.broadMs, narrow+=stats.narrowMs, solve+=stats.solveMs;
+        if(s%100==99 || s==steps-1)
+            std::printf("step %4d: %6u awake, %6u islands, %7u pairs, %7u contacts, %.2f ms\n",
+                        s+1,stats.awake,stats.islands,stats.pairs,stats.contacts,ms);
+    }
+    double wall=Ms(t);
+    std::printf("%d steps in %.0f ms: %.1f steps/s, %.2f ms avg (%.2f worst); broad %.2f, narrow %.2f, solve %.2f ms avg\n",
+                steps,wall,steps*1000.0/wall,total/steps,worst,broad/steps,narrow/steps,solve/steps);
+    std::printf("state hash %016llx\n",(unsigned long long)world.StateHash());
+    core::jobs::Shutdown();
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "core/JobSystem.hpp"
+#include "core/Profiler.hpp"
+#include "graphics/VoxelMesher.hpp"
+#include "graphics/VoxelRemesher.hpp"
+#include "physics/VoxelGrid.hpp"
+
+// dancore_voxelbench: builds a heightmap terrain in VoxelGrid, then times storage,
+// a full mesh (single thread and job system) and incremental remeshing after edits.
+//
+//   dancore_voxelbench [--size=N] [--height=N] [--edits=N] [--workers=N]
+
+using namespace dancore;
+namespace prof = core::profiler;
+
+static double Ms(prof::Clock begin){ return double(prof::Now()-begin)/1e6; }
+
+static int Usage(){
+    std::cerr<<"usage: dancore_voxelbench [--size=N] [--height=N] [--edits=N] [--workers=N]\n";
+    return 2;
+}
+
+static int Height(int x, int z, int height){
+    double h=0.5+0.25*std::sin(x*0.021)*std::cos(z*0.017)+0.15*std::sin((x+z)*0.063)+0.1*std::cos(x*0.11-z*0.07);
+    return std::clamp(int(h*height),1,height-1);
+}
+
+int main(int argc, char** argv){
+    int size=512, height=96, edits=200;
+    uint32_t workers=0;
+    for(int i=1;i<argc;i++){
+        const char* a=argv[i];
+        if(!std::strncmp(a,"--size=",7)) size=std::max(std::atoi(a+7),32);
+        else if(!std::strncmp(a,"--height=",9)) height=std::max(std::atoi(a+9),8);
+        else if(!std::strncmp(a,"--edits=",8)) edits=std::max(std::atoi(a+8),0);
+        else if(!std::strncmp(a,"--workers=",10)) workers=(uint32_t)std::max(std::atoi(a+10),1);
+        else return Usage();
+    }
+    core::jobs::Init(workers);
+    physics::VoxelGrid grid;
+
+    // камень, три слоя земли, трава сверху
+    prof::Clock t=prof::Now();
+    for(int z=0;z<size;z++) for(int x=0;x<size;x++){
+        int h=Height(x,z,height);
+        for(int y=0;y<=h;y++) grid.Set(x,y,z,physics::VoxelMaterial(y==h?3:y>=h-3?2:1));
+    }
+    double genMs=Ms(t);
+    auto st=grid.Stats();
+    double dense=double(size)*size*height*sizeof(physics::VoxelMaterial);
+    std::printf("terrain %dx%dx%d: generated in %.0f ms\n",size,height,size,genMs);
+    std::printf("storage: %zu chunks (%zu uniform), %zu detailed bricks, %.2f MB vs %.2f MB dense (%.1f%%)\n",
+                st.chunks,st.uniformChunks,st.detailedBricks,st.bytes/1048576.0,dense/1048576.0,100.0*st.bytes/dense);
+
+    // один поток, LOD 0: чистая скорость мешера
+    std::vector<std::pair<physics::VoxelChunkKey,const physics::VoxelChunk*>> chunks;
+    grid.ForEachChunk([&](physics::VoxelChunkKey key, const physics::VoxelChunk& c){ chunks.push_back({key,&c}); });
+    static const int kDir[6][3]={{-1,0,0},{1,0,0},{0,-1,0},{0,1,0},{0,0,-1},{0,0,1}};
+    for(int lod=0;lod<3;lod++){
+        graphics::VoxelMesh mesh;
+        size_t quads=0;
+        t=prof::Now();
+        for(auto [key,c]: chunks){
+            int32_t p[3];
+            physics::UnpackChunkKey(key,p[0],p[1],p[2]);
+            std::shared_ptr<const physics::VoxelChunk> hold[6];
+            const physics::VoxelChunk* nb[6];
+            for(int f=0;f<6;f++){ hold[f]=grid.Chunk(physics::PackChunkKey(p[0]+kDir[f][0],p[1]+kDir[f][1],p[2]+kDir[f][2])); nb[f]=hold[f].get(); }
+            graphics::MeshVoxelChunk(*c,nb,lod,mesh);
+            quads+=mesh.quads.size();
+        }
+        double ms=Ms(t);
+        std::printf("mesh lod %d, 1 thread: %zu quads, %.1f ms, %.1f us/chunk\n",lod,quads,ms,ms*1000.0/chunks.size());
+    }
+
+    // весь мир через job system, затем правки сферами с перемешиванием
+    graphics::VoxelRemesher remesher(grid);
+    float camera[3]={size*0.5f,float(height),size*0.5f};
+    t=prof::Now();
+    remesher.Update(camera);
+    remesher.Flush();
+    std::printf("remesh all, %u workers: %zu meshes in %.1f ms\n",core::jobs::WorkerCount(),remesher.MeshCount(),Ms(t));
+
+    std::mt19937 rng(7);
+    std::vector<physics::VoxelChunkKey> updated;
+    double editMs=0, remeshMs=0, worst=0;
+    size_t remeshed=0;
+    for(int i=0;i<edits;i++){
+        int x=int(rng()%size), z=int(rng()%size);
+        float c[3]={float(x),float(Height(x,z,height)),float(z)};
+        t=prof::Now();
+        grid.FillSphere(c,3.0f+float(rng()%6),physics::VoxelMaterial(i%2?0:1));
+        editMs+=Ms(t);
+        t=prof::Now();
+        remesher.Update(camera);
+        remesher.Flush();
+        double ms=Ms(t);
+        remeshMs+=ms;
+        worst=std::max(worst,ms);
+        remesher.TakeUpdated(updated);
+        remeshed+=updated.size();
+    }
+    if(edits)
+        std::printf("%d edits: fill %.3f ms, remesh %.3f ms avg (%.3f worst), %.1f chunks per edit\n",
+                    edits,editMs/edits,remeshMs/edits,worst,double(remeshed)/edits);
+    core::jobs::Shutdown();
+    return 0;
+}